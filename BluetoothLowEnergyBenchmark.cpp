@@ -0,0 +1,775 @@
+// BluetoothLowEnergyBenchmark.cpp : Benchmarks of the hot paths of the
+// library: uuid names, formatting, decoders, device tree lookups, reference
+// counting, storage of samples, and discovery of simulated devices.
+//
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <future>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base.h"
+#include "btle.h"
+#include "btle_address.h"
+#include "btle_async.h"
+#include "btle_benchmark.h"
+#include "btle_characteristics_def.h"
+#include "btle_devpropkey_names.h"
+#include "btle_gatt.h"
+#include "btle_gatt_sim.h"
+#include "btle_guid.h"
+#include "btle_ieee11073.h"
+#include "btle_measurements.h"
+#include "btle_output.h"
+#include "btle_sample_log.h"
+#include "btle_sensortag.h"
+#include "btle_services_def.h"
+#include "btle_time_series.h"
+#include "btle_uuid_interner.h"
+#include "btle_uuid_names.h"
+
+namespace {
+
+// Number of values the batch benchmarks process per operation.
+const size_t kBatchSize = 1024;
+
+// Samples held by the time series and sample log scanned by the scan
+// benchmarks.
+const size_t kStoredSamples = 100000;
+
+std::vector<BTH_LE_UUID> ShortServiceUuids() {
+  std::vector<BTH_LE_UUID> uuids;
+#define DEFINE_SERVICE(id, name) uuids.push_back(btle::Uuid(static_cast<USHORT>(id)).ToBthLeUuid());
+#include "btle_services.h"
+#undef DEFINE_SERVICE
+  return uuids;
+}
+
+std::vector<BTH_LE_UUID> ShortCharacteristicUuids() {
+  std::vector<BTH_LE_UUID> uuids;
+#define DEFINE_CHARACTERISTIC(id, name) uuids.push_back(btle::Uuid(static_cast<USHORT>(id)).ToBthLeUuid());
+#include "btle_characteristics.h"
+#undef DEFINE_CHARACTERISTIC
+  return uuids;
+}
+
+std::vector<BTH_LE_UUID> LongCharacteristicUuids() {
+  std::vector<BTH_LE_UUID> uuids;
+#define DEFINE_CHARACTERISTIC_LONG(uuid1, uuid2, uuid3, uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8, name) \
+  uuids.push_back(btle::Uuid(GUID{ uuid1, uuid2, uuid3, { uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8 } }).ToBthLeUuid());
+#include "btle_characteristics_long.h"
+#undef DEFINE_CHARACTERISTIC_LONG
+  return uuids;
+}
+
+std::vector<DEVPROPKEY> DevPropKeys() {
+  std::vector<DEVPROPKEY> keys;
+#undef DEFINE_DEVPROPKEY
+#define DEFINE_DEVPROPKEY(name, uuid1, uuid2, uuid3, uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8, pid) \
+  keys.push_back(DEVPROPKEY{ { uuid1, uuid2, uuid3, { uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8 } }, pid });
+#include "devpropkeys.h"
+#undef DEFINE_DEVPROPKEY
+  return keys;
+}
+
+std::vector<GUID> RandomGuids(size_t count) {
+  std::mt19937_64 random(1);
+  std::vector<GUID> guids(count);
+  for (size_t i = 0; i < count; i++) {
+    UINT64 high = random();
+    UINT64 low = random();
+    guids[i] = btle::Uuid(high, low).ToGuid();
+  }
+  return guids;
+}
+
+// Formats "guid" through a stream, as the library did before WriteGuid.
+std::string StreamFormatGuid(const GUID& guid) {
+  std::ostringstream stream;
+  stream << std::hex << std::setfill('0')
+    << std::setw(8) << guid.Data1 << "-"
+    << std::setw(4) << guid.Data2 << "-"
+    << std::setw(4) << guid.Data3 << "-";
+  for (int i = 0; i < 8; i++) {
+    if (i == 2)
+      stream << "-";
+    stream << std::setw(2) << static_cast<int>(guid.Data4[i]);
+  }
+  return stream.str();
+}
+
+std::vector<UINT8> RandomBytes(size_t count) {
+  std::mt19937_64 random(2);
+  std::vector<UINT8> bytes(count);
+  for (size_t i = 0; i < count; i++)
+    bytes[i] = static_cast<UINT8>(random());
+  return bytes;
+}
+
+// Heart rate measurement with an 8-bit rate and two RR intervals.
+std::vector<UINT8> HeartRatePayload(size_t index) {
+  std::vector<UINT8> payload;
+  UINT8 rate = static_cast<UINT8>(60 + index % 40);
+  USHORT rr = static_cast<USHORT>(60 * 1024 / rate);
+  payload.push_back(0x10);
+  payload.push_back(rate);
+  for (int i = 0; i < 2; i++) {
+    payload.push_back(static_cast<UINT8>(rr));
+    payload.push_back(static_cast<UINT8>(rr >> 8));
+  }
+  return payload;
+}
+
+// Value of a measurement characteristic, as notified by a device.
+struct MeasurementPayload {
+  USHORT characteristic;
+  std::vector<UINT8> data;
+};
+
+// One value of each decoded measurement characteristic, with most of the
+// optional fields present. Used when no recording is given.
+std::vector<MeasurementPayload> BuiltInMeasurementPayloads() {
+  // Heart rate: 16-bit rate, energy expended and one RR interval.
+  static const UINT8 kHeartRate[] = { 0x19, 0x50, 0x00, 0x10, 0x00, 0x00, 0x04 };
+  // Temperature: 36.7 C, time stamp and temperature type.
+  static const UINT8 kTemperature[] = { 0x06, 0x6f, 0x01, 0x00, 0xff, 0xde, 0x07, 0x01, 0x02, 0x03, 0x04, 0x05, 0x02 };
+  // Blood pressure: 120/80/93 mmHg, pulse rate, user id and status.
+  static const UINT8 kBloodPressure[] = { 0x1c, 0x78, 0x00, 0x50, 0x00, 0x5d, 0x00, 0x48, 0x00, 0x01, 0x00, 0x00 };
+  // Cycling speed and cadence: wheel and crank revolution data.
+  static const UINT8 kCsc[] = { 0x03, 0x10, 0x00, 0x00, 0x00, 0x00, 0x04, 0x20, 0x00, 0x00, 0x08 };
+  // Running speed and cadence: stride length, total distance, running.
+  static const UINT8 kRsc[] = { 0x07, 0x00, 0x02, 0x5a, 0x64, 0x00, 0x10, 0x27, 0x00, 0x00 };
+  // Cycling power: crank revolution data.
+  static const UINT8 kCyclingPower[] = { 0x20, 0x00, 0xfa, 0x00, 0x10, 0x00, 0x00, 0x04 };
+  // Location and speed: speed, total distance, location and heading.
+  static const UINT8 kLocation[] = { 0x17, 0x00, 0x00, 0x02, 0x10, 0x27, 0x00, 0x40, 0xe2, 0x01, 0x00, 0xc0, 0x1d, 0xfe, 0xff, 0x10, 0x27 };
+
+  std::vector<MeasurementPayload> payloads;
+  MeasurementPayload payload;
+  payload.characteristic = btle::Heart_Rate_Measurement;
+  payload.data = HeartRatePayload(0);
+  payloads.push_back(payload);
+  payload.data.assign(kHeartRate, kHeartRate + sizeof(kHeartRate));
+  payloads.push_back(payload);
+  payload.characteristic = btle::Temperature_Measurement;
+  payload.data.assign(kTemperature, kTemperature + sizeof(kTemperature));
+  payloads.push_back(payload);
+  payload.characteristic = btle::Blood_Pressure_Measurement;
+  payload.data.assign(kBloodPressure, kBloodPressure + sizeof(kBloodPressure));
+  payloads.push_back(payload);
+  payload.characteristic = btle::CSC_Measurement;
+  payload.data.assign(kCsc, kCsc + sizeof(kCsc));
+  payloads.push_back(payload);
+  payload.characteristic = btle::RSC_Measurement;
+  payload.data.assign(kRsc, kRsc + sizeof(kRsc));
+  payloads.push_back(payload);
+  payload.characteristic = btle::Cycling_Power_Measurement;
+  payload.data.assign(kCyclingPower, kCyclingPower + sizeof(kCyclingPower));
+  payloads.push_back(payload);
+  payload.characteristic = btle::Location_and_Speed;
+  payload.data.assign(kLocation, kLocation + sizeof(kLocation));
+  payloads.push_back(payload);
+  return payloads;
+}
+
+// Decodes "payload" with the decoder of its characteristic, and returns
+// its flags in "flags".
+bool DecodeMeasurement(const MeasurementPayload& payload, UINT16* flags, std::string* error) {
+  const UINT8* data = payload.data.data();
+  size_t size = payload.data.size();
+  USHORT uuid = payload.characteristic;
+  if (uuid == btle::Heart_Rate_Measurement) {
+    btle::HeartRateMeasurement measurement;
+    if (!btle::DecodeHeartRateMeasurement(data, size, &measurement, error))
+      return false;
+    *flags = measurement.flags;
+  } else if (uuid == btle::Temperature_Measurement || uuid == btle::Intermediate_Temperature) {
+    btle::TemperatureMeasurement measurement;
+    if (!btle::DecodeTemperatureMeasurement(data, size, &measurement, error))
+      return false;
+    *flags = measurement.flags;
+  } else if (uuid == btle::Blood_Pressure_Measurement || uuid == btle::Intermediate_Cuff_Pressure) {
+    btle::BloodPressureMeasurement measurement;
+    if (!btle::DecodeBloodPressureMeasurement(data, size, &measurement, error))
+      return false;
+    *flags = measurement.flags;
+  } else if (uuid == btle::CSC_Measurement) {
+    btle::CscMeasurement measurement;
+    if (!btle::DecodeCscMeasurement(data, size, &measurement, error))
+      return false;
+    *flags = measurement.flags;
+  } else if (uuid == btle::RSC_Measurement) {
+    btle::RscMeasurement measurement;
+    if (!btle::DecodeRscMeasurement(data, size, &measurement, error))
+      return false;
+    *flags = measurement.flags;
+  } else if (uuid == btle::Cycling_Power_Measurement) {
+    btle::CyclingPowerMeasurement measurement;
+    if (!btle::DecodeCyclingPowerMeasurement(data, size, &measurement, error))
+      return false;
+    *flags = measurement.flags;
+  } else if (uuid == btle::Location_and_Speed) {
+    btle::LocationAndSpeed measurement;
+    if (!btle::DecodeLocationAndSpeed(data, size, &measurement, error))
+      return false;
+    *flags = measurement.flags;
+  } else {
+    *error = "No decoder for the characteristic.";
+    return false;
+  }
+  return true;
+}
+
+// Appends the values of measurement characteristics logged in the sample
+// log at "path" (written by the "--log" option of the app) to "payloads".
+bool LoadRecordedPayloads(const std::string& path, std::vector<MeasurementPayload>* payloads, std::string* error) {
+  btle::SampleLogReader reader;
+  if (!reader.Open(std::wstring(path.begin(), path.end()), error))
+    return false;
+
+  btle::SampleLogReader::Cursor cursor = reader.All();
+  btle::SampleRecord record;
+  std::string decode_error;
+  UINT16 flags;
+  while (cursor.Next(&record)) {
+    if (!record.characteristic.IsShort())
+      continue;
+    MeasurementPayload payload;
+    payload.characteristic = record.characteristic.short_uuid();
+    payload.data.assign(record.payload.data(), record.payload.data() + record.payload.size());
+    // Keeps the values that decode, so that failures are not timed.
+    if (DecodeMeasurement(payload, &flags, &decode_error))
+      payloads->push_back(payload);
+  }
+  if (payloads->empty()) {
+    *error = "The recording has no measurement values.";
+    return false;
+  }
+  return true;
+}
+
+// Heart rate monitors and SensorTags, "count" in all.
+void AddSimulatedDevices(btle::SimulatedGattBackend* backend, int count) {
+  for (int i = 0; i < count; i++)
+    backend->AddDevice(i % 2 == 0 ? btle::SimulatedHeartRateMonitor(i / 2) : btle::SimulatedSensorTag(i / 2));
+}
+
+bool DiscoverDevices(std::vector<scoped_refptr<btle::Device>>* devices, std::string* error) {
+  std::vector<btle::DeviceInfo> infos;
+  if (!btle::GetGattBackend()->EnumerateDevices(&infos, error))
+    return false;
+  for (std::vector<btle::DeviceInfo>::const_iterator it = infos.begin(); it != infos.end(); ++it) {
+    scoped_refptr<btle::Device> device(new btle::Device(*it));
+    if (!CollectDeviceServices(device, error))
+      return false;
+    devices->push_back(device);
+  }
+  return true;
+}
+
+bool DiscoverDevicesAsync(btle::IoExecutor* executor, std::vector<scoped_refptr<btle::Device>>* devices, std::string* error) {
+  std::vector<btle::DeviceInfo> infos;
+  if (!btle::GetGattBackend()->EnumerateDevices(&infos, error))
+    return false;
+  std::vector<std::future<btle::AsyncStatus>> results;
+  for (std::vector<btle::DeviceInfo>::const_iterator it = infos.begin(); it != infos.end(); ++it) {
+    scoped_refptr<btle::Device> device(new btle::Device(*it));
+    results.push_back(CollectDeviceServicesAsync(executor, device));
+    devices->push_back(device);
+  }
+  bool success = true;
+  for (size_t i = 0; i < results.size(); i++) {
+    btle::AsyncStatus status = results[i].get();
+    if (!status.success && success) {
+      *error = status.error;
+      success = false;
+    }
+  }
+  return success;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+void AddUuidBenchmarks(btle::BenchmarkRunner* runner) {
+  runner->Add("uuid/find_service_name_short", "lookups", [](btle::BenchmarkState* state) {
+    static const std::vector<BTH_LE_UUID> uuids = ShortServiceUuids();
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::FindServiceName(uuids[i % uuids.size()]).size());
+  });
+  runner->Add("uuid/find_characteristic_name_short", "lookups", [](btle::BenchmarkState* state) {
+    static const std::vector<BTH_LE_UUID> uuids = ShortCharacteristicUuids();
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::FindCharacteristicName(uuids[i % uuids.size()]).size());
+  });
+  runner->Add("uuid/find_characteristic_name_long", "lookups", [](btle::BenchmarkState* state) {
+    static const std::vector<BTH_LE_UUID> uuids = LongCharacteristicUuids();
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::FindCharacteristicName(uuids[i % uuids.size()]).size());
+  });
+  runner->Add("uuid/find_name_unknown", "lookups", [](btle::BenchmarkState* state) {
+    static const std::vector<GUID> guids = RandomGuids(1024);
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      BTH_LE_UUID uuid = btle::Uuid(guids[i % guids.size()]).ToBthLeUuid();
+      state->Consume(btle::FindCharacteristicName(uuid).size());
+    }
+  });
+  runner->Add("uuid/format_display", "uuids", [](btle::BenchmarkState* state) {
+    static const std::vector<BTH_LE_UUID> uuids = ShortCharacteristicUuids();
+    char buffer[btle::kUuidDisplaySize];
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      const BTH_LE_UUID& uuid = uuids[i % uuids.size()];
+      state->Consume(btle::FormatUuidDisplay(uuid, btle::FindCharacteristicName(uuid), buffer, sizeof(buffer)));
+    }
+  });
+  runner->Add("uuid/parse", "uuids", [](btle::BenchmarkState* state) {
+    static const std::vector<std::string> texts = [] {
+      std::vector<std::string> result;
+      std::vector<GUID> guids = RandomGuids(1024);
+      char buffer[btle::kGuidStringSize];
+      for (size_t i = 0; i < guids.size(); i++)
+        result.push_back(std::string(buffer, btle::FormatGuid(guids[i], buffer, sizeof(buffer))));
+      result.push_back("180d");
+      return result;
+    }();
+    BTH_LE_UUID uuid;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::ParseUuid(texts[i % texts.size()], &uuid);
+      state->Consume(static_cast<UINT64>(uuid.IsShortUuid));
+    }
+  });
+  runner->Add("uuid/intern_find", "lookups", [](btle::BenchmarkState* state) {
+    static const std::vector<BTH_LE_UUID> uuids = ShortCharacteristicUuids();
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(static_cast<UINT64>(btle::UuidIds.Find(btle::Uuid(uuids[i % uuids.size()]))));
+  });
+}
+
+void AddFormattingBenchmarks(btle::BenchmarkRunner* runner) {
+  runner->Add("guid/format", "guids", [](btle::BenchmarkState* state) {
+    static const std::vector<GUID> guids = RandomGuids(1024);
+    char buffer[btle::kGuidStringSize];
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::FormatGuid(guids[i % guids.size()], buffer, sizeof(buffer)));
+  });
+  runner->Add("guid/format_stream", "guids", [](btle::BenchmarkState* state) {
+    static const std::vector<GUID> guids = RandomGuids(1024);
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(StreamFormatGuid(guids[i % guids.size()]).size());
+  });
+  runner->Add("guid/parse", "guids", [](btle::BenchmarkState* state) {
+    static const std::vector<std::string> texts = [] {
+      std::vector<std::string> result;
+      std::vector<GUID> guids = RandomGuids(1024);
+      char buffer[btle::kGuidStringSize];
+      for (size_t i = 0; i < guids.size(); i++)
+        result.push_back(std::string(buffer, btle::FormatGuid(guids[i], buffer, sizeof(buffer))));
+      return result;
+    }();
+    GUID guid;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::ParseGuid(texts[i % texts.size()], &guid);
+      state->Consume(static_cast<UINT64>(guid.Data1));
+    }
+  });
+  runner->Add("address/format", "addresses", [](btle::BenchmarkState* state) {
+    char buffer[btle::BluetoothAddress::kStringSize];
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      BLUETOOTH_ADDRESS address;
+      address.ullLong = 0x00126f4f5c4eULL + i;
+      state->Consume(btle::BluetoothAddress(address).Format(buffer, sizeof(buffer)));
+    }
+  });
+  runner->Add("address/to_string", "addresses", [](btle::BenchmarkState* state) {
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      BLUETOOTH_ADDRESS address;
+      address.ullLong = 0x00126f4f5c4eULL + i;
+      state->Consume(btle::BluetoothAddress(address).ToString().size());
+    }
+  });
+  runner->Add("address/from_device_path", "paths", [](btle::BenchmarkState* state) {
+    static const std::wstring path =
+        L"\\\\?\\bthledevice#{0000180f-0000-1000-8000-00805f9b34fb}_dev_vid&01000d_pid&0000_rev&0110_00126f4f5c4e#7&2e7b3d6e&0&0016#{6e3bb679-4372-40c8-9eaa-4509df260cd8}";
+    btle::BluetoothAddress address;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::BluetoothAddress::FromDevicePath(path, &address);
+      state->Consume(&address);
+    }
+  });
+  runner->Add("devpropkey/format", "keys", [](btle::BenchmarkState* state) {
+    static const std::vector<DEVPROPKEY> keys = DevPropKeys();
+    char buffer[btle::kDevPropKeyStringSize];
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::FormatDevPropKey(keys[i % keys.size()], buffer, sizeof(buffer)));
+  });
+  runner->Add("devpropkey/find_name", "lookups", [](btle::BenchmarkState* state) {
+    static const std::vector<DEVPROPKEY> keys = DevPropKeys();
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::FindDevPropKeyName(keys[i % keys.size()]).size());
+  });
+}
+
+void AddDecoderBenchmarks(btle::BenchmarkRunner* runner, const std::vector<MeasurementPayload>* payloads) {
+  runner->Add("decode/ir_temperature", "samples", [](btle::BenchmarkState* state) {
+    static const std::vector<UINT8> data = RandomBytes(kBatchSize * btle::sensortag::kIrTemperatureSize);
+    btle::sensortag::IrTemperature temperature;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::sensortag::DecodeIrTemperature(&data[(i % kBatchSize) * btle::sensortag::kIrTemperatureSize], &temperature);
+      state->Consume(temperature.object);
+    }
+  });
+  runner->Add("decode/ir_temperature_reference", "samples", [](btle::BenchmarkState* state) {
+    static const std::vector<UINT8> data = RandomBytes(kBatchSize * btle::sensortag::kIrTemperatureSize);
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::sensortag::ReferenceObjectTemperature(&data[(i % kBatchSize) * btle::sensortag::kIrTemperatureSize]));
+  });
+  runner->Add("decode/ir_temperature_batch", "samples", [](btle::BenchmarkState* state) {
+    static const std::vector<UINT8> data = RandomBytes(kBatchSize * btle::sensortag::kIrTemperatureSize);
+    std::vector<btle::sensortag::IrTemperature> temperatures(kBatchSize);
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::sensortag::DecodeIrTemperatures(data.data(), kBatchSize, temperatures.data());
+      state->Consume(temperatures[i % kBatchSize].object);
+    }
+    state->set_items(state->iterations() * kBatchSize);
+  });
+  runner->Add("decode/sensortag", "samples", [](btle::BenchmarkState* state) {
+    static const std::vector<UINT8> data = RandomBytes(64);
+    btle::sensortag::Decoder decoder;
+    std::string error;
+    decoder.SetBarometerCalibration(data.data(), data.size(), &error);
+    btle::sensortag::Sample sample;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::sensortag::SensorKind kind = static_cast<btle::sensortag::SensorKind>(i % btle::sensortag::kSensorKindCount);
+      const btle::sensortag::SensorInfo* info = btle::sensortag::GetSensorInfo(kind);
+      decoder.Decode(kind, data.data(), info->data_size, &sample, &error);
+      state->Consume(sample.rotation.x);
+    }
+  });
+  runner->Add("decode/heart_rate", "records", [](btle::BenchmarkState* state) {
+    static const std::vector<std::vector<UINT8>> payloads = [] {
+      std::vector<std::vector<UINT8>> result;
+      for (size_t i = 0; i < 64; i++)
+        result.push_back(HeartRatePayload(i));
+      return result;
+    }();
+    btle::HeartRateMeasurement measurement;
+    std::string error;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      const std::vector<UINT8>& payload = payloads[i % payloads.size()];
+      btle::DecodeHeartRateMeasurement(payload.data(), payload.size(), &measurement, &error);
+      state->Consume(static_cast<UINT64>(measurement.heart_rate));
+    }
+  });
+  runner->Add("decode/heart_rate_describe", "records", [](btle::BenchmarkState* state) {
+    static const std::vector<UINT8> payload = HeartRatePayload(12);
+    std::string text;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::DescribeMeasurement(btle::Heart_Rate_Measurement, payload.data(), payload.size(), &text);
+      state->Consume(text.size());
+    }
+  });
+  runner->Add("decode/cycling_power", "records", [](btle::BenchmarkState* state) {
+    // Flags (crank revolution data), power, cumulative crank revolutions and
+    // last crank event time.
+    static const UINT8 payload[] = { 0x20, 0x00, 0xfa, 0x00, 0x10, 0x00, 0x00, 0x04 };
+    btle::CyclingPowerMeasurement measurement;
+    std::string error;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::DecodeCyclingPowerMeasurement(payload, sizeof(payload), &measurement, &error);
+      state->Consume(static_cast<UINT64>(measurement.power));
+    }
+  });
+  runner->Add("decode/recorded_measurements", "records", [payloads](btle::BenchmarkState* state) {
+    std::string error;
+    UINT16 flags = 0;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      DecodeMeasurement((*payloads)[i % payloads->size()], &flags, &error);
+      state->Consume(static_cast<UINT64>(flags));
+    }
+  });
+  runner->Add("decode/sfloat", "values", [](btle::BenchmarkState* state) {
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::ieee11073::SFloatToDouble(static_cast<UINT16>(i)));
+  });
+  runner->Add("decode/sfloat_reference", "values", [](btle::BenchmarkState* state) {
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(btle::ieee11073::ReferenceSFloatToDouble(static_cast<UINT16>(i)));
+  });
+  runner->Add("decode/sfloat_batch", "values", [](btle::BenchmarkState* state) {
+    static const std::vector<UINT8> data = RandomBytes(kBatchSize * 2);
+    std::vector<double> values(kBatchSize);
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::ieee11073::SFloatsToDouble(data.data(), kBatchSize, values.data());
+      state->Consume(values[i % kBatchSize]);
+    }
+    state->set_items(state->iterations() * kBatchSize);
+  });
+}
+
+void AddDeviceTreeBenchmarks(btle::BenchmarkRunner* runner, const std::vector<scoped_refptr<btle::Device>>* devices) {
+  runner->Add("tree/find_service", "lookups", [devices](btle::BenchmarkState* state) {
+    scoped_refptr<btle::Device> device = (*devices)[0];
+    BTH_LE_UUID uuid = btle::Uuid(btle::Battery_Service).ToBthLeUuid();
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(device->FindService(uuid).get());
+  });
+  runner->Add("tree/find_characteristic", "lookups", [devices](btle::BenchmarkState* state) {
+    scoped_refptr<btle::Service> service = (*devices)[0]->FindService(btle::Uuid(btle::Heart_Rate).ToBthLeUuid());
+    BTH_LE_UUID uuid = btle::Uuid(btle::Body_Sensor_Location).ToBthLeUuid();
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      state->Consume(service->FindCharacteristic(uuid).get());
+  });
+  runner->Add("refcount/copy", "copies", [devices](btle::BenchmarkState* state) {
+    scoped_refptr<btle::Characteristic> characteristic = (*devices)[0]->services()[1]->characteristics()[0];
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      scoped_refptr<btle::Characteristic> copy(characteristic);
+      state->Consume(copy.get());
+    }
+  });
+  runner->Add("refcount/copy_services", "copies", [devices](btle::BenchmarkState* state) {
+    const std::vector<scoped_refptr<btle::Service>>& services = (*devices)[0]->services();
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      std::vector<scoped_refptr<btle::Service>> copy(services);
+      state->Consume(copy.back().get());
+    }
+  });
+}
+
+void AddStorageBenchmarks(btle::BenchmarkRunner* runner) {
+  // Heart rate and RR interval as integers, temperature as a float, one
+  // sample per second.
+  static const std::vector<btle::SeriesColumnType> columns = {
+    btle::kIntegerColumn, btle::kIntegerColumn, btle::kFloatColumn
+  };
+  struct Samples {
+    static btle::SeriesSample Make(UINT64 index) {
+      btle::SeriesSample sample = {};
+      sample.timestamp_us = index * 1000000;
+      sample.integers[0] = 60 + (index * 7) % 40;
+      sample.integers[1] = 60 * 1024 / sample.integers[0];
+      sample.floats[2] = 25.0 + ((index / 8) % 64) * 0.03125;
+      return sample;
+    }
+  };
+
+  runner->Add("time_series/append", "samples", [](btle::BenchmarkState* state) {
+    btle::TimeSeries series(columns, btle::TimeSeries::kDefaultBlockSamples);
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      series.Append(Samples::Make(i));
+    btle::SeriesStats stats = series.stats();
+    state->SetCounter("compression_ratio", stats.encoded_bytes == 0 ? 0 : static_cast<double>(stats.raw_bytes) / stats.encoded_bytes);
+  });
+  // Baseline of time_series/append: the samples stored uncompressed.
+  runner->Add("time_series/append_raw", "samples", [](btle::BenchmarkState* state) {
+    std::vector<btle::SeriesSample> samples;
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      samples.push_back(Samples::Make(i));
+    state->Consume(samples.data());
+  });
+  // Series of "kStoredSamples" samples, appended to by the first run that
+  // uses it, outside of its timing.
+  struct StoredSeries {
+    static btle::TimeSeries* Get(btle::BenchmarkState* state) {
+      static btle::TimeSeries* series = NULL;
+      if (series == NULL) {
+        state->PauseTiming();
+        series = new btle::TimeSeries(columns, btle::TimeSeries::kDefaultBlockSamples);
+        for (UINT64 i = 0; i < kStoredSamples; i++)
+          series->Append(Samples::Make(i));
+        state->ResumeTiming();
+      }
+      return series;
+    }
+  };
+  runner->Add("time_series/scan", "samples", [](btle::BenchmarkState* state) {
+    btle::TimeSeries* stored_series = StoredSeries::Get(state);
+    btle::SeriesSample sample;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::TimeSeries::Cursor cursor = stored_series->All();
+      while (cursor.Next(&sample))
+        state->Consume(sample.floats[2]);
+    }
+    state->set_items(state->iterations() * kStoredSamples);
+  });
+  runner->Add("time_series/aggregate", "queries", [](btle::BenchmarkState* state) {
+    btle::TimeSeries* stored_series = StoredSeries::Get(state);
+    btle::SeriesAggregate aggregate;
+    std::string error;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      // A tenth of the series, at a moving offset.
+      UINT64 from_us = (i * 7919 % (kStoredSamples * 9 / 10)) * 1000000;
+      stored_series->Aggregate(0, from_us, from_us + kStoredSamples / 10 * 1000000, &aggregate, &error);
+      state->Consume(aggregate.sum);
+    }
+  });
+
+  runner->Add("sample_log/append", "records", [](btle::BenchmarkState* state) {
+    static const std::vector<UINT8> payload = HeartRatePayload(0);
+    std::wstring path = L"btle_benchmark.log";
+    btle::UuidId id = btle::UuidIds.Intern(btle::Uuid(btle::Heart_Rate_Measurement));
+    btle::BluetoothAddress device(0x00126f4f5c4eULL);
+    std::string error;
+    state->PauseTiming();
+    btle::SampleLogWriter writer;
+    writer.Open(path, btle::SampleLogWriter::kDefaultBlockSize, btle::SampleLogWriter::kDefaultCommitIntervalUs, &error);
+    state->ResumeTiming();
+    for (UINT64 i = 0; i < state->iterations(); i++)
+      writer.Append(i * 1000000, device, id, payload.data(), payload.size(), &error);
+    writer.Close(&error);
+    state->PauseTiming();
+    remove(to_std_string(path).c_str());
+    state->ResumeTiming();
+  });
+  runner->Add("sample_log/scan", "records", [](btle::BenchmarkState* state) {
+    static const std::vector<UINT8> payload = HeartRatePayload(0);
+    std::wstring path = L"btle_benchmark.log";
+    std::string error;
+    state->PauseTiming();
+    {
+      btle::UuidId id = btle::UuidIds.Intern(btle::Uuid(btle::Heart_Rate_Measurement));
+      btle::SampleLogWriter writer;
+      writer.Open(path, btle::SampleLogWriter::kDefaultBlockSize, btle::SampleLogWriter::kDefaultCommitIntervalUs, &error);
+      for (UINT64 i = 0; i < kStoredSamples; i++)
+        writer.Append(i * 1000000, btle::BluetoothAddress(0x00126f4f5c4eULL), id, payload.data(), payload.size(), &error);
+      writer.Close(&error);
+    }
+    btle::SampleLogReader reader;
+    reader.Open(path, &error);
+    state->ResumeTiming();
+    btle::SampleRecord record;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      btle::SampleLogReader::Cursor cursor = reader.All();
+      while (cursor.Next(&record))
+        state->Consume(record.timestamp_us);
+    }
+    state->PauseTiming();
+    reader.Close();
+    remove(to_std_string(path).c_str());
+    state->ResumeTiming();
+    state->set_items(state->iterations() * kStoredSamples);
+  });
+}
+
+void AddDiscoveryBenchmarks(btle::BenchmarkRunner* runner, int device_count, btle::IoExecutor* executor) {
+  std::string name = "discovery/simulated_" + std::to_string(device_count);
+  runner->Add(name, "devices", [](btle::BenchmarkState* state) {
+    std::string error;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      std::vector<scoped_refptr<btle::Device>> devices;
+      if (!DiscoverDevices(&devices, &error)) {
+        printf("Error: %s\n", error.c_str());
+        exit(-1);
+      }
+      state->set_items(devices.size() * state->iterations());
+    }
+  });
+  runner->Add(name + "_async", "devices", [executor](btle::BenchmarkState* state) {
+    std::string error;
+    for (UINT64 i = 0; i < state->iterations(); i++) {
+      std::vector<scoped_refptr<btle::Device>> devices;
+      if (!DiscoverDevicesAsync(executor, &devices, &error)) {
+        printf("Error: %s\n", error.c_str());
+        exit(-1);
+      }
+      state->set_items(devices.size() * state->iterations());
+    }
+  });
+}
+
+void PrintResult(const btle::BenchmarkResult& result) {
+  printf("%-40s %12.1f ns/op %9.2f allocs/op %10.1f B/op %14.0f %s/s",
+         result.name.c_str(), result.ns_per_op, result.allocations_per_op, result.allocated_bytes_per_op,
+         result.throughput, result.item_unit.c_str());
+  for (std::vector<std::pair<std::string, double>>::const_iterator it = result.counters.begin(); it != result.counters.end(); ++it)
+    printf(" %s=%.2f", it->first.c_str(), it->second);
+  printf("\n");
+  fflush(stdout);
+}
+
+}  // namespace
+
+// Number of threads of the asynchronous discovery.
+const size_t kIoThreads = 4;
+
+int main(int argc, char* argv[]) {
+  // Options: "--filter <substring>" (benchmarks to run), "--format
+  // text|json|ndjson" (output of the results), "--min-time-ms <ms>" (time
+  // of a run), "--repetitions <count>" (runs of each benchmark, the median
+  // is reported), "--devices <count>" (simulated devices discovered),
+  // "--recording <sample log file>" (measurement values decoded by
+  // "decode/recorded_measurements", instead of built-in ones).
+  btle::BenchmarkOptions options;
+  btle::OutputFormat output_format = btle::kTextOutput;
+  int device_count = 100;
+  std::string recording;
+  for (int arg_index = 1; arg_index + 1 < argc; arg_index += 2) {
+    std::string option = argv[arg_index];
+    std::string value = argv[arg_index + 1];
+    if (option == "--filter") {
+      options.filter = value;
+    } else if (option == "--format") {
+      if (!btle::ParseOutputFormat(value, &output_format)) {
+        printf("Error: Unknown output format.\n");
+        return -1;
+      }
+    } else if (option == "--min-time-ms") {
+      options.min_time_ms = strtoull(value.c_str(), NULL, 10);
+    } else if (option == "--repetitions") {
+      options.repetitions = std::max(atoi(value.c_str()), 1);
+    } else if (option == "--devices") {
+      device_count = std::max(atoi(value.c_str()), 1);
+    } else if (option == "--recording") {
+      recording = value;
+    } else {
+      printf("Error: Unknown option '%s'.\n", option.c_str());
+      return -1;
+    }
+  }
+
+  std::string error;
+  std::vector<MeasurementPayload> payloads;
+  if (recording.empty()) {
+    payloads = BuiltInMeasurementPayloads();
+  } else if (!LoadRecordedPayloads(recording, &payloads, &error)) {
+    printf("Error: %s\n", error.c_str());
+    return -1;
+  }
+
+  // All GATT calls are served by the simulated devices.
+  btle::SimulatedGattBackend simulator;
+  AddSimulatedDevices(&simulator, device_count);
+  btle::SetGattBackend(&simulator);
+
+  std::vector<scoped_refptr<btle::Device>> devices;
+  if (!DiscoverDevices(&devices, &error)) {
+    printf("Error: %s\n", error.c_str());
+    return -1;
+  }
+
+  btle::IoExecutor executor(kIoThreads);
+  btle::BenchmarkRunner runner(options);
+  AddUuidBenchmarks(&runner);
+  AddFormattingBenchmarks(&runner);
+  AddDecoderBenchmarks(&runner, &payloads);
+  AddDeviceTreeBenchmarks(&runner, &devices);
+  AddStorageBenchmarks(&runner);
+  AddDiscoveryBenchmarks(&runner, device_count, &executor);
+
+  std::vector<btle::BenchmarkResult> results;
+  if (output_format == btle::kTextOutput) {
+    runner.Run(PrintResult, &results);
+  } else {
+    runner.Run(NULL, &results);
+    btle::OutputWriter writer(stdout, output_format);
+    for (std::vector<btle::BenchmarkResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+      WriteBenchmarkResult(*it, &writer);
+  }
+  return 0;
+}
@@ -0,0 +1,26 @@
+// BluetoothLowEnergyTests.cpp : Runs the unit tests of the library.
+//
+
+#include "stdafx.h"
+
+#include <stdio.h>
+
+#include <string>
+
+#include "btle_test.h"
+
+int main(int argc, char* argv[]) {
+  // Options: "--filter <substring>" (tests to run).
+  std::string filter;
+  for (int arg_index = 1; arg_index + 1 < argc; arg_index += 2) {
+    std::string option = argv[arg_index];
+    if (option == "--filter") {
+      filter = argv[arg_index + 1];
+    } else {
+      printf("Error: Unknown option '%s'.\n", option.c_str());
+      return -1;
+    }
+  }
+
+  return btle::test::RunTests(filter) == 0 ? 0 : 1;
+}
@@ -1,3 +1,3 @@
-#include "stdafx.h"
-
+#include "stdafx.h"
+
 #include "btle.h"
\ No newline at end of file
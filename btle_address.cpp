@@ -0,0 +1,106 @@
+#include "stdafx.h"
+
+#include "btle_address.h"
+
+namespace btle {
+
+namespace {
+
+// Returns the value of the hex digit "c", or a value with bit 4 set if "c"
+// is not a hex digit (including any character outside of ASCII).
+inline
+UINT32 HexDigitValue(UINT32 c) {
+  UINT32 digit = c - '0';
+  UINT32 letter = (c | 0x20) - 'a';
+  UINT32 is_digit = digit < 10;
+  UINT32 is_letter = letter < 6;
+  // Exactly one of the masks is all ones for a valid digit.
+  UINT32 value = (digit & (0 - is_digit)) | ((letter + 10) & (0 - is_letter));
+  return value | ((1 - (is_digit | is_letter)) << 4);
+}
+
+template <typename Char>
+inline
+bool IsHexDigit(Char c) {
+  return HexDigitValue(static_cast<UINT32>(c)) < 16;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+char* BluetoothAddress::Write(char* out, bool lower_case) const {
+  // Between '9' and 'A' (or 'a') there are 7 (or 39) characters.
+  UINT32 letter_offset = lower_case ? 39 : 7;
+  for (size_t i = 0; i < kDigits; i++) {
+    UINT32 nibble = static_cast<UINT32>(value_ >> (4 * (kDigits - 1 - i))) & 0x0f;
+    UINT32 is_letter = nibble > 9;
+    out[i] = static_cast<char>('0' + nibble + (letter_offset & (0 - is_letter)));
+  }
+  return out + kDigits;
+}
+
+size_t BluetoothAddress::Format(char* buffer, size_t size) const {
+  if (size < kStringSize)
+    return 0;
+  Write(buffer, false);
+  buffer[kDigits] = 0;
+  return kDigits;
+}
+
+std::string BluetoothAddress::ToString() const {
+  char buffer[kStringSize];
+  return std::string(buffer, Format(buffer, sizeof(buffer)));
+}
+
+template <typename Char>
+bool BluetoothAddress::ParseDigits(const Char* digits, BluetoothAddress* address) {
+  UINT64 value = 0;
+  UINT32 error = 0;
+  for (size_t i = 0; i < kDigits; i++) {
+    UINT32 digit = HexDigitValue(static_cast<UINT32>(digits[i]));
+    error |= digit;
+    value = (value << 4) | (digit & 0x0f);
+  }
+  if (error & 0x10)
+    return false;
+  *address = BluetoothAddress(value);
+  return true;
+}
+
+bool BluetoothAddress::Parse(std::string_view text, BluetoothAddress* address) {
+  if (text.size() != kDigits)
+    return false;
+  return ParseDigits(text.data(), address);
+}
+
+bool BluetoothAddress::FromInstanceId(std::string_view id, BluetoothAddress* address) {
+  size_t start = id.find('_');
+  if (start == std::string_view::npos)
+    return false;
+  size_t end = id.find('\\', start);
+  if (end == std::string_view::npos)
+    return false;
+  return Parse(id.substr(start + 1, end - start - 1), address);
+}
+
+bool BluetoothAddress::FromDevicePath(std::wstring_view path, BluetoothAddress* address) {
+  // Candidates end with a "#": skip over the runs of digits that don't.
+  size_t position = 0;
+  while (position + kDigits + 2 <= path.size()) {
+    if (path[position] != L'_') {
+      position++;
+      continue;
+    }
+    size_t count = 0;
+    while (count < kDigits && IsHexDigit(path[position + 1 + count]))
+      count++;
+    if (count == kDigits && path[position + 1 + kDigits] == L'#')
+      return ParseDigits(path.data() + position + 1, address);
+    position += 1 + count;
+  }
+  return false;
+}
+
+}  // namespace btle
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "btle_platform.h"
+
+#include "base.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// 48-bit Bluetooth device address, held in the low bits of an integer, so
+// that addresses are cheap to copy, compare and hash.
+//
+// The text form is 12 hex digits, most significant byte first
+// ("00126F4F5C4E"), as in device instance IDs. Parsing and formatting work
+// digit by digit with arithmetic instead of branches or sscanf/sprintf, and
+// never allocate.
+//
+class BluetoothAddress {
+public:
+  // Number of hex digits of the text form.
+  static const size_t kDigits = 12;
+  // Size of a formatted address, including the terminating null.
+  static const size_t kStringSize = kDigits + 1;
+  static const UINT64 kMask = 0xffffffffffffULL;
+
+  BluetoothAddress() : value_(0) {
+  }
+
+  explicit BluetoothAddress(UINT64 value) : value_(value & kMask) {
+  }
+
+  explicit BluetoothAddress(const BLUETOOTH_ADDRESS& address) : value_(address.ullLong & kMask) {
+  }
+
+  UINT64 value() const { return value_; }
+  bool IsNull() const { return value_ == 0; }
+
+  BLUETOOTH_ADDRESS ToBluetoothAddress() const {
+    BLUETOOTH_ADDRESS result;
+    result.ullLong = value_;
+    return result;
+  }
+
+  // Writes the 12 digits to "out", without null terminator. Returns the end
+  // of the written characters.
+  char* Write(char* out, bool lower_case) const;
+
+  // Writes the upper case digits null terminated. Returns the number of
+  // characters written, not counting the null, or 0 if "size" is too small.
+  size_t Format(char* buffer, size_t size) const;
+
+  std::string ToString() const;
+
+  // Parses exactly 12 hex digits, upper or lower case.
+  static bool Parse(std::string_view text, BluetoothAddress* address);
+
+  // Device instance IDs: "BTHLE\DEV_00126F4F5C4E\7&2e7b3d6e&0&00126F4F5C4E".
+  // The address is the part between the first "_" and the next "\".
+  static bool FromInstanceId(std::string_view id, BluetoothAddress* address);
+
+  // Device interface paths of GATT services:
+  // "\\?\bthledevice#{...}_dev_vid&..._pid&..._rev&..._00126f4f5c4e#7&...".
+  // The address is the first run of 12 hex digits between "_" and "#".
+  static bool FromDevicePath(std::wstring_view path, BluetoothAddress* address);
+
+  bool operator==(const BluetoothAddress& other) const { return value_ == other.value_; }
+  bool operator!=(const BluetoothAddress& other) const { return value_ != other.value_; }
+  bool operator<(const BluetoothAddress& other) const { return value_ < other.value_; }
+
+  // Mixes all the bits of the address, as the low bits of consecutive
+  // addresses of a vendor differ little.
+  size_t Hash() const {
+    UINT64 value = value_;
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    return static_cast<size_t>(value);
+  }
+
+private:
+  // Parses the 12 characters at "digits", of type char or wchar_t.
+  template <typename Char>
+  static bool ParseDigits(const Char* digits, BluetoothAddress* address);
+
+  UINT64 value_;
+};
+
+}  // namespace btle
+
+namespace std {
+
+template <>
+struct hash<btle::BluetoothAddress> {
+  size_t operator()(const btle::BluetoothAddress& address) const {
+    return address.Hash();
+  }
+};
+
+}  // namespace std
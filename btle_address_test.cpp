@@ -0,0 +1,127 @@
+#include "stdafx.h"
+
+#include <string>
+#include <string_view>
+
+#include "btle_address.h"
+#include "btle_test.h"
+
+// Exactly 12 hex digits, of either case.
+BTLE_TEST(address, Parse) {
+  btle::BluetoothAddress address;
+  BTLE_EXPECT(btle::BluetoothAddress::Parse("00126F4F5C4E", &address));
+  BTLE_EXPECT_EQ(0x00126f4f5c4eULL, address.value());
+  BTLE_EXPECT(btle::BluetoothAddress::Parse("abcdefABCDEF", &address));
+  BTLE_EXPECT_EQ(0xabcdefabcdefULL, address.value());
+
+  BTLE_EXPECT(!btle::BluetoothAddress::Parse("", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::Parse("00126F4F5C4", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::Parse("00126F4F5C4E0", &address));
+  BTLE_EXPECT_EQ(0xabcdefabcdefULL, address.value());
+}
+
+// Every character around the digit and letter ranges, and outside of
+// ASCII, is rejected at every position.
+BTLE_TEST(address, ParseInvalidCharacters) {
+  const char kInvalid[] = { '/', ':', '@', 'G', '`', 'g', ' ', '\0', '\x80', '\xb0', '\xc1', '\xff' };
+  int accepted = 0;
+  for (size_t i = 0; i < sizeof(kInvalid); i++) {
+    for (size_t position = 0; position < btle::BluetoothAddress::kDigits; position++) {
+      std::string text = "00126F4F5C4E";
+      text[position] = kInvalid[i];
+      btle::BluetoothAddress address;
+      if (btle::BluetoothAddress::Parse(text, &address))
+        accepted++;
+    }
+  }
+  BTLE_EXPECT_EQ(0, accepted);
+}
+
+// "\\?\bthledevice#{...}_dev_vid&..._00126f4f5c4e#..." paths.
+BTLE_TEST(address, FromDevicePath) {
+  btle::BluetoothAddress address;
+  BTLE_EXPECT(btle::BluetoothAddress::FromDevicePath(
+      L"\\\\?\\bthledevice#{0000180f-0000-1000-8000-00805f9b34fb}_dev_vid&02000d_pid&0000_rev&0110_00126f4f5c4e#7&2e7b3d6e&0&0023#{6e3bb679-4372-40c8-9eaa-4509df260cd8}",
+      &address));
+  BTLE_EXPECT_EQ(0x00126f4f5c4eULL, address.value());
+
+  // Runs of 12 hex digits not followed by "#", or too short, are skipped.
+  BTLE_EXPECT(btle::BluetoothAddress::FromDevicePath(L"_abcdefabcdef0#_abc#_00126F4F5C4E_#_0123456789ab#", &address));
+  BTLE_EXPECT_EQ(0x0123456789abULL, address.value());
+  BTLE_EXPECT(btle::BluetoothAddress::FromDevicePath(L"__0123456789ab#", &address));
+  BTLE_EXPECT_EQ(0x0123456789abULL, address.value());
+
+  BTLE_EXPECT(!btle::BluetoothAddress::FromDevicePath(L"", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::FromDevicePath(L"_00126f4f5c4e", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::FromDevicePath(L"00126f4f5c4e#", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::FromDevicePath(L"_00126f4f5c4e0#", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::FromDevicePath(L"_00126f4f5c4#_00126f4f5c4e", &address));
+  BTLE_EXPECT_EQ(0x0123456789abULL, address.value());
+}
+
+// Wide characters whose low byte is a hex digit, and the full width forms
+// of the digits, are not hex digits.
+BTLE_TEST(address, FromDevicePathWideCharacters) {
+  const wchar_t kInvalid[] = { 0x0130, 0x0141, 0x0161, 0x1030, 0x3061, 0xff10, 0xff21, 0xff41, 0xffff };
+  int accepted = 0;
+  for (size_t i = 0; i < sizeof(kInvalid) / sizeof(kInvalid[0]); i++) {
+    for (size_t position = 0; position < btle::BluetoothAddress::kDigits; position++) {
+      std::wstring path = L"_00126f4f5c4e#";
+      path[1 + position] = kInvalid[i];
+      btle::BluetoothAddress address;
+      if (btle::BluetoothAddress::FromDevicePath(path, &address))
+        accepted++;
+    }
+  }
+  BTLE_EXPECT_EQ(0, accepted);
+}
+
+// The address is between the first "_" and the next "\".
+BTLE_TEST(address, FromInstanceId) {
+  btle::BluetoothAddress address;
+  BTLE_EXPECT(btle::BluetoothAddress::FromInstanceId("BTHLE\\DEV_00126F4F5C4E\\7&2e7b3d6e&0&00126F4F5C4E", &address));
+  BTLE_EXPECT_EQ(0x00126f4f5c4eULL, address.value());
+
+  BTLE_EXPECT(!btle::BluetoothAddress::FromInstanceId("BTHLE\\DEV00126F4F5C4E\\7&2e7b3d6e&0&00126F4F5C4E", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::FromInstanceId("BTHLE\\DEV_00126F4F5C4E", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::FromInstanceId("BTHLE\\DEV_00126F4F5C4E0\\7", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::FromInstanceId("BTHLE\\DEV_\\00126F4F5C4E", &address));
+  // A "\" before the "_" is not the end of the address.
+  BTLE_EXPECT(!btle::BluetoothAddress::FromInstanceId("BTHLE\\00126F4F5C4E_", &address));
+  BTLE_EXPECT(!btle::BluetoothAddress::FromInstanceId("", &address));
+  BTLE_EXPECT_EQ(0x00126f4f5c4eULL, address.value());
+}
+
+// Written digits parse back to the address, in both cases.
+BTLE_TEST(address, WriteRoundTrip) {
+  const UINT64 kValues[] = { 0, 0x00126f4f5c4eULL, 0xabcdefabcdefULL, 0x0123456789abULL, 0xffffffffffffULL };
+  for (size_t i = 0; i < sizeof(kValues) / sizeof(kValues[0]); i++) {
+    btle::BluetoothAddress address(kValues[i]);
+    char upper[btle::BluetoothAddress::kDigits];
+    char lower[btle::BluetoothAddress::kDigits];
+    BTLE_EXPECT(address.Write(upper, false) == upper + btle::BluetoothAddress::kDigits);
+    BTLE_EXPECT(address.Write(lower, true) == lower + btle::BluetoothAddress::kDigits);
+    for (size_t digit = 0; digit < btle::BluetoothAddress::kDigits; digit++) {
+      BTLE_EXPECT(!(upper[digit] >= 'a' && upper[digit] <= 'f'));
+      BTLE_EXPECT(!(lower[digit] >= 'A' && lower[digit] <= 'F'));
+      BTLE_EXPECT_EQ(upper[digit] | 0x20, lower[digit] | 0x20);
+    }
+
+    btle::BluetoothAddress parsed;
+    BTLE_EXPECT(btle::BluetoothAddress::Parse(std::string_view(upper, sizeof(upper)), &parsed));
+    BTLE_EXPECT(parsed == address);
+    BTLE_EXPECT(btle::BluetoothAddress::Parse(std::string_view(lower, sizeof(lower)), &parsed));
+    BTLE_EXPECT(parsed == address);
+    BTLE_EXPECT_EQ(std::string(upper, sizeof(upper)), address.ToString());
+  }
+
+  char lower[btle::BluetoothAddress::kDigits];
+  btle::BluetoothAddress(0xabcdef012345ULL).Write(lower, true);
+  BTLE_EXPECT_EQ(std::string("abcdef012345"), std::string(lower, sizeof(lower)));
+
+  char buffer[btle::BluetoothAddress::kStringSize];
+  BTLE_EXPECT_EQ(0u, btle::BluetoothAddress(1).Format(buffer, sizeof(buffer) - 1));
+  BTLE_EXPECT_EQ(12u, btle::BluetoothAddress(1).Format(buffer, sizeof(buffer)));
+  BTLE_EXPECT_EQ(std::string("000000000001"), std::string(buffer));
+  BTLE_EXPECT_EQ(0x123456789abcULL, btle::BluetoothAddress(0xff123456789abcULL).value());
+}
@@ -0,0 +1,430 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "btle_async.h"
+#include "btle_gatt.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+IoExecutor::IoExecutor(size_t thread_count) : running_(0), stopping_(false), next_timer_id_(1), next_command_id_(1) {
+  if (thread_count == 0)
+    thread_count = 1;
+  for (size_t i = 0; i < thread_count; i++) {
+    threads_.push_back(std::thread([this]() { Run(); }));
+  }
+  timer_thread_ = std::thread([this]() { RunTimer(); });
+}
+
+IoExecutor::~IoExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  timer_condition_.notify_all();
+  timer_thread_.join();
+  for (std::vector<std::thread>::iterator it = threads_.begin(); it != threads_.end(); ++it) {
+    it->join();
+  }
+}
+
+ULONG IoExecutor::PostDelayed(const Task& task, DWORD delay_ms) {
+  ULONG id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DelayedTask timer;
+    timer.id = id = next_timer_id_++;
+    timer.task = task;
+    timer_ids_[id] = timers_.insert(std::make_pair(monotonic_microseconds() + delay_ms * 1000ULL, timer));
+  }
+  timer_condition_.notify_one();
+  return id;
+}
+
+bool IoExecutor::CancelDelayed(ULONG timer_id) {
+  Task task;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<ULONG, TimerMap::iterator>::iterator it = timer_ids_.find(timer_id);
+    if (it == timer_ids_.end())
+      return false;
+    // Released after unlocking: it may hold the last reference to an object
+    // taking "mutex_" in its destructor.
+    task.swap(it->second->second.task);
+    timers_.erase(it->second);
+    timer_ids_.erase(it);
+  }
+  return true;
+}
+
+ULONG IoExecutor::PostSerialized(ULONGLONG queue_key, const Task& task) {
+  ULONG id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SerialQueue& queue = queues_[queue_key];
+    SerialCommand command;
+    command.id = id = next_command_id_++;
+    command.posted_us = monotonic_microseconds();
+    command.task = task;
+    queue.commands.push_back(command);
+    queue.metrics.queue_depth = static_cast<ULONG>(queue.commands.size());
+    queue.metrics.max_queue_depth = std::max(queue.metrics.max_queue_depth, queue.metrics.queue_depth);
+    if (queue.active)
+      return id;
+    queue.active = true;
+    tasks_.push_back([this, queue_key]() { RunSerialized(queue_key); });
+  }
+  condition_.notify_one();
+  return id;
+}
+
+bool IoExecutor::RemoveSerialized(ULONGLONG queue_key, ULONG command_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  SerialQueue& queue = queues_[queue_key];
+  for (std::deque<SerialCommand>::iterator it = queue.commands.begin(); it != queue.commands.end(); ++it) {
+    if (it->id == command_id) {
+      queue.commands.erase(it);
+      queue.metrics.queue_depth = static_cast<ULONG>(queue.commands.size());
+      return true;
+    }
+  }
+  return false;
+}
+
+void IoExecutor::RecordAbandoned(ULONGLONG queue_key, bool timed_out, bool running) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CommandQueueMetrics& metrics = queues_[queue_key].metrics;
+  if (timed_out) {
+    metrics.timeouts++;
+  } else {
+    metrics.cancellations++;
+  }
+  if (running)
+    metrics.abandoned_running++;
+}
+
+void IoExecutor::RunSerialized(ULONGLONG queue_key) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  SerialQueue& queue = queues_[queue_key];
+  if (queue.commands.empty()) {
+    // All the remaining commands were removed.
+    queue.active = false;
+    return;
+  }
+  ULONGLONG start_us = monotonic_microseconds();
+  ULONGLONG wait_us = start_us - queue.commands.front().posted_us;
+  Task task = queue.commands.front().task;
+  queue.commands.pop_front();
+  queue.metrics.queue_depth = static_cast<ULONG>(queue.commands.size());
+  queue.metrics.total_wait_us += wait_us;
+  queue.metrics.max_wait_us = std::max(queue.metrics.max_wait_us, wait_us);
+  lock.unlock();
+
+  task();
+
+  lock.lock();
+  queue.metrics.commands++;
+  queue.metrics.total_run_us += monotonic_microseconds() - start_us;
+  if (queue.commands.empty()) {
+    queue.active = false;
+    return;
+  }
+  // Go back to the end of the executor queue, so that a busy device doesn't
+  // starve the others.
+  tasks_.push_back([this, queue_key]() { RunSerialized(queue_key); });
+  lock.unlock();
+  condition_.notify_one();
+}
+
+bool IoExecutor::GetQueueMetrics(ULONGLONG queue_key, CommandQueueMetrics* metrics) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<ULONGLONG, SerialQueue>::const_iterator it = queues_.find(queue_key);
+  if (it == queues_.end())
+    return false;
+  *metrics = it->second.metrics;
+  return true;
+}
+
+CommandQueueMetrics IoExecutor::queue_metrics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CommandQueueMetrics total;
+  for (std::map<ULONGLONG, SerialQueue>::const_iterator it = queues_.begin(); it != queues_.end(); ++it) {
+    const CommandQueueMetrics& metrics = it->second.metrics;
+    total.commands += metrics.commands;
+    total.queue_depth += metrics.queue_depth;
+    total.max_queue_depth = std::max(total.max_queue_depth, metrics.max_queue_depth);
+    total.total_wait_us += metrics.total_wait_us;
+    total.max_wait_us = std::max(total.max_wait_us, metrics.max_wait_us);
+    total.total_run_us += metrics.total_run_us;
+    total.timeouts += metrics.timeouts;
+    total.cancellations += metrics.cancellations;
+    total.abandoned_running += metrics.abandoned_running;
+  }
+  return total;
+}
+
+void IoExecutor::RunTimer() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (timers_.empty()) {
+      timer_condition_.wait(lock);
+      continue;
+    }
+
+    ULONGLONG now_us = monotonic_microseconds();
+    TimerMap::iterator it = timers_.begin();
+    if (it->first > now_us) {
+      timer_condition_.wait_for(lock, std::chrono::microseconds(it->first - now_us));
+      continue;
+    }
+
+    tasks_.push_back(it->second.task);
+    timer_ids_.erase(it->second.id);
+    timers_.erase(it);
+    condition_.notify_one();
+  }
+}
+
+void IoExecutor::Post(const Task& task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+  }
+  condition_.notify_one();
+}
+
+size_t IoExecutor::pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size() + running_;
+}
+
+void IoExecutor::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    while (tasks_.empty() && !stopping_)
+      condition_.wait(lock);
+    if (tasks_.empty())
+      return;
+
+    Task task = tasks_.front();
+    tasks_.pop_front();
+    running_++;
+    lock.unlock();
+    task();
+    lock.lock();
+    running_--;
+  }
+}
+
+}  // namespace btle
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+std::future<btle::AsyncResult<scoped_refptr<btle::CharacteristicValue>>> ReadServiceCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context) {
+  return btle::PostAsync<scoped_refptr<btle::CharacteristicValue>>(
+      executor,
+      btle::DeviceQueueKey(device),
+      context,
+      [=](scoped_refptr<btle::CharacteristicValue>* value, std::string* error) {
+        return ReadServiceCharacteristicValue(service_handle->get(), characteristic, value, error);
+      });
+}
+
+void ReadServiceCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context,
+    const btle::AsyncValue<scoped_refptr<btle::CharacteristicValue>>::Callback& callback) {
+  btle::PostAsync<scoped_refptr<btle::CharacteristicValue>>(
+      executor,
+      btle::DeviceQueueKey(device),
+      context,
+      [=](scoped_refptr<btle::CharacteristicValue>* value, std::string* error) {
+        return ReadServiceCharacteristicValue(service_handle->get(), characteristic, value, error);
+      },
+      callback);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+std::future<btle::AsyncStatus> WriteServiceCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::CharacteristicValue> value,
+    ULONG flags,
+    const btle::OperationContext& context) {
+  std::shared_ptr<std::promise<btle::AsyncStatus>> promise(new std::promise<btle::AsyncStatus>());
+  WriteServiceCharacteristicValueAsync(executor, device, service_handle, characteristic, value, flags, context, [promise](const btle::AsyncStatus& status) {
+    promise->set_value(status);
+  });
+  return promise->get_future();
+}
+
+// Waits for its turn in "DeviceWriteRateLimiter" without holding a thread or
+// the device queue, then writes the latest value on the device queue.
+// "context" bounds both waits.
+void WriteServiceCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::CharacteristicValue> value,
+    ULONG flags,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback) {
+  DeviceWriteRateLimiter.WriteAsync(
+      executor,
+      device->info().address.ullLong,
+      characteristic->info().CharacteristicValueHandle,
+      value,
+      true/*coalesce*/,
+      context,
+      [=](scoped_refptr<btle::CharacteristicValue> latest_value, const btle::WriteRateLimiter::WriteCallback& done) {
+        btle::PostAsync(executor, btle::DeviceQueueKey(device), context, [=](std::string* error) {
+          return WriteServiceCharacteristicValueWorker(service_handle->get(), characteristic, latest_value, flags, error);
+        }, [done](const btle::AsyncStatus& status) {
+          done(status.success, status.error);
+        });
+      },
+      [callback](bool success, const std::string& error) {
+        btle::AsyncStatus status;
+        status.success = success;
+        status.error = error;
+        callback(status);
+      });
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+static btle::AsyncOperation SubscribeOperation(
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic) {
+  return [=](std::string* error) {
+    return SubscribeToNotifications(service_handle->get(), characteristic, error);
+  };
+}
+
+std::future<btle::AsyncStatus> SubscribeToNotificationsAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context) {
+  return btle::PostAsync(executor, btle::DeviceQueueKey(device), context, SubscribeOperation(service_handle, characteristic));
+}
+
+void SubscribeToNotificationsAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback) {
+  btle::PostAsync(executor, btle::DeviceQueueKey(device), context, SubscribeOperation(service_handle, characteristic), callback);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+static btle::AsyncOperation CollectDescriptorValueOperation(
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::Descriptor> descriptor) {
+  return [=](std::string* error) {
+    return CollectCharacteristicDescriptorValue(device, service, characteristic, descriptor, error);
+  };
+}
+
+std::future<btle::AsyncStatus> CollectCharacteristicDescriptorValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::Descriptor> descriptor,
+    const btle::OperationContext& context) {
+  return btle::PostAsync(executor, btle::DeviceQueueKey(device), context, CollectDescriptorValueOperation(device, service, characteristic, descriptor));
+}
+
+void CollectCharacteristicDescriptorValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::Descriptor> descriptor,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback) {
+  btle::PostAsync(executor, btle::DeviceQueueKey(device), context, CollectDescriptorValueOperation(device, service, characteristic, descriptor), callback);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+static btle::AsyncOperation CollectValueOperation(
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic) {
+  return [=](std::string* error) {
+    return CollectCharacteristicValue(device, service, characteristic, error);
+  };
+}
+
+std::future<btle::AsyncStatus> CollectCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context) {
+  return btle::PostAsync(executor, btle::DeviceQueueKey(device), context, CollectValueOperation(device, service, characteristic));
+}
+
+void CollectCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback) {
+  btle::PostAsync(executor, btle::DeviceQueueKey(device), context, CollectValueOperation(device, service, characteristic), callback);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+static btle::AsyncOperation CollectServicesOperation(scoped_refptr<btle::Device> device, const btle::OperationContext& context) {
+  return [=](std::string* error) {
+    return CollectDeviceServices(device, context, error);
+  };
+}
+
+std::future<btle::AsyncStatus> CollectDeviceServicesAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    const btle::OperationContext& context) {
+  return btle::PostAsync(executor, btle::DeviceQueueKey(device), context, CollectServicesOperation(device, context));
+}
+
+void CollectDeviceServicesAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback) {
+  btle::PostAsync(executor, btle::DeviceQueueKey(device), context, CollectServicesOperation(device, context), callback);
+}
@@ -0,0 +1,438 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base.h"
+#include "btle.h"
+#include "btle_cancellation.h"
+
+namespace btle {
+
+struct CommandQueueMetrics {
+  CommandQueueMetrics()
+    : commands(0),
+      queue_depth(0),
+      max_queue_depth(0),
+      total_wait_us(0),
+      max_wait_us(0),
+      total_run_us(0),
+      timeouts(0),
+      cancellations(0),
+      abandoned_running(0) {
+  }
+
+  // Number of commands run.
+  ULONG commands;
+  // Number of commands waiting for the previous ones to complete.
+  ULONG queue_depth;
+  ULONG max_queue_depth;
+  // Time spent by commands between being posted and starting.
+  ULONGLONG total_wait_us;
+  ULONGLONG max_wait_us;
+  ULONGLONG total_run_us;
+  // Number of commands whose deadline expired, or which were cancelled,
+  // before completion.
+  ULONG timeouts;
+  ULONG cancellations;
+  // Number of those that were already running: their caller was completed
+  // right away, but the queue stayed busy until the blocking call returned.
+  ULONG abandoned_running;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Fixed pool of threads running posted tasks in FIFO order. Tasks still
+// queued when the executor is destroyed are run before the threads exit;
+// delayed tasks not yet due are discarded.
+//
+// Tasks posted with PostSerialized() to the same queue run one at a time, in
+// order. A GATT link handles one request at a time, so commands for a device
+// share the queue keyed by its address, while different devices progress in
+// parallel.
+//
+class IoExecutor {
+public:
+  typedef std::function<void()> Task;
+
+  explicit IoExecutor(size_t thread_count);
+  ~IoExecutor();
+
+  void Post(const Task& task);
+
+  // Posts "task" once "delay_ms" milliseconds have elapsed. Returns an id
+  // for CancelDelayed().
+  ULONG PostDelayed(const Task& task, DWORD delay_ms);
+
+  // Discards a delayed task that is not due yet, along with what it holds.
+  // Returns false if it was already posted.
+  bool CancelDelayed(ULONG timer_id);
+
+  // Runs "task" once all the tasks previously posted to "queue_key" have
+  // completed. Returns an id for RemoveSerialized().
+  ULONG PostSerialized(ULONGLONG queue_key, const Task& task);
+
+  // Removes a command that has not started yet. Returns false if it already
+  // started.
+  bool RemoveSerialized(ULONGLONG queue_key, ULONG command_id);
+
+  // Counts a command that timed out or got cancelled.
+  void RecordAbandoned(ULONGLONG queue_key, bool timed_out, bool running);
+
+  bool GetQueueMetrics(ULONGLONG queue_key, CommandQueueMetrics* metrics) const;
+  // Metrics summed over all queues (max_* are the max over all queues).
+  CommandQueueMetrics queue_metrics() const;
+
+  size_t thread_count() const { return threads_.size(); }
+
+  // Number of tasks queued or running.
+  size_t pending() const;
+
+private:
+  struct SerialCommand {
+    ULONG id;
+    // Time the command was posted.
+    ULONGLONG posted_us;
+    Task task;
+  };
+
+  struct DelayedTask {
+    ULONG id;
+    Task task;
+  };
+  typedef std::multimap<ULONGLONG, DelayedTask> TimerMap;
+
+  struct SerialQueue {
+    SerialQueue() : active(false) {
+    }
+
+    // Commands not started yet.
+    std::deque<SerialCommand> commands;
+    // Whether a command of the queue is scheduled or running.
+    bool active;
+    CommandQueueMetrics metrics;
+  };
+
+  void Run();
+  void RunTimer();
+  void RunSerialized(ULONGLONG queue_key);
+
+  std::vector<std::thread> threads_;
+  std::deque<Task> tasks_;
+  size_t running_;
+  bool stopping_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+
+  // Delayed tasks, by due time (monotonic_microseconds), and by id.
+  TimerMap timers_;
+  std::map<ULONG, TimerMap::iterator> timer_ids_;
+  ULONG next_timer_id_;
+  std::thread timer_thread_;
+  std::condition_variable timer_condition_;
+
+  std::map<ULONGLONG, SerialQueue> queues_;
+  ULONG next_command_id_;
+
+  IoExecutor(const IoExecutor& other);
+  const IoExecutor& operator=(const IoExecutor& other);
+};
+
+struct AsyncStatus {
+  AsyncStatus() : success(false) {
+  }
+
+  bool success;
+  std::string error;
+};
+
+template<typename T>
+struct AsyncResult : public AsyncStatus {
+  AsyncResult() : value() {
+  }
+
+  T value;
+};
+
+typedef std::function<bool(std::string* error)> AsyncOperation;
+typedef std::function<void(const AsyncStatus& status)> StatusCallback;
+
+template<typename T>
+struct AsyncValue {
+  typedef std::function<bool(T* value, std::string* error)> Operation;
+  typedef std::function<void(const AsyncResult<T>& result)> Callback;
+};
+
+namespace internal {
+
+//////////////////////////////////////////////////////////////////////////////
+// Command posted to a queue of an executor, completed by whichever comes
+// first: the command itself, its deadline or its cancellation. An abandoned
+// command is removed from the queue if it has not started yet; otherwise the
+// blocking call runs to completion and its result is dropped.
+//
+template<typename Result>
+class PendingOperation : public RefCounted<PendingOperation<Result>> {
+public:
+  typedef std::function<void(Result* result)> Function;
+  typedef std::function<void(const Result& result)> Callback;
+
+  static void Post(IoExecutor* executor, ULONGLONG queue_key, const OperationContext& context, const Function& function, const Callback& callback) {
+    scoped_refptr<PendingOperation<Result>> operation(new PendingOperation<Result>(executor, queue_key, context, callback));
+
+    // The deadline and cancellation callbacks only go through the executor,
+    // and wait for "mutex_": they can't run before the setup is complete.
+    std::lock_guard<std::mutex> lock(operation->mutex_);
+    operation->command_id_ = executor->PostSerialized(queue_key, [operation, function]() {
+      operation->Run(function);
+    });
+    DWORD timeout_ms = context.remaining_ms();
+    if (timeout_ms != INFINITE)
+      operation->timer_id_ = executor->PostDelayed([operation]() { operation->Abandon(true); }, timeout_ms);
+    operation->cancel_id_ = context.token().Register([executor, operation]() {
+      executor->Post([operation]() { operation->Abandon(false); });
+    });
+  }
+
+private:
+  enum State {
+    kQueued,
+    kRunning,
+    kDone
+  };
+
+  PendingOperation(IoExecutor* executor, ULONGLONG queue_key, const OperationContext& context, const Callback& callback)
+    : executor_(executor),
+      queue_key_(queue_key),
+      context_(context),
+      callback_(callback),
+      state_(kQueued),
+      command_id_(0),
+      timer_id_(0),
+      cancel_id_(0) {
+  }
+
+  void Run(const Function& function) {
+    bool expired;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (state_ != kQueued)
+        return;
+      expired = context_.expired() || context_.token().cancelled();
+      if (!expired)
+        state_ = kRunning;
+    }
+    if (expired) {
+      // Expired while waiting in the queue, before its timer fired.
+      Abandon(!context_.token().cancelled());
+      return;
+    }
+
+    Result result;
+    function(&result);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (state_ == kDone)
+        return;
+      state_ = kDone;
+    }
+    Complete(result);
+  }
+
+  void Abandon(bool timed_out) {
+    bool running;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (state_ == kDone)
+        return;
+      running = (state_ == kRunning);
+      state_ = kDone;
+    }
+    if (!running)
+      executor_->RemoveSerialized(queue_key_, command_id_);
+    executor_->RecordAbandoned(queue_key_, timed_out, running);
+
+    Result result;
+    result.error = timed_out ? kOperationTimedOut : kOperationCancelled;
+    Complete(result);
+  }
+
+  void Complete(const Result& result) {
+    // The deadline timer holds a reference to the operation until it fires.
+    if (timer_id_ != 0)
+      executor_->CancelDelayed(timer_id_);
+    context_.token().Unregister(cancel_id_);
+    if (callback_)
+      callback_(result);
+  }
+
+  IoExecutor* executor_;
+  ULONGLONG queue_key_;
+  OperationContext context_;
+  Callback callback_;
+  std::mutex mutex_;
+  State state_;
+  ULONG command_id_;
+  ULONG timer_id_;
+  int cancel_id_;
+};
+
+}  // namespace internal
+
+// Runs "operation" on the "queue_key" queue of "executor" and invokes
+// "callback" on an executor thread once it completes, or once "context"
+// expires or gets cancelled. When the operation itself completes, the next
+// command of the queue starts after the callback returns, so callbacks should
+// be short.
+inline
+void PostAsync(IoExecutor* executor, ULONGLONG queue_key, const OperationContext& context, const AsyncOperation& operation, const StatusCallback& callback) {
+  internal::PendingOperation<AsyncStatus>::Post(executor, queue_key, context, [operation](AsyncStatus* status) {
+    status->success = operation(&status->error);
+  }, callback);
+}
+
+inline
+std::future<AsyncStatus> PostAsync(IoExecutor* executor, ULONGLONG queue_key, const OperationContext& context, const AsyncOperation& operation) {
+  std::shared_ptr<std::promise<AsyncStatus>> promise(new std::promise<AsyncStatus>());
+  PostAsync(executor, queue_key, context, operation, [promise](const AsyncStatus& status) {
+    promise->set_value(status);
+  });
+  return promise->get_future();
+}
+
+template<typename T>
+void PostAsync(IoExecutor* executor, ULONGLONG queue_key, const OperationContext& context, const typename AsyncValue<T>::Operation& operation, const typename AsyncValue<T>::Callback& callback) {
+  internal::PendingOperation<AsyncResult<T>>::Post(executor, queue_key, context, [operation](AsyncResult<T>* result) {
+    result->success = operation(&result->value, &result->error);
+  }, callback);
+}
+
+template<typename T>
+std::future<AsyncResult<T>> PostAsync(IoExecutor* executor, ULONGLONG queue_key, const OperationContext& context, const typename AsyncValue<T>::Operation& operation) {
+  std::shared_ptr<std::promise<AsyncResult<T>>> promise(new std::promise<AsyncResult<T>>());
+  PostAsync<T>(executor, queue_key, context, operation, [promise](const AsyncResult<T>& result) {
+    promise->set_value(result);
+  });
+  return promise->get_future();
+}
+
+}  // namespace btle
+
+// Asynchronous versions of the GATT operations of "btle_gatt.h". Each one
+// exists in two forms: returning a future, or invoking a completion callback
+// on an executor thread.
+//
+// Operations run on the queue of their device (see DeviceQueueKey), so
+// operations to a device are issued one at a time, in order, while
+// different devices progress in parallel. The Windows GATT APIs are
+// synchronous, so a running operation occupies one executor thread.
+//
+// Every operation completes with kOperationTimedOut or kOperationCancelled
+// as soon as its context expires or gets cancelled. A running Win32 call
+// can't be interrupted though: it keeps its executor thread and device queue
+// until it returns. Operations hold a reference to their service handle, so
+// the handle stays open until then even if the caller has moved on (service
+// discovery opens its own handles, and stops at the next step).
+
+namespace btle {
+
+// Key of the IoExecutor queue serializing the commands sent to "device".
+inline
+ULONGLONG DeviceQueueKey(const scoped_refptr<Device>& device) {
+  return device->info().address.ullLong;
+}
+
+}  // namespace btle
+
+std::future<btle::AsyncResult<scoped_refptr<btle::CharacteristicValue>>> ReadServiceCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context = btle::OperationContext());
+void ReadServiceCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context,
+    const btle::AsyncValue<scoped_refptr<btle::CharacteristicValue>>::Callback& callback);
+
+std::future<btle::AsyncStatus> WriteServiceCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::CharacteristicValue> value,
+    ULONG flags,
+    const btle::OperationContext& context = btle::OperationContext());
+void WriteServiceCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::CharacteristicValue> value,
+    ULONG flags,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback);
+
+std::future<btle::AsyncStatus> SubscribeToNotificationsAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context = btle::OperationContext());
+void SubscribeToNotificationsAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback);
+
+std::future<btle::AsyncStatus> CollectCharacteristicDescriptorValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::Descriptor> descriptor,
+    const btle::OperationContext& context = btle::OperationContext());
+void CollectCharacteristicDescriptorValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    scoped_refptr<btle::Descriptor> descriptor,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback);
+
+std::future<btle::AsyncStatus> CollectCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context = btle::OperationContext());
+void CollectCharacteristicValueAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    scoped_refptr<btle::Service> service,
+    scoped_refptr<btle::Characteristic> characteristic,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback);
+
+std::future<btle::AsyncStatus> CollectDeviceServicesAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    const btle::OperationContext& context = btle::OperationContext());
+void CollectDeviceServicesAsync(
+    btle::IoExecutor* executor,
+    scoped_refptr<btle::Device> device,
+    const btle::OperationContext& context,
+    const btle::StatusCallback& callback);
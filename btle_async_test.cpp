@@ -0,0 +1,229 @@
+#include "stdafx.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "btle_async.h"
+#include "btle_test.h"
+
+namespace {
+
+// Object whose destruction can be observed from the test thread.
+class Probe : public RefCounted<Probe> {
+public:
+  explicit Probe(std::atomic<bool>* destroyed) : destroyed_(destroyed) {
+  }
+
+private:
+  ~Probe() {
+    *destroyed_ = true;
+  }
+
+  std::atomic<bool>* destroyed_;
+};
+
+// Waits up to a second for "flag" to be set.
+bool WaitFor(const std::atomic<bool>& flag) {
+  for (int i = 0; i < 1000 && !flag; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return flag;
+}
+
+// Waits up to a second for "count" commands of "queue_key" to complete.
+bool WaitForCommands(const btle::IoExecutor& executor, ULONGLONG queue_key, ULONG count) {
+  btle::CommandQueueMetrics metrics;
+  for (int i = 0; i < 1000; i++) {
+    if (executor.GetQueueMetrics(queue_key, &metrics) && metrics.commands >= count)
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+}  // namespace
+
+BTLE_TEST(async, PostDelayed) {
+  btle::IoExecutor executor(1);
+  std::atomic<bool> ran(false);
+  executor.PostDelayed([&ran]() { ran = true; }, 1);
+  BTLE_EXPECT(WaitFor(ran));
+}
+
+BTLE_TEST(async, CancelDelayed) {
+  btle::IoExecutor executor(1);
+  std::atomic<bool> ran(false);
+  std::atomic<bool> destroyed(false);
+  scoped_refptr<Probe> probe(new Probe(&destroyed));
+  ULONG timer_id = executor.PostDelayed([&ran, probe]() { ran = true; }, 60000);
+  probe = scoped_refptr<Probe>();
+  BTLE_EXPECT(!destroyed);
+  BTLE_EXPECT(executor.CancelDelayed(timer_id));
+  BTLE_EXPECT(destroyed);
+  BTLE_EXPECT(!executor.CancelDelayed(timer_id));
+  BTLE_EXPECT(!ran);
+}
+
+// An operation that completes before its deadline releases what it holds
+// right away, instead of when the deadline timer would have fired.
+BTLE_TEST(async, CompletionCancelsDeadline) {
+  btle::IoExecutor executor(1);
+  std::atomic<bool> completed(false);
+  std::atomic<bool> destroyed(false);
+  {
+    scoped_refptr<Probe> probe(new Probe(&destroyed));
+    btle::PostAsync(&executor, 1, btle::OperationContext(60000), [](std::string*) {
+      return true;
+    }, [&completed, probe](const btle::AsyncStatus& status) {
+      completed = status.success;
+    });
+  }
+  BTLE_EXPECT(WaitFor(completed));
+  BTLE_EXPECT(WaitFor(destroyed));
+}
+
+// Commands of a queue run one at a time, in the order they were posted,
+// even with threads to spare.
+BTLE_TEST(async, PostSerializedInOrder) {
+  btle::IoExecutor executor(4);
+  std::mutex mutex;
+  std::vector<int> order;
+  std::atomic<int> running(0);
+  std::atomic<int> max_running(0);
+  const int kCommands = 200;
+  for (int i = 0; i < kCommands; i++) {
+    executor.PostSerialized(1, [&, i]() {
+      int now = ++running;
+      if (now > max_running)
+        max_running = now;
+      std::this_thread::yield();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(i);
+      }
+      running--;
+    });
+  }
+  BTLE_EXPECT(WaitForCommands(executor, 1, kCommands));
+  BTLE_EXPECT_EQ(1, max_running.load());
+  std::lock_guard<std::mutex> lock(mutex);
+  BTLE_EXPECT_EQ(static_cast<size_t>(kCommands), order.size());
+  int misordered = 0;
+  for (size_t i = 0; i < order.size(); i++) {
+    if (order[i] != static_cast<int>(i))
+      misordered++;
+  }
+  BTLE_EXPECT_EQ(0, misordered);
+}
+
+// A blocked queue does not hold up the commands of other queues.
+BTLE_TEST(async, PostSerializedKeysRunConcurrently) {
+  btle::IoExecutor executor(2);
+  std::atomic<bool> other_ran(false);
+  std::atomic<bool> saw_other(false);
+  std::atomic<bool> queued_ran(false);
+  executor.PostSerialized(1, [&other_ran, &saw_other]() {
+    saw_other = WaitFor(other_ran);
+  });
+  executor.PostSerialized(1, [&queued_ran]() { queued_ran = true; });
+  executor.PostSerialized(2, [&other_ran]() { other_ran = true; });
+  BTLE_EXPECT(WaitFor(saw_other));
+  BTLE_EXPECT(WaitFor(queued_ran));
+}
+
+// Depth and wait times of the commands queued behind a blocked one, and the
+// commands completed.
+BTLE_TEST(async, QueueMetrics) {
+  btle::IoExecutor executor(2);
+  std::atomic<bool> started(false);
+  std::atomic<bool> release(false);
+  btle::CommandQueueMetrics metrics;
+  BTLE_EXPECT(!executor.GetQueueMetrics(1, &metrics));
+
+  executor.PostSerialized(1, [&started, &release]() {
+    started = true;
+    WaitFor(release);
+  });
+  BTLE_EXPECT(WaitFor(started));
+  for (int i = 0; i < 3; i++)
+    executor.PostSerialized(1, []() {});
+  BTLE_EXPECT(executor.GetQueueMetrics(1, &metrics));
+  BTLE_EXPECT_EQ(3u, metrics.queue_depth);
+  BTLE_EXPECT_EQ(3u, metrics.max_queue_depth);
+  BTLE_EXPECT_EQ(0u, metrics.commands);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  release = true;
+  BTLE_EXPECT(WaitForCommands(executor, 1, 4));
+  BTLE_EXPECT(executor.GetQueueMetrics(1, &metrics));
+  BTLE_EXPECT_EQ(4u, metrics.commands);
+  BTLE_EXPECT_EQ(0u, metrics.queue_depth);
+  BTLE_EXPECT_EQ(3u, metrics.max_queue_depth);
+  BTLE_EXPECT(metrics.max_wait_us >= 20000);
+  BTLE_EXPECT(metrics.total_wait_us >= 3 * 20000);
+  BTLE_EXPECT(metrics.total_run_us >= 20000);
+  BTLE_EXPECT_EQ(0u, metrics.timeouts);
+
+  // Another queue adds to the totals only.
+  executor.PostSerialized(2, []() {});
+  BTLE_EXPECT(WaitForCommands(executor, 2, 1));
+  BTLE_EXPECT(executor.GetQueueMetrics(2, &metrics));
+  BTLE_EXPECT_EQ(1u, metrics.commands);
+  BTLE_EXPECT_EQ(1u, metrics.max_queue_depth);
+  BTLE_EXPECT_EQ(5u, executor.queue_metrics().commands);
+  BTLE_EXPECT_EQ(3u, executor.queue_metrics().max_queue_depth);
+}
+
+// Operations abandoned while queued are removed from their queue and
+// counted as timeouts or cancellations; those abandoned while running are
+// counted as such too.
+BTLE_TEST(async, QueueMetricsAbandoned) {
+  btle::IoExecutor executor(2);
+  std::atomic<bool> started(false);
+  std::atomic<bool> release(false);
+  std::future<btle::AsyncStatus> running = btle::PostAsync(&executor, 1, btle::OperationContext(20), [&started, &release](std::string*) {
+    started = true;
+    WaitFor(release);
+    return true;
+  });
+  BTLE_EXPECT(WaitFor(started));
+
+  std::atomic<bool> ran(false);
+  std::future<btle::AsyncStatus> timed_out = btle::PostAsync(&executor, 1, btle::OperationContext(20), [&ran](std::string*) {
+    ran = true;
+    return true;
+  });
+  btle::CancellationSource source;
+  std::future<btle::AsyncStatus> cancelled = btle::PostAsync(&executor, 1, btle::OperationContext(source.token()), [&ran](std::string*) {
+    ran = true;
+    return true;
+  });
+  source.Cancel();
+
+  BTLE_EXPECT(running.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+  BTLE_EXPECT(timed_out.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+  BTLE_EXPECT(cancelled.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+  BTLE_EXPECT_EQ(std::string(btle::kOperationTimedOut), running.get().error);
+  BTLE_EXPECT_EQ(std::string(btle::kOperationTimedOut), timed_out.get().error);
+  BTLE_EXPECT_EQ(std::string(btle::kOperationCancelled), cancelled.get().error);
+
+  btle::CommandQueueMetrics metrics;
+  BTLE_EXPECT(executor.GetQueueMetrics(1, &metrics));
+  BTLE_EXPECT_EQ(2u, metrics.timeouts);
+  BTLE_EXPECT_EQ(1u, metrics.cancellations);
+  BTLE_EXPECT_EQ(1u, metrics.abandoned_running);
+  BTLE_EXPECT_EQ(0u, metrics.queue_depth);
+
+  // The running operation keeps the queue until it returns; the abandoned
+  // ones never run.
+  release = true;
+  BTLE_EXPECT(WaitForCommands(executor, 1, 1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  BTLE_EXPECT(!ran);
+  BTLE_EXPECT(executor.GetQueueMetrics(1, &metrics));
+  BTLE_EXPECT_EQ(1u, metrics.commands);
+}
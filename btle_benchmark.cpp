@@ -0,0 +1,155 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "btle_benchmark.h"
+
+namespace {
+
+// Written after each run, so that the results of the benchmarks are used.
+volatile UINT64 Sink = 0;
+
+}  // namespace
+
+namespace btle {
+
+UINT64 MonotonicNanoseconds() {
+  static LARGE_INTEGER frequency = {};
+  if (frequency.QuadPart == 0)
+    QueryPerformanceFrequency(&frequency);
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+  return (counter.QuadPart / frequency.QuadPart) * 1000000000 +
+      (counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+BenchmarkState::BenchmarkState(UINT64 iterations)
+  : iterations_(iterations), items_(iterations), paused_ns_(0), paused_allocations_(0),
+    paused_allocated_bytes_(0), pause_start_ns_(0), pause_start_allocations_(0),
+    pause_start_allocated_bytes_(0), sink_(0) {
+}
+
+void BenchmarkState::SetCounter(const std::string& name, double value) {
+  for (std::vector<std::pair<std::string, double>>::iterator it = counters_.begin(); it != counters_.end(); ++it) {
+    if (it->first == name) {
+      it->second = value;
+      return;
+    }
+  }
+  counters_.push_back(std::make_pair(name, value));
+}
+
+void BenchmarkState::PauseTiming() {
+  pause_start_allocations_ = AllocationCount();
+  pause_start_allocated_bytes_ = AllocatedBytes();
+  pause_start_ns_ = MonotonicNanoseconds();
+}
+
+void BenchmarkState::ResumeTiming() {
+  paused_ns_ += MonotonicNanoseconds() - pause_start_ns_;
+  paused_allocations_ += AllocationCount() - pause_start_allocations_;
+  paused_allocated_bytes_ += AllocatedBytes() - pause_start_allocated_bytes_;
+}
+
+void BenchmarkState::Consume(double value) {
+  UINT64 bits;
+  memcpy(&bits, &value, sizeof(bits));
+  sink_ ^= bits;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+BenchmarkRunner::BenchmarkRunner(const BenchmarkOptions& options) : options_(options) {
+}
+
+void BenchmarkRunner::Add(const std::string& name, const std::string& item_unit, const BenchmarkFunction& function) {
+  Benchmark benchmark;
+  benchmark.name = name;
+  benchmark.item_unit = item_unit;
+  benchmark.function = function;
+  benchmarks_.push_back(benchmark);
+}
+
+void BenchmarkRunner::Run(const std::function<void(const BenchmarkResult& result)>& callback, std::vector<BenchmarkResult>* results) {
+  const UINT64 kMaxIterations = 1000000000;
+  double min_time_ns = options_.min_time_ms * 1e6;
+  for (std::vector<Benchmark>::const_iterator it = benchmarks_.begin(); it != benchmarks_.end(); ++it) {
+    if (!options_.filter.empty() && it->name.find(options_.filter) == std::string::npos)
+      continue;
+
+    // Grow the iterations until a run lasts the minimum time, aiming 20%
+    // past it, by at most 10 times per step.
+    UINT64 iterations = 1;
+    std::vector<BenchmarkResult> runs;
+    for (;;) {
+      BenchmarkResult result = RunOnce(*it, iterations);
+      double elapsed_ns = result.ns_per_op * iterations;
+      if (elapsed_ns >= min_time_ns || iterations >= kMaxIterations) {
+        runs.push_back(result);
+        break;
+      }
+      double target = iterations * min_time_ns * 1.2 / std::max(elapsed_ns, 1.0);
+      iterations = std::min(iterations * 10, std::max(iterations + 1, static_cast<UINT64>(target)));
+    }
+    for (int i = 1; i < options_.repetitions; i++)
+      runs.push_back(RunOnce(*it, iterations));
+
+    std::sort(runs.begin(), runs.end(), [](const BenchmarkResult& x, const BenchmarkResult& y) {
+      return x.ns_per_op < y.ns_per_op;
+    });
+    results->push_back(runs[runs.size() / 2]);
+    if (callback)
+      callback(results->back());
+  }
+}
+
+BenchmarkResult BenchmarkRunner::RunOnce(const Benchmark& benchmark, UINT64 iterations) {
+  BenchmarkState state(iterations);
+  UINT64 start_allocations = AllocationCount();
+  UINT64 start_allocated_bytes = AllocatedBytes();
+  UINT64 start_ns = MonotonicNanoseconds();
+  benchmark.function(&state);
+  UINT64 elapsed_ns = MonotonicNanoseconds() - start_ns - state.paused_ns_;
+  UINT64 allocations = AllocationCount() - start_allocations - state.paused_allocations_;
+  UINT64 allocated_bytes = AllocatedBytes() - start_allocated_bytes - state.paused_allocated_bytes_;
+  Sink = Sink ^ state.sink_;
+
+  BenchmarkResult result;
+  result.name = benchmark.name;
+  result.item_unit = benchmark.item_unit;
+  result.iterations = iterations;
+  result.ns_per_op = static_cast<double>(elapsed_ns) / iterations;
+  result.allocations_per_op = static_cast<double>(allocations) / iterations;
+  result.allocated_bytes_per_op = static_cast<double>(allocated_bytes) / iterations;
+  result.throughput = elapsed_ns == 0 ? 0 : state.items() * 1e9 / elapsed_ns;
+  result.counters = state.counters();
+  return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+void WriteBenchmarkResult(const BenchmarkResult& result, OutputWriter* writer) {
+  writer->BeginRecord("Benchmark");
+  writer->String("name", result.name);
+  writer->String("unit", result.item_unit);
+  writer->UInt("iterations", result.iterations);
+  writer->Double("ns_per_op", result.ns_per_op);
+  writer->Double("allocations_per_op", result.allocations_per_op);
+  writer->Double("allocated_bytes_per_op", result.allocated_bytes_per_op);
+  writer->Double("throughput", result.throughput);
+  if (!result.counters.empty()) {
+    writer->BeginObject("counters");
+    for (std::vector<std::pair<std::string, double>>::const_iterator it = result.counters.begin(); it != result.counters.end(); ++it)
+      writer->Double(it->first, it->second);
+    writer->EndObject();
+  }
+  writer->EndRecord();
+}
+
+}  // namespace btle
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base.h"
+#include "btle_output.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Micro- and macro-benchmarks of the library, run by the
+// BluetoothLowEnergyBenchmark executable.
+//
+// A benchmark runs "iterations" operations in a loop. The runner grows the
+// number of iterations until a run lasts at least the minimum time, then
+// repeats the run and reports the median: the time per operation, the heap
+// allocations per operation (counted by the replacement of the global
+// operator new in btle_benchmark.cpp, which must only be linked into the
+// benchmark), and the throughput in the unit of the items the benchmark
+// processed, if any.
+//
+class BenchmarkState {
+public:
+  explicit BenchmarkState(UINT64 iterations);
+
+  UINT64 iterations() const { return iterations_; }
+
+  // Items processed by the run (e.g. bytes written, samples decoded), for
+  // the throughput. Defaults to one per iteration.
+  void set_items(UINT64 items) { items_ = items; }
+  UINT64 items() const { return items_; }
+
+  // Additional result of the run, e.g. a compression ratio.
+  void SetCounter(const std::string& name, double value);
+  const std::vector<std::pair<std::string, double>>& counters() const { return counters_; }
+
+  // Excludes the setup done inside a run from its time and allocations.
+  void PauseTiming();
+  void ResumeTiming();
+
+  // Keeps the computation of "value" from being optimized out.
+  void Consume(UINT64 value) { sink_ ^= value; }
+  void Consume(double value);
+  void Consume(const void* pointer) { sink_ ^= static_cast<UINT64>(reinterpret_cast<uintptr_t>(pointer)); }
+
+private:
+  friend class BenchmarkRunner;
+
+  UINT64 iterations_;
+  UINT64 items_;
+  std::vector<std::pair<std::string, double>> counters_;
+  // Totals of the paused periods.
+  UINT64 paused_ns_;
+  UINT64 paused_allocations_;
+  UINT64 paused_allocated_bytes_;
+  UINT64 pause_start_ns_;
+  UINT64 pause_start_allocations_;
+  UINT64 pause_start_allocated_bytes_;
+  UINT64 sink_;
+};
+
+typedef std::function<void(BenchmarkState* state)> BenchmarkFunction;
+
+struct BenchmarkResult {
+  std::string name;
+  // Unit of the items of the throughput ("ops" by default).
+  std::string item_unit;
+  UINT64 iterations;
+  double ns_per_op;
+  double allocations_per_op;
+  double allocated_bytes_per_op;
+  // Items per second.
+  double throughput;
+  std::vector<std::pair<std::string, double>> counters;
+};
+
+struct BenchmarkOptions {
+  BenchmarkOptions() : min_time_ms(200), repetitions(3) {
+  }
+
+  // Only the benchmarks whose name contains "filter" run.
+  std::string filter;
+  UINT64 min_time_ms;
+  int repetitions;
+};
+
+class BenchmarkRunner {
+public:
+  explicit BenchmarkRunner(const BenchmarkOptions& options);
+
+  void Add(const std::string& name, const std::string& item_unit, const BenchmarkFunction& function);
+
+  // Runs the benchmarks, in the order they were added, appending their
+  // results to "results". Calls "callback" after each benchmark, if set.
+  void Run(const std::function<void(const BenchmarkResult& result)>& callback, std::vector<BenchmarkResult>* results);
+
+private:
+  struct Benchmark {
+    std::string name;
+    std::string item_unit;
+    BenchmarkFunction function;
+  };
+
+  // Runs "iterations" iterations of "benchmark" once.
+  BenchmarkResult RunOnce(const Benchmark& benchmark, UINT64 iterations);
+
+  BenchmarkOptions options_;
+  std::vector<Benchmark> benchmarks_;
+};
+
+// Writes a result as a record of "writer": its name, unit, iteration
+// count, ns_per_op, allocations_per_op, allocated_bytes_per_op, throughput
+// and counters.
+void WriteBenchmarkResult(const BenchmarkResult& result, OutputWriter* writer);
+
+// Number of calls to the global operator new, and bytes requested, since
+// the start of the process.
+UINT64 AllocationCount();
+UINT64 AllocatedBytes();
+
+// Nanoseconds of a monotonic clock.
+UINT64 MonotonicNanoseconds();
+
+}  // namespace btle
@@ -0,0 +1,85 @@
+#include "stdafx.h"
+
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+#include "btle_benchmark.h"
+
+namespace {
+
+std::atomic<UINT64> Allocations(0);
+std::atomic<UINT64> AllocatedBytesTotal(0);
+
+void* Allocate(size_t size) {
+  Allocations.fetch_add(1, std::memory_order_relaxed);
+  AllocatedBytesTotal.fetch_add(size, std::memory_order_relaxed);
+  return malloc(size == 0 ? 1 : size);
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// Replacement of the global allocation functions, counting the allocations
+// of the whole process. They live in their own file so that they are not
+// inlined into code that allocates: compilers then see operator new calls
+// paired with free(), and warn about mismatched allocation functions.
+//
+void* operator new(size_t size) {
+  void* pointer = Allocate(size);
+  if (pointer == NULL)
+    throw std::bad_alloc();
+  return pointer;
+}
+
+void* operator new[](size_t size) {
+  void* pointer = Allocate(size);
+  if (pointer == NULL)
+    throw std::bad_alloc();
+  return pointer;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+  free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  free(pointer);
+}
+
+namespace btle {
+
+UINT64 AllocationCount() {
+  return Allocations.load(std::memory_order_relaxed);
+}
+
+UINT64 AllocatedBytes() {
+  return AllocatedBytesTotal.load(std::memory_order_relaxed);
+}
+
+}  // namespace btle
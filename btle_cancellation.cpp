@@ -0,0 +1,101 @@
+#include "stdafx.h"
+
+#include "btle_cancellation.h"
+
+namespace btle {
+
+const char kOperationCancelled[] = "Operation cancelled";
+const char kOperationTimedOut[] = "Operation timed out";
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CancellationToken::cancelled() const {
+  if (!state_)
+    return false;
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->cancelled;
+}
+
+int CancellationToken::Register(const Callback& callback) const {
+  if (!state_)
+    return 0;
+
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (!state_->cancelled) {
+      int id = state_->next_id++;
+      state_->callbacks[id] = callback;
+      return id;
+    }
+  }
+  callback();
+  return 0;
+}
+
+void CancellationToken::Unregister(int id) const {
+  if (!state_ || id == 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->callbacks.erase(id);
+  // Wait for the callback to return, unless it is the one unregistering.
+  while (state_->running_id == id && state_->running_thread != std::this_thread::get_id())
+    state_->condition.wait(lock);
+}
+
+void CancellationSource::Cancel() {
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  if (state_->cancelled)
+    return;
+  state_->cancelled = true;
+  state_->running_thread = std::this_thread::get_id();
+
+  while (!state_->callbacks.empty()) {
+    std::map<int, CancellationToken::Callback>::iterator it = state_->callbacks.begin();
+    CancellationToken::Callback callback = it->second;
+    state_->running_id = it->first;
+    state_->callbacks.erase(it);
+    lock.unlock();
+    callback();
+    lock.lock();
+  }
+  state_->running_id = 0;
+  state_->condition.notify_all();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+OperationContext::OperationContext(DWORD timeout_ms, const CancellationToken& token)
+  : deadline_us_(timeout_ms == INFINITE ? 0 : monotonic_microseconds() + timeout_ms * 1000ULL),
+    token_(token) {
+}
+
+bool OperationContext::expired() const {
+  return deadline_us_ != 0 && monotonic_microseconds() >= deadline_us_;
+}
+
+DWORD OperationContext::remaining_ms() const {
+  if (deadline_us_ == 0)
+    return INFINITE;
+  ULONGLONG now_us = monotonic_microseconds();
+  if (now_us >= deadline_us_)
+    return 0;
+  // Round up, so that a timer set with the result fires after the deadline.
+  return static_cast<DWORD>((deadline_us_ - now_us + 999) / 1000);
+}
+
+bool OperationContext::Check(std::string* error) const {
+  if (token_.cancelled()) {
+    *error = kOperationCancelled;
+    return false;
+  }
+  if (expired()) {
+    *error = kOperationTimedOut;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace btle
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "base.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Cancellation request shared between the owner of an operation
+// (CancellationSource) and the operation itself (CancellationToken). A
+// default constructed token is never cancelled.
+//
+class CancellationToken {
+public:
+  typedef std::function<void()> Callback;
+
+  CancellationToken() {
+  }
+
+  bool cancelled() const;
+
+  // Invokes "callback" when the token gets cancelled, right away if it
+  // already is. Returns an id for Unregister(), 0 if the callback will never
+  // be invoked later.
+  int Register(const Callback& callback) const;
+
+  // Once Unregister() returns, the callback is not running and won't run.
+  void Unregister(int id) const;
+
+private:
+  friend class CancellationSource;
+
+  class State : public RefCounted<State> {
+  public:
+    State() : cancelled(false), next_id(1), running_id(0) {
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool cancelled;
+    int next_id;
+    // Callback being invoked by Cancel(), and the thread invoking it.
+    int running_id;
+    std::thread::id running_thread;
+    std::map<int, Callback> callbacks;
+  };
+
+  explicit CancellationToken(const scoped_refptr<State>& state) : state_(state) {
+  }
+
+  scoped_refptr<State> state_;
+};
+
+class CancellationSource {
+public:
+  CancellationSource() : state_(new CancellationToken::State()) {
+  }
+
+  CancellationToken token() const {
+    return CancellationToken(state_);
+  }
+
+  bool cancelled() const {
+    return token().cancelled();
+  }
+
+  // Cancels the token and invokes the registered callbacks on the calling
+  // thread.
+  void Cancel();
+
+private:
+  scoped_refptr<CancellationToken::State> state_;
+};
+
+// Errors reported by operations that were cancelled, or whose deadline
+// expired, before completion.
+extern const char kOperationCancelled[];
+extern const char kOperationTimedOut[];
+
+//////////////////////////////////////////////////////////////////////////////
+// Deadline and cancellation token of an operation. Multi-step operations
+// check it between steps; asynchronous operations also complete their
+// caller as soon as it expires or is cancelled.
+//
+class OperationContext {
+public:
+  // No deadline, never cancelled.
+  OperationContext() : deadline_us_(0) {
+  }
+
+  // Deadline "timeout_ms" milliseconds from now (INFINITE for none).
+  explicit OperationContext(DWORD timeout_ms, const CancellationToken& token = CancellationToken());
+
+  explicit OperationContext(const CancellationToken& token) : deadline_us_(0), token_(token) {
+  }
+
+  // Absolute deadline (monotonic_microseconds), 0 if none.
+  ULONGLONG deadline_us() const { return deadline_us_; }
+  const CancellationToken& token() const { return token_; }
+
+  bool expired() const;
+
+  // Milliseconds until the deadline, INFINITE if there is none.
+  DWORD remaining_ms() const;
+
+  // Returns false and fills "error" if the operation must stop.
+  bool Check(std::string* error) const;
+
+private:
+  ULONGLONG deadline_us_;
+  CancellationToken token_;
+};
+
+}  // namespace btle
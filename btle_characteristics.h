@@ -1,85 +1,85 @@
-// See https://developer.bluetooth.org/gatt/characteristics/Pages/CharacteristicsHome.aspx
-DEFINE_CHARACTERISTIC(0x2A00, Device_Name)
-DEFINE_CHARACTERISTIC(0x2A01, Appearance)
-DEFINE_CHARACTERISTIC(0x2A02, Peripheral_Privacy_Flag)
-DEFINE_CHARACTERISTIC(0x2A03, Reconnection_Address)
-DEFINE_CHARACTERISTIC(0x2A04, Peripheral_Preferred_Connection_Parameters)
-DEFINE_CHARACTERISTIC(0x2A05, Service_Changed)
-DEFINE_CHARACTERISTIC(0x2A06, Alert_Level)
-DEFINE_CHARACTERISTIC(0x2A07, Tx_Power_Level)
-DEFINE_CHARACTERISTIC(0x2A08, Date_Time)
-DEFINE_CHARACTERISTIC(0x2A09, Day_of_Week)
-DEFINE_CHARACTERISTIC(0x2A0A, Day_Date_Time)
-DEFINE_CHARACTERISTIC(0x2A0C, Exact_Time_256)
-DEFINE_CHARACTERISTIC(0x2A0D, DST_Offset)
-DEFINE_CHARACTERISTIC(0x2A0E, Time_Zone)
-DEFINE_CHARACTERISTIC(0x2A0F, Local_Time_Information)
-DEFINE_CHARACTERISTIC(0x2A11, Time_with_DST)
-DEFINE_CHARACTERISTIC(0x2A12, Time_Accuracy)
-DEFINE_CHARACTERISTIC(0x2A13, Time_Source)
-DEFINE_CHARACTERISTIC(0x2A14, Reference_Time_Information)
-DEFINE_CHARACTERISTIC(0x2A16, Time_Update_Control_Point)
-DEFINE_CHARACTERISTIC(0x2A17, Time_Update_State)
-DEFINE_CHARACTERISTIC(0x2A18, Glucose_Measurement)
-DEFINE_CHARACTERISTIC(0x2A19, Battery_Level)
-DEFINE_CHARACTERISTIC(0x2A1C, Temperature_Measurement)
-DEFINE_CHARACTERISTIC(0x2A1D, Temperature_Type)
-DEFINE_CHARACTERISTIC(0x2A1E, Intermediate_Temperature)
-DEFINE_CHARACTERISTIC(0x2A21, Measurement_Interval)
-DEFINE_CHARACTERISTIC(0x2A22, Boot_Keyboard_Input_Report)
-DEFINE_CHARACTERISTIC(0x2A23, System_ID)
-DEFINE_CHARACTERISTIC(0x2A24, Model_Number_String)
-DEFINE_CHARACTERISTIC(0x2A25, Serial_Number_String)
-DEFINE_CHARACTERISTIC(0x2A26, Firmware_Revision_String)
-DEFINE_CHARACTERISTIC(0x2A27, Hardware_Revision_String)
-DEFINE_CHARACTERISTIC(0x2A28, Software_Revision_String)
-DEFINE_CHARACTERISTIC(0x2A29, Manufacturer_Name_String)
-DEFINE_CHARACTERISTIC(0x2A2A, IEEE_11073_20601_Regulatory_Certification_Data_List)
-DEFINE_CHARACTERISTIC(0x2A2B, Current_Time)
-DEFINE_CHARACTERISTIC(0x2A31, Scan_Refresh)
-DEFINE_CHARACTERISTIC(0x2A32, Boot_Keyboard_Output_Report)
-DEFINE_CHARACTERISTIC(0x2A33, Boot_Mouse_Input_Report)
-DEFINE_CHARACTERISTIC(0x2A34, Glucose_Measurement_Context)
-DEFINE_CHARACTERISTIC(0x2A35, Blood_Pressure_Measurement)
-DEFINE_CHARACTERISTIC(0x2A36, Intermediate_Cuff_Pressure)
-DEFINE_CHARACTERISTIC(0x2A37, Heart_Rate_Measurement)
-DEFINE_CHARACTERISTIC(0x2A38, Body_Sensor_Location)
-DEFINE_CHARACTERISTIC(0x2A39, Heart_Rate_Control_Point)
-DEFINE_CHARACTERISTIC(0x2A3F, Alert_Status)
-DEFINE_CHARACTERISTIC(0x2A40, Ringer_Control_Point)
-DEFINE_CHARACTERISTIC(0x2A41, Ringer_Setting)
-DEFINE_CHARACTERISTIC(0x2A42, Alert_Category_ID_Bit_Mask)
-DEFINE_CHARACTERISTIC(0x2A43, Alert_Category_ID)
-DEFINE_CHARACTERISTIC(0x2A44, Alert_Notification_Control_Point)
-DEFINE_CHARACTERISTIC(0x2A45, Unread_Alert_Status)
-DEFINE_CHARACTERISTIC(0x2A46, New_Alert)
-DEFINE_CHARACTERISTIC(0x2A47, Supported_New_Alert_Category)
-DEFINE_CHARACTERISTIC(0x2A48, Supported_Unread_Alert_Category)
-DEFINE_CHARACTERISTIC(0x2A49, Blood_Pressure_Feature)
-DEFINE_CHARACTERISTIC(0x2A4A, HID_Information)
-DEFINE_CHARACTERISTIC(0x2A4B, Report_Map)
-DEFINE_CHARACTERISTIC(0x2A4C, HID_Control_Point)
-DEFINE_CHARACTERISTIC(0x2A4D, Report)
-DEFINE_CHARACTERISTIC(0x2A4E, Protocol_Mode)
-DEFINE_CHARACTERISTIC(0x2A4F, Scan_Interval_Window)
-DEFINE_CHARACTERISTIC(0x2A50, PnP_ID)
-DEFINE_CHARACTERISTIC(0x2A51, Glucose_Feature)
-DEFINE_CHARACTERISTIC(0x2A52, Record_Access_Control_Point)
-DEFINE_CHARACTERISTIC(0x2A53, RSC_Measurement)
-DEFINE_CHARACTERISTIC(0x2A54, RSC_Feature)
-DEFINE_CHARACTERISTIC(0x2A55, SC_Control_Point)
-DEFINE_CHARACTERISTIC(0x2A5B, CSC_Measurement)
-DEFINE_CHARACTERISTIC(0x2A5C, CSC_Feature)
-DEFINE_CHARACTERISTIC(0x2A5D, Sensor_Location)
-DEFINE_CHARACTERISTIC(0x2A63, Cycling_Power_Measurement)
-DEFINE_CHARACTERISTIC(0x2A64, Cycling_Power_Vector)
-DEFINE_CHARACTERISTIC(0x2A65, Cycling_Power_Feature)
-DEFINE_CHARACTERISTIC(0x2A66, Cycling_Power_Control_Point)
-DEFINE_CHARACTERISTIC(0x2A67, Location_and_Speed)
-DEFINE_CHARACTERISTIC(0x2A68, Navigation)
-DEFINE_CHARACTERISTIC(0x2A69, Position_Quality)
-DEFINE_CHARACTERISTIC(0x2A6A, LN_Feature)
-DEFINE_CHARACTERISTIC(0x2A6B, LN_Control_Point)
-
-// TI Sensor Tag
-DEFINE_CHARACTERISTIC(0xffe1, Key_Press_State)
+// See https://developer.bluetooth.org/gatt/characteristics/Pages/CharacteristicsHome.aspx
+DEFINE_CHARACTERISTIC(0x2A00, Device_Name)
+DEFINE_CHARACTERISTIC(0x2A01, Appearance)
+DEFINE_CHARACTERISTIC(0x2A02, Peripheral_Privacy_Flag)
+DEFINE_CHARACTERISTIC(0x2A03, Reconnection_Address)
+DEFINE_CHARACTERISTIC(0x2A04, Peripheral_Preferred_Connection_Parameters)
+DEFINE_CHARACTERISTIC(0x2A05, Service_Changed)
+DEFINE_CHARACTERISTIC(0x2A06, Alert_Level)
+DEFINE_CHARACTERISTIC(0x2A07, Tx_Power_Level)
+DEFINE_CHARACTERISTIC(0x2A08, Date_Time)
+DEFINE_CHARACTERISTIC(0x2A09, Day_of_Week)
+DEFINE_CHARACTERISTIC(0x2A0A, Day_Date_Time)
+DEFINE_CHARACTERISTIC(0x2A0C, Exact_Time_256)
+DEFINE_CHARACTERISTIC(0x2A0D, DST_Offset)
+DEFINE_CHARACTERISTIC(0x2A0E, Time_Zone)
+DEFINE_CHARACTERISTIC(0x2A0F, Local_Time_Information)
+DEFINE_CHARACTERISTIC(0x2A11, Time_with_DST)
+DEFINE_CHARACTERISTIC(0x2A12, Time_Accuracy)
+DEFINE_CHARACTERISTIC(0x2A13, Time_Source)
+DEFINE_CHARACTERISTIC(0x2A14, Reference_Time_Information)
+DEFINE_CHARACTERISTIC(0x2A16, Time_Update_Control_Point)
+DEFINE_CHARACTERISTIC(0x2A17, Time_Update_State)
+DEFINE_CHARACTERISTIC(0x2A18, Glucose_Measurement)
+DEFINE_CHARACTERISTIC(0x2A19, Battery_Level)
+DEFINE_CHARACTERISTIC(0x2A1C, Temperature_Measurement)
+DEFINE_CHARACTERISTIC(0x2A1D, Temperature_Type)
+DEFINE_CHARACTERISTIC(0x2A1E, Intermediate_Temperature)
+DEFINE_CHARACTERISTIC(0x2A21, Measurement_Interval)
+DEFINE_CHARACTERISTIC(0x2A22, Boot_Keyboard_Input_Report)
+DEFINE_CHARACTERISTIC(0x2A23, System_ID)
+DEFINE_CHARACTERISTIC(0x2A24, Model_Number_String)
+DEFINE_CHARACTERISTIC(0x2A25, Serial_Number_String)
+DEFINE_CHARACTERISTIC(0x2A26, Firmware_Revision_String)
+DEFINE_CHARACTERISTIC(0x2A27, Hardware_Revision_String)
+DEFINE_CHARACTERISTIC(0x2A28, Software_Revision_String)
+DEFINE_CHARACTERISTIC(0x2A29, Manufacturer_Name_String)
+DEFINE_CHARACTERISTIC(0x2A2A, IEEE_11073_20601_Regulatory_Certification_Data_List)
+DEFINE_CHARACTERISTIC(0x2A2B, Current_Time)
+DEFINE_CHARACTERISTIC(0x2A31, Scan_Refresh)
+DEFINE_CHARACTERISTIC(0x2A32, Boot_Keyboard_Output_Report)
+DEFINE_CHARACTERISTIC(0x2A33, Boot_Mouse_Input_Report)
+DEFINE_CHARACTERISTIC(0x2A34, Glucose_Measurement_Context)
+DEFINE_CHARACTERISTIC(0x2A35, Blood_Pressure_Measurement)
+DEFINE_CHARACTERISTIC(0x2A36, Intermediate_Cuff_Pressure)
+DEFINE_CHARACTERISTIC(0x2A37, Heart_Rate_Measurement)
+DEFINE_CHARACTERISTIC(0x2A38, Body_Sensor_Location)
+DEFINE_CHARACTERISTIC(0x2A39, Heart_Rate_Control_Point)
+DEFINE_CHARACTERISTIC(0x2A3F, Alert_Status)
+DEFINE_CHARACTERISTIC(0x2A40, Ringer_Control_Point)
+DEFINE_CHARACTERISTIC(0x2A41, Ringer_Setting)
+DEFINE_CHARACTERISTIC(0x2A42, Alert_Category_ID_Bit_Mask)
+DEFINE_CHARACTERISTIC(0x2A43, Alert_Category_ID)
+DEFINE_CHARACTERISTIC(0x2A44, Alert_Notification_Control_Point)
+DEFINE_CHARACTERISTIC(0x2A45, Unread_Alert_Status)
+DEFINE_CHARACTERISTIC(0x2A46, New_Alert)
+DEFINE_CHARACTERISTIC(0x2A47, Supported_New_Alert_Category)
+DEFINE_CHARACTERISTIC(0x2A48, Supported_Unread_Alert_Category)
+DEFINE_CHARACTERISTIC(0x2A49, Blood_Pressure_Feature)
+DEFINE_CHARACTERISTIC(0x2A4A, HID_Information)
+DEFINE_CHARACTERISTIC(0x2A4B, Report_Map)
+DEFINE_CHARACTERISTIC(0x2A4C, HID_Control_Point)
+DEFINE_CHARACTERISTIC(0x2A4D, Report)
+DEFINE_CHARACTERISTIC(0x2A4E, Protocol_Mode)
+DEFINE_CHARACTERISTIC(0x2A4F, Scan_Interval_Window)
+DEFINE_CHARACTERISTIC(0x2A50, PnP_ID)
+DEFINE_CHARACTERISTIC(0x2A51, Glucose_Feature)
+DEFINE_CHARACTERISTIC(0x2A52, Record_Access_Control_Point)
+DEFINE_CHARACTERISTIC(0x2A53, RSC_Measurement)
+DEFINE_CHARACTERISTIC(0x2A54, RSC_Feature)
+DEFINE_CHARACTERISTIC(0x2A55, SC_Control_Point)
+DEFINE_CHARACTERISTIC(0x2A5B, CSC_Measurement)
+DEFINE_CHARACTERISTIC(0x2A5C, CSC_Feature)
+DEFINE_CHARACTERISTIC(0x2A5D, Sensor_Location)
+DEFINE_CHARACTERISTIC(0x2A63, Cycling_Power_Measurement)
+DEFINE_CHARACTERISTIC(0x2A64, Cycling_Power_Vector)
+DEFINE_CHARACTERISTIC(0x2A65, Cycling_Power_Feature)
+DEFINE_CHARACTERISTIC(0x2A66, Cycling_Power_Control_Point)
+DEFINE_CHARACTERISTIC(0x2A67, Location_and_Speed)
+DEFINE_CHARACTERISTIC(0x2A68, Navigation)
+DEFINE_CHARACTERISTIC(0x2A69, Position_Quality)
+DEFINE_CHARACTERISTIC(0x2A6A, LN_Feature)
+DEFINE_CHARACTERISTIC(0x2A6B, LN_Control_Point)
+
+// TI Sensor Tag
+DEFINE_CHARACTERISTIC(0xffe1, Key_Press_State)
@@ -0,0 +1,223 @@
+#include "stdafx.h"
+
+#include <cstring>
+#include <sstream>
+
+#include "btle_coro.h"
+#include "btle_gatt.h"
+
+namespace btle {
+
+static const char kChannelClosed[] = "Notification channel closed";
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+OperationAwaiter<scoped_refptr<CharacteristicValue>> ReadCharacteristic(
+    IoExecutor* executor,
+    scoped_refptr<Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<Characteristic> characteristic,
+    const OperationContext& context) {
+  return OperationAwaiter<scoped_refptr<CharacteristicValue>>(
+      executor,
+      DeviceQueueKey(device),
+      [=](scoped_refptr<CharacteristicValue>* value, std::string* error) {
+        return ReadServiceCharacteristicValue(service_handle->get(), characteristic, value, error);
+      },
+      context);
+}
+
+StatusAwaiter WriteCharacteristic(
+    IoExecutor* executor,
+    scoped_refptr<Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<Characteristic> characteristic,
+    scoped_refptr<CharacteristicValue> value,
+    ULONG flags,
+    const OperationContext& context) {
+  return StatusAwaiter(
+      executor,
+      [=](const StatusCallback& callback) {
+        WriteServiceCharacteristicValueAsync(executor, device, service_handle, characteristic, value, flags, context, callback);
+      },
+      context);
+}
+
+StatusAwaiter SubscribeCharacteristic(
+    IoExecutor* executor,
+    scoped_refptr<Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<Characteristic> characteristic,
+    const OperationContext& context) {
+  return StatusAwaiter(
+      executor,
+      DeviceQueueKey(device),
+      [=](std::string* error) {
+        return SubscribeToNotifications(service_handle->get(), characteristic, error);
+      },
+      context);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+NotificationChannel::NotificationChannel(IoExecutor* executor, size_t capacity, size_t slot_size)
+  : executor_(executor),
+    capacity_(capacity ? capacity : 1),
+    slot_size_(slot_size ? slot_size : 1),
+    storage_((capacity_ + 1) * slot_size_),
+    sizes_(capacity_ + 1),
+    queue_(capacity_),
+    head_(0),
+    count_(0),
+    held_(kNoSlot),
+    closed_(false),
+    dropped_(0),
+    truncated_(0),
+    event_handle_(NULL) {
+  free_.reserve(capacity_ + 1);
+  for (size_t slot = 0; slot <= capacity_; slot++)
+    free_.push_back(slot);
+}
+
+NotificationChannel::~NotificationChannel() {
+  Unregister();
+}
+
+bool NotificationChannel::Register(HANDLE service_handle, scoped_refptr<Characteristic> characteristic, std::string* error) {
+  Unregister();
+
+  BLUETOOTH_GATT_VALUE_CHANGED_EVENT_REGISTRATION registration;
+  registration.NumCharacteristics = 1;
+  registration.Characteristics[0] = characteristic->info();
+  HRESULT hr = GetGattBackend()->RegisterEvent(
+      service_handle,
+      CharacteristicValueChangedEvent,
+      &registration,
+      &NotificationChannel::OnValueChanged,
+      this,
+      &event_handle_,
+      BLUETOOTH_GATT_FLAG_NONE);
+  if (FAILED(hr)) {
+    std::ostringstream string_stream;
+    string_stream << "Error calling BluetoothGATTRegisterEvent: hr=" <<  hr;
+    *error = string_stream.str();
+    event_handle_ = NULL;
+    return false;
+  }
+  value_format_ = characteristic->value_format();
+  return true;
+}
+
+void NotificationChannel::Unregister() {
+  if (event_handle_ != NULL) {
+    GetGattBackend()->UnregisterEvent(event_handle_, BLUETOOTH_GATT_FLAG_NONE);
+    event_handle_ = NULL;
+  }
+}
+
+VOID CALLBACK NotificationChannel::OnValueChanged(BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_out_parameter, PVOID context) {
+  if (event_type != CharacteristicValueChangedEvent)
+    return;
+
+  NotificationChannel* channel = reinterpret_cast<NotificationChannel*>(context);
+  BLUETOOTH_GATT_VALUE_CHANGED_EVENT* event = reinterpret_cast<BLUETOOTH_GATT_VALUE_CHANGED_EVENT*>(event_out_parameter);
+  channel->Push(event->CharacteristicValue->Data, event->CharacteristicValue->DataSize);
+}
+
+void NotificationChannel::Push(const UINT8* data, size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_)
+    return;
+
+  size_t slot;
+  if (count_ == capacity_) {
+    slot = queue_[head_];
+    head_ = (head_ + 1) % capacity_;
+    count_--;
+    dropped_++;
+  } else {
+    slot = free_.back();
+    free_.pop_back();
+  }
+  if (size > slot_size_) {
+    size = slot_size_;
+    truncated_++;
+  }
+  memcpy(&storage_[slot * slot_size_], data, size);
+  sizes_[slot] = size;
+  queue_[(head_ + count_) % capacity_] = slot;
+  count_++;
+
+  if (waiter_) {
+    scoped_refptr<ValueWaiter> waiter = waiter_;
+    waiter_ = scoped_refptr<ValueWaiter>();
+    std::lock_guard<std::mutex> waiter_lock(waiter->mutex());
+    if (waiter->Claim())
+      waiter->Resume(PopFront());
+  }
+}
+
+ValueView NotificationChannel::PopFront() {
+  if (held_ != kNoSlot)
+    free_.push_back(held_);
+  held_ = queue_[head_];
+  head_ = (head_ + 1) % capacity_;
+  count_--;
+  return Slot(held_);
+}
+
+void NotificationChannel::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  closed_ = true;
+  if (waiter_) {
+    scoped_refptr<ValueWaiter> waiter = waiter_;
+    waiter_ = scoped_refptr<ValueWaiter>();
+    std::lock_guard<std::mutex> waiter_lock(waiter->mutex());
+    if (waiter->Claim())
+      waiter->Fail(kChannelClosed);
+  }
+}
+
+ULONG NotificationChannel::dropped() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_;
+}
+
+ULONG NotificationChannel::truncated() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return truncated_;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool NotificationAwaiter::await_suspend(std::coroutine_handle<> handle) {
+  std::lock_guard<std::mutex> lock(channel_->mutex_);
+  if (channel_->count_ != 0) {
+    result_.success = true;
+    result_.value = channel_->PopFront();
+    return false;
+  }
+  if (channel_->closed_) {
+    result_.error = kChannelClosed;
+    return false;
+  }
+
+  waiter_ = scoped_refptr<NotificationChannel::ValueWaiter>(new NotificationChannel::ValueWaiter(channel_->executor_, token_));
+  channel_->waiter_ = waiter_;
+  std::lock_guard<std::mutex> waiter_lock(waiter_->mutex());
+  waiter_->Suspend(handle, timeout_ms_);
+  return true;
+}
+
+AsyncResult<ValueView> NotificationAwaiter::await_resume() {
+  if (!waiter_)
+    return result_;
+
+  waiter_->Finish();
+  return waiter_->result();
+}
+
+}  // namespace btle
@@ -0,0 +1,515 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base.h"
+#include "btle.h"
+#include "btle_async.h"
+#include "btle_value_view.h"
+
+// Coroutine front end of the asynchronous GATT operations. A device session
+// is written as sequential code:
+//
+//   btle::Task<btle::AsyncStatus> Session(btle::IoExecutor* executor, ...) {
+//     btle::AsyncResult<scoped_refptr<btle::CharacteristicValue>> result =
+//         co_await btle::ReadCharacteristic(executor, service_handle, characteristic);
+//     ...
+//   }
+//
+// and started with btle::Spawn(). Sessions only hold an executor thread
+// while a GATT call is running, so thousands of them can share a few
+// threads. GATT awaits accept an OperationContext (deadline and
+// cancellation token), the others a timeout and/or a CancellationToken;
+// expired or cancelled awaits complete with kOperationTimedOut or
+// kOperationCancelled.
+namespace btle {
+
+template<typename T>
+class Task;
+
+namespace internal {
+
+// Resumes the awaiting coroutine, if any, when a Task completes.
+template<typename Promise>
+struct FinalAwaiter {
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+    std::coroutine_handle<> continuation = handle.promise().continuation;
+    return continuation ? continuation : std::noop_coroutine();
+  }
+
+  void await_resume() const noexcept {
+  }
+};
+
+// Coroutine owning its own frame, used to run spawned tasks.
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() {
+      DetachedTask task;
+      task.handle = std::coroutine_handle<promise_type>::from_promise(*this);
+      return task;
+    }
+    std::suspend_always initial_suspend() noexcept { return std::suspend_always(); }
+    std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+    void return_void() {
+    }
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  std::coroutine_handle<> handle;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// State of a suspended coroutine waiting for the first of several events
+// (completion, timer, cancellation). Whoever claims the waiter first stores
+// the result and posts the coroutine back on the executor.
+//
+// The awaiter holds "mutex" while it registers its wake-up sources, and
+// those only claim the waiter from executor tasks, so a claim never races
+// with the registration.
+//
+template<typename T>
+class Waiter : public RefCounted<Waiter<T>> {
+public:
+  Waiter(IoExecutor* executor, const CancellationToken& token)
+    : executor_(executor), token_(token), claimed_(false), cancel_id_(0), timer_id_(0) {
+  }
+
+  std::mutex& mutex() { return mutex_; }
+  const AsyncResult<T>& result() const { return result_; }
+
+  // Called with "mutex" held, from await_suspend().
+  void Suspend(std::coroutine_handle<> handle, DWORD timeout_ms) {
+    handle_ = handle;
+    scoped_refptr<Waiter<T>> self(this);
+    IoExecutor* executor = executor_;
+    cancel_id_ = token_.Register([self, executor]() {
+      executor->Post([self]() { self->Complete(kOperationCancelled); });
+    });
+    if (timeout_ms != INFINITE)
+      timer_id_ = executor_->PostDelayed([self]() { self->Complete(kOperationTimedOut); }, timeout_ms);
+  }
+
+  // Called with "mutex" held, from await_suspend(): "timer_id" completes the
+  // waiter in place of the timeout.
+  void SetTimer(ULONG timer_id) {
+    timer_id_ = timer_id;
+  }
+
+  // Called with "mutex" held. Returns false if the waiter was already
+  // claimed.
+  bool Claim() {
+    if (claimed_)
+      return false;
+    claimed_ = true;
+    return true;
+  }
+
+  // Called with "mutex" held, after a successful Claim().
+  void Resume(const T& value) {
+    result_.success = true;
+    result_.value = value;
+    PostResume();
+  }
+
+  // Called with "mutex" held, after a successful Claim().
+  void Fail(const char* error) {
+    result_.error = error;
+    PostResume();
+  }
+
+  // Called from await_resume(). A timer that didn't fire would keep the
+  // waiter alive until it does.
+  void Finish() {
+    if (timer_id_ != 0)
+      executor_->CancelDelayed(timer_id_);
+    token_.Unregister(cancel_id_);
+  }
+
+private:
+  void Complete(const char* error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Claim())
+      Fail(error);
+  }
+
+  void PostResume() {
+    std::coroutine_handle<> handle = handle_;
+    executor_->Post([handle]() { handle.resume(); });
+  }
+
+  IoExecutor* executor_;
+  CancellationToken token_;
+  std::mutex mutex_;
+  bool claimed_;
+  int cancel_id_;
+  ULONG timer_id_;
+  std::coroutine_handle<> handle_;
+  AsyncResult<T> result_;
+};
+
+}  // namespace internal
+
+//////////////////////////////////////////////////////////////////////////////
+// Coroutine producing a value of type T. The coroutine starts when the task
+// is awaited or spawned, and resumes its awaiter when it completes.
+//
+template<typename T>
+class Task {
+public:
+  class promise_type {
+  public:
+    promise_type() : value() {
+    }
+
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return std::suspend_always(); }
+    internal::FinalAwaiter<promise_type> final_suspend() noexcept { return internal::FinalAwaiter<promise_type>(); }
+    void return_value(const T& result) { value = result; }
+    void unhandled_exception() { std::terminate(); }
+
+    std::coroutine_handle<> continuation;
+    T value;
+  };
+
+  Task(Task&& other) noexcept : handle_(other.handle_) {
+    other.handle_ = nullptr;
+  }
+
+  ~Task() {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept {
+    handle_.promise().continuation = continuation;
+    return handle_;
+  }
+
+  T await_resume() { return handle_.promise().value; }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {
+  }
+
+  std::coroutine_handle<promise_type> handle_;
+
+  Task(const Task& other);
+  const Task& operator=(const Task& other);
+};
+
+namespace internal {
+
+template<typename T>
+DetachedTask RunDetached(Task<T> task, std::function<void(const T&)> callback) {
+  T result = co_await task;
+  if (callback)
+    callback(result);
+}
+
+}  // namespace internal
+
+// Starts "task" on "executor" and invokes "callback" with its result.
+template<typename T>
+void Spawn(IoExecutor* executor, Task<T> task, const std::function<void(const std::type_identity_t<T>&)>& callback) {
+  std::coroutine_handle<> handle = internal::RunDetached(std::move(task), callback).handle;
+  executor->Post([handle]() { handle.resume(); });
+}
+
+template<typename T>
+std::future<T> Spawn(IoExecutor* executor, Task<T> task) {
+  std::shared_ptr<std::promise<T>> promise(new std::promise<T>());
+  Spawn<T>(executor, std::move(task), [promise](const T& result) {
+    promise->set_value(result);
+  });
+  return promise->get_future();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Awaitable running a blocking operation on the "queue_key" queue of an
+// executor (see PostAsync). The coroutine resumes as a separate executor
+// task, so it doesn't hold the queue, as soon as the operation completes or
+// its context expires or gets cancelled.
+//
+template<typename T>
+class OperationAwaiter {
+public:
+  OperationAwaiter(IoExecutor* executor, ULONGLONG queue_key, const typename AsyncValue<T>::Operation& operation, const OperationContext& context)
+    : executor_(executor), queue_key_(queue_key), operation_(operation), context_(context) {
+  }
+
+  bool await_ready() const { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    IoExecutor* executor = executor_;
+    AsyncResult<T>* result = &result_;
+    PostAsync<T>(executor_, queue_key_, context_, operation_, [executor, result, handle](const AsyncResult<T>& operation_result) {
+      *result = operation_result;
+      executor->Post([handle]() { handle.resume(); });
+    });
+  }
+
+  AsyncResult<T> await_resume() { return result_; }
+
+private:
+  IoExecutor* executor_;
+  ULONGLONG queue_key_;
+  typename AsyncValue<T>::Operation operation_;
+  OperationContext context_;
+  AsyncResult<T> result_;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Awaitable asynchronous operation completing with an AsyncStatus. The
+// coroutine resumes as soon as the operation completes, or "context"
+// expires or gets cancelled, whether or not the operation itself honours
+// the context.
+//
+class StatusAwaiter {
+public:
+  // Starts an asynchronous operation completing with "callback".
+  typedef std::function<void(const StatusCallback& callback)> Start;
+
+  StatusAwaiter(IoExecutor* executor, ULONGLONG queue_key, const AsyncOperation& operation, const OperationContext& context)
+    : executor_(executor), context_(context) {
+    start_ = [executor, queue_key, operation, context](const StatusCallback& callback) {
+      PostAsync(executor, queue_key, context, operation, callback);
+    };
+  }
+
+  // Awaits an operation started by "start", e.g. the callback form of one of
+  // the operations of "btle_async.h".
+  StatusAwaiter(IoExecutor* executor, const Start& start, const OperationContext& context)
+    : executor_(executor), start_(start), context_(context) {
+  }
+
+  bool await_ready() const { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    waiter_ = scoped_refptr<internal::Waiter<bool>>(new internal::Waiter<bool>(executor_, context_.token()));
+    std::lock_guard<std::mutex> lock(waiter_->mutex());
+    waiter_->Suspend(handle, context_.remaining_ms());
+
+    // The completion claims the waiter from an executor task, like the
+    // deadline and the cancellation: "start" may complete right away.
+    scoped_refptr<internal::Waiter<bool>> waiter = waiter_;
+    IoExecutor* executor = executor_;
+    AsyncStatus* status = &status_;
+    start_([waiter, executor, status](const AsyncStatus& operation_status) {
+      executor->Post([waiter, status, operation_status]() {
+        std::lock_guard<std::mutex> lock(waiter->mutex());
+        if (!waiter->Claim())
+          return;
+        // Not resumed yet: the awaiter, and "status", are still there.
+        *status = operation_status;
+        waiter->Resume(true);
+      });
+    });
+  }
+
+  AsyncStatus await_resume() {
+    waiter_->Finish();
+    if (waiter_->result().success)
+      return status_;
+    return waiter_->result();
+  }
+
+private:
+  IoExecutor* executor_;
+  Start start_;
+  OperationContext context_;
+  scoped_refptr<internal::Waiter<bool>> waiter_;
+  AsyncStatus status_;
+};
+
+OperationAwaiter<scoped_refptr<CharacteristicValue>> ReadCharacteristic(
+    IoExecutor* executor,
+    scoped_refptr<Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<Characteristic> characteristic,
+    const OperationContext& context = OperationContext());
+
+// Writes through "DeviceWriteRateLimiter", see
+// WriteServiceCharacteristicValueAsync().
+StatusAwaiter WriteCharacteristic(
+    IoExecutor* executor,
+    scoped_refptr<Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<Characteristic> characteristic,
+    scoped_refptr<CharacteristicValue> value,
+    ULONG flags,
+    const OperationContext& context = OperationContext());
+
+StatusAwaiter SubscribeCharacteristic(
+    IoExecutor* executor,
+    scoped_refptr<Device> device,
+    scoped_refptr<SharedHandle> service_handle,
+    scoped_refptr<Characteristic> characteristic,
+    const OperationContext& context = OperationContext());
+
+//////////////////////////////////////////////////////////////////////////////
+// Suspends the coroutine for "delay_ms" milliseconds without holding an
+// executor thread. Fails only if cancelled.
+//
+class DelayAwaiter {
+public:
+  DelayAwaiter(IoExecutor* executor, DWORD delay_ms, const CancellationToken& token)
+    : waiter_(new internal::Waiter<bool>(executor, token)), executor_(executor), delay_ms_(delay_ms) {
+  }
+
+  bool await_ready() const { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    std::lock_guard<std::mutex> lock(waiter_->mutex());
+    waiter_->Suspend(handle, INFINITE);
+    scoped_refptr<internal::Waiter<bool>> waiter = waiter_;
+    waiter_->SetTimer(executor_->PostDelayed([waiter]() {
+      std::lock_guard<std::mutex> lock(waiter->mutex());
+      if (waiter->Claim())
+        waiter->Resume(true);
+    }, delay_ms_));
+  }
+
+  AsyncStatus await_resume() {
+    waiter_->Finish();
+    return waiter_->result();
+  }
+
+private:
+  scoped_refptr<internal::Waiter<bool>> waiter_;
+  IoExecutor* executor_;
+  DWORD delay_ms_;
+};
+
+inline
+DelayAwaiter Delay(IoExecutor* executor, DWORD delay_ms, const CancellationToken& token = CancellationToken()) {
+  return DelayAwaiter(executor, delay_ms, token);
+}
+
+class NotificationAwaiter;
+
+//////////////////////////////////////////////////////////////////////////////
+// Queue of value changed notifications of a characteristic, consumed by a
+// coroutine with NextNotification(). When the queue is full, the oldest
+// value is dropped.
+//
+// Values are copied into a ring of fixed size slots allocated once, and
+// handed out as views over their slot: a view stays valid until the next
+// NextNotification() on the channel. Values longer than a slot are
+// truncated.
+//
+class NotificationChannel : public RefCounted<NotificationChannel> {
+public:
+  // Largest attribute value.
+  static const size_t kMaxValueSize = 512;
+
+  NotificationChannel(IoExecutor* executor, size_t capacity, size_t slot_size = kMaxValueSize);
+
+  // Registers for value changed events of "characteristic". Notifications
+  // must be enabled separately (see SubscribeCharacteristic).
+  bool Register(HANDLE service_handle, scoped_refptr<Characteristic> characteristic, std::string* error);
+  void Unregister();
+
+  // Presentation format of the registered characteristic (see
+  // Characteristic::value_format()), kept so that every notification is
+  // decoded without looking it up again.
+  const ValueFormat& value_format() const { return value_format_; }
+
+  // Decodes a value handed out by NextNotification() with value_format().
+  // Returns false if the characteristic has no supported format.
+  bool Decode(const ValueView& value, double* decoded) const {
+    return value_format_.Decode(value.data(), value.size(), decoded);
+  }
+
+  // Queues a value, or hands it to the waiting coroutine.
+  void Push(const UINT8* data, size_t size);
+
+  // Wakes the waiting coroutine, if any, with an error. Later awaits fail
+  // right away once the queue is empty.
+  void Close();
+
+  ULONG dropped() const;
+  ULONG truncated() const;
+
+protected:
+  virtual ~NotificationChannel();
+
+private:
+  friend class NotificationAwaiter;
+  typedef internal::Waiter<ValueView> ValueWaiter;
+
+  static const size_t kNoSlot = static_cast<size_t>(-1);
+
+  static VOID CALLBACK OnValueChanged(BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_out_parameter, PVOID context);
+
+  // Called with "mutex_" held.
+  ValueView Slot(size_t index) const {
+    return ValueView(&storage_[index * slot_size_], sizes_[index]);
+  }
+  ValueView PopFront();
+
+  IoExecutor* executor_;
+  size_t capacity_;
+  size_t slot_size_;
+  mutable std::mutex mutex_;
+  // capacity_ + 1 slots: up to capacity_ queued values, in "queue_" from
+  // "head_" on, and the value handed out last ("held_"). The other slots are
+  // in "free_". A value pushed when the queue is full reuses the slot of the
+  // oldest value.
+  std::vector<UINT8> storage_;
+  std::vector<size_t> sizes_;
+  std::vector<size_t> queue_;
+  size_t head_;
+  size_t count_;
+  std::vector<size_t> free_;
+  size_t held_;
+  scoped_refptr<ValueWaiter> waiter_;
+  bool closed_;
+  ULONG dropped_;
+  ULONG truncated_;
+  ValueFormat value_format_;
+  BLUETOOTH_GATT_EVENT_HANDLE event_handle_;
+};
+
+class NotificationAwaiter {
+public:
+  NotificationAwaiter(scoped_refptr<NotificationChannel> channel, DWORD timeout_ms, const CancellationToken& token)
+    : channel_(channel), timeout_ms_(timeout_ms), token_(token) {
+  }
+
+  bool await_ready() const { return false; }
+  bool await_suspend(std::coroutine_handle<> handle);
+  AsyncResult<ValueView> await_resume();
+
+private:
+  scoped_refptr<NotificationChannel> channel_;
+  DWORD timeout_ms_;
+  CancellationToken token_;
+  scoped_refptr<NotificationChannel::ValueWaiter> waiter_;
+  // Result when a value was available without suspending.
+  AsyncResult<ValueView> result_;
+};
+
+// Waits for the next notification of "channel", for at most "timeout_ms"
+// milliseconds (INFINITE for no limit).
+inline
+NotificationAwaiter NextNotification(scoped_refptr<NotificationChannel> channel, DWORD timeout_ms, const CancellationToken& token = CancellationToken()) {
+  return NotificationAwaiter(channel, timeout_ms, token);
+}
+
+}  // namespace btle
@@ -0,0 +1,206 @@
+#include "stdafx.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "btle_coro.h"
+#include "btle_test.h"
+
+namespace {
+
+// Start function of an operation that only completes when the test invokes
+// the callback it keeps.
+btle::StatusAwaiter::Start HangingStart(std::shared_ptr<btle::StatusCallback> callback) {
+  return [callback](const btle::StatusCallback& done) {
+    *callback = done;
+  };
+}
+
+btle::Task<btle::AsyncStatus> AwaitStatus(btle::IoExecutor* executor, btle::StatusAwaiter::Start start, btle::OperationContext context) {
+  btle::AsyncStatus status = co_await btle::StatusAwaiter(executor, start, context);
+  co_return status;
+}
+
+// Waits up to a second for the result of a spawned task.
+template<typename T>
+bool WaitForResult(std::future<T>& result) {
+  return result.wait_for(std::chrono::seconds(1)) == std::future_status::ready;
+}
+
+scoped_refptr<btle::NotificationChannel> MakeChannel(btle::IoExecutor* executor, size_t capacity, size_t slot_size) {
+  return scoped_refptr<btle::NotificationChannel>(new btle::NotificationChannel(executor, capacity, slot_size));
+}
+
+void Push(const scoped_refptr<btle::NotificationChannel>& channel, const std::string& value) {
+  channel->Push(reinterpret_cast<const UINT8*>(value.data()), value.size());
+}
+
+// Awaits up to "count" notifications, each waiting at most "timeout_ms",
+// and returns their values, or the error that ended the wait. "received" is
+// called after the first value is handed out, before it is copied.
+btle::Task<std::vector<std::string>> Collect(scoped_refptr<btle::NotificationChannel> channel, size_t count, DWORD timeout_ms,
+                                             btle::CancellationToken token, std::function<void()> received) {
+  std::vector<std::string> values;
+  for (size_t i = 0; i < count; i++) {
+    btle::AsyncResult<btle::ValueView> result = co_await btle::NextNotification(channel, timeout_ms, token);
+    if (!result.success) {
+      values.push_back("error: " + result.error);
+      break;
+    }
+    if (i == 0 && received)
+      received();
+    values.push_back(std::string(reinterpret_cast<const char*>(result.value.data()), result.value.size()));
+  }
+  co_return values;
+}
+
+std::vector<std::string> Values(const char* first, const char* second = NULL, const char* third = NULL) {
+  std::vector<std::string> values(1, first);
+  if (second != NULL)
+    values.push_back(second);
+  if (third != NULL)
+    values.push_back(third);
+  return values;
+}
+
+}  // namespace
+
+// An operation that ignores its context doesn't hold the awaiting
+// coroutine past the deadline, and completing it later is harmless.
+BTLE_TEST(coro, StatusAwaiterTimesOut) {
+  btle::IoExecutor executor(2);
+  std::shared_ptr<btle::StatusCallback> callback(new btle::StatusCallback());
+  std::future<btle::AsyncStatus> result = btle::Spawn(&executor, AwaitStatus(&executor, HangingStart(callback), btle::OperationContext(20)));
+  BTLE_EXPECT(WaitForResult(result));
+  btle::AsyncStatus status = result.get();
+  BTLE_EXPECT(!status.success);
+  BTLE_EXPECT_EQ(std::string(btle::kOperationTimedOut), status.error);
+
+  btle::AsyncStatus late;
+  late.success = true;
+  (*callback)(late);
+}
+
+BTLE_TEST(coro, StatusAwaiterCancelled) {
+  btle::IoExecutor executor(2);
+  std::shared_ptr<btle::StatusCallback> callback(new btle::StatusCallback());
+  btle::CancellationSource cancellation;
+  std::future<btle::AsyncStatus> result = btle::Spawn(&executor, AwaitStatus(&executor, HangingStart(callback), btle::OperationContext(cancellation.token())));
+  cancellation.Cancel();
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT_EQ(std::string(btle::kOperationCancelled), result.get().error);
+}
+
+// The status of an operation completing in time, failures included, is
+// passed through.
+BTLE_TEST(coro, StatusAwaiterCompletes) {
+  btle::IoExecutor executor(2);
+  btle::StatusAwaiter::Start start = [](const btle::StatusCallback& done) {
+    btle::AsyncStatus status;
+    status.error = "write failed";
+    done(status);
+  };
+  std::future<btle::AsyncStatus> result = btle::Spawn(&executor, AwaitStatus(&executor, start, btle::OperationContext(60000)));
+  BTLE_EXPECT(WaitForResult(result));
+  btle::AsyncStatus status = result.get();
+  BTLE_EXPECT(!status.success);
+  BTLE_EXPECT_EQ(std::string("write failed"), status.error);
+}
+
+// A full queue drops its oldest value, counted by dropped(); values longer
+// than a slot are truncated.
+BTLE_TEST(coro, NotificationChannelDropsOldest) {
+  btle::IoExecutor executor(2);
+  scoped_refptr<btle::NotificationChannel> channel = MakeChannel(&executor, 2, 8);
+  Push(channel, "first");
+  Push(channel, "second");
+  Push(channel, "third value");
+  BTLE_EXPECT_EQ(1u, channel->dropped());
+  BTLE_EXPECT_EQ(1u, channel->truncated());
+
+  std::future<std::vector<std::string>> result = btle::Spawn(&executor, Collect(channel, 2, 1000, btle::CancellationToken(), NULL));
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT(result.get() == Values("second", "third va"));
+}
+
+// The value handed out last keeps its slot while the queue wraps around and
+// drops values, until the next NextNotification().
+BTLE_TEST(coro, NotificationChannelHeldSlot) {
+  btle::IoExecutor executor(2);
+  scoped_refptr<btle::NotificationChannel> channel = MakeChannel(&executor, 2, 8);
+  Push(channel, "value 1");
+  Push(channel, "value 2");
+  std::future<std::vector<std::string>> result = btle::Spawn(&executor, Collect(channel, 3, 1000, btle::CancellationToken(), [channel]() {
+    Push(channel, "value 3");
+    Push(channel, "value 4");
+    Push(channel, "value 5");
+    Push(channel, "value 6");
+  }));
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT(result.get() == Values("value 1", "value 5", "value 6"));
+  BTLE_EXPECT_EQ(3u, channel->dropped());
+}
+
+// A value pushed while the coroutine waits resumes it with that value.
+BTLE_TEST(coro, NotificationChannelPushResumes) {
+  btle::IoExecutor executor(2);
+  scoped_refptr<btle::NotificationChannel> channel = MakeChannel(&executor, 4, 8);
+  std::future<std::vector<std::string>> result = btle::Spawn(&executor, Collect(channel, 2, 1000, btle::CancellationToken(), NULL));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  BTLE_EXPECT(result.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+  Push(channel, "pushed");
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  Push(channel, "again");
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT(result.get() == Values("pushed", "again"));
+  BTLE_EXPECT_EQ(0u, channel->dropped());
+}
+
+BTLE_TEST(coro, NotificationChannelTimesOut) {
+  btle::IoExecutor executor(2);
+  scoped_refptr<btle::NotificationChannel> channel = MakeChannel(&executor, 4, 8);
+  std::future<std::vector<std::string>> result = btle::Spawn(&executor, Collect(channel, 1, 20, btle::CancellationToken(), NULL));
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT(result.get() == Values("error: Operation timed out"));
+
+  // The channel is still usable.
+  Push(channel, "late");
+  result = btle::Spawn(&executor, Collect(channel, 1, 20, btle::CancellationToken(), NULL));
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT(result.get() == Values("late"));
+}
+
+BTLE_TEST(coro, NotificationChannelCancelled) {
+  btle::IoExecutor executor(2);
+  scoped_refptr<btle::NotificationChannel> channel = MakeChannel(&executor, 4, 8);
+  btle::CancellationSource cancellation;
+  std::future<std::vector<std::string>> result = btle::Spawn(&executor, Collect(channel, 1, INFINITE, cancellation.token(), NULL));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  cancellation.Cancel();
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT(result.get() == Values("error: Operation cancelled"));
+}
+
+// Close() wakes the waiting coroutine; the values queued before it are
+// still handed out, and those pushed after it are ignored.
+BTLE_TEST(coro, NotificationChannelClosed) {
+  btle::IoExecutor executor(2);
+  scoped_refptr<btle::NotificationChannel> channel = MakeChannel(&executor, 4, 8);
+  std::future<std::vector<std::string>> result = btle::Spawn(&executor, Collect(channel, 1, INFINITE, btle::CancellationToken(), NULL));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  channel->Close();
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT(result.get() == Values("error: Notification channel closed"));
+
+  scoped_refptr<btle::NotificationChannel> queued = MakeChannel(&executor, 4, 8);
+  Push(queued, "queued");
+  queued->Close();
+  Push(queued, "ignored");
+  result = btle::Spawn(&executor, Collect(queued, 3, INFINITE, btle::CancellationToken(), NULL));
+  BTLE_EXPECT(WaitForResult(result));
+  BTLE_EXPECT(result.get() == Values("queued", "error: Notification channel closed"));
+}
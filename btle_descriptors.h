@@ -1,9 +1,9 @@
-DEFINE_DESCRIPTOR(0x2900, Characteristic_Extended_Properties)
-DEFINE_DESCRIPTOR(0x2901, Characteristic_User_Description)
-DEFINE_DESCRIPTOR(0x2902, Client_Characteristic_Configuration)
-DEFINE_DESCRIPTOR(0x2903, Server_Characteristic_Configuration)
-DEFINE_DESCRIPTOR(0x2904, Characteristic_Presentation_Format)
-DEFINE_DESCRIPTOR(0x2905, Characteristic_Aggregate_Format)
-DEFINE_DESCRIPTOR(0x2906, Valid_Range)
-DEFINE_DESCRIPTOR(0x2907, External_Report_Reference)
-DEFINE_DESCRIPTOR(0x2908, Report_Reference)
+DEFINE_DESCRIPTOR(0x2900, Characteristic_Extended_Properties)
+DEFINE_DESCRIPTOR(0x2901, Characteristic_User_Description)
+DEFINE_DESCRIPTOR(0x2902, Client_Characteristic_Configuration)
+DEFINE_DESCRIPTOR(0x2903, Server_Characteristic_Configuration)
+DEFINE_DESCRIPTOR(0x2904, Characteristic_Presentation_Format)
+DEFINE_DESCRIPTOR(0x2905, Characteristic_Aggregate_Format)
+DEFINE_DESCRIPTOR(0x2906, Valid_Range)
+DEFINE_DESCRIPTOR(0x2907, External_Report_Reference)
+DEFINE_DESCRIPTOR(0x2908, Report_Reference)
@@ -0,0 +1,153 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "btle_devpropkey_names.h"
+#include "btle_guid.h"
+
+namespace btle {
+
+namespace {
+
+struct DevPropKeyName {
+  GUID fmtid;
+  DEVPROPID pid;
+  std::string_view name;
+};
+
+// Range of the entries of a property set in kDevPropKeyNames.
+struct PropertySet {
+  GUID fmtid;
+  size_t begin;
+  size_t end;
+};
+
+constexpr int CompareGuid(const GUID& x, const GUID& y) {
+  if (x.Data1 != y.Data1)
+    return x.Data1 < y.Data1 ? -1 : 1;
+  if (x.Data2 != y.Data2)
+    return x.Data2 < y.Data2 ? -1 : 1;
+  if (x.Data3 != y.Data3)
+    return x.Data3 < y.Data3 ? -1 : 1;
+  for (int i = 0; i < 8; i++) {
+    if (x.Data4[i] != y.Data4[i])
+      return x.Data4[i] < y.Data4[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+constexpr bool DevPropKeyLess(const DevPropKeyName& x, const DevPropKeyName& y) {
+  int result = CompareGuid(x.fmtid, y.fmtid);
+  return result != 0 ? result < 0 : x.pid < y.pid;
+}
+
+// Stable insertion sort: for duplicated keys, the first entry of the header
+// wins, as with the linear search it replaces.
+template <size_t N>
+constexpr std::array<DevPropKeyName, N> Sorted(std::array<DevPropKeyName, N> entries) {
+  for (size_t i = 1; i < N; i++) {
+    DevPropKeyName entry = entries[i];
+    size_t j = i;
+    for (; j > 0 && DevPropKeyLess(entry, entries[j - 1]); j--)
+      entries[j] = entries[j - 1];
+    entries[j] = entry;
+  }
+  return entries;
+}
+
+constexpr auto kDevPropKeyNames = Sorted(std::array{
+#undef DEFINE_DEVPROPKEY
+#define DEFINE_DEVPROPKEY(name, uuid1, uuid2, uuid3, uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8, pid) \
+  DevPropKeyName{ { uuid1, uuid2, uuid3, { uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8 } }, pid, #name },
+#include "devpropkeys.h"
+#undef DEFINE_DEVPROPKEY
+});
+
+template <size_t N>
+constexpr size_t CountPropertySets(const std::array<DevPropKeyName, N>& names) {
+  size_t count = 0;
+  for (size_t i = 0; i < N; i++) {
+    if (i == 0 || CompareGuid(names[i - 1].fmtid, names[i].fmtid) != 0)
+      count++;
+  }
+  return count;
+}
+
+template <size_t kCount, size_t N>
+constexpr std::array<PropertySet, kCount> MakePropertySets(const std::array<DevPropKeyName, N>& names) {
+  std::array<PropertySet, kCount> sets = {};
+  size_t count = 0;
+  for (size_t i = 0; i < N; i++) {
+    if (i == 0 || CompareGuid(names[i - 1].fmtid, names[i].fmtid) != 0) {
+      if (count > 0)
+        sets[count - 1].end = i;
+      sets[count] = PropertySet{ names[i].fmtid, i, N };
+      count++;
+    }
+  }
+  return sets;
+}
+
+constexpr auto kPropertySets = MakePropertySets<CountPropertySets(kDevPropKeyNames)>(kDevPropKeyNames);
+
+char* WriteDecimal(char* out, ULONG value) {
+  char digits[10];
+  int count = 0;
+  do {
+    digits[count++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (count > 0)
+    *out++ = digits[--count];
+  return out;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+std::string_view FindDevPropKeyName(const DEVPROPKEY& key) {
+  const PropertySet* set = std::lower_bound(
+      kPropertySets.data(), kPropertySets.data() + kPropertySets.size(), key.fmtid,
+      [](const PropertySet& x, const GUID& fmtid) { return CompareGuid(x.fmtid, fmtid) < 0; });
+  if (set == kPropertySets.data() + kPropertySets.size() || CompareGuid(set->fmtid, key.fmtid) != 0)
+    return std::string_view();
+
+  const DevPropKeyName* begin = kDevPropKeyNames.data() + set->begin;
+  const DevPropKeyName* end = kDevPropKeyNames.data() + set->end;
+  const DevPropKeyName* it = std::lower_bound(begin, end, key.pid,
+      [](const DevPropKeyName& x, DEVPROPID pid) { return x.pid < pid; });
+  if (it == end || it->pid != key.pid)
+    return std::string_view();
+  return it->name;
+}
+
+size_t FormatDevPropKey(const DEVPROPKEY& key, char* buffer, size_t size) {
+  std::string_view name = FindDevPropKeyName(key);
+  if (!name.empty()) {
+    if (name.size() + 1 > size)
+      return 0;
+    memcpy(buffer, name.data(), name.size());
+    buffer[name.size()] = 0;
+    return name.size();
+  }
+
+  char text[kDevPropKeyStringSize];
+  char* out = text;
+  memcpy(out, "guid=", 5);
+  out = WriteGuid(key.fmtid, out + 5);
+  memcpy(out, ", pid=", 6);
+  out = WriteDecimal(out + 6, key.pid);
+
+  size_t length = out - text;
+  if (length + 1 > size)
+    return 0;
+  memcpy(buffer, text, length);
+  buffer[length] = 0;
+  return length;
+}
+
+}  // namespace btle
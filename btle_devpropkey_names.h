@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string_view>
+
+#ifdef _WIN32
+#include <setupapi.h>
+#endif
+#include "btle_platform.h"
+
+#include "base.h"
+
+// Names of the device property keys listed in devpropkeys.h.
+//
+// The keys are compiled into a constant table sorted by (fmtid, pid), with
+// an index of the distinct fmtids: a lookup is a binary search among the
+// property sets, then among the pids of the set. Lookups and formatting
+// never allocate.
+namespace btle {
+
+// Returns an empty view for unknown keys.
+std::string_view FindDevPropKeyName(const DEVPROPKEY& key);
+
+// Buffer size large enough for FormatDevPropKey with any key.
+const size_t kDevPropKeyStringSize = 64;
+
+// Writes the name of "key", or "guid=<fmtid>, pid=<pid>" for unknown keys,
+// null terminated. Returns the number of characters written, not counting
+// the null, or 0 if "size" is too small.
+size_t FormatDevPropKey(const DEVPROPKEY& key, char* buffer, size_t size);
+
+}  // namespace btle
@@ -0,0 +1,488 @@
+#include "stdafx.h"
+
+#include <iostream>
+#include <sstream>
+
+#include "btle_gatt.h"
+#include "btle_helpers.h"
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool TryGetDeviceServicePath(scoped_refptr<btle::Device> device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error) {
+  return btle::GetGattBackend()->FindServicePath(device->info(), service_uuid, path, error);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectCharacteristicDescriptorValueWorker(HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::Descriptor> descriptor, std::string* error) {
+  USHORT required_length;
+  HRESULT hr = btle::GetGattBackend()->GetDescriptorValue(
+      service_handle,
+      &descriptor->info(),
+      0,
+      NULL,
+      &required_length,
+      BLUETOOTH_GATT_FLAG_NONE);
+  if (NoDataResult(hr, required_length)) {
+    return true;
+  }
+
+  if (hr != HRESULT_FROM_WIN32(ERROR_MORE_DATA)) {
+    std::ostringstream string_stream;
+    string_stream << "Error getting descriptor value";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_struct<BTH_LE_GATT_DESCRIPTOR_VALUE> value(scoped_struct<BTH_LE_GATT_DESCRIPTOR_VALUE>::Allocate(required_length));
+  value.get()->DataSize = required_length;
+
+  ULONG actual_length = required_length;
+  hr = btle::GetGattBackend()->GetDescriptorValue(
+      service_handle,
+      &descriptor->info(),
+      actual_length,
+      value.get(),
+      &required_length,
+      BLUETOOTH_GATT_FLAG_NONE);
+  if (!CheckSuccessulHResult(hr, actual_length, required_length, "BluetoothGATTGetDescriptorValue", error))
+    return false;
+
+  scoped_refptr<btle::DescriptorValue> descriptor_value(new btle::DescriptorValue(value));
+  descriptor->set_value(descriptor_value);
+
+  if (descriptor_value->info().DescriptorType == CharacteristicFormat) {
+    // Values in a format we cannot decode are simply left undecoded.
+    btle::ValueFormat value_format;
+    std::string format_error;
+    if (btle::ValueFormat::Compile(descriptor_value->info().CharacteristicFormat.Format,
+                                   static_cast<CHAR>(descriptor_value->info().CharacteristicFormat.Exponent),
+                                   descriptor_value->info().CharacteristicFormat.Unit,
+                                   &value_format,
+                                   &format_error)) {
+      characteristic->set_value_format(value_format);
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectCharacteristicDescriptorValue(scoped_refptr<btle::Device> device, scoped_refptr<btle::Service> service, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::Descriptor> descriptor, std::string* error) {
+  std::wstring path;
+  if (!TryGetDeviceServicePath(device, service->info().ServiceUuid, &path, error))
+    return false;
+
+  if (path.empty())
+    return true;
+
+  HANDLE service_handle = btle::GetGattBackend()->OpenDevice(path, /*GENERIC_WRITE | */GENERIC_READ, 0);
+  if (service_handle == INVALID_HANDLE_VALUE) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error opening device '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_handle<HANDLE> handle(service_handle);
+  if (!CollectCharacteristicDescriptorValueWorker(service_handle, characteristic, descriptor, error)) {
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectCharacteristicDescriptors(HANDLE device_handle, scoped_refptr<btle::Device> device, scoped_refptr<btle::Service> service, scoped_refptr<btle::Characteristic> characteristic, const btle::OperationContext& context, std::string* error) {
+  USHORT required_count;
+  HRESULT hr = btle::GetGattBackend()->GetDescriptors(
+      device_handle,
+      &characteristic->info(),
+      0,
+      NULL,
+      &required_count,
+      BLUETOOTH_GATT_FLAG_NONE);
+  if (NoDataResult(hr, required_count)) {
+    return true;
+  }
+
+  if (hr != HRESULT_FROM_WIN32(ERROR_MORE_DATA)) {
+    std::ostringstream string_stream;
+    string_stream << "Error getting descriptors";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_array<BTH_LE_GATT_DESCRIPTOR> descriptors(new BTH_LE_GATT_DESCRIPTOR[required_count]);
+  USHORT actual_count = required_count;
+  hr = btle::GetGattBackend()->GetDescriptors(
+      device_handle,
+      &characteristic->info(),
+      actual_count,
+      descriptors.get(),
+      &required_count,
+      BLUETOOTH_GATT_FLAG_NONE);
+  if (!CheckSuccessulHResult(hr, actual_count, required_count, "BluetoothGATTGetDescriptors", error))
+    return false;
+
+  for(int i = 0; i < actual_count; i++) {
+    BTH_LE_GATT_DESCRIPTOR& descriptor(descriptors.get()[i]);
+    scoped_refptr<btle::Descriptor> descriptor_ptr(new btle::Descriptor(descriptor));
+    characteristic->descriptors().push_back(descriptor_ptr);
+    if (!context.Check(error))
+      return false;
+    if (!CollectCharacteristicDescriptorValue(device, service, characteristic, descriptor_ptr, error))
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool ReadServiceCharacteristicValue(HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::CharacteristicValue>* characteristic_value, std::string* error) {
+  ULONG flags = BLUETOOTH_GATT_FLAG_FORCE_READ_FROM_DEVICE;
+
+  USHORT required_length;
+  HRESULT hr = btle::GetGattBackend()->GetCharacteristicValue(
+      service_handle,
+      &characteristic->info(),
+      0,
+      NULL,
+      &required_length,
+      flags);
+  if (NoDataResult(hr, required_length)) {
+    return true;
+  }
+
+  if (hr != HRESULT_FROM_WIN32(ERROR_MORE_DATA)) {
+    std::ostringstream string_stream;
+    string_stream << "Error getting characteristic value";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_struct<BTH_LE_GATT_CHARACTERISTIC_VALUE> value(scoped_struct<BTH_LE_GATT_CHARACTERISTIC_VALUE>::Allocate(required_length));
+  value.get()->DataSize = required_length;
+
+  USHORT actual_length = required_length;
+  hr = btle::GetGattBackend()->GetCharacteristicValue(
+      service_handle,
+      &characteristic->info(),
+      actual_length,
+      value.get(),
+      &required_length,
+      flags);
+  if (!CheckSuccessulHResult(hr, actual_length, required_length, "BluetoothGATTGetCharacteristicValue", error))
+    return false;
+
+  (*characteristic_value) = scoped_refptr<btle::CharacteristicValue>(new btle::CharacteristicValue(value));
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectCharacteristicValueWorker(HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, std::string* error) {
+  USHORT required_length;
+  HRESULT hr = btle::GetGattBackend()->GetCharacteristicValue(
+      service_handle,
+      &characteristic->info(),
+      0,
+      NULL,
+      &required_length,
+      BLUETOOTH_GATT_FLAG_NONE);
+  if (NoDataResult(hr, required_length)) {
+    return true;
+  }
+
+  if (hr != HRESULT_FROM_WIN32(ERROR_MORE_DATA)) {
+    std::ostringstream string_stream;
+    string_stream << "Error getting characteristic value";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_struct<BTH_LE_GATT_CHARACTERISTIC_VALUE> value(scoped_struct<BTH_LE_GATT_CHARACTERISTIC_VALUE>::Allocate(required_length));
+  value.get()->DataSize = required_length;
+
+  USHORT actual_length = required_length;
+  hr = btle::GetGattBackend()->GetCharacteristicValue(
+      service_handle,
+      &characteristic->info(),
+      actual_length,
+      value.get(),
+      &required_length,
+      BLUETOOTH_GATT_FLAG_NONE);
+  if (!CheckSuccessulHResult(hr, actual_length, required_length, "BluetoothGATTGetCharacteristicValue", error))
+    return false;
+
+  scoped_refptr<btle::CharacteristicValue> characteristic_value(new btle::CharacteristicValue(value));
+  characteristic->set_value(characteristic_value);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool WriteServiceCharacteristicValueWorker(HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::CharacteristicValue> value, ULONG flags, std::string* error) {
+  //BTH_LE_GATT_RELIABLE_WRITE_CONTEXT context;
+  //HRESULT hr = BluetoothGATTBeginReliableWrite(
+  //    service_handle,
+  //    &context,
+  //    BLUETOOTH_GATT_FLAG_NONE);
+  //if (FAILED(hr)) {
+  //  std::ostringstream string_stream;
+  //  string_stream << "Error calling BluetoothGATTBeginReliableWrite: hr=" <<  hr;
+  //  *error = string_stream.str();
+  //  return false;
+  //}
+
+  HRESULT hr = btle::GetGattBackend()->SetCharacteristicValue(
+      service_handle,
+      &characteristic->info(),
+      &value->info(),
+      flags);
+  if (FAILED(hr)) {
+    std::ostringstream string_stream;
+    string_stream << "Error calling BluetoothGATTSetCharacteristicValue: hr=" <<  hr;
+    *error = string_stream.str();
+    return false;
+  }
+
+  //hr = BluetoothGATTEndReliableWrite(
+  //    service_handle,
+  //    context,
+  //    BLUETOOTH_GATT_FLAG_NONE);
+  //if (FAILED(hr)) {
+  //  std::ostringstream string_stream;
+  //  string_stream << "Error calling BluetoothGATTEndReliableWrite: hr=" <<  hr;
+  //  *error = string_stream.str();
+  //  return false;
+  //}
+  return true;
+}
+
+btle::WriteRateLimiter DeviceWriteRateLimiter(
+    btle::RateLimit(20.0/*writes per second*/, 10.0/*burst*/),
+    btle::RateLimit(10.0/*writes per second*/, 4.0/*burst*/));
+
+//////////////////////////////////////////////////////////////////////////////
+// Writes a characteristic value through "DeviceWriteRateLimiter". A value
+// still waiting for its turn is replaced by a later value written to the same
+// characteristic.
+//
+bool WriteServiceCharacteristicValue(scoped_refptr<btle::Device> device, HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::CharacteristicValue> value, ULONG flags, std::string* error) {
+  return DeviceWriteRateLimiter.Write(
+      device->info().address.ullLong,
+      characteristic->info().CharacteristicValueHandle,
+      value,
+      true/*coalesce*/,
+      btle::OperationContext(),
+      [=](scoped_refptr<btle::CharacteristicValue> latest_value, std::string* write_error) {
+        return WriteServiceCharacteristicValueWorker(service_handle, characteristic, latest_value, flags, write_error);
+      },
+      error);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool SubscribeToNotifications(HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, std::string* error) {
+  scoped_refptr<btle::Descriptor> descriptor;
+  for(std::vector<scoped_refptr<btle::Descriptor>>::const_iterator it = characteristic->descriptors().begin(); it != characteristic->descriptors().end(); ++it) {
+    if ((*it)->info().DescriptorType == ClientCharacteristicConfiguration) {
+      descriptor = *it;
+      break;
+    }
+  }
+
+  if (!descriptor) {
+    std::ostringstream string_stream;
+    string_stream << "Characteristic " << btle::CHARACTERISTIC_UUID_TO_STRING(characteristic->info().CharacteristicUuid) << " has no client configuration descriptor";
+    *error = string_stream.str();
+    return false;
+  }
+
+  BTH_LE_GATT_DESCRIPTOR_VALUE value;
+  RtlZeroMemory(&value, sizeof(value));
+  value.DescriptorType = ClientCharacteristicConfiguration;
+  value.ClientCharacteristicConfiguration.IsSubscribeToNotification = TRUE;
+
+  HRESULT hr = btle::GetGattBackend()->SetDescriptorValue(
+      service_handle,
+      &descriptor->info(),
+      &value,
+      BLUETOOTH_GATT_FLAG_NONE);
+  if (FAILED(hr)) {
+    std::ostringstream string_stream;
+    string_stream << "Error calling BluetoothGATTSetDescriptorValue: hr=" <<  hr;
+    *error = string_stream.str();
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool OpenDeviceService(scoped_refptr<btle::Device> device, const BTH_LE_UUID& service_uuid, bool read_write, scoped_handle<HANDLE>* handle, std::string* error) {
+  std::wstring path;
+  if (!TryGetDeviceServicePath(device, service_uuid, &path, error))
+    return false;
+
+  if (path.empty())
+    return true;
+
+  DWORD desired_access = (read_write ? GENERIC_WRITE | GENERIC_READ : GENERIC_READ);
+  HANDLE service_handle = btle::GetGattBackend()->OpenDevice(path, desired_access, FILE_SHARE_READ);
+  if (service_handle == INVALID_HANDLE_VALUE) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error opening device '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  (*handle).set(service_handle);
+  return true;
+}
+
+bool OpenDeviceService(scoped_refptr<btle::Device> device, const BTH_LE_UUID& service_uuid, bool read_write, scoped_refptr<SharedHandle>* handle, std::string* error) {
+  scoped_handle<HANDLE> service_handle;
+  if (!OpenDeviceService(device, service_uuid, read_write, &service_handle, error))
+    return false;
+
+  *handle = scoped_refptr<SharedHandle>(new SharedHandle(service_handle.Pass()));
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectCharacteristicValue(scoped_refptr<btle::Device> device, scoped_refptr<btle::Service> service, scoped_refptr<btle::Characteristic> characteristic, std::string* error) {
+  scoped_handle<HANDLE> service_handle;
+  if (!OpenDeviceService(device, service->info().ServiceUuid, false, &service_handle, error))
+    return false;
+
+  if (!CollectCharacteristicValueWorker(service_handle.get(), characteristic, error)) {
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectServiceCharacteristics(HANDLE device_handle, scoped_refptr<btle::Device> device, scoped_refptr<btle::Service> service, const btle::OperationContext& context, std::string* error) {
+  USHORT required_count;
+  HRESULT hr = btle::GetGattBackend()->GetCharacteristics(device_handle, &service->info(), 0, NULL, &required_count, BLUETOOTH_GATT_FLAG_NONE);
+  if (NoDataResult(hr, required_count)) {
+    return true;
+  }
+
+  if (hr != HRESULT_FROM_WIN32(ERROR_MORE_DATA)) {
+    std::ostringstream string_stream;
+    string_stream << "Error getting characteristics";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_array<BTH_LE_GATT_CHARACTERISTIC> gatt_characteristics(new BTH_LE_GATT_CHARACTERISTIC[required_count]);
+  USHORT actual_count = required_count;
+  hr = btle::GetGattBackend()->GetCharacteristics(device_handle, &service->info(), actual_count, gatt_characteristics.get(), &required_count, BLUETOOTH_GATT_FLAG_NONE);
+  if (!CheckSuccessulHResult(hr, actual_count, required_count, "BluetoothGATTGetCharacteristics", error))
+    return false;
+
+  for(int i = 0; i < actual_count; i++) {
+    BTH_LE_GATT_CHARACTERISTIC& gatt_characteristic(gatt_characteristics.get()[i]);
+    scoped_refptr<btle::Characteristic> characteristic(new btle::Characteristic(gatt_characteristic));
+    service->characteristics().push_back(characteristic);
+    if (!context.Check(error))
+      return false;
+    if (characteristic->info().IsReadable) {
+      if (!CollectCharacteristicValue(device, service, characteristic, error)) {
+        return false;
+      }
+    }
+
+    if (!CollectCharacteristicDescriptors(device_handle, device, service,  characteristic, context, error)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectDeviceService(HANDLE device_handle, scoped_refptr<btle::Device> device, scoped_refptr<btle::Service> service, const btle::OperationContext& context, std::string* error) {
+  if (!CollectServiceCharacteristics(device_handle, device, service, context, error)) {
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectDeviceServices(scoped_refptr<btle::Device> device, std::string* error) {
+  return CollectDeviceServices(device, btle::OperationContext(), error);
+}
+
+bool CollectDeviceServices(scoped_refptr<btle::Device> device, const btle::OperationContext& context, std::string* error) {
+  if (!context.Check(error))
+    return false;
+
+  std::wstring path = device->info().path;
+
+  HANDLE device_handle = btle::GetGattBackend()->OpenDevice(path, GENERIC_WRITE | GENERIC_READ, 0);
+  if (device_handle == INVALID_HANDLE_VALUE) {
+    DWORD last_error = GetLastError();
+    std::ostringstream string_stream;
+    string_stream << "Error opening device: " << last_error;
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_handle<HANDLE> handle(device_handle);
+  USHORT required_count;
+  HRESULT hr = btle::GetGattBackend()->GetServices(handle.get(), 0, NULL, &required_count, BLUETOOTH_GATT_FLAG_NONE);
+  if (NoDataResult(hr, required_count)) {
+    return true;
+  }
+
+  if (hr != HRESULT_FROM_WIN32(ERROR_MORE_DATA)) {
+    std::ostringstream string_stream;
+    string_stream << "Unexpected return value from BluetoothGATTGetServices: " << hr;
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_array<BTH_LE_GATT_SERVICE> services(new BTH_LE_GATT_SERVICE[required_count]);
+  USHORT actual_count = required_count;
+  hr = btle::GetGattBackend()->GetServices(handle.get(), actual_count, services.get(), &required_count, BLUETOOTH_GATT_FLAG_NONE);
+  if (!CheckSuccessulHResult(hr, actual_count, required_count, "BluetoothGATTGetServices", error))
+    return false;
+
+  for(int i = 0; i < actual_count; i++) {
+    BTH_LE_GATT_SERVICE& service(services.get()[i]);
+    scoped_refptr<btle::Service> service_ptr(new btle::Service(service));
+    device->services().push_back(service_ptr);
+
+    if (!context.Check(error))
+      return false;
+    if (!CollectDeviceService(handle.get(), device, service_ptr, context, error)) {
+      return false;
+    }
+  }
+
+  return true;
+}
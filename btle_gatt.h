@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+#include "base.h"
+#include "btle.h"
+#include "btle_cancellation.h"
+#include "btle_gatt_backend.h"
+#include "btle_rate_limiter.h"
+
+// Blocking GATT operations on top of the BluetoothGATT* APIs, called through
+// the current btle::GattBackend. Every function returns false and fills
+// "error" on failure.
+
+// Finds the device interface path of a GATT service of "device".
+bool TryGetDeviceServicePath(scoped_refptr<btle::Device> device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error);
+
+// Opens a handle to a GATT service of "device".
+bool OpenDeviceService(scoped_refptr<btle::Device> device, const BTH_LE_UUID& service_uuid, bool read_write, scoped_handle<HANDLE>* handle, std::string* error);
+// Same, for handles shared with asynchronous operations (see "btle_async.h").
+bool OpenDeviceService(scoped_refptr<btle::Device> device, const BTH_LE_UUID& service_uuid, bool read_write, scoped_refptr<SharedHandle>* handle, std::string* error);
+
+bool ReadServiceCharacteristicValue(HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::CharacteristicValue>* characteristic_value, std::string* error);
+
+// Writes a characteristic value right away, bypassing "DeviceWriteRateLimiter".
+bool WriteServiceCharacteristicValueWorker(HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::CharacteristicValue> value, ULONG flags, std::string* error);
+
+// Writes are throttled per device and per characteristic, so that bursts of
+// configuration writes don't overrun peripherals and drop the connection.
+extern btle::WriteRateLimiter DeviceWriteRateLimiter;
+
+// Writes a characteristic value through "DeviceWriteRateLimiter", blocking
+// the calling thread while throttled (see WriteServiceCharacteristicValueAsync
+// for executor threads).
+bool WriteServiceCharacteristicValue(scoped_refptr<btle::Device> device, HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::CharacteristicValue> value, ULONG flags, std::string* error);
+
+// Enables notifications by writing the Client Characteristic Configuration
+// descriptor of "characteristic".
+bool SubscribeToNotifications(HANDLE service_handle, scoped_refptr<btle::Characteristic> characteristic, std::string* error);
+
+// Reads the current value of a descriptor into "descriptor".
+bool CollectCharacteristicDescriptorValue(scoped_refptr<btle::Device> device, scoped_refptr<btle::Service> service, scoped_refptr<btle::Characteristic> characteristic, scoped_refptr<btle::Descriptor> descriptor, std::string* error);
+
+// Reads the current value of a characteristic into "characteristic".
+bool CollectCharacteristicValue(scoped_refptr<btle::Device> device, scoped_refptr<btle::Service> service, scoped_refptr<btle::Characteristic> characteristic, std::string* error);
+
+// Discovers services, characteristics and descriptors of "device", along with
+// the current value of readable attributes. With a context, discovery stops
+// between two GATT calls once the context expires or gets cancelled.
+bool CollectDeviceServices(scoped_refptr<btle::Device> device, std::string* error);
+bool CollectDeviceServices(scoped_refptr<btle::Device> device, const btle::OperationContext& context, std::string* error);
@@ -0,0 +1,33 @@
+#include "stdafx.h"
+
+#include "btle_gatt_backend.h"
+#include "btle_gatt_sim.h"
+#ifdef _WIN32
+#include "btle_gatt_win32.h"
+#endif
+
+namespace btle {
+
+namespace {
+
+#ifdef _WIN32
+Win32GattBackend DefaultBackend;
+#else
+SimulatedGattBackend DefaultBackend;
+#endif
+GattBackend* CurrentBackend = &DefaultBackend;
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+GattBackend* GetGattBackend() {
+  return CurrentBackend;
+}
+
+void SetGattBackend(GattBackend* backend) {
+  CurrentBackend = backend;
+}
+
+}  // namespace btle
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base.h"
+#include "btle.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// The calls the GATT layer makes to the system: enumerating devices,
+// looking up and opening service interfaces, and the BluetoothGATT*
+// functions, with the same parameters and results. All GATT code goes
+// through the current backend, so that the calls can be served by the
+// system (Win32GattBackend), recorded or served from a recording
+// (btle_gatt_trace.h), or simulated (SimulatedGattBackend).
+//
+// Handles returned by OpenDevice() are closed with CloseHandle().
+//
+class GattBackend {
+public:
+  virtual ~GattBackend() {}
+
+  // Appends the Bluetooth LE devices present to "devices".
+  virtual bool EnumerateDevices(std::vector<DeviceInfo>* devices, std::string* error) = 0;
+
+  // Finds the interface path of the GATT service "service_uuid" of
+  // "device". Sets "path" to "" if the device has no such service.
+  virtual bool FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error) = 0;
+
+  // Opens a device or service interface path, as CreateFile(): returns
+  // INVALID_HANDLE_VALUE and sets the last error on failure.
+  virtual HANDLE OpenDevice(const std::wstring& path, DWORD desired_access, DWORD share_mode) = 0;
+
+  virtual HRESULT GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG flags) = 0;
+  virtual HRESULT GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG flags) = 0;
+  virtual HRESULT GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG flags) = 0;
+  virtual HRESULT GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG flags) = 0;
+  virtual HRESULT GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG flags) = 0;
+  virtual HRESULT SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, ULONG flags) = 0;
+  virtual HRESULT SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE* value, ULONG flags) = 0;
+  virtual HRESULT RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_parameter,
+                                PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG flags) = 0;
+  virtual HRESULT UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG flags) = 0;
+};
+
+// The backend of all GATT calls: a Win32GattBackend by default on Windows,
+// and a SimulatedGattBackend without devices elsewhere. Must only be
+// changed before the first GATT call.
+GattBackend* GetGattBackend();
+void SetGattBackend(GattBackend* backend);
+
+}  // namespace btle
@@ -0,0 +1,733 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+#include "btle_address.h"
+#include "btle_characteristics_def.h"
+#include "btle_descriptors_def.h"
+#include "btle_gatt_sim.h"
+#include "btle_guid.h"
+#include "btle_services_def.h"
+
+namespace btle {
+
+namespace {
+
+std::wstring ToWide(const char* begin, const char* end) {
+  return std::wstring(begin, end);
+}
+
+std::wstring AddressDigits(const BLUETOOTH_ADDRESS& address) {
+  char buffer[BluetoothAddress::kStringSize];
+  return ToWide(buffer, BluetoothAddress(address).Write(buffer, true));
+}
+
+std::wstring GuidText(const Uuid& uuid) {
+  char buffer[kGuidStringSize];
+  return ToWide(buffer, WriteGuid(uuid.ToGuid(), buffer));
+}
+
+// Win32 value structures end with a variable length "Data" array, and are
+// never smaller than the structure itself.
+template<class T>
+USHORT ValueStructSize(size_t data_size) {
+  return static_cast<USHORT>(std::max(sizeof(T), offsetof(T, Data) + data_size));
+}
+
+HRESULT SimulatedFailure() {
+  return HRESULT_FROM_WIN32(ERROR_SEM_TIMEOUT);
+}
+
+void AppendLE16(std::vector<UINT8>* value, USHORT data) {
+  value->push_back(static_cast<UINT8>(data));
+  value->push_back(static_cast<UINT8>(data >> 8));
+}
+
+SimulatedDescriptor ClientConfiguration() {
+  SimulatedDescriptor descriptor;
+  descriptor.type = ClientCharacteristicConfiguration;
+  descriptor.uuid = Uuid(Client_Characteristic_Configuration);
+  descriptor.value.assign(2, 0);
+  return descriptor;
+}
+
+SimulatedCharacteristic DeviceNameCharacteristic(const std::string& name) {
+  SimulatedCharacteristic characteristic;
+  characteristic.uuid = Uuid(Device_Name);
+  characteristic.readable = true;
+  characteristic.value.assign(name.begin(), name.end());
+  return characteristic;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+SimulatedGattBackend::SimulatedGattBackend(UINT64 seed) : random_(seed), prune_size_(kMinPruneSize) {
+}
+
+SimulatedGattBackend::~SimulatedGattBackend() {
+  std::vector<Registration*> registrations;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::map<BLUETOOTH_GATT_EVENT_HANDLE, Registration*>::iterator it = registrations_.begin(); it != registrations_.end(); ++it)
+      registrations.push_back(it->second);
+    registrations_.clear();
+  }
+  for (std::vector<Registration*>::iterator it = registrations.begin(); it != registrations.end(); ++it) {
+    Stop(*it);
+    delete *it;
+  }
+  for (std::vector<Device*>::iterator it = devices_.begin(); it != devices_.end(); ++it)
+    delete *it;
+}
+
+void SimulatedGattBackend::AddDevice(const SimulatedDevice& config) {
+  size_t index = devices_.size();
+  Device* device = new Device();
+  device->config = config;
+  DeviceInfo& info = device->config.info;
+  std::wstring digits = AddressDigits(info.address);
+  std::wstring number = std::to_wstring(index);
+  if (info.path.empty()) {
+    info.path = L"\\\\?\\BTHLE#Dev_" + digits + L"#sim&" + number + L"#{" + GuidText(Uuid(GUID_BLUETOOTHLE_DEVICE_INTERFACE)) + L"}";
+  }
+  if (info.id.empty()) {
+    std::string address = BluetoothAddress(info.address).ToString();
+    info.id = "BTHLE\\DEV_" + address + "\\SIM&" + std::to_string(index) + "&" + address;
+  }
+
+  USHORT handle = 1;
+  const std::vector<SimulatedService>& services = device->config.services;
+  for (size_t s = 0; s < services.size(); s++) {
+    std::wstring service_guid = GuidText(services[s].uuid);
+    device->service_paths.push_back(L"\\\\?\\BTHLEDevice#{" + service_guid + L"}_Dev_SIM_" + digits +
+                                     L"#sim&" + number + L"&" + std::to_wstring(s) + L"#{" + service_guid + L"}");
+    device->service_handles.push_back(handle++);
+    device->characteristic_handles.push_back(std::vector<USHORT>());
+    device->descriptor_handles.push_back(std::vector<std::vector<USHORT>>());
+    const std::vector<SimulatedCharacteristic>& characteristics = services[s].characteristics;
+    for (size_t c = 0; c < characteristics.size(); c++) {
+      // Declaration, then value.
+      device->characteristic_handles[s].push_back(handle);
+      handle += 2;
+      device->descriptor_handles[s].push_back(std::vector<USHORT>());
+      for (size_t d = 0; d < characteristics[c].descriptors.size(); d++)
+        device->descriptor_handles[s][c].push_back(handle++);
+    }
+
+    Target target;
+    target.device = index;
+    target.service = static_cast<int>(s);
+    paths_[device->service_paths[s]] = target;
+  }
+
+  Target target;
+  target.device = index;
+  target.service = -1;
+  paths_[info.path] = target;
+  devices_.push_back(device);
+}
+
+void SimulatedGattBackend::SetTiming(SimulatedOperation operation, const SimulatedTiming& timing) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  timings_[operation] = timing;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool SimulatedGattBackend::EnumerateDevices(std::vector<DeviceInfo>* devices, std::string* error) {
+  if (Simulate(kSimulateEnumerate)) {
+    *error = "Error enumerating device: simulated failure";
+    return false;
+  }
+  for (std::vector<Device*>::const_iterator it = devices_.begin(); it != devices_.end(); ++it)
+    devices->push_back((*it)->config.info);
+  return true;
+}
+
+bool SimulatedGattBackend::FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error) {
+  if (Simulate(kSimulateDiscover)) {
+    *error = "Error enumerating service from GUID: simulated failure";
+    return false;
+  }
+
+  Uuid uuid(service_uuid);
+  path->clear();
+  for (std::vector<Device*>::const_iterator it = devices_.begin(); it != devices_.end(); ++it) {
+    if ((*it)->config.info.address.ullLong != device.address.ullLong)
+      continue;
+    const std::vector<SimulatedService>& services = (*it)->config.services;
+    for (size_t s = 0; s < services.size(); s++) {
+      if (services[s].uuid == uuid) {
+        *path = (*it)->service_paths[s];
+        return true;
+      }
+    }
+    *error = "Error enumerating service from GUID: service not found on device " + BluetoothAddress(device.address).ToString();
+    return false;
+  }
+  *error = "Error enumerating service from GUID: device " + BluetoothAddress(device.address).ToString() + " not found";
+  return false;
+}
+
+HANDLE SimulatedGattBackend::OpenDevice(const std::wstring& path, DWORD, DWORD) {
+  if (Simulate(kSimulateOpen)) {
+    SetLastError(ERROR_SEM_TIMEOUT);
+    return INVALID_HANDLE_VALUE;
+  }
+
+  std::map<std::wstring, Target>::const_iterator it = paths_.find(path);
+  if (it == paths_.end()) {
+    SetLastError(ERROR_DEVICE_NOT_CONNECTED);
+    return INVALID_HANDLE_VALUE;
+  }
+
+  HANDLE handle = CreateEvent(NULL, TRUE, FALSE, NULL);
+  if (handle == NULL)
+    return INVALID_HANDLE_VALUE;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (targets_.size() >= prune_size_)
+    PruneTargets();
+  targets_[handle] = it->second;
+  return handle;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+HRESULT SimulatedGattBackend::GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG) {
+  Target target;
+  if (!FindTarget(device_handle, &target))
+    return E_HANDLE;
+  if (Simulate(kSimulateDiscover))
+    return SimulatedFailure();
+
+  const Device& device = *devices_[target.device];
+  const std::vector<SimulatedService>& configs = device.config.services;
+  *required_count = static_cast<USHORT>(configs.size());
+  if (configs.empty())
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  if (services == NULL || count < configs.size())
+    return HRESULT_FROM_WIN32(ERROR_MORE_DATA);
+
+  for (size_t s = 0; s < configs.size(); s++) {
+    services[s].ServiceUuid = configs[s].uuid.ToBthLeUuid();
+    services[s].AttributeHandle = device.service_handles[s];
+  }
+  return S_OK;
+}
+
+HRESULT SimulatedGattBackend::GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG) {
+  Target target;
+  if (!FindTarget(device_handle, &target))
+    return E_HANDLE;
+  if (Simulate(kSimulateDiscover))
+    return SimulatedFailure();
+
+  const Device& device = *devices_[target.device];
+  std::vector<USHORT>::const_iterator found = std::find(device.service_handles.begin(), device.service_handles.end(), service->AttributeHandle);
+  if (found == device.service_handles.end())
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+  Attribute attribute;
+  attribute.service = static_cast<int>(found - device.service_handles.begin());
+  size_t size = device.config.services[attribute.service].characteristics.size();
+  *required_count = static_cast<USHORT>(size);
+  if (size == 0)
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  if (characteristics == NULL || count < size)
+    return HRESULT_FROM_WIN32(ERROR_MORE_DATA);
+
+  for (size_t c = 0; c < size; c++) {
+    attribute.characteristic = static_cast<int>(c);
+    FillCharacteristic(device, attribute, &characteristics[c]);
+  }
+  return S_OK;
+}
+
+HRESULT SimulatedGattBackend::GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG) {
+  Target target;
+  if (!FindTarget(device_handle, &target))
+    return E_HANDLE;
+  if (Simulate(kSimulateDiscover))
+    return SimulatedFailure();
+
+  Attribute attribute;
+  if (!FindCharacteristic(target, characteristic->AttributeHandle, &attribute))
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+  const Device& device = *devices_[target.device];
+  const std::vector<SimulatedDescriptor>& configs = device.config.services[attribute.service].characteristics[attribute.characteristic].descriptors;
+  *required_count = static_cast<USHORT>(configs.size());
+  if (configs.empty())
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  if (descriptors == NULL || count < configs.size())
+    return HRESULT_FROM_WIN32(ERROR_MORE_DATA);
+
+  for (size_t d = 0; d < configs.size(); d++) {
+    descriptors[d].ServiceHandle = device.service_handles[attribute.service];
+    descriptors[d].CharacteristicHandle = characteristic->AttributeHandle;
+    descriptors[d].DescriptorType = configs[d].type;
+    descriptors[d].DescriptorUuid = configs[d].uuid.ToBthLeUuid();
+    descriptors[d].AttributeHandle = device.descriptor_handles[attribute.service][attribute.characteristic][d];
+  }
+  return S_OK;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+HRESULT SimulatedGattBackend::GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG) {
+  Target target;
+  if (!FindTarget(service_handle, &target))
+    return E_HANDLE;
+  if (Simulate(kSimulateRead))
+    return SimulatedFailure();
+
+  Attribute attribute;
+  if (!FindCharacteristic(target, characteristic->AttributeHandle, &attribute))
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+  SimulatedCharacteristic& config = devices_[target.device]->config.services[attribute.service].characteristics[attribute.characteristic];
+  if (!config.readable)
+    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  *required_size = ValueStructSize<BTH_LE_GATT_CHARACTERISTIC_VALUE>(config.value.size());
+  if (value == NULL || size < *required_size)
+    return HRESULT_FROM_WIN32(ERROR_MORE_DATA);
+
+  value->DataSize = static_cast<ULONG>(config.value.size());
+  if (!config.value.empty())
+    memcpy(value->Data, config.value.data(), config.value.size());
+  return S_OK;
+}
+
+HRESULT SimulatedGattBackend::GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG) {
+  Target target;
+  if (!FindTarget(service_handle, &target))
+    return E_HANDLE;
+  if (Simulate(kSimulateRead))
+    return SimulatedFailure();
+
+  Attribute attribute;
+  int index;
+  if (!FindDescriptor(target, descriptor->AttributeHandle, &attribute, &index))
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+  const SimulatedDescriptor& config = devices_[target.device]->config.services[attribute.service].characteristics[attribute.characteristic].descriptors[index];
+  std::lock_guard<std::mutex> lock(mutex_);
+  *required_size = ValueStructSize<BTH_LE_GATT_DESCRIPTOR_VALUE>(config.value.size());
+  if (value == NULL || size < *required_size)
+    return HRESULT_FROM_WIN32(ERROR_MORE_DATA);
+
+  // The parsed form of the well known descriptors, as the system fills it.
+  const std::vector<UINT8>& data = config.value;
+  value->DescriptorType = config.type;
+  value->DescriptorUuid = config.uuid.ToBthLeUuid();
+  switch (config.type) {
+  case CharacteristicExtendedProperties:
+    value->CharacteristicExtendedProperties.IsReliableWriteEnabled = !data.empty() && (data[0] & 0x01) != 0;
+    value->CharacteristicExtendedProperties.IsAuxiliariesWritable = !data.empty() && (data[0] & 0x02) != 0;
+    break;
+  case ClientCharacteristicConfiguration:
+    value->ClientCharacteristicConfiguration.IsSubscribeToNotification = !data.empty() && (data[0] & 0x01) != 0;
+    value->ClientCharacteristicConfiguration.IsSubscribeToIndication = !data.empty() && (data[0] & 0x02) != 0;
+    break;
+  case ServerCharacteristicConfiguration:
+    value->ServerCharacteristicConfiguration.IsBroadcast = !data.empty() && (data[0] & 0x01) != 0;
+    break;
+  case CharacteristicFormat:
+    // Format, exponent, unit (LE16), namespace, description (LE16).
+    if (data.size() >= 7) {
+      value->CharacteristicFormat.Format = data[0];
+      value->CharacteristicFormat.Exponent = data[1];
+      value->CharacteristicFormat.Unit.IsShortUuid = TRUE;
+      value->CharacteristicFormat.Unit.Value.ShortUuid = static_cast<USHORT>(data[2] | (data[3] << 8));
+      value->CharacteristicFormat.NameSpace = data[4];
+      value->CharacteristicFormat.Description.IsShortUuid = TRUE;
+      value->CharacteristicFormat.Description.Value.ShortUuid = static_cast<USHORT>(data[5] | (data[6] << 8));
+    }
+    break;
+  default:
+    break;
+  }
+  value->DataSize = static_cast<ULONG>(data.size());
+  if (!data.empty())
+    memcpy(value->Data, data.data(), data.size());
+  return S_OK;
+}
+
+HRESULT SimulatedGattBackend::SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, ULONG flags) {
+  Target target;
+  if (!FindTarget(service_handle, &target))
+    return E_HANDLE;
+  if (Simulate(kSimulateWrite))
+    return SimulatedFailure();
+
+  Attribute attribute;
+  if (!FindCharacteristic(target, characteristic->AttributeHandle, &attribute))
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+  SimulatedCharacteristic& config = devices_[target.device]->config.services[attribute.service].characteristics[attribute.characteristic];
+  bool without_response = (flags & BLUETOOTH_GATT_FLAG_WRITE_WITHOUT_RESPONSE) != 0;
+  if (without_response ? !config.writable_without_response : !config.writable)
+    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  config.value.assign(value->Data, value->Data + value->DataSize);
+  return S_OK;
+}
+
+HRESULT SimulatedGattBackend::SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE* value, ULONG) {
+  Target target;
+  if (!FindTarget(service_handle, &target))
+    return E_HANDLE;
+  if (Simulate(kSimulateWrite))
+    return SimulatedFailure();
+
+  Attribute attribute;
+  int index;
+  if (!FindDescriptor(target, descriptor->AttributeHandle, &attribute, &index))
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+
+  SimulatedDescriptor& config = devices_[target.device]->config.services[attribute.service].characteristics[attribute.characteristic].descriptors[index];
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (config.type == ClientCharacteristicConfiguration) {
+    // Callers set the parsed form, not the data.
+    config.value.assign(2, 0);
+    config.value[0] = (value->ClientCharacteristicConfiguration.IsSubscribeToNotification ? 0x01 : 0) |
+                      (value->ClientCharacteristicConfiguration.IsSubscribeToIndication ? 0x02 : 0);
+  } else {
+    config.value.assign(value->Data, value->Data + value->DataSize);
+  }
+  return S_OK;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+HRESULT SimulatedGattBackend::RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_parameter,
+                                            PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                            BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG) {
+  Target target;
+  if (!FindTarget(service_handle, &target))
+    return E_HANDLE;
+  if (event_type != CharacteristicValueChangedEvent || event_parameter == NULL)
+    return E_INVALIDARG;
+  if (Simulate(kSimulateRegister))
+    return SimulatedFailure();
+
+  const BLUETOOTH_GATT_VALUE_CHANGED_EVENT_REGISTRATION* parameter =
+      reinterpret_cast<const BLUETOOTH_GATT_VALUE_CHANGED_EVENT_REGISTRATION*>(event_parameter);
+  std::vector<Attribute> characteristics;
+  for (USHORT i = 0; i < parameter->NumCharacteristics; i++) {
+    Attribute attribute;
+    if (!FindCharacteristic(target, parameter->Characteristics[i].AttributeHandle, &attribute))
+      return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+    const SimulatedCharacteristic& config = devices_[target.device]->config.services[attribute.service].characteristics[attribute.characteristic];
+    if (!config.notifiable && !config.indicatable)
+      return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+    characteristics.push_back(attribute);
+  }
+
+  Registration* registration = new Registration();
+  registration->callback = callback;
+  registration->context = context;
+  registration->device = target.device;
+  registration->characteristics = characteristics;
+  registration->stopped = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    registrations_[registration] = registration;
+  }
+  registration->thread = std::thread(&SimulatedGattBackend::Deliver, this, registration);
+  *event_handle = registration;
+  return S_OK;
+}
+
+HRESULT SimulatedGattBackend::UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG) {
+  Registration* registration = NULL;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<BLUETOOTH_GATT_EVENT_HANDLE, Registration*>::iterator it = registrations_.find(event_handle);
+    if (it == registrations_.end())
+      return E_INVALIDARG;
+    registration = it->second;
+    registrations_.erase(it);
+  }
+  Stop(registration);
+  delete registration;
+  return S_OK;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool SimulatedGattBackend::Simulate(SimulatedOperation operation) {
+  UINT64 delay_us;
+  bool failed;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const SimulatedTiming& timing = timings_[operation];
+    delay_us = timing.latency_us;
+    if (timing.jitter_us > 0)
+      delay_us += random_() % (timing.jitter_us + 1);
+    failed = timing.failure_rate > 0 &&
+        std::uniform_real_distribution<double>(0.0, 1.0)(random_) < timing.failure_rate;
+  }
+  if (delay_us > 0)
+    std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+  return failed;
+}
+
+void SimulatedGattBackend::PruneTargets() {
+  std::map<HANDLE, Target>::iterator it = targets_.begin();
+  while (it != targets_.end()) {
+    DWORD flags;
+    if (GetHandleInformation(it->first, &flags))
+      ++it;
+    else
+      it = targets_.erase(it);
+  }
+  // Prune again once the handles still open have doubled.
+  prune_size_ = 2 * targets_.size();
+  if (prune_size_ < kMinPruneSize)
+    prune_size_ = kMinPruneSize;
+}
+
+bool SimulatedGattBackend::FindTarget(HANDLE handle, Target* target) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<HANDLE, Target>::const_iterator it = targets_.find(handle);
+  if (it == targets_.end())
+    return false;
+  *target = it->second;
+  return true;
+}
+
+bool SimulatedGattBackend::FindCharacteristic(const Target& target, USHORT attribute_handle, Attribute* attribute) const {
+  const Device& device = *devices_[target.device];
+  for (size_t s = 0; s < device.characteristic_handles.size(); s++) {
+    if (target.service >= 0 && static_cast<size_t>(target.service) != s)
+      continue;
+    const std::vector<USHORT>& handles = device.characteristic_handles[s];
+    std::vector<USHORT>::const_iterator it = std::find(handles.begin(), handles.end(), attribute_handle);
+    if (it != handles.end()) {
+      attribute->service = static_cast<int>(s);
+      attribute->characteristic = static_cast<int>(it - handles.begin());
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SimulatedGattBackend::FindDescriptor(const Target& target, USHORT attribute_handle, Attribute* attribute, int* descriptor) const {
+  const Device& device = *devices_[target.device];
+  for (size_t s = 0; s < device.descriptor_handles.size(); s++) {
+    if (target.service >= 0 && static_cast<size_t>(target.service) != s)
+      continue;
+    for (size_t c = 0; c < device.descriptor_handles[s].size(); c++) {
+      const std::vector<USHORT>& handles = device.descriptor_handles[s][c];
+      std::vector<USHORT>::const_iterator it = std::find(handles.begin(), handles.end(), attribute_handle);
+      if (it != handles.end()) {
+        attribute->service = static_cast<int>(s);
+        attribute->characteristic = static_cast<int>(c);
+        *descriptor = static_cast<int>(it - handles.begin());
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void SimulatedGattBackend::FillCharacteristic(const Device& device, const Attribute& attribute, BTH_LE_GATT_CHARACTERISTIC* info) const {
+  const SimulatedCharacteristic& config = device.config.services[attribute.service].characteristics[attribute.characteristic];
+  RtlZeroMemory(info, sizeof(*info));
+  info->ServiceHandle = device.service_handles[attribute.service];
+  info->CharacteristicUuid = config.uuid.ToBthLeUuid();
+  info->AttributeHandle = device.characteristic_handles[attribute.service][attribute.characteristic];
+  info->CharacteristicValueHandle = info->AttributeHandle + 1;
+  info->IsReadable = config.readable;
+  info->IsWritable = config.writable;
+  info->IsWritableWithoutResponse = config.writable_without_response;
+  info->IsNotifiable = config.notifiable;
+  info->IsIndicatable = config.indicatable;
+  for (std::vector<SimulatedDescriptor>::const_iterator it = config.descriptors.begin(); it != config.descriptors.end(); ++it) {
+    if (it->type == CharacteristicExtendedProperties)
+      info->HasExtendedProperties = TRUE;
+  }
+}
+
+void SimulatedGattBackend::Deliver(Registration* registration) {
+  const Device& device = *devices_[registration->device];
+  size_t size = registration->characteristics.size();
+  UINT64 start_us = monotonic_microseconds();
+  std::vector<UINT64> counts(size, 0);
+  std::vector<UINT8> data;
+  std::vector<UINT8> buffer;
+  for (;;) {
+    // The characteristic with the earliest next notification.
+    size_t next = size;
+    UINT64 due_us = 0;
+    for (size_t i = 0; i < size; i++) {
+      const Attribute& attribute = registration->characteristics[i];
+      UINT64 interval_us = device.config.services[attribute.service].characteristics[attribute.characteristic].notify_interval_us;
+      if (interval_us == 0)
+        continue;
+      UINT64 time_us = start_us + (counts[i] + 1) * interval_us;
+      if (next == size || time_us < due_us) {
+        next = i;
+        due_us = time_us;
+      }
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(registration->mutex);
+      if (next == size) {
+        registration->stopped_changed.wait(lock, [registration] { return registration->stopped; });
+      } else {
+        UINT64 now_us = monotonic_microseconds();
+        if (due_us > now_us) {
+          registration->stopped_changed.wait_for(lock, std::chrono::microseconds(due_us - now_us),
+                                                 [registration] { return registration->stopped; });
+        }
+      }
+      if (registration->stopped)
+        return;
+    }
+
+    const Attribute& attribute = registration->characteristics[next];
+    const SimulatedCharacteristic& config = device.config.services[attribute.service].characteristics[attribute.characteristic];
+    if (config.generator) {
+      data.clear();
+      config.generator(counts[next], &data);
+    } else {
+      std::lock_guard<std::mutex> lock(mutex_);
+      data = config.value;
+    }
+    counts[next]++;
+
+    buffer.assign(ValueStructSize<BTH_LE_GATT_CHARACTERISTIC_VALUE>(data.size()), 0);
+    BTH_LE_GATT_CHARACTERISTIC_VALUE* value = reinterpret_cast<BTH_LE_GATT_CHARACTERISTIC_VALUE*>(buffer.data());
+    value->DataSize = static_cast<ULONG>(data.size());
+    if (!data.empty())
+      memcpy(value->Data, data.data(), data.size());
+
+    BLUETOOTH_GATT_VALUE_CHANGED_EVENT event;
+    event.ChangedAttributeHandle = device.characteristic_handles[attribute.service][attribute.characteristic] + 1;
+    event.CharacteristicValueDataSize = data.size();
+    event.CharacteristicValue = value;
+    registration->callback(CharacteristicValueChangedEvent, &event, registration->context);
+  }
+}
+
+void SimulatedGattBackend::Stop(Registration* registration) {
+  {
+    std::lock_guard<std::mutex> lock(registration->mutex);
+    registration->stopped = true;
+  }
+  registration->stopped_changed.notify_all();
+  if (registration->thread.joinable())
+    registration->thread.join();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+SimulatedDevice SimulatedHeartRateMonitor(int index) {
+  SimulatedDevice device;
+  device.info.address.ullLong = 0xC0FFEE000000ULL + index;
+  device.info.friendly_name = "Simulated HRM " + std::to_string(index);
+
+  SimulatedService access;
+  access.uuid = Uuid(Generic_Access);
+  access.characteristics.push_back(DeviceNameCharacteristic(device.info.friendly_name));
+  device.services.push_back(access);
+
+  SimulatedService heart_rate;
+  heart_rate.uuid = Uuid(Heart_Rate);
+  SimulatedCharacteristic measurement;
+  measurement.uuid = Uuid(Heart_Rate_Measurement);
+  measurement.notifiable = true;
+  measurement.descriptors.push_back(ClientConfiguration());
+  measurement.notify_interval_us = 1000000;
+  // Flags (8-bit rate, one RR interval), rate, RR interval in 1/1024 s.
+  measurement.generator = [index](UINT64 count, std::vector<UINT8>* value) {
+    UINT8 rate = static_cast<UINT8>(60 + (count * 7 + index * 3) % 40);
+    value->push_back(0x10);
+    value->push_back(rate);
+    AppendLE16(value, static_cast<USHORT>(60 * 1024 / rate));
+  };
+  heart_rate.characteristics.push_back(measurement);
+  SimulatedCharacteristic location;
+  location.uuid = Uuid(Body_Sensor_Location);
+  location.readable = true;
+  location.value.push_back(1);  // Chest
+  heart_rate.characteristics.push_back(location);
+  device.services.push_back(heart_rate);
+
+  SimulatedService battery;
+  battery.uuid = Uuid(Battery_Service);
+  SimulatedCharacteristic level;
+  level.uuid = Uuid(Battery_Level);
+  level.readable = true;
+  level.notifiable = true;
+  level.value.push_back(static_cast<UINT8>(100 - index % 50));
+  level.descriptors.push_back(ClientConfiguration());
+  // uint8, exponent 0, percentage, Bluetooth SIG namespace, no description.
+  SimulatedDescriptor format;
+  format.type = CharacteristicFormat;
+  format.uuid = Uuid(Characteristic_Presentation_Format);
+  format.value.push_back(0x04);
+  format.value.push_back(0x00);
+  AppendLE16(&format.value, 0x27AD);
+  format.value.push_back(0x01);
+  AppendLE16(&format.value, 0x0000);
+  level.descriptors.push_back(format);
+  battery.characteristics.push_back(level);
+  device.services.push_back(battery);
+  return device;
+}
+
+SimulatedDevice SimulatedSensorTag(int index) {
+  SimulatedDevice device;
+  device.info.address.ullLong = 0xBC6A29000000ULL + index;
+  device.info.friendly_name = "TI BLE Sensor Tag";
+
+  SimulatedService access;
+  access.uuid = Uuid(Generic_Access);
+  access.characteristics.push_back(DeviceNameCharacteristic(device.info.friendly_name));
+  device.services.push_back(access);
+
+  SimulatedService temperature;
+  temperature.uuid = Uuid(IR_Temperature_Service);
+  SimulatedCharacteristic data;
+  data.uuid = Uuid(IR_Temperature_Data);
+  data.readable = true;
+  data.notifiable = true;
+  data.value.assign(4, 0);
+  data.descriptors.push_back(ClientConfiguration());
+  data.notify_interval_us = 1000000;
+  // Raw object voltage and ambient temperature in 1/128 degrees, around
+  // 25 degrees.
+  data.generator = [index](UINT64 count, std::vector<UINT8>* value) {
+    AppendLE16(value, static_cast<USHORT>(0xFF00 + (count + index) % 64));
+    AppendLE16(value, static_cast<USHORT>((25 * 128) + ((count * 5 + index) % 128)));
+  };
+  temperature.characteristics.push_back(data);
+  SimulatedCharacteristic config;
+  config.uuid = Uuid(IR_Temperature_Config);
+  config.readable = true;
+  config.writable = true;
+  config.value.push_back(0);
+  temperature.characteristics.push_back(config);
+  device.services.push_back(temperature);
+  return device;
+}
+
+}  // namespace btle
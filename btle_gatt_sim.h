@@ -0,0 +1,203 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base.h"
+#include "btle.h"
+#include "btle_gatt_backend.h"
+#include "btle_uuid.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Configuration of simulated peripherals: devices, their attribute tables
+// and the values of their attributes.
+//
+struct SimulatedDescriptor {
+  BTH_LE_GATT_DESCRIPTOR_TYPE type;
+  Uuid uuid;
+  std::vector<UINT8> value;
+};
+
+struct SimulatedCharacteristic {
+  SimulatedCharacteristic()
+    : readable(false), writable(false), writable_without_response(false),
+      notifiable(false), indicatable(false), notify_interval_us(0) {
+  }
+
+  Uuid uuid;
+  bool readable;
+  bool writable;
+  bool writable_without_response;
+  bool notifiable;
+  bool indicatable;
+  // Value returned by reads, replaced by writes.
+  std::vector<UINT8> value;
+  std::vector<SimulatedDescriptor> descriptors;
+  // Interval of the notifications of a registration, 0 for none.
+  UINT64 notify_interval_us;
+  // If set, computes the value of the "count"-th notification (from 0);
+  // the notifications repeat "value" otherwise.
+  std::function<void(UINT64 count, std::vector<UINT8>* value)> generator;
+};
+
+struct SimulatedService {
+  Uuid uuid;
+  std::vector<SimulatedCharacteristic> characteristics;
+};
+
+struct SimulatedDevice {
+  // The path and id are generated by AddDevice() when empty.
+  DeviceInfo info;
+  std::vector<SimulatedService> services;
+};
+
+// Operations with their own timing.
+enum SimulatedOperation {
+  kSimulateEnumerate,
+  kSimulateOpen,
+  kSimulateDiscover,
+  kSimulateRead,
+  kSimulateWrite,
+  kSimulateRegister,
+  kSimulatedOperationCount,
+};
+
+struct SimulatedTiming {
+  SimulatedTiming() : latency_us(0), jitter_us(0), failure_rate(0) {
+  }
+
+  // Each call takes "latency_us" plus a uniform random delay of up to
+  // "jitter_us", and fails with probability "failure_rate" (0 to 1).
+  UINT64 latency_us;
+  UINT64 jitter_us;
+  double failure_rate;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Backend serving the calls from simulated devices held in memory, with the
+// results, buffer size semantics and errors of the BluetoothGATT* APIs, so
+// that the GATT code runs and can be measured without devices, and on any
+// platform.
+//
+// Attribute handles are numbered in the order of the attribute table of
+// each device. Interface paths follow the Windows formats, so that the
+// addresses are parsed back from them. Opened handles are event handles,
+// closed with CloseHandle().
+//
+// Failures are reported as timeouts (ERROR_SEM_TIMEOUT), opens of devices
+// that aren't present as ERROR_DEVICE_NOT_CONNECTED, and services a device
+// doesn't have as FindServicePath() errors. Random delays
+// and failures are drawn from a generator seeded with "seed", so that runs
+// repeat. As with the BluetoothGATT* APIs, a callback must not unregister
+// its own event.
+//
+class SimulatedGattBackend : public GattBackend {
+public:
+  explicit SimulatedGattBackend(UINT64 seed = 0);
+  // Stops the notifications still registered.
+  virtual ~SimulatedGattBackend();
+
+  // Adds a device. Must be called before the first GATT call.
+  void AddDevice(const SimulatedDevice& device);
+  void SetTiming(SimulatedOperation operation, const SimulatedTiming& timing);
+
+  size_t device_count() const { return devices_.size(); }
+
+  virtual bool EnumerateDevices(std::vector<DeviceInfo>* devices, std::string* error);
+  virtual bool FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error);
+  virtual HANDLE OpenDevice(const std::wstring& path, DWORD desired_access, DWORD share_mode);
+  virtual HRESULT GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG flags);
+  virtual HRESULT GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG flags);
+  virtual HRESULT SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, ULONG flags);
+  virtual HRESULT SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE* value, ULONG flags);
+  virtual HRESULT RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_parameter,
+                                PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG flags);
+  virtual HRESULT UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG flags);
+
+private:
+  static const size_t kMinPruneSize = 64;
+
+  // A device with the attribute handles of its table.
+  struct Device {
+    SimulatedDevice config;
+    std::vector<std::wstring> service_paths;
+    std::vector<USHORT> service_handles;
+    // Indexed by service then characteristic.
+    std::vector<std::vector<USHORT>> characteristic_handles;
+    std::vector<std::vector<std::vector<USHORT>>> descriptor_handles;
+  };
+
+  // What an opened handle refers to: a device, or one of its services.
+  struct Target {
+    size_t device;
+    // -1 for the device itself.
+    int service;
+  };
+
+  // A characteristic of a device.
+  struct Attribute {
+    int service;
+    int characteristic;
+  };
+
+  // Delivers the notifications of a registration.
+  struct Registration {
+    PFNBLUETOOTH_GATT_EVENT_CALLBACK callback;
+    PVOID context;
+    size_t device;
+    std::vector<Attribute> characteristics;
+    std::mutex mutex;
+    std::condition_variable stopped_changed;
+    bool stopped;
+    std::thread thread;
+  };
+
+  // Waits for the timing of "operation" and returns true if the call
+  // fails.
+  bool Simulate(SimulatedOperation operation);
+  // Forgets the targets of the handles closed since, with "mutex_" held.
+  void PruneTargets();
+  bool FindTarget(HANDLE handle, Target* target);
+  // Find a characteristic or descriptor of "target" by attribute handle:
+  // any of the device, or of the service the target is.
+  bool FindCharacteristic(const Target& target, USHORT attribute_handle, Attribute* attribute) const;
+  bool FindDescriptor(const Target& target, USHORT attribute_handle, Attribute* attribute, int* descriptor) const;
+  void FillCharacteristic(const Device& device, const Attribute& attribute, BTH_LE_GATT_CHARACTERISTIC* info) const;
+  void Deliver(Registration* registration);
+  void Stop(Registration* registration);
+
+  std::vector<Device*> devices_;
+  // Device and service interface paths.
+  std::map<std::wstring, Target> paths_;
+  SimulatedTiming timings_[kSimulatedOperationCount];
+  std::mutex mutex_;
+  std::mt19937_64 random_;
+  std::map<HANDLE, Target> targets_;
+  // Size of "targets_" at which OpenDevice() prunes it.
+  size_t prune_size_;
+  std::map<BLUETOOTH_GATT_EVENT_HANDLE, Registration*> registrations_;
+
+  SimulatedGattBackend(const SimulatedGattBackend& other);
+  const SimulatedGattBackend& operator=(const SimulatedGattBackend& other);
+};
+
+// Presets: the "index"-th simulated heart rate monitor (Generic Access,
+// Heart Rate with notifications every second, Battery Service), and the
+// "index"-th simulated SensorTag (Generic Access and the IR temperature
+// service, with notifications every second).
+SimulatedDevice SimulatedHeartRateMonitor(int index);
+SimulatedDevice SimulatedSensorTag(int index);
+
+}  // namespace btle
@@ -0,0 +1,63 @@
+#include "stdafx.h"
+
+#include <string>
+#include <vector>
+
+#include "btle_gatt_sim.h"
+#include "btle_services_def.h"
+#include "btle_test.h"
+
+namespace {
+
+BTH_LE_UUID ServiceUuid(USHORT uuid) {
+  return btle::Uuid(uuid).ToBthLeUuid();
+}
+
+}  // namespace
+
+BTLE_TEST(gatt_sim, FindServicePath) {
+  btle::SimulatedGattBackend backend;
+  backend.AddDevice(btle::SimulatedHeartRateMonitor(0));
+  std::vector<btle::DeviceInfo> devices;
+  std::string error;
+  BTLE_EXPECT(backend.EnumerateDevices(&devices, &error));
+  BTLE_EXPECT_EQ(1u, devices.size());
+
+  std::wstring path;
+  BTLE_EXPECT(backend.FindServicePath(devices[0], ServiceUuid(btle::Heart_Rate), &path, &error));
+  BTLE_EXPECT(!path.empty());
+
+  // A service the device doesn't have.
+  BTLE_EXPECT(!backend.FindServicePath(devices[0], ServiceUuid(btle::Glucose), &path, &error));
+  BTLE_EXPECT(path.empty());
+  BTLE_EXPECT(!error.empty());
+
+  // A device the backend doesn't have.
+  btle::DeviceInfo unknown = devices[0];
+  unknown.address.ullLong++;
+  error.clear();
+  BTLE_EXPECT(!backend.FindServicePath(unknown, ServiceUuid(btle::Heart_Rate), &path, &error));
+  BTLE_EXPECT(!error.empty());
+}
+
+// Handles opened and closed repeatedly are forgotten, and the ones still
+// open keep working.
+BTLE_TEST(gatt_sim, OpenAndClose) {
+  btle::SimulatedGattBackend backend;
+  backend.AddDevice(btle::SimulatedHeartRateMonitor(0));
+  std::vector<btle::DeviceInfo> devices;
+  std::string error;
+  BTLE_EXPECT(backend.EnumerateDevices(&devices, &error));
+
+  scoped_handle<HANDLE> kept(backend.OpenDevice(devices[0].path, GENERIC_READ, 0));
+  BTLE_EXPECT(kept.get() != INVALID_HANDLE_VALUE);
+  for (int i = 0; i < 1000; i++) {
+    HANDLE handle = backend.OpenDevice(devices[0].path, GENERIC_READ, 0);
+    BTLE_EXPECT(handle != INVALID_HANDLE_VALUE);
+    CloseHandle(handle);
+  }
+
+  USHORT count = 0;
+  BTLE_EXPECT(backend.GetServices(kept.get(), 0, NULL, &count, BLUETOOTH_GATT_FLAG_NONE) == HRESULT_FROM_WIN32(ERROR_MORE_DATA));
+  BTLE_EXPECT(count > 0);
+}
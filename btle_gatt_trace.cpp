@@ -0,0 +1,642 @@
+#include "stdafx.h"
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "btle_address.h"
+#include "btle_gatt_trace.h"
+#include "btle_guid.h"
+
+namespace btle {
+
+namespace {
+
+const char kTraceMagic[8] = { 'B', 'T', 'L', 'E', 'T', 'R', 'C', '1' };
+
+// Records are written once this much is buffered.
+const size_t kBufferSize = 64 * 1024;
+
+struct RecordHeader {
+  UINT16 operation;
+  UINT16 key_size;
+  INT32 result;
+  UINT32 required;
+  UINT32 data_size;
+  UINT64 start_us;
+  UINT64 duration_us;
+};
+
+static_assert(sizeof(RecordHeader) == 32, "RecordHeader must be packed");
+
+void AppendBytes(std::vector<UINT8>* buffer, const void* data, size_t size) {
+  const UINT8* bytes = static_cast<const UINT8*>(data);
+  buffer->insert(buffer->end(), bytes, bytes + size);
+}
+
+void AppendString(std::vector<UINT8>* buffer, const std::string& value) {
+  UINT16 size = static_cast<UINT16>(std::min<size_t>(value.size(), 0xffff));
+  AppendBytes(buffer, &size, sizeof(size));
+  AppendBytes(buffer, value.data(), size);
+}
+
+bool ReadString(const std::vector<UINT8>& buffer, size_t* position, std::string* value) {
+  UINT16 size;
+  if (buffer.size() - *position < sizeof(size))
+    return false;
+  memcpy(&size, &buffer[*position], sizeof(size));
+  *position += sizeof(size);
+  if (buffer.size() - *position < size)
+    return false;
+  value->assign(reinterpret_cast<const char*>(buffer.data()) + *position, size);
+  *position += size;
+  return true;
+}
+
+std::string AttributeKey(const std::string& handle_key, char kind, USHORT attribute_handle) {
+  std::ostringstream string_stream;
+  string_stream << handle_key << "/" << kind << attribute_handle;
+  return string_stream.str();
+}
+
+std::string ServicePathKey(const DeviceInfo& device, const BTH_LE_UUID& service_uuid) {
+  char key[BluetoothAddress::kDigits + 1 + kGuidStringSize];
+  char* out = BluetoothAddress(device.address).Write(key, true);
+  *out++ = '/';
+  out = WriteGuid(Uuid(service_uuid).ToGuid(), out);
+  return std::string(key, out);
+}
+
+// Bytes of the output of a call, only valid if it succeeded.
+size_t OutputSize(HRESULT hr, const void* output, size_t capacity, size_t required) {
+  if (FAILED(hr) || output == NULL)
+    return 0;
+  return std::min(capacity, required);
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+GattTraceRecorder::GattTraceRecorder(GattBackend* backend)
+  : backend_(backend),
+    start_us_(0),
+    registration_count_(0) {
+}
+
+GattTraceRecorder::~GattTraceRecorder() {
+  std::string error;
+  Close(&error);
+}
+
+bool GattTraceRecorder::Open(const std::wstring& path, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  HANDLE file_handle = CreateFile(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error creating trace file '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+  file_.set(file_handle);
+  path_ = path;
+  start_us_ = monotonic_microseconds();
+  buffer_.clear();
+  AppendBytes(&buffer_, kTraceMagic, sizeof(kTraceMagic));
+  error_.clear();
+  return true;
+}
+
+bool GattTraceRecorder::Close(std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_.get() == INVALID_HANDLE_VALUE)
+    return true;
+  WriteBuffer(&error_);
+  file_.set(INVALID_HANDLE_VALUE);
+  if (!error_.empty()) {
+    *error = error_;
+    return false;
+  }
+  return true;
+}
+
+bool GattTraceRecorder::EnumerateDevices(std::vector<DeviceInfo>* devices, std::string* error) {
+  UINT64 now = monotonic_microseconds();
+  size_t first = devices->size();
+  if (!backend_->EnumerateDevices(devices, error))
+    return false;
+
+  for (std::vector<DeviceInfo>::const_iterator it = devices->begin() + first; it != devices->end(); ++it) {
+    std::vector<UINT8> data;
+    AppendBytes(&data, &it->address.ullLong, sizeof(it->address.ullLong));
+    AppendString(&data, to_std_string(it->path));
+    AppendString(&data, it->id);
+    AppendString(&data, it->friendly_name);
+    Record(kTraceDevice, S_OK, 0, now, std::string(), data.data(), data.size());
+  }
+  return true;
+}
+
+bool GattTraceRecorder::FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error) {
+  UINT64 start = monotonic_microseconds();
+  bool success = backend_->FindServicePath(device, service_uuid, path, error);
+  std::string data = success ? to_std_string(*path) : *error;
+  Record(kTraceFindServicePath, success ? S_OK : E_FAIL, 0, start, ServicePathKey(device, service_uuid), data.data(), data.size());
+  return success;
+}
+
+HANDLE GattTraceRecorder::OpenDevice(const std::wstring& path, DWORD desired_access, DWORD share_mode) {
+  UINT64 start = monotonic_microseconds();
+  HANDLE handle = backend_->OpenDevice(path, desired_access, share_mode);
+  DWORD last_error = GetLastError();
+  std::string key = to_std_string(path);
+  Record(kTraceOpenDevice, handle == INVALID_HANDLE_VALUE ? HRESULT_FROM_WIN32(last_error) : S_OK, 0, start, key, NULL, 0);
+  if (handle != INVALID_HANDLE_VALUE) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    paths_[handle] = key;
+  }
+  SetLastError(last_error);
+  return handle;
+}
+
+HRESULT GattTraceRecorder::GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG flags) {
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->GetServices(device_handle, count, services, required_count, flags);
+  size_t size = OutputSize(hr, services, count, *required_count) * sizeof(*services);
+  Record(kTraceGetServices, hr, *required_count, start, HandleKey(device_handle), services, size);
+  return hr;
+}
+
+HRESULT GattTraceRecorder::GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG flags) {
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->GetCharacteristics(device_handle, service, count, characteristics, required_count, flags);
+  size_t size = OutputSize(hr, characteristics, count, *required_count) * sizeof(*characteristics);
+  Record(kTraceGetCharacteristics, hr, *required_count, start,
+         AttributeKey(HandleKey(device_handle), 's', service->AttributeHandle), characteristics, size);
+  return hr;
+}
+
+HRESULT GattTraceRecorder::GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG flags) {
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->GetDescriptors(device_handle, characteristic, count, descriptors, required_count, flags);
+  size_t size = OutputSize(hr, descriptors, count, *required_count) * sizeof(*descriptors);
+  Record(kTraceGetDescriptors, hr, *required_count, start,
+         AttributeKey(HandleKey(device_handle), 'c', characteristic->AttributeHandle), descriptors, size);
+  return hr;
+}
+
+HRESULT GattTraceRecorder::GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG flags) {
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->GetCharacteristicValue(service_handle, characteristic, size, value, required_size, flags);
+  Record(kTraceGetCharacteristicValue, hr, *required_size, start,
+         AttributeKey(HandleKey(service_handle), 'c', characteristic->AttributeHandle), value, OutputSize(hr, value, size, *required_size));
+  return hr;
+}
+
+HRESULT GattTraceRecorder::GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG flags) {
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->GetDescriptorValue(service_handle, descriptor, size, value, required_size, flags);
+  Record(kTraceGetDescriptorValue, hr, *required_size, start,
+         AttributeKey(HandleKey(service_handle), 'd', descriptor->AttributeHandle), value, OutputSize(hr, value, size, *required_size));
+  return hr;
+}
+
+HRESULT GattTraceRecorder::SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, ULONG flags) {
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->SetCharacteristicValue(service_handle, characteristic, value, flags);
+  // The written bytes, for inspection.
+  Record(kTraceSetCharacteristicValue, hr, 0, start,
+         AttributeKey(HandleKey(service_handle), 'c', characteristic->AttributeHandle), value->Data, value->DataSize);
+  return hr;
+}
+
+HRESULT GattTraceRecorder::SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE* value, ULONG flags) {
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->SetDescriptorValue(service_handle, descriptor, value, flags);
+  Record(kTraceSetDescriptorValue, hr, 0, start,
+         AttributeKey(HandleKey(service_handle), 'd', descriptor->AttributeHandle), value, sizeof(*value));
+  return hr;
+}
+
+HRESULT GattTraceRecorder::RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_parameter,
+                                         PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                         BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG flags) {
+  Registration* registration = new Registration();
+  registration->recorder = this;
+  registration->callback = callback;
+  registration->context = context;
+  registration->key = HandleKey(service_handle);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    registration->number = registration_count_++;
+  }
+
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->RegisterEvent(service_handle, event_type, event_parameter, &GattTraceRecorder::OnEvent, registration, event_handle, flags);
+  Record(kTraceRegisterEvent, hr, registration->number, start, registration->key, NULL, 0);
+  if (FAILED(hr)) {
+    delete registration;
+    return hr;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  registrations_[*event_handle] = registration;
+  return hr;
+}
+
+HRESULT GattTraceRecorder::UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG flags) {
+  UINT64 start = monotonic_microseconds();
+  HRESULT hr = backend_->UnregisterEvent(event_handle, flags);
+
+  // No callback runs once the registration is gone.
+  Registration* registration = NULL;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<BLUETOOTH_GATT_EVENT_HANDLE, Registration*>::iterator it = registrations_.find(event_handle);
+    if (it != registrations_.end()) {
+      registration = it->second;
+      registrations_.erase(it);
+    }
+  }
+  if (registration != NULL) {
+    Record(kTraceUnregisterEvent, hr, registration->number, start, registration->key, NULL, 0);
+    delete registration;
+  }
+  return hr;
+}
+
+VOID CALLBACK GattTraceRecorder::OnEvent(BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_out_parameter, PVOID context) {
+  Registration* registration = reinterpret_cast<Registration*>(context);
+  if (event_type == CharacteristicValueChangedEvent) {
+    BLUETOOTH_GATT_VALUE_CHANGED_EVENT* event = reinterpret_cast<BLUETOOTH_GATT_VALUE_CHANGED_EVENT*>(event_out_parameter);
+    std::vector<UINT8> data;
+    AppendBytes(&data, &event->ChangedAttributeHandle, sizeof(event->ChangedAttributeHandle));
+    AppendBytes(&data, event->CharacteristicValue->Data, event->CharacteristicValue->DataSize);
+    registration->recorder->Record(kTraceNotification, S_OK, registration->number, monotonic_microseconds(),
+                                   registration->key, data.data(), data.size());
+  }
+  registration->callback(event_type, event_out_parameter, registration->context);
+}
+
+std::string GattTraceRecorder::HandleKey(HANDLE handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<HANDLE, std::string>::const_iterator it = paths_.find(handle);
+  return it == paths_.end() ? std::string() : it->second;
+}
+
+void GattTraceRecorder::Record(GattTraceOperation operation, HRESULT result, UINT32 required, UINT64 start_us,
+                               const std::string& key, const void* data, size_t size) {
+  UINT64 end_us = monotonic_microseconds();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (file_.get() == INVALID_HANDLE_VALUE)
+    return;
+
+  RecordHeader header;
+  header.operation = static_cast<UINT16>(operation);
+  header.key_size = static_cast<UINT16>(std::min<size_t>(key.size(), 0xffff));
+  header.result = result;
+  header.required = required;
+  header.data_size = static_cast<UINT32>(size);
+  header.start_us = start_us - start_us_;
+  header.duration_us = end_us - start_us;
+  AppendBytes(&buffer_, &header, sizeof(header));
+  AppendBytes(&buffer_, key.data(), header.key_size);
+  AppendBytes(&buffer_, data, size);
+  if (buffer_.size() >= kBufferSize && error_.empty())
+    WriteBuffer(&error_);
+}
+
+bool GattTraceRecorder::WriteBuffer(std::string* error) {
+  if (buffer_.empty())
+    return true;
+  DWORD written = 0;
+  BOOL success = WriteFile(file_.get(), buffer_.data(), static_cast<DWORD>(buffer_.size()), &written, NULL);
+  buffer_.clear();
+  if (!success) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error writing trace file '" << to_std_string(path_) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+GattTraceReplayer::GattTraceReplayer(double speed) : speed_(speed) {
+}
+
+GattTraceReplayer::~GattTraceReplayer() {
+  for (std::map<BLUETOOTH_GATT_EVENT_HANDLE, Registration*>::iterator it = registrations_.begin(); it != registrations_.end(); ++it) {
+    Stop(it->second);
+    delete it->second;
+  }
+}
+
+bool GattTraceReplayer::Load(const std::wstring& path, std::string* error) {
+  HANDLE file_handle = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error opening trace file '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_handle<HANDLE> handle(file_handle);
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(handle.get(), &file_size)) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error getting size of trace file '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  std::vector<UINT8> data(static_cast<size_t>(file_size.QuadPart));
+  DWORD actual_size = 0;
+  if (!data.empty() &&
+      (!ReadFile(handle.get(), data.data(), static_cast<DWORD>(data.size()), &actual_size, NULL) || actual_size != data.size())) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error reading trace file '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  if (data.size() < sizeof(kTraceMagic) || memcmp(data.data(), kTraceMagic, sizeof(kTraceMagic)) != 0) {
+    *error = "Invalid trace file '" + to_std_string(path) + "'.";
+    return false;
+  }
+
+  // A trace cut short by a crash is replayed up to its last full record.
+  records_.clear();
+  for (size_t position = sizeof(kTraceMagic); data.size() - position >= sizeof(RecordHeader); ) {
+    RecordHeader header;
+    memcpy(&header, &data[position], sizeof(header));
+    if (data.size() - position - sizeof(header) < static_cast<size_t>(header.key_size) + header.data_size)
+      break;
+    position += sizeof(header);
+
+    GattTraceRecord record;
+    record.operation = static_cast<GattTraceOperation>(header.operation);
+    record.result = header.result;
+    record.required = header.required;
+    record.start_us = header.start_us;
+    record.duration_us = header.duration_us;
+    record.key.assign(reinterpret_cast<const char*>(&data[position]), header.key_size);
+    position += header.key_size;
+    record.data.assign(data.begin() + position, data.begin() + position + header.data_size);
+    position += header.data_size;
+    records_.push_back(record);
+  }
+
+  // Queues point into "records_", which doesn't change from now on.
+  devices_.clear();
+  queues_.clear();
+  notifications_.clear();
+  for (std::vector<GattTraceRecord>::const_iterator it = records_.begin(); it != records_.end(); ++it) {
+    if (it->operation == kTraceDevice) {
+      DeviceInfo device;
+      std::string device_path;
+      size_t position = sizeof(device.address.ullLong);
+      if (it->data.size() < position ||
+          !ReadString(it->data, &position, &device_path) ||
+          !ReadString(it->data, &position, &device.id) ||
+          !ReadString(it->data, &position, &device.friendly_name)) {
+        *error = "Invalid device record in trace file '" + to_std_string(path) + "'.";
+        return false;
+      }
+      memcpy(&device.address.ullLong, it->data.data(), sizeof(device.address.ullLong));
+      device.path = to_std_wstring(device_path);
+      devices_.push_back(device);
+    } else if (it->operation == kTraceNotification) {
+      notifications_[it->required].push_back(&*it);
+    } else {
+      queues_[std::make_pair(static_cast<int>(it->operation), it->key)].push_back(&*it);
+    }
+  }
+  return true;
+}
+
+bool GattTraceReplayer::EnumerateDevices(std::vector<DeviceInfo>* devices, std::string*) {
+  devices->insert(devices->end(), devices_.begin(), devices_.end());
+  return true;
+}
+
+bool GattTraceReplayer::FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error) {
+  std::string key = ServicePathKey(device, service_uuid);
+  const GattTraceRecord* record = Next(kTraceFindServicePath, key);
+  if (record == NULL) {
+    *error = "No recorded service path for " + key;
+    return false;
+  }
+  std::string data(record->data.begin(), record->data.end());
+  if (FAILED(record->result)) {
+    *error = data;
+    return false;
+  }
+  *path = to_std_wstring(data);
+  return true;
+}
+
+HANDLE GattTraceReplayer::OpenDevice(const std::wstring& path, DWORD, DWORD) {
+  std::string key = to_std_string(path);
+  const GattTraceRecord* record = Next(kTraceOpenDevice, key);
+  if (record == NULL || FAILED(record->result)) {
+    SetLastError(record == NULL ? ERROR_FILE_NOT_FOUND : HRESULT_CODE(record->result));
+    return INVALID_HANDLE_VALUE;
+  }
+
+  HANDLE handle = CreateEvent(NULL, TRUE, FALSE, NULL);
+  if (handle == NULL)
+    return INVALID_HANDLE_VALUE;
+  std::lock_guard<std::mutex> lock(mutex_);
+  paths_[handle] = key;
+  return handle;
+}
+
+HRESULT GattTraceReplayer::GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG) {
+  const GattTraceRecord* record = Next(kTraceGetServices, HandleKey(device_handle));
+  if (record == NULL)
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  *required_count = static_cast<USHORT>(record->required);
+  if (services != NULL)
+    memcpy(services, record->data.data(), std::min(record->data.size(), count * sizeof(*services)));
+  return record->result;
+}
+
+HRESULT GattTraceReplayer::GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG) {
+  const GattTraceRecord* record = Next(kTraceGetCharacteristics, AttributeKey(HandleKey(device_handle), 's', service->AttributeHandle));
+  if (record == NULL)
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  *required_count = static_cast<USHORT>(record->required);
+  if (characteristics != NULL)
+    memcpy(characteristics, record->data.data(), std::min(record->data.size(), count * sizeof(*characteristics)));
+  return record->result;
+}
+
+HRESULT GattTraceReplayer::GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG) {
+  const GattTraceRecord* record = Next(kTraceGetDescriptors, AttributeKey(HandleKey(device_handle), 'c', characteristic->AttributeHandle));
+  if (record == NULL)
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  *required_count = static_cast<USHORT>(record->required);
+  if (descriptors != NULL)
+    memcpy(descriptors, record->data.data(), std::min(record->data.size(), count * sizeof(*descriptors)));
+  return record->result;
+}
+
+HRESULT GattTraceReplayer::GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG) {
+  const GattTraceRecord* record = Next(kTraceGetCharacteristicValue, AttributeKey(HandleKey(service_handle), 'c', characteristic->AttributeHandle));
+  if (record == NULL)
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  *required_size = static_cast<USHORT>(record->required);
+  if (value != NULL)
+    memcpy(value, record->data.data(), std::min<size_t>(record->data.size(), size));
+  return record->result;
+}
+
+HRESULT GattTraceReplayer::GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG) {
+  const GattTraceRecord* record = Next(kTraceGetDescriptorValue, AttributeKey(HandleKey(service_handle), 'd', descriptor->AttributeHandle));
+  if (record == NULL)
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  *required_size = static_cast<USHORT>(record->required);
+  if (value != NULL)
+    memcpy(value, record->data.data(), std::min<size_t>(record->data.size(), size));
+  return record->result;
+}
+
+HRESULT GattTraceReplayer::SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE*, ULONG) {
+  const GattTraceRecord* record = Next(kTraceSetCharacteristicValue, AttributeKey(HandleKey(service_handle), 'c', characteristic->AttributeHandle));
+  return record == NULL ? HRESULT_FROM_WIN32(ERROR_NOT_FOUND) : record->result;
+}
+
+HRESULT GattTraceReplayer::SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE*, ULONG) {
+  const GattTraceRecord* record = Next(kTraceSetDescriptorValue, AttributeKey(HandleKey(service_handle), 'd', descriptor->AttributeHandle));
+  return record == NULL ? HRESULT_FROM_WIN32(ERROR_NOT_FOUND) : record->result;
+}
+
+HRESULT GattTraceReplayer::RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE, PVOID,
+                                         PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                         BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG) {
+  std::string key = HandleKey(service_handle);
+  const GattTraceRecord* record = Next(kTraceRegisterEvent, key);
+  if (record == NULL)
+    return HRESULT_FROM_WIN32(ERROR_NOT_FOUND);
+  if (FAILED(record->result))
+    return record->result;
+
+  Registration* registration = new Registration();
+  registration->callback = callback;
+  registration->context = context;
+  registration->key = key;
+  registration->start_us = record->start_us;
+  registration->stopped = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<UINT32, std::vector<const GattTraceRecord*>>::const_iterator it = notifications_.find(record->required);
+    if (it != notifications_.end())
+      registration->notifications = it->second;
+    registrations_[registration] = registration;
+  }
+  registration->thread = std::thread(&GattTraceReplayer::Deliver, this, registration);
+  *event_handle = registration;
+  return record->result;
+}
+
+HRESULT GattTraceReplayer::UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG) {
+  Registration* registration = NULL;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<BLUETOOTH_GATT_EVENT_HANDLE, Registration*>::iterator it = registrations_.find(event_handle);
+    if (it == registrations_.end())
+      return E_INVALIDARG;
+    registration = it->second;
+    registrations_.erase(it);
+  }
+  Stop(registration);
+  const GattTraceRecord* record = Next(kTraceUnregisterEvent, registration->key);
+  delete registration;
+  return record == NULL ? S_OK : record->result;
+}
+
+void GattTraceReplayer::Deliver(Registration* registration) {
+  UINT64 start_us = monotonic_microseconds();
+  for (std::vector<const GattTraceRecord*>::const_iterator it = registration->notifications.begin();
+       it != registration->notifications.end();
+       ++it) {
+    const GattTraceRecord& record = **it;
+    {
+      std::unique_lock<std::mutex> lock(registration->mutex);
+      if (speed_ > 0 && record.start_us > registration->start_us) {
+        UINT64 delay_us = static_cast<UINT64>((record.start_us - registration->start_us) / speed_);
+        UINT64 now_us = monotonic_microseconds();
+        if (start_us + delay_us > now_us) {
+          registration->stopped_changed.wait_for(lock, std::chrono::microseconds(start_us + delay_us - now_us),
+                                                 [registration] { return registration->stopped; });
+        }
+      }
+      if (registration->stopped)
+        return;
+    }
+
+    USHORT changed_handle;
+    if (record.data.size() < sizeof(changed_handle))
+      continue;
+    memcpy(&changed_handle, record.data.data(), sizeof(changed_handle));
+    size_t size = record.data.size() - sizeof(changed_handle);
+    std::vector<UINT8> buffer(offsetof(BTH_LE_GATT_CHARACTERISTIC_VALUE, Data) + std::max<size_t>(size, 1));
+    BTH_LE_GATT_CHARACTERISTIC_VALUE* value = reinterpret_cast<BTH_LE_GATT_CHARACTERISTIC_VALUE*>(buffer.data());
+    value->DataSize = static_cast<ULONG>(size);
+    if (size > 0)
+      memcpy(value->Data, record.data.data() + sizeof(changed_handle), size);
+
+    BLUETOOTH_GATT_VALUE_CHANGED_EVENT event;
+    event.ChangedAttributeHandle = changed_handle;
+    event.CharacteristicValueDataSize = size;
+    event.CharacteristicValue = value;
+    registration->callback(CharacteristicValueChangedEvent, &event, registration->context);
+  }
+}
+
+const GattTraceRecord* GattTraceReplayer::Next(GattTraceOperation operation, const std::string& key) {
+  const GattTraceRecord* record = NULL;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<std::pair<int, std::string>, std::deque<const GattTraceRecord*>>::iterator it =
+        queues_.find(std::make_pair(static_cast<int>(operation), key));
+    if (it == queues_.end() || it->second.empty())
+      return NULL;
+    record = it->second.front();
+    it->second.pop_front();
+  }
+  Wait(record->duration_us);
+  return record;
+}
+
+std::string GattTraceReplayer::HandleKey(HANDLE handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<HANDLE, std::string>::const_iterator it = paths_.find(handle);
+  return it == paths_.end() ? std::string() : it->second;
+}
+
+void GattTraceReplayer::Wait(UINT64 duration_us) {
+  if (speed_ > 0 && duration_us > 0)
+    std::this_thread::sleep_for(std::chrono::microseconds(static_cast<UINT64>(duration_us / speed_)));
+}
+
+void GattTraceReplayer::Stop(Registration* registration) {
+  {
+    std::lock_guard<std::mutex> lock(registration->mutex);
+    registration->stopped = true;
+  }
+  registration->stopped_changed.notify_all();
+  if (registration->thread.joinable())
+    registration->thread.join();
+}
+
+}  // namespace btle
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base.h"
+#include "btle.h"
+#include "btle_gatt_backend.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Traces of GATT interactions: the discovered devices, then every call to
+// a GattBackend with its result, output and duration, and every
+// notification with its arrival time.
+//
+// A trace file is "BTLETRC1" followed by records: a header (operation,
+// result, required size or count, start time since the beginning of the
+// recording and duration, in microseconds), a key and the output bytes.
+//
+// Keys identify the target of a call independently of handle values: the
+// interface path of the opened handle, plus the attribute handle of the
+// service, characteristic or descriptor. Notifications are keyed like their
+// registration and numbered by it.
+//
+enum GattTraceOperation {
+  kTraceDevice = 1,
+  kTraceFindServicePath,
+  kTraceOpenDevice,
+  kTraceGetServices,
+  kTraceGetCharacteristics,
+  kTraceGetDescriptors,
+  kTraceGetCharacteristicValue,
+  kTraceGetDescriptorValue,
+  kTraceSetCharacteristicValue,
+  kTraceSetDescriptorValue,
+  kTraceRegisterEvent,
+  kTraceNotification,
+  kTraceUnregisterEvent,
+};
+
+struct GattTraceRecord {
+  GattTraceOperation operation;
+  HRESULT result;
+  // Required size or count, or number of the registration of events and
+  // notifications.
+  UINT32 required;
+  UINT64 start_us;
+  UINT64 duration_us;
+  std::string key;
+  std::vector<UINT8> data;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Backend forwarding all calls to "backend" and appending them to a trace
+// file. Records are buffered and written when the buffer is full and on
+// Close().
+//
+class GattTraceRecorder : public GattBackend {
+public:
+  explicit GattTraceRecorder(GattBackend* backend);
+  // Calls Close().
+  virtual ~GattTraceRecorder();
+
+  bool Open(const std::wstring& path, std::string* error);
+  bool Close(std::string* error);
+
+  virtual bool EnumerateDevices(std::vector<DeviceInfo>* devices, std::string* error);
+  virtual bool FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error);
+  virtual HANDLE OpenDevice(const std::wstring& path, DWORD desired_access, DWORD share_mode);
+  virtual HRESULT GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG flags);
+  virtual HRESULT GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG flags);
+  virtual HRESULT SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, ULONG flags);
+  virtual HRESULT SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE* value, ULONG flags);
+  virtual HRESULT RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_parameter,
+                                PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG flags);
+  virtual HRESULT UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG flags);
+
+private:
+  // Stands between the backend and the callback of a registration.
+  struct Registration {
+    GattTraceRecorder* recorder;
+    PFNBLUETOOTH_GATT_EVENT_CALLBACK callback;
+    PVOID context;
+    std::string key;
+    UINT32 number;
+  };
+
+  static VOID CALLBACK OnEvent(BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_out_parameter, PVOID context);
+
+  std::string HandleKey(HANDLE handle);
+  void Record(GattTraceOperation operation, HRESULT result, UINT32 required, UINT64 start_us,
+              const std::string& key, const void* data, size_t size);
+  // Must be called with the lock held.
+  bool WriteBuffer(std::string* error);
+
+  GattBackend* backend_;
+  std::mutex mutex_;
+  scoped_handle<HANDLE> file_;
+  std::wstring path_;
+  std::vector<UINT8> buffer_;
+  UINT64 start_us_;
+  // Interface path of each open handle.
+  std::map<HANDLE, std::string> paths_;
+  std::map<BLUETOOTH_GATT_EVENT_HANDLE, Registration*> registrations_;
+  UINT32 registration_count_;
+  // First write error, reported by Close().
+  std::string error_;
+
+  GattTraceRecorder(const GattTraceRecorder& other);
+  const GattTraceRecorder& operator=(const GattTraceRecorder& other);
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Backend serving the calls from a trace, so that the GATT code runs
+// without devices. Calls are matched by operation and key, in recorded
+// order, and take their recorded duration divided by "speed": 1 replays in
+// real time, 10 ten times faster, and 0 as fast as possible. Notifications
+// are delivered by a thread per registration, at their recorded delay
+// after the registration divided by "speed".
+//
+// Calls the trace doesn't have fail with ERROR_NOT_FOUND. Opened handles
+// are event handles, so that they can be closed with CloseHandle(). As with
+// the BluetoothGATT* APIs, a callback must not unregister its own event.
+//
+class GattTraceReplayer : public GattBackend {
+public:
+  explicit GattTraceReplayer(double speed);
+  // Stops the notifications still registered.
+  virtual ~GattTraceReplayer();
+
+  bool Load(const std::wstring& path, std::string* error);
+
+  // Returns the devices of the recorded enumeration.
+  virtual bool EnumerateDevices(std::vector<DeviceInfo>* devices, std::string* error);
+  virtual bool FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error);
+  virtual HANDLE OpenDevice(const std::wstring& path, DWORD desired_access, DWORD share_mode);
+  virtual HRESULT GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG flags);
+  virtual HRESULT GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG flags);
+  virtual HRESULT SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, ULONG flags);
+  virtual HRESULT SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE* value, ULONG flags);
+  virtual HRESULT RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_parameter,
+                                PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG flags);
+  virtual HRESULT UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG flags);
+
+private:
+  // Delivers the notifications of a registration.
+  struct Registration {
+    PFNBLUETOOTH_GATT_EVENT_CALLBACK callback;
+    PVOID context;
+    std::string key;
+    // Recorded start of the registration.
+    UINT64 start_us;
+    std::vector<const GattTraceRecord*> notifications;
+    std::mutex mutex;
+    std::condition_variable stopped_changed;
+    bool stopped;
+    std::thread thread;
+  };
+
+  void Deliver(Registration* registration);
+  // Removes the next record of "operation" and "key" from the queue, or
+  // returns NULL. Waits for its duration.
+  const GattTraceRecord* Next(GattTraceOperation operation, const std::string& key);
+  std::string HandleKey(HANDLE handle);
+  void Wait(UINT64 duration_us);
+  void Stop(Registration* registration);
+
+  double speed_;
+  std::vector<GattTraceRecord> records_;
+  std::vector<DeviceInfo> devices_;
+  std::mutex mutex_;
+  // Records of each operation and key, in recorded order, and
+  // notifications of each registration number.
+  std::map<std::pair<int, std::string>, std::deque<const GattTraceRecord*>> queues_;
+  std::map<UINT32, std::vector<const GattTraceRecord*>> notifications_;
+  std::map<HANDLE, std::string> paths_;
+  std::map<BLUETOOTH_GATT_EVENT_HANDLE, Registration*> registrations_;
+
+  GattTraceReplayer(const GattTraceReplayer& other);
+  const GattTraceReplayer& operator=(const GattTraceReplayer& other);
+};
+
+}  // namespace btle
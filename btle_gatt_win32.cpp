@@ -0,0 +1,336 @@
+#include "stdafx.h"
+
+#include <sstream>
+#include <vector>
+
+#include "btle_address.h"
+#include "btle_gatt_win32.h"
+#include "btle_helpers.h"
+
+namespace btle {
+
+namespace {
+
+//////////////////////////////////////////////////////////////////////////////
+// Represents a registry property value
+//
+class DeviceRegistryProperty : public RefCounted<DeviceRegistryProperty> {
+public:
+  DeviceRegistryProperty(DWORD property_type, scoped_array<UINT8>& value, size_t value_size)
+      : property_type_(property_type), value_(value.Pass()), value_size_(value_size) {
+  }
+
+  bool AsString(std::string* value, std::string* error) {
+    if (property_type_ != REG_SZ) {
+      *error = "Property is not a string";
+      return false;
+    }
+
+    std::wstring wvalue(reinterpret_cast<WCHAR*>(value_.get()));
+    *value = to_std_string(wvalue);
+    return true;
+  }
+
+private:
+  DWORD property_type_;
+  scoped_array<UINT8> value_;
+  size_t value_size_;
+};
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectDeviceRegistryProperty(HDEVINFO device_info_handle, SP_DEVINFO_DATA& device_info_data, DWORD property, scoped_refptr<DeviceRegistryProperty>* value, std::string* error) {
+  ULONG required_length = 0;
+  BOOL success = SetupDiGetDeviceRegistryProperty(
+      device_info_handle,
+      &device_info_data,
+      property,
+      NULL,
+      NULL,
+      0, 
+      &required_length);
+  if (!CheckInsufficientBuffer(success, "SetupDiGetDeviceRegistryProperty", error))
+    return false;
+
+  scoped_array<UINT8> property_value(new UINT8[required_length]);
+  ULONG actual_length = required_length;
+  DWORD property_type;
+  success = SetupDiGetDeviceRegistryProperty(
+      device_info_handle,
+      &device_info_data,
+      property,
+      &property_type,
+      property_value.get(),
+      actual_length, 
+      &required_length);
+  if (!CheckSuccessulResult(success, actual_length, required_length, "SetupDiGetDeviceRegistryProperty", error))
+    return false;
+
+  (*value) = scoped_refptr<DeviceRegistryProperty>(new DeviceRegistryProperty(property_type, property_value, actual_length));
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectDeviceFriendlyName(HDEVINFO device_info_handle, SP_DEVINFO_DATA& device_info_data, DeviceInfo* device_info, std::string* error) {
+  scoped_refptr<DeviceRegistryProperty> property;
+  if (!CollectDeviceRegistryProperty(device_info_handle, device_info_data, SPDRP_FRIENDLYNAME, &property, error)) {
+    return false;
+  }
+
+  if (!property->AsString(&device_info->friendly_name, error)) {
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectDeviceBluetoothAddress(HDEVINFO device_info_handle, SP_DEVINFO_DATA& device_info_data, DeviceInfo* device_info, std::string* error) {
+  BluetoothAddress address;
+  if (!BluetoothAddress::FromInstanceId(device_info->id, &address)) {
+    *error = "Device instance ID value does not seem to contain a Bluetooth Adpater address.";
+    return false;
+  }
+
+  device_info->address = address.ToBluetoothAddress();
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool CollectDeviceInstanceId(HDEVINFO device_info_handle, SP_DEVINFO_DATA& device_info_data, DeviceInfo* device_info, std::string* error) {
+  ULONG required_length = 0;
+  BOOL success = SetupDiGetDeviceInstanceId(
+      device_info_handle,
+      &device_info_data,
+      NULL,
+      0, 
+      &required_length);
+  if (!CheckInsufficientBuffer(success, "SetupDiGetDeviceInstanceId", error))
+    return false;
+
+  scoped_array<WCHAR> instance_id(new WCHAR[required_length]);
+  ULONG actual_length = required_length;
+  success = SetupDiGetDeviceInstanceId(
+      device_info_handle,
+      &device_info_data,
+      instance_id.get(),
+      actual_length, 
+      &required_length);
+  if (!CheckSuccessulResult(success, actual_length, required_length, "SetupDiGetDeviceInstanceId", error))
+    return false;
+
+  device_info->id = to_std_string(std::wstring(instance_id.get()));
+  return true;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+DeviceInfoResult EnumerateDeviceInterface(HDEVINFO device_info_handle, const GUID& interface_guid, int device_index,
+                                          SP_DEVICE_INTERFACE_DATA* device_interface_data, SP_DEVINFO_DATA* device_info_data,
+                                          std::wstring* path, std::string* error) {
+  GUID temp_guid = interface_guid;
+  RtlZeroMemory(device_interface_data, sizeof(SP_DEVICE_INTERFACE_DATA));
+  device_interface_data->cbSize = sizeof(SP_DEVICE_INTERFACE_DATA);
+  BOOL success = SetupDiEnumDeviceInterfaces(
+      device_info_handle,
+      NULL,
+      (LPGUID)&temp_guid,
+      (DWORD)device_index,
+      device_interface_data);
+  if (!success) {
+    DWORD last_error = GetLastError();
+    if (last_error == ERROR_NO_MORE_ITEMS) {
+      return kNoMoreDevices;
+    }
+    else {
+      std::ostringstream string_stream;
+      string_stream << "Error enumerating device interfaces: " << last_error;
+      *error = string_stream.str();
+      return kError;
+    }
+  }
+
+  // Retrieve required # of bytes for interface details
+  ULONG required_length = 0;
+  success = SetupDiGetDeviceInterfaceDetail(
+      device_info_handle,
+      device_interface_data,
+      NULL,
+      0,
+      &required_length,
+      NULL);
+  if (!CheckInsufficientBuffer(success, "SetupDiGetDeviceInterfaceDetail", error))
+    return kError;
+
+  scoped_array<UINT8> interface_data(new UINT8[required_length]);
+  RtlZeroMemory(interface_data.get(), required_length);
+
+  PSP_DEVICE_INTERFACE_DETAIL_DATA device_interface_detail_data = reinterpret_cast<PSP_DEVICE_INTERFACE_DETAIL_DATA>(interface_data.get());
+  device_interface_detail_data->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA);
+
+  RtlZeroMemory(device_info_data, sizeof(SP_DEVINFO_DATA));
+  device_info_data->cbSize = sizeof(SP_DEVINFO_DATA);
+
+  ULONG actual_length = required_length;
+  success = SetupDiGetDeviceInterfaceDetail(
+      device_info_handle,
+      device_interface_data,
+      device_interface_detail_data,
+      actual_length,
+      &required_length,
+      device_info_data);
+  if (!CheckSuccessulResult(success, actual_length, required_length, "SetupDiGetDeviceInterfaceDetail", error))
+    return kError;
+
+  *path = std::wstring(device_interface_detail_data->DevicePath);
+  return kOk;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool Win32GattBackend::EnumerateDevices(std::vector<DeviceInfo>* devices, std::string* error) {
+  // Open an enumerator for all present BTLE devices.
+  scoped_hdevinfo dev_info_handle;
+  HRESULT hr = dev_info_handle.OpenBluetoothLeDevices();
+  if (FAILED(hr)) {
+    std::ostringstream string_stream;
+    string_stream << "Error enumerating device: HRESULT=" << hr;
+    *error = string_stream.str();
+    return false;
+  }
+
+  for(int i = 0; ; i++) {
+    DeviceInfo device_info;
+    SP_DEVICE_INTERFACE_DATA device_interface_data;
+    SP_DEVINFO_DATA device_info_data;
+    DeviceInfoResult result = EnumerateDeviceInterface(dev_info_handle.get(), GUID_BLUETOOTHLE_DEVICE_INTERFACE, i, &device_interface_data, &device_info_data, &device_info.path, error);
+    if (result == kNoMoreDevices) {
+      return true;
+    }
+
+    if (result == kError) {
+      return false;
+    }
+
+    if (!CollectDeviceInstanceId(dev_info_handle.get(), device_info_data, &device_info, error)) {
+      return false;
+    }
+    if (!CollectDeviceFriendlyName(dev_info_handle.get(), device_info_data, &device_info, error)) {
+      return false;
+    }
+    if (!CollectDeviceBluetoothAddress(dev_info_handle.get(), device_info_data, &device_info, error)) {
+      return false;
+    }
+
+    devices->push_back(device_info);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool Win32GattBackend::FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error) {
+  GUID long_uuid = BTH_LE_UUID_TO_GUID(service_uuid);
+  scoped_hdevinfo dev_info_handle;
+  HRESULT hr = dev_info_handle.OpenBluetoothLeService(long_uuid);
+  if (FAILED(hr)) {
+    std::ostringstream string_stream;
+    string_stream << "Error enumerating service from GUID: HRESULT=" << hr;
+    *error = string_stream.str();
+    return false;
+  }
+
+  BluetoothAddress device_address(device.address);
+  std::vector<std::wstring> paths;
+  for(int i = 0; ; i++) {
+    std::wstring service_path;
+    std::string device_info_error;
+    SP_DEVICE_INTERFACE_DATA device_interface_data;
+    SP_DEVINFO_DATA device_info_data;
+    DeviceInfoResult result = EnumerateDeviceInterface(dev_info_handle.get(), long_uuid, i, &device_interface_data, &device_info_data, &service_path, &device_info_error);
+    if (result == kNoMoreDevices) {
+      break;
+    }
+    else if (result == kError) {
+      *error = device_info_error;
+      return false;
+    }
+    else {
+      BluetoothAddress path_address;
+      if (BluetoothAddress::FromDevicePath(service_path, &path_address) && path_address == device_address) {
+        paths.push_back(service_path);
+      }
+    }
+  }
+
+  if (paths.size() >= 2) {
+    std::ostringstream string_stream;
+    string_stream << "There is more than one service for the given device. How can this be?";
+    *error = string_stream.str();
+    return false;
+  }
+
+  if (paths.size() == 0) {
+    (*path) = L"";
+    return true;
+  }
+
+  (*path) = paths[0];
+  return true;
+}
+
+HANDLE Win32GattBackend::OpenDevice(const std::wstring& path, DWORD desired_access, DWORD share_mode) {
+  return CreateFile(path.c_str(), desired_access, share_mode, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+}
+
+HRESULT Win32GattBackend::GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG flags) {
+  return BluetoothGATTGetServices(device_handle, count, services, required_count, flags);
+}
+
+HRESULT Win32GattBackend::GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG flags) {
+  return BluetoothGATTGetCharacteristics(device_handle, service, count, characteristics, required_count, flags);
+}
+
+HRESULT Win32GattBackend::GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG flags) {
+  return BluetoothGATTGetDescriptors(device_handle, characteristic, count, descriptors, required_count, flags);
+}
+
+HRESULT Win32GattBackend::GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG flags) {
+  return BluetoothGATTGetCharacteristicValue(service_handle, characteristic, size, value, required_size, flags);
+}
+
+HRESULT Win32GattBackend::GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG flags) {
+  return BluetoothGATTGetDescriptorValue(service_handle, descriptor, size, value, required_size, flags);
+}
+
+HRESULT Win32GattBackend::SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, ULONG flags) {
+  return BluetoothGATTSetCharacteristicValue(service_handle, characteristic, value, NULL, flags);
+}
+
+HRESULT Win32GattBackend::SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE* value, ULONG flags) {
+  return BluetoothGATTSetDescriptorValue(service_handle, descriptor, value, flags);
+}
+
+HRESULT Win32GattBackend::RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_parameter,
+                                        PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                        BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG flags) {
+  return BluetoothGATTRegisterEvent(service_handle, event_type, event_parameter, callback, context, event_handle, flags);
+}
+
+HRESULT Win32GattBackend::UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG flags) {
+  return BluetoothGATTUnregisterEvent(event_handle, flags);
+}
+
+}  // namespace btle
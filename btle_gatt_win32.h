@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <setupapi.h>
+
+#include "base.h"
+#include "btle.h"
+#include "btle_gatt_backend.h"
+
+enum DeviceInfoResult {
+  kOk,
+  kError,
+  kNoMoreDevices
+};
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// The SetupDi*, CreateFile and BluetoothGATT* functions.
+//
+class Win32GattBackend : public GattBackend {
+public:
+  virtual bool EnumerateDevices(std::vector<DeviceInfo>* devices, std::string* error);
+  virtual bool FindServicePath(const DeviceInfo& device, const BTH_LE_UUID& service_uuid, std::wstring* path, std::string* error);
+  virtual HANDLE OpenDevice(const std::wstring& path, DWORD desired_access, DWORD share_mode);
+  virtual HRESULT GetServices(HANDLE device_handle, USHORT count, BTH_LE_GATT_SERVICE* services, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetCharacteristics(HANDLE device_handle, BTH_LE_GATT_SERVICE* service, USHORT count, BTH_LE_GATT_CHARACTERISTIC* characteristics, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetDescriptors(HANDLE device_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, USHORT count, BTH_LE_GATT_DESCRIPTOR* descriptors, USHORT* required_count, ULONG flags);
+  virtual HRESULT GetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, ULONG size, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, USHORT* required_size, ULONG flags);
+  virtual HRESULT GetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, ULONG size, BTH_LE_GATT_DESCRIPTOR_VALUE* value, USHORT* required_size, ULONG flags);
+  virtual HRESULT SetCharacteristicValue(HANDLE service_handle, BTH_LE_GATT_CHARACTERISTIC* characteristic, BTH_LE_GATT_CHARACTERISTIC_VALUE* value, ULONG flags);
+  virtual HRESULT SetDescriptorValue(HANDLE service_handle, BTH_LE_GATT_DESCRIPTOR* descriptor, BTH_LE_GATT_DESCRIPTOR_VALUE* value, ULONG flags);
+  virtual HRESULT RegisterEvent(HANDLE service_handle, BTH_LE_GATT_EVENT_TYPE event_type, PVOID event_parameter,
+                                PFNBLUETOOTH_GATT_EVENT_CALLBACK callback, PVOID context,
+                                BLUETOOTH_GATT_EVENT_HANDLE* event_handle, ULONG flags);
+  virtual HRESULT UnregisterEvent(BLUETOOTH_GATT_EVENT_HANDLE event_handle, ULONG flags);
+};
+
+// Retrieves the "device_index"-th interface of class "interface_guid" of
+// "device_info_handle": its interface data, the data of its device and its
+// path.
+DeviceInfoResult EnumerateDeviceInterface(HDEVINFO device_info_handle, const GUID& interface_guid, int device_index,
+                                          SP_DEVICE_INTERFACE_DATA* device_interface_data, SP_DEVINFO_DATA* device_info_data,
+                                          std::wstring* path, std::string* error);
+
+}  // namespace btle
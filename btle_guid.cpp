@@ -0,0 +1,171 @@
+#include "stdafx.h"
+
+#include <array>
+#include <cstring>
+
+#include "btle_guid.h"
+
+namespace btle {
+
+namespace {
+
+const char kHexDigits[] = "0123456789abcdef";
+
+// Lower case digits of each byte value.
+constexpr std::array<char, 512> MakeHexPairs() {
+  std::array<char, 512> pairs = {};
+  for (int i = 0; i < 256; i++) {
+    pairs[2 * i] = kHexDigits[i >> 4];
+    pairs[2 * i + 1] = kHexDigits[i & 0x0f];
+  }
+  return pairs;
+}
+
+// Value of each hex digit, -1 for other characters.
+constexpr std::array<INT8, 256> MakeHexValues() {
+  std::array<INT8, 256> values = {};
+  for (int i = 0; i < 256; i++)
+    values[i] = -1;
+  for (int i = 0; i < 10; i++)
+    values['0' + i] = static_cast<INT8>(i);
+  for (int i = 0; i < 6; i++) {
+    values['a' + i] = static_cast<INT8>(10 + i);
+    values['A' + i] = static_cast<INT8>(10 + i);
+  }
+  return values;
+}
+
+constexpr std::array<char, 512> kHexPairs = MakeHexPairs();
+constexpr std::array<INT8, 256> kHexValues = MakeHexValues();
+
+inline
+char* WriteByte(char* out, UINT8 value) {
+  out[0] = kHexPairs[2 * value];
+  out[1] = kHexPairs[2 * value + 1];
+  return out + 2;
+}
+
+// Parses "count" bytes (2 * count digits) into "value". Invalid digits make
+// "error" negative.
+inline
+UINT32 ReadBytes(const char* text, int count, int* error) {
+  UINT32 value = 0;
+  for (int i = 0; i < 2 * count; i++) {
+    int digit = kHexValues[static_cast<UINT8>(text[i])];
+    *error |= digit;
+    value = (value << 4) | (digit & 0x0f);
+  }
+  return value;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+char* WriteGuid(const GUID& guid, char* out) {
+  out = WriteByte(out, static_cast<UINT8>(guid.Data1 >> 24));
+  out = WriteByte(out, static_cast<UINT8>(guid.Data1 >> 16));
+  out = WriteByte(out, static_cast<UINT8>(guid.Data1 >> 8));
+  out = WriteByte(out, static_cast<UINT8>(guid.Data1));
+  *out++ = '-';
+  out = WriteByte(out, static_cast<UINT8>(guid.Data2 >> 8));
+  out = WriteByte(out, static_cast<UINT8>(guid.Data2));
+  *out++ = '-';
+  out = WriteByte(out, static_cast<UINT8>(guid.Data3 >> 8));
+  out = WriteByte(out, static_cast<UINT8>(guid.Data3));
+  *out++ = '-';
+  out = WriteByte(out, guid.Data4[0]);
+  out = WriteByte(out, guid.Data4[1]);
+  *out++ = '-';
+  for (int i = 2; i < 8; i++)
+    out = WriteByte(out, guid.Data4[i]);
+  return out;
+}
+
+char* WriteHex(const UINT8* data, size_t size, char* out) {
+  for (size_t i = 0; i < size; i++)
+    out = WriteByte(out, data[i]);
+  return out;
+}
+
+size_t FormatGuid(const GUID& guid, char* buffer, size_t size) {
+  if (size < kGuidStringSize)
+    return 0;
+  char* out = WriteGuid(guid, buffer);
+  *out = 0;
+  return out - buffer;
+}
+
+bool ParseGuid(std::string_view text, GUID* guid) {
+  if (text.size() == kGuidStringSize + 1 && text.front() == '{' && text.back() == '}')
+    text = text.substr(1, kGuidStringSize - 1);
+  if (text.size() != kGuidStringSize - 1)
+    return false;
+
+  const char* in = text.data();
+  if (in[8] != '-' || in[13] != '-' || in[18] != '-' || in[23] != '-')
+    return false;
+
+  int error = 0;
+  GUID result;
+  result.Data1 = ReadBytes(in, 4, &error);
+  result.Data2 = static_cast<USHORT>(ReadBytes(in + 9, 2, &error));
+  result.Data3 = static_cast<USHORT>(ReadBytes(in + 14, 2, &error));
+  result.Data4[0] = static_cast<UCHAR>(ReadBytes(in + 19, 1, &error));
+  result.Data4[1] = static_cast<UCHAR>(ReadBytes(in + 21, 1, &error));
+  for (int i = 0; i < 6; i++)
+    result.Data4[2 + i] = static_cast<UCHAR>(ReadBytes(in + 24 + 2 * i, 1, &error));
+  if (error < 0)
+    return false;
+
+  *guid = result;
+  return true;
+}
+
+bool ParseUuid(std::string_view text, BTH_LE_UUID* uuid) {
+  if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X'))
+    text.remove_prefix(2);
+
+  if (text.size() >= 1 && text.size() <= 4) {
+    UINT32 value = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+      int digit = kHexValues[static_cast<UINT8>(text[i])];
+      if (digit < 0)
+        return false;
+      value = (value << 4) | digit;
+    }
+    memset(uuid, 0, sizeof(*uuid));
+    uuid->IsShortUuid = TRUE;
+    uuid->Value.ShortUuid = static_cast<USHORT>(value);
+    return true;
+  }
+
+  GUID guid;
+  if (!ParseGuid(text, &guid))
+    return false;
+  memset(uuid, 0, sizeof(*uuid));
+  USHORT short_uuid;
+  if (GetShortUuid(guid, &short_uuid)) {
+    uuid->IsShortUuid = TRUE;
+    uuid->Value.ShortUuid = short_uuid;
+  } else {
+    uuid->IsShortUuid = FALSE;
+    uuid->Value.LongUuid = guid;
+  }
+  return true;
+}
+
+bool GetShortUuid(const GUID& guid, USHORT* short_uuid) {
+  const GUID base = BTH_LE_ATT_BLUETOOTH_BASE_GUID;
+  if (guid.Data1 > 0xffff ||
+      guid.Data2 != base.Data2 ||
+      guid.Data3 != base.Data3 ||
+      memcmp(guid.Data4, base.Data4, sizeof(guid.Data4)) != 0) {
+    return false;
+  }
+  *short_uuid = static_cast<USHORT>(guid.Data1);
+  return true;
+}
+
+}  // namespace btle
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string_view>
+
+#include "btle_platform.h"
+
+#include "base.h"
+
+// Formatting and parsing of GUIDs and Bluetooth uuids in their canonical
+// text form, "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" (lower case, with
+// leading zeros).
+//
+// Formatting writes 2 digits at a time from a table of the 256 byte values,
+// parsing reads them through a table of the 256 characters. Neither
+// allocates.
+namespace btle {
+
+// Size of a formatted GUID, including the terminating null.
+const size_t kGuidStringSize = 37;
+
+// Writes the 36 characters of "guid" to "out", without null terminator.
+// Returns the end of the written characters.
+char* WriteGuid(const GUID& guid, char* out);
+
+// Writes the 2 lower case hex digits of each of the "size" bytes of "data"
+// to "out", without null terminator. Returns the end of the written
+// characters.
+char* WriteHex(const UINT8* data, size_t size, char* out);
+
+// Writes "guid" null terminated. Returns the number of characters written,
+// not counting the null, or 0 if "size" is too small.
+size_t FormatGuid(const GUID& guid, char* buffer, size_t size);
+
+// Parses the canonical form, upper or lower case, optionally in braces
+// ("{...}"). The whole text must match.
+bool ParseGuid(std::string_view text, GUID* guid);
+
+// Parses a short uuid ("0x180a", "180a", 1 to 4 hex digits) or a long one
+// (as ParseGuid). A long uuid derived from the Bluetooth base uuid
+// (0000xxxx-0000-1000-8000-00805f9b34fb) is returned as a short uuid, so
+// that parsed uuids compare equal to the ones reported by the device.
+bool ParseUuid(std::string_view text, BTH_LE_UUID* uuid);
+
+// Returns true and sets "short_uuid" if "guid" is derived from the
+// Bluetooth base uuid.
+bool GetShortUuid(const GUID& guid, USHORT* short_uuid);
+
+}  // namespace btle
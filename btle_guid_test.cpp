@@ -0,0 +1,126 @@
+#include "stdafx.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <random>
+#include <string>
+
+#include "btle_guid.h"
+#include "btle_test.h"
+#include "btle_uuid.h"
+
+namespace {
+
+std::string Format(const GUID& guid) {
+  char buffer[btle::kGuidStringSize];
+  return std::string(buffer, btle::FormatGuid(guid, buffer, sizeof(buffer)));
+}
+
+bool SameGuid(const GUID& expected, const GUID& actual) {
+  return memcmp(&expected, &actual, sizeof(GUID)) == 0;
+}
+
+std::string ToUpper(std::string text) {
+  for (size_t i = 0; i < text.size(); i++)
+    text[i] = static_cast<char>(toupper(static_cast<unsigned char>(text[i])));
+  return text;
+}
+
+}  // namespace
+
+BTLE_TEST(guid, Format) {
+  GUID guid = { 0x0000180a, 0x0001, 0x1000, { 0x80, 0x00, 0x00, 0x80, 0x5f, 0x9b, 0x04, 0xfb } };
+  BTLE_EXPECT_EQ(std::string("0000180a-0001-1000-8000-00805f9b04fb"), Format(guid));
+
+  char buffer[btle::kGuidStringSize];
+  BTLE_EXPECT_EQ(0u, btle::FormatGuid(guid, buffer, sizeof(buffer) - 1));
+  BTLE_EXPECT_EQ(36u, btle::FormatGuid(guid, buffer, sizeof(buffer)));
+  BTLE_EXPECT_EQ(0, buffer[36]);
+}
+
+// Random GUIDs survive formatting and parsing, in lower case, upper case
+// and between braces.
+BTLE_TEST(guid, RoundTrip) {
+  std::mt19937_64 random(1);
+  int mismatches = 0;
+  for (int i = 0; i < 100000; i++) {
+    UINT64 high = random();
+    UINT64 low = random();
+    // Zero some bytes so that leading zeros are covered too.
+    high &= ~(0xffULL << (8 * (i % 8)));
+    low &= ~(0xffULL << (8 * ((i / 8) % 8)));
+    GUID guid = btle::Uuid(high, low).ToGuid();
+    std::string text = Format(guid);
+
+    GUID lower = {};
+    GUID upper = {};
+    GUID braced = {};
+    if (text.size() != 36 ||
+        !btle::ParseGuid(text, &lower) || !SameGuid(guid, lower) ||
+        !btle::ParseGuid(ToUpper(text), &upper) || !SameGuid(guid, upper) ||
+        !btle::ParseGuid("{" + text + "}", &braced) || !SameGuid(guid, braced)) {
+      if (mismatches++ < 10)
+        BTLE_EXPECT_EQ(std::string(), text);
+    }
+  }
+  BTLE_EXPECT_EQ(0, mismatches);
+}
+
+BTLE_TEST(guid, ParseMalformed) {
+  static const char* const kTexts[] = {
+    "",
+    "0000180a-0000-1000-8000-00805f9b34f",
+    "0000180a-0000-1000-8000-00805f9b34fb0",
+    "0000180a-0000-1000-8000-00805f9b34fg",
+    "0000180a-0000-1000-8000+00805f9b34fb",
+    "0000180a0-000-1000-8000-00805f9b34fb",
+    "{0000180a-0000-1000-8000-00805f9b34fb",
+    "0000180a-0000-1000-8000-00805f9b34fb}",
+    "(0000180a-0000-1000-8000-00805f9b34fb)",
+    " 0000180a-0000-1000-8000-00805f9b34fb",
+  };
+  for (size_t i = 0; i < sizeof(kTexts) / sizeof(kTexts[0]); i++) {
+    GUID guid;
+    BTLE_EXPECT(!btle::ParseGuid(kTexts[i], &guid));
+  }
+}
+
+// Every short uuid parses from its short forms and from its base derived
+// long form, and comes back as the same short uuid.
+BTLE_TEST(guid, ParseShortUuids) {
+  int mismatches = 0;
+  for (UINT32 i = 0; i <= 0xffff; i++) {
+    USHORT short_uuid = static_cast<USHORT>(i);
+    char hex[8];
+    snprintf(hex, sizeof(hex), "%x", i);
+    std::string long_text = Format(btle::Uuid(short_uuid).ToGuid());
+
+    BTH_LE_UUID plain = {};
+    BTH_LE_UUID prefixed = {};
+    BTH_LE_UUID derived = {};
+    USHORT from_guid = 0;
+    if (!btle::ParseUuid(hex, &plain) || !plain.IsShortUuid || plain.Value.ShortUuid != short_uuid ||
+        !btle::ParseUuid(std::string("0x") + hex, &prefixed) || !prefixed.IsShortUuid || prefixed.Value.ShortUuid != short_uuid ||
+        !btle::ParseUuid(long_text, &derived) || !derived.IsShortUuid || derived.Value.ShortUuid != short_uuid ||
+        !btle::GetShortUuid(btle::Uuid(short_uuid).ToGuid(), &from_guid) || from_guid != short_uuid) {
+      if (mismatches++ < 10)
+        BTLE_EXPECT_EQ(std::string(), long_text);
+    }
+  }
+  BTLE_EXPECT_EQ(0, mismatches);
+}
+
+BTLE_TEST(guid, ParseLongUuid) {
+  BTH_LE_UUID uuid = {};
+  BTLE_EXPECT(btle::ParseUuid("f000aa01-0451-4000-b000-000000000000", &uuid));
+  BTLE_EXPECT(!uuid.IsShortUuid);
+  BTLE_EXPECT_EQ(std::string("f000aa01-0451-4000-b000-000000000000"), Format(uuid.Value.LongUuid));
+
+  USHORT short_uuid = 0;
+  BTLE_EXPECT(!btle::GetShortUuid(uuid.Value.LongUuid, &short_uuid));
+  BTLE_EXPECT(!btle::ParseUuid("0x", &uuid));
+  BTLE_EXPECT(!btle::ParseUuid("12345", &uuid));
+  BTLE_EXPECT(!btle::ParseUuid("18g0", &uuid));
+}
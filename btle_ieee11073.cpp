@@ -0,0 +1,272 @@
+#include "stdafx.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define BTLE_IEEE11073_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include "btle_ieee11073.h"
+
+namespace btle {
+namespace ieee11073 {
+
+namespace {
+
+// Special values, indexed by "value - k[S]FloatPositiveInfinity".
+const int kSpecialCount = 5;
+const ValueKind kSpecialKinds[kSpecialCount] = {
+  kPositiveInfinity, kNaN, kNRes, kReserved, kNegativeInfinity
+};
+const double kSpecialValues[kSpecialCount] = {
+  std::numeric_limits<double>::infinity(),
+  std::numeric_limits<double>::quiet_NaN(),
+  std::numeric_limits<double>::quiet_NaN(),
+  std::numeric_limits<double>::quiet_NaN(),
+  -std::numeric_limits<double>::infinity(),
+};
+
+// Indexed by the raw 4-bit exponent: 0..7 are positive, 8..15 are -8..-1.
+const double kSFloatMultipliers[16] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+  1, 1, 1, 1, 1, 1, 1, 1,
+};
+const double kSFloatDivisors[16] = {
+  1, 1, 1, 1, 1, 1, 1, 1,
+  1e8, 1e7, 1e6, 1e5, 1e4, 1e3, 1e2, 1e1,
+};
+
+// Same for the raw 8-bit exponent of FLOAT values.
+struct FloatScales {
+  FloatScales() {
+    for (int raw = 0; raw < 256; raw++) {
+      int exponent = static_cast<INT8>(raw);
+      multipliers[raw] = exponent >= 0 ? pow(10.0, exponent) : 1.0;
+      divisors[raw] = exponent >= 0 ? 1.0 : pow(10.0, -exponent);
+    }
+  }
+
+  double multipliers[256];
+  double divisors[256];
+};
+
+const FloatScales kFloatScales;
+
+inline
+UINT32 SFloatSpecialIndex(UINT32 value) {
+  return value - kSFloatPositiveInfinity;
+}
+
+inline
+UINT32 FloatSpecialIndex(UINT32 value) {
+  return value - kFloatPositiveInfinity;
+}
+
+inline
+double SFloatNumber(UINT32 value) {
+  int mantissa = static_cast<INT32>(value << 20) >> 20;
+  UINT32 exponent = (value >> 12) & 0x0f;
+  return mantissa * kSFloatMultipliers[exponent] / kSFloatDivisors[exponent];
+}
+
+inline
+double FloatNumber(UINT32 value) {
+  int mantissa = static_cast<INT32>(value << 8) >> 8;
+  UINT32 exponent = value >> 24;
+  return mantissa * kFloatScales.multipliers[exponent] / kFloatScales.divisors[exponent];
+}
+
+inline
+UINT32 ReadUInt16(const UINT8* data) {
+  return data[0] | (data[1] << 8);
+}
+
+inline
+UINT32 ReadUInt32(const UINT8* data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<UINT32>(data[3]) << 24);
+}
+
+#if BTLE_IEEE11073_SSE2
+inline
+void Store(double* values, __m128d low, __m128d high) {
+  _mm_storeu_pd(values, low);
+  _mm_storeu_pd(values + 2, high);
+}
+
+inline
+void Store(float* values, __m128d low, __m128d high) {
+  _mm_storeu_ps(values, _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high)));
+}
+
+// Mask of the 32-bit lanes of "raw" holding a special value.
+inline
+int SpecialMask(__m128i raw, UINT32 first_special) {
+  __m128i index = _mm_sub_epi32(raw, _mm_set1_epi32(first_special));
+  __m128i special = _mm_and_si128(_mm_cmpgt_epi32(index, _mm_set1_epi32(-1)),
+                                  _mm_cmplt_epi32(index, _mm_set1_epi32(kSpecialCount)));
+  return _mm_movemask_epi8(special);
+}
+#endif
+
+template <typename T>
+void ConvertSFloats(const UINT8* data, size_t count, T* values) {
+  size_t index = 0;
+#if BTLE_IEEE11073_SSE2
+  for (; index + 4 <= count; index += 4) {
+    const UINT8* input = data + index * 2;
+    __m128i raw = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input)), _mm_setzero_si128());
+    if (SpecialMask(raw, kSFloatPositiveInfinity) != 0) {
+      for (size_t i = 0; i < 4; i++)
+        values[index + i] = static_cast<T>(SFloatToDouble(static_cast<UINT16>(ReadUInt16(input + i * 2))));
+      continue;
+    }
+    __m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(raw, 20), 20);
+    UINT32 e0 = input[1] >> 4;
+    UINT32 e1 = input[3] >> 4;
+    UINT32 e2 = input[5] >> 4;
+    UINT32 e3 = input[7] >> 4;
+    __m128d low = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(mantissa),
+                                        _mm_set_pd(kSFloatMultipliers[e1], kSFloatMultipliers[e0])),
+                             _mm_set_pd(kSFloatDivisors[e1], kSFloatDivisors[e0]));
+    __m128d high = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(mantissa, mantissa)),
+                                         _mm_set_pd(kSFloatMultipliers[e3], kSFloatMultipliers[e2])),
+                              _mm_set_pd(kSFloatDivisors[e3], kSFloatDivisors[e2]));
+    Store(values + index, low, high);
+  }
+#endif
+  for (; index < count; index++) {
+    values[index] = static_cast<T>(SFloatToDouble(static_cast<UINT16>(ReadUInt16(data + index * 2))));
+  }
+}
+
+template <typename T>
+void ConvertFloats(const UINT8* data, size_t count, T* values) {
+  size_t index = 0;
+#if BTLE_IEEE11073_SSE2
+  const double* multipliers = kFloatScales.multipliers;
+  const double* divisors = kFloatScales.divisors;
+  for (; index + 4 <= count; index += 4) {
+    const UINT8* input = data + index * 4;
+    __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    if (SpecialMask(raw, kFloatPositiveInfinity) != 0) {
+      for (size_t i = 0; i < 4; i++)
+        values[index + i] = static_cast<T>(FloatToDouble(ReadUInt32(input + i * 4)));
+      continue;
+    }
+    __m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(raw, 8), 8);
+    UINT32 e0 = input[3];
+    UINT32 e1 = input[7];
+    UINT32 e2 = input[11];
+    UINT32 e3 = input[15];
+    __m128d low = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(mantissa),
+                                        _mm_set_pd(multipliers[e1], multipliers[e0])),
+                             _mm_set_pd(divisors[e1], divisors[e0]));
+    __m128d high = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(mantissa, mantissa)),
+                                         _mm_set_pd(multipliers[e3], multipliers[e2])),
+                              _mm_set_pd(divisors[e3], divisors[e2]));
+    Store(values + index, low, high);
+  }
+#endif
+  for (; index < count; index++) {
+    values[index] = static_cast<T>(FloatToDouble(ReadUInt32(data + index * 4)));
+  }
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+ValueKind ClassifySFloat(UINT16 value) {
+  UINT32 special = SFloatSpecialIndex(value);
+  return special < kSpecialCount ? kSpecialKinds[special] : kNumber;
+}
+
+ValueKind ClassifyFloat(UINT32 value) {
+  UINT32 special = FloatSpecialIndex(value);
+  return special < kSpecialCount ? kSpecialKinds[special] : kNumber;
+}
+
+double SFloatToDouble(UINT16 value) {
+  UINT32 special = SFloatSpecialIndex(value);
+  if (special < kSpecialCount)
+    return kSpecialValues[special];
+  return SFloatNumber(value);
+}
+
+float SFloatToFloat(UINT16 value) {
+  return static_cast<float>(SFloatToDouble(value));
+}
+
+double FloatToDouble(UINT32 value) {
+  UINT32 special = FloatSpecialIndex(value);
+  if (special < kSpecialCount)
+    return kSpecialValues[special];
+  return FloatNumber(value);
+}
+
+float FloatToFloat(UINT32 value) {
+  return static_cast<float>(FloatToDouble(value));
+}
+
+void SFloatsToDouble(const UINT8* data, size_t count, double* values) {
+  ConvertSFloats(data, count, values);
+}
+
+void SFloatsToFloat(const UINT8* data, size_t count, float* values) {
+  ConvertSFloats(data, count, values);
+}
+
+void FloatsToDouble(const UINT8* data, size_t count, double* values) {
+  ConvertFloats(data, count, values);
+}
+
+void FloatsToFloat(const UINT8* data, size_t count, float* values) {
+  ConvertFloats(data, count, values);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+double ReferenceSFloatToDouble(UINT16 value) {
+  switch (value) {
+    case kSFloatPositiveInfinity: return std::numeric_limits<double>::infinity();
+    case kSFloatNegativeInfinity: return -std::numeric_limits<double>::infinity();
+    case kSFloatNaN:
+    case kSFloatNRes:
+    case kSFloatReserved:
+      return std::numeric_limits<double>::quiet_NaN();
+  }
+  int mantissa = value & 0x0fff;
+  if (mantissa >= 0x0800)
+    mantissa -= 0x1000;
+  int exponent = value >> 12;
+  if (exponent >= 0x08)
+    exponent -= 0x10;
+  if (exponent < 0)
+    return mantissa / pow(10.0, -exponent);
+  return mantissa * pow(10.0, exponent);
+}
+
+double ReferenceFloatToDouble(UINT32 value) {
+  switch (value) {
+    case kFloatPositiveInfinity: return std::numeric_limits<double>::infinity();
+    case kFloatNegativeInfinity: return -std::numeric_limits<double>::infinity();
+    case kFloatNaN:
+    case kFloatNRes:
+    case kFloatReserved:
+      return std::numeric_limits<double>::quiet_NaN();
+  }
+  int mantissa = value & 0x00ffffff;
+  if (mantissa >= 0x00800000)
+    mantissa -= 0x01000000;
+  int exponent = static_cast<INT8>(value >> 24);
+  if (exponent < 0)
+    return mantissa / pow(10.0, -exponent);
+  return mantissa * pow(10.0, exponent);
+}
+
+}  // namespace ieee11073
+}  // namespace btle
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "base.h"
+
+// Conversions of the IEEE-11073 16-bit SFLOAT and 32-bit FLOAT types used by
+// the health profiles (temperature, blood pressure, glucose, ...).
+//
+// SFLOAT: 4-bit exponent, 12-bit mantissa. FLOAT: 8-bit exponent, 24-bit
+// mantissa. Both signed, and the value is mantissa * 10^exponent. A few
+// values with a 0 exponent are reserved for special values.
+//
+// The conversions use tables of powers of ten: a value with a negative
+// exponent is divided by 10^-exponent instead of multiplied by an inexact
+// 10^exponent, so the result is the correctly rounded double (and the float
+// rounded from it) whenever the power of ten is exact.
+namespace btle {
+namespace ieee11073 {
+
+enum ValueKind {
+  kNumber,
+  kNaN,
+  kNRes,
+  kPositiveInfinity,
+  kNegativeInfinity,
+  kReserved,
+};
+
+const UINT16 kSFloatNaN = 0x07ff;
+const UINT16 kSFloatNRes = 0x0800;
+const UINT16 kSFloatPositiveInfinity = 0x07fe;
+const UINT16 kSFloatNegativeInfinity = 0x0802;
+const UINT16 kSFloatReserved = 0x0801;
+
+const UINT32 kFloatNaN = 0x007fffff;
+const UINT32 kFloatNRes = 0x00800000;
+const UINT32 kFloatPositiveInfinity = 0x007ffffe;
+const UINT32 kFloatNegativeInfinity = 0x00800002;
+const UINT32 kFloatReserved = 0x00800001;
+
+ValueKind ClassifySFloat(UINT16 value);
+ValueKind ClassifyFloat(UINT32 value);
+
+// NaN, NRes and the reserved value convert to a quiet NaN, the infinities to
+// the infinities.
+double SFloatToDouble(UINT16 value);
+float SFloatToFloat(UINT16 value);
+double FloatToDouble(UINT32 value);
+float FloatToFloat(UINT32 value);
+
+// Converts "count" consecutive little-endian values of "data". Uses SSE2
+// when available.
+void SFloatsToDouble(const UINT8* data, size_t count, double* values);
+void SFloatsToFloat(const UINT8* data, size_t count, float* values);
+void FloatsToDouble(const UINT8* data, size_t count, double* values);
+void FloatsToFloat(const UINT8* data, size_t count, float* values);
+
+// Straightforward (pow based) conversions. Slow: only meant to validate the
+// conversions above, which return the same values bit for bit.
+double ReferenceSFloatToDouble(UINT16 value);
+double ReferenceFloatToDouble(UINT32 value);
+
+}  // namespace ieee11073
+}  // namespace btle
@@ -0,0 +1,114 @@
+#include "stdafx.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "btle_ieee11073.h"
+#include "btle_test.h"
+
+namespace {
+
+// Same value, bit for bit, any NaN matching any NaN.
+bool SameDouble(double expected, double actual) {
+  if (std::isnan(expected))
+    return std::isnan(actual);
+  return memcmp(&expected, &actual, sizeof(double)) == 0;
+}
+
+bool SameFloat(float expected, float actual) {
+  if (std::isnan(expected))
+    return std::isnan(actual);
+  return memcmp(&expected, &actual, sizeof(float)) == 0;
+}
+
+}  // namespace
+
+// Every SFLOAT, through the scalar conversions, against the pow based
+// reference.
+BTLE_TEST(ieee11073, SFloatScalarExhaustive) {
+  int mismatches = 0;
+  for (UINT32 i = 0; i <= 0xffff; i++) {
+    UINT16 value = static_cast<UINT16>(i);
+    double expected = btle::ieee11073::ReferenceSFloatToDouble(value);
+    if (!SameDouble(expected, btle::ieee11073::SFloatToDouble(value)) ||
+        !SameFloat(static_cast<float>(expected), btle::ieee11073::SFloatToFloat(value))) {
+      if (mismatches++ < 10)
+        BTLE_EXPECT_EQ(expected, btle::ieee11073::SFloatToDouble(value));
+    }
+  }
+  BTLE_EXPECT_EQ(0, mismatches);
+}
+
+// Every SFLOAT, through the batch (SSE2) conversions, at every alignment of
+// the output relative to a batch.
+BTLE_TEST(ieee11073, SFloatBatchExhaustive) {
+  std::vector<UINT8> data(2 * 0x10000);
+  for (UINT32 i = 0; i <= 0xffff; i++) {
+    data[2 * i] = static_cast<UINT8>(i);
+    data[2 * i + 1] = static_cast<UINT8>(i >> 8);
+  }
+
+  for (size_t start = 0; start < 4; start++) {
+    size_t count = 0x10000 - start;
+    std::vector<double> doubles(count);
+    std::vector<float> floats(count);
+    btle::ieee11073::SFloatsToDouble(&data[2 * start], count, &doubles[0]);
+    btle::ieee11073::SFloatsToFloat(&data[2 * start], count, &floats[0]);
+
+    int mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+      UINT16 value = static_cast<UINT16>(start + i);
+      double expected = btle::ieee11073::ReferenceSFloatToDouble(value);
+      if (!SameDouble(expected, doubles[i]) || !SameFloat(static_cast<float>(expected), floats[i])) {
+        if (mismatches++ < 10)
+          BTLE_EXPECT_EQ(expected, doubles[i]);
+      }
+    }
+    BTLE_EXPECT_EQ(0, mismatches);
+  }
+}
+
+BTLE_TEST(ieee11073, SFloatSpecialValues) {
+  BTLE_EXPECT(std::isnan(btle::ieee11073::SFloatToDouble(btle::ieee11073::kSFloatNaN)));
+  BTLE_EXPECT(std::isnan(btle::ieee11073::SFloatToDouble(btle::ieee11073::kSFloatNRes)));
+  BTLE_EXPECT(std::isnan(btle::ieee11073::SFloatToDouble(btle::ieee11073::kSFloatReserved)));
+  BTLE_EXPECT(btle::ieee11073::SFloatToDouble(btle::ieee11073::kSFloatPositiveInfinity) == HUGE_VAL);
+  BTLE_EXPECT(btle::ieee11073::SFloatToDouble(btle::ieee11073::kSFloatNegativeInfinity) == -HUGE_VAL);
+  BTLE_EXPECT_EQ(btle::ieee11073::kNaN, btle::ieee11073::ClassifySFloat(btle::ieee11073::kSFloatNaN));
+  BTLE_EXPECT_EQ(btle::ieee11073::kNumber, btle::ieee11073::ClassifySFloat(0x0001));
+}
+
+// FLOATs of every exponent, with a spread of mantissas, through the scalar
+// and batch conversions.
+BTLE_TEST(ieee11073, FloatSweep) {
+  std::vector<UINT32> values;
+  for (UINT32 exponent = 0; exponent < 0x100; exponent++) {
+    for (UINT32 mantissa = 0; mantissa < 0x1000000; mantissa += 0x1000000 / 64 + 1)
+      values.push_back((exponent << 24) | mantissa);
+    values.push_back((exponent << 24) | 0x7fffff);
+    values.push_back((exponent << 24) | 0x800000);
+    values.push_back((exponent << 24) | 0xffffff);
+  }
+
+  std::vector<UINT8> data(4 * values.size());
+  for (size_t i = 0; i < values.size(); i++)
+    memcpy(&data[4 * i], &values[i], 4);
+  std::vector<double> doubles(values.size());
+  std::vector<float> floats(values.size());
+  btle::ieee11073::FloatsToDouble(&data[0], values.size(), &doubles[0]);
+  btle::ieee11073::FloatsToFloat(&data[0], values.size(), &floats[0]);
+
+  int mismatches = 0;
+  for (size_t i = 0; i < values.size(); i++) {
+    double expected = btle::ieee11073::ReferenceFloatToDouble(values[i]);
+    if (!SameDouble(expected, btle::ieee11073::FloatToDouble(values[i])) ||
+        !SameFloat(static_cast<float>(expected), btle::ieee11073::FloatToFloat(values[i])) ||
+        !SameDouble(expected, doubles[i]) ||
+        !SameFloat(static_cast<float>(expected), floats[i])) {
+      if (mismatches++ < 10)
+        BTLE_EXPECT_EQ(expected, btle::ieee11073::FloatToDouble(values[i]));
+    }
+  }
+  BTLE_EXPECT_EQ(0, mismatches);
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "base.h"
+#include "btle_ieee11073.h"
+#include "btle_measurements.h"
+
+// Compile-time schemas for flag driven characteristic values.
+//
+// A schema lists the fields of a value, in order, with the flag bit that
+// makes each optional field present. Decoding is a single pass without a
+// branch per field:
+// - the offset of every field is computed from the flags with a running
+//   sum, then the total size is checked once,
+// - every field is then read and stored unconditionally. An absent field
+//   reads zeros and stores into a scratch record, so the output record keeps
+//   the zero it was reset to.
+//
+// Only included by the files defining schemas.
+namespace btle {
+namespace schema {
+
+enum Format {
+  kUInt8,
+  kUInt16,
+  kSInt16,
+  kUInt24,
+  kSInt24,
+  kUInt32,
+  kSInt32,
+  kSFloat,
+  kFloat,
+  kDateTime,
+};
+
+template <Format kFormat>
+struct FormatSize;
+template <> struct FormatSize<kUInt8> { static const size_t value = 1; };
+template <> struct FormatSize<kUInt16> { static const size_t value = 2; };
+template <> struct FormatSize<kSInt16> { static const size_t value = 2; };
+template <> struct FormatSize<kUInt24> { static const size_t value = 3; };
+template <> struct FormatSize<kSInt24> { static const size_t value = 3; };
+template <> struct FormatSize<kUInt32> { static const size_t value = 4; };
+template <> struct FormatSize<kSInt32> { static const size_t value = 4; };
+template <> struct FormatSize<kSFloat> { static const size_t value = 2; };
+template <> struct FormatSize<kFloat> { static const size_t value = 4; };
+template <> struct FormatSize<kDateTime> { static const size_t value = 7; };
+
+// Largest field, in bytes: absent fields read that many zeros.
+const size_t kMaxFieldSize = 8;
+
+namespace internal {
+
+extern const UINT8 kZeros[kMaxFieldSize];
+
+inline
+UINT32 ReadUInt16(const UINT8* data) {
+  return data[0] | (data[1] << 8);
+}
+
+inline
+UINT32 ReadUInt24(const UINT8* data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16);
+}
+
+inline
+UINT32 ReadUInt32(const UINT8* data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<UINT32>(data[3]) << 24);
+}
+
+template <Format kFormat, typename T>
+inline
+void Read(const UINT8* data, T* value) {
+  if constexpr (kFormat == kUInt8) {
+    *value = static_cast<T>(data[0]);
+  } else if constexpr (kFormat == kUInt16) {
+    *value = static_cast<T>(ReadUInt16(data));
+  } else if constexpr (kFormat == kSInt16) {
+    *value = static_cast<T>(static_cast<INT16>(ReadUInt16(data)));
+  } else if constexpr (kFormat == kUInt24) {
+    *value = static_cast<T>(ReadUInt24(data));
+  } else if constexpr (kFormat == kSInt24) {
+    *value = static_cast<T>(static_cast<INT32>(ReadUInt24(data) << 8) >> 8);
+  } else if constexpr (kFormat == kUInt32) {
+    *value = static_cast<T>(ReadUInt32(data));
+  } else if constexpr (kFormat == kSInt32) {
+    *value = static_cast<T>(static_cast<INT32>(ReadUInt32(data)));
+  } else if constexpr (kFormat == kSFloat) {
+    *value = static_cast<T>(ieee11073::SFloatToDouble(static_cast<UINT16>(ReadUInt16(data))));
+  } else if constexpr (kFormat == kFloat) {
+    *value = static_cast<T>(ieee11073::FloatToDouble(ReadUInt32(data)));
+  } else if constexpr (kFormat == kDateTime) {
+    value->year = static_cast<UINT16>(ReadUInt16(data));
+    value->month = data[2];
+    value->day = data[3];
+    value->hours = data[4];
+    value->minutes = data[5];
+    value->seconds = data[6];
+  }
+}
+
+template <typename T>
+struct MemberTraits;
+
+template <typename R, typename T>
+struct MemberTraits<T R::*> {
+  typedef R Record;
+  typedef T Value;
+};
+
+}  // namespace internal
+
+//////////////////////////////////////////////////////////////////////////////
+// A field stored into "kMember". The field is always present when "kFlag" is
+// 0, otherwise it is present when the flag bit is set (or clear, with
+// "kWhenSet" false).
+//
+// Two fields may store into the same member when their flags exclude each
+// other, e.g. a value encoded on 8 or 16 bits depending on a flag.
+//
+template <auto kMember, Format kFormat, UINT32 kFlag = 0, bool kWhenSet = true>
+struct Field {
+  typedef typename internal::MemberTraits<decltype(kMember)>::Record Record;
+  static const size_t kSize = FormatSize<kFormat>::value;
+  static_assert(kSize <= kMaxFieldSize, "Field larger than kMaxFieldSize");
+
+  static size_t Present(UINT32 flags) {
+    if constexpr (kFlag == 0) {
+      return 1;
+    } else {
+      return ((flags & kFlag) != 0) == kWhenSet;
+    }
+  }
+
+  static void Store(const UINT8* data, Record* record) {
+    internal::Read<kFormat>(data, &(record->*kMember));
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Trailing list of 16-bit values filling the rest of the value when "kFlag"
+// is set. Values past the capacity of "kArray" are dropped.
+//
+template <auto kArray, auto kCount, UINT32 kFlag>
+struct TrailingUInt16 {
+  template <typename Record>
+  static void Store(UINT32 flags, const UINT8* data, size_t size, Record* record) {
+    const size_t capacity = sizeof(record->*kArray) / sizeof((record->*kArray)[0]);
+    size_t count = (flags & kFlag) ? size / 2 : 0;
+    if (count > capacity)
+      count = capacity;
+    record->*kCount = static_cast<typename internal::MemberTraits<decltype(kCount)>::Value>(count);
+    for (size_t i = 0; i < count; i++) {
+      (record->*kArray)[i] = static_cast<UINT16>(internal::ReadUInt16(data + 2 * i));
+    }
+  }
+};
+
+struct NoTrailing {
+  template <typename Record>
+  static void Store(UINT32, const UINT8*, size_t, Record*) {
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// A value made of a flags field ("kFlagsFormat", stored into
+// Record::flags), followed by "Fields" and an optional "Trailing" list.
+//
+template <typename Record, Format kFlagsFormat, typename Trailing, typename... Fields>
+class Schema {
+public:
+  static bool Decode(const UINT8* data, size_t size, Record* record, std::string* error) {
+    return Decode(data, size, record, error, std::index_sequence_for<Fields...>());
+  }
+
+private:
+  static const size_t kFlagsSize = FormatSize<kFlagsFormat>::value;
+
+  template <size_t... kIndex>
+  static bool Decode(const UINT8* data, size_t size, Record* record, std::string* error,
+                     std::index_sequence<kIndex...>) {
+    if (size < kFlagsSize) {
+      *error = "Value too short";
+      return false;
+    }
+
+    *record = Record();
+    internal::Read<kFlagsFormat>(data, &record->flags);
+    UINT32 flags = record->flags;
+
+    // Offsets of the fields, from the flags.
+    size_t present[sizeof...(Fields) + 1];
+    size_t offset[sizeof...(Fields) + 1];
+    size_t end = kFlagsSize;
+    ((present[kIndex] = Fields::Present(flags),
+      offset[kIndex] = end,
+      end += present[kIndex] * Fields::kSize), ...);
+    if (end > size) {
+      *error = "Value too short for its flags";
+      return false;
+    }
+
+    Record scratch;
+    ((Fields::Store(present[kIndex] ? data + offset[kIndex] : internal::kZeros,
+                    present[kIndex] ? record : &scratch)), ...);
+    Trailing::Store(flags, data + end, size - end, record);
+    return true;
+  }
+};
+
+}  // namespace schema
+}  // namespace btle
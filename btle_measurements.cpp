@@ -0,0 +1,223 @@
+#include "stdafx.h"
+
+#include <sstream>
+
+#include "btle_characteristics_def.h"
+#include "btle_measurement_schema.h"
+#include "btle_measurements.h"
+
+namespace btle {
+
+namespace schema {
+namespace internal {
+
+const UINT8 kZeros[kMaxFieldSize] = { 0 };
+
+}  // namespace internal
+}  // namespace schema
+
+namespace {
+
+using schema::Field;
+using schema::NoTrailing;
+using schema::Schema;
+using schema::TrailingUInt16;
+
+typedef HeartRateMeasurement HRM;
+typedef Schema<HRM, schema::kUInt8,
+               TrailingUInt16<&HRM::rr_intervals, &HRM::rr_interval_count, kHeartRateRrIntervals>,
+               Field<&HRM::heart_rate, schema::kUInt8, kHeartRateUInt16, false>,
+               Field<&HRM::heart_rate, schema::kUInt16, kHeartRateUInt16>,
+               Field<&HRM::energy_expended, schema::kUInt16, kHeartRateEnergyExpended>
+              > HeartRateSchema;
+
+typedef TemperatureMeasurement TM;
+typedef Schema<TM, schema::kUInt8, NoTrailing,
+               Field<&TM::temperature, schema::kFloat>,
+               Field<&TM::timestamp, schema::kDateTime, kTemperatureTimestamp>,
+               Field<&TM::temperature_type, schema::kUInt8, kTemperatureType>
+              > TemperatureSchema;
+
+typedef BloodPressureMeasurement BPM;
+typedef Schema<BPM, schema::kUInt8, NoTrailing,
+               Field<&BPM::systolic, schema::kSFloat>,
+               Field<&BPM::diastolic, schema::kSFloat>,
+               Field<&BPM::mean_arterial_pressure, schema::kSFloat>,
+               Field<&BPM::timestamp, schema::kDateTime, kBloodPressureTimestamp>,
+               Field<&BPM::pulse_rate, schema::kSFloat, kBloodPressurePulseRate>,
+               Field<&BPM::user_id, schema::kUInt8, kBloodPressureUserId>,
+               Field<&BPM::status, schema::kUInt16, kBloodPressureStatus>
+              > BloodPressureSchema;
+
+typedef CscMeasurement CSC;
+typedef Schema<CSC, schema::kUInt8, NoTrailing,
+               Field<&CSC::wheel_revolutions, schema::kUInt32, kCscWheelRevolutions>,
+               Field<&CSC::last_wheel_event_time, schema::kUInt16, kCscWheelRevolutions>,
+               Field<&CSC::crank_revolutions, schema::kUInt16, kCscCrankRevolutions>,
+               Field<&CSC::last_crank_event_time, schema::kUInt16, kCscCrankRevolutions>
+              > CscSchema;
+
+typedef RscMeasurement RSC;
+typedef Schema<RSC, schema::kUInt8, NoTrailing,
+               Field<&RSC::speed, schema::kUInt16>,
+               Field<&RSC::cadence, schema::kUInt8>,
+               Field<&RSC::stride_length, schema::kUInt16, kRscStrideLength>,
+               Field<&RSC::total_distance, schema::kUInt32, kRscTotalDistance>
+              > RscSchema;
+
+typedef CyclingPowerMeasurement CPM;
+typedef Schema<CPM, schema::kUInt16, NoTrailing,
+               Field<&CPM::power, schema::kSInt16>,
+               Field<&CPM::pedal_power_balance, schema::kUInt8, kCyclingPowerPedalBalance>,
+               Field<&CPM::accumulated_torque, schema::kUInt16, kCyclingPowerAccumulatedTorque>,
+               Field<&CPM::wheel_revolutions, schema::kUInt32, kCyclingPowerWheelRevolutions>,
+               Field<&CPM::last_wheel_event_time, schema::kUInt16, kCyclingPowerWheelRevolutions>,
+               Field<&CPM::crank_revolutions, schema::kUInt16, kCyclingPowerCrankRevolutions>,
+               Field<&CPM::last_crank_event_time, schema::kUInt16, kCyclingPowerCrankRevolutions>,
+               Field<&CPM::max_force, schema::kSInt16, kCyclingPowerExtremeForces>,
+               Field<&CPM::min_force, schema::kSInt16, kCyclingPowerExtremeForces>,
+               Field<&CPM::max_torque, schema::kSInt16, kCyclingPowerExtremeTorques>,
+               Field<&CPM::min_torque, schema::kSInt16, kCyclingPowerExtremeTorques>,
+               Field<&CPM::extreme_angles, schema::kUInt24, kCyclingPowerExtremeAngles>,
+               Field<&CPM::top_dead_spot_angle, schema::kUInt16, kCyclingPowerTopDeadSpotAngle>,
+               Field<&CPM::bottom_dead_spot_angle, schema::kUInt16, kCyclingPowerBottomDeadSpotAngle>,
+               Field<&CPM::accumulated_energy, schema::kUInt16, kCyclingPowerAccumulatedEnergy>
+              > CyclingPowerSchema;
+
+typedef LocationAndSpeed LNS;
+typedef Schema<LNS, schema::kUInt16, NoTrailing,
+               Field<&LNS::speed, schema::kUInt16, kLocationSpeed>,
+               Field<&LNS::total_distance, schema::kUInt24, kLocationTotalDistance>,
+               Field<&LNS::latitude, schema::kSInt32, kLocationLocation>,
+               Field<&LNS::longitude, schema::kSInt32, kLocationLocation>,
+               Field<&LNS::elevation, schema::kSInt24, kLocationElevation>,
+               Field<&LNS::heading, schema::kUInt16, kLocationHeading>,
+               Field<&LNS::rolling_time, schema::kUInt8, kLocationRollingTime>,
+               Field<&LNS::utc_time, schema::kDateTime, kLocationUtcTime>
+              > LocationAndSpeedSchema;
+
+void AppendDateTime(std::ostream& stream, const DateTime& value) {
+  stream << value.year << "-" << static_cast<int>(value.month) << "-" << static_cast<int>(value.day) << " "
+         << static_cast<int>(value.hours) << ":" << static_cast<int>(value.minutes) << ":" << static_cast<int>(value.seconds);
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool DecodeHeartRateMeasurement(const UINT8* data, size_t size, HeartRateMeasurement* measurement, std::string* error) {
+  return HeartRateSchema::Decode(data, size, measurement, error);
+}
+
+bool DecodeTemperatureMeasurement(const UINT8* data, size_t size, TemperatureMeasurement* measurement, std::string* error) {
+  return TemperatureSchema::Decode(data, size, measurement, error);
+}
+
+bool DecodeBloodPressureMeasurement(const UINT8* data, size_t size, BloodPressureMeasurement* measurement, std::string* error) {
+  return BloodPressureSchema::Decode(data, size, measurement, error);
+}
+
+bool DecodeCscMeasurement(const UINT8* data, size_t size, CscMeasurement* measurement, std::string* error) {
+  return CscSchema::Decode(data, size, measurement, error);
+}
+
+bool DecodeRscMeasurement(const UINT8* data, size_t size, RscMeasurement* measurement, std::string* error) {
+  return RscSchema::Decode(data, size, measurement, error);
+}
+
+bool DecodeCyclingPowerMeasurement(const UINT8* data, size_t size, CyclingPowerMeasurement* measurement, std::string* error) {
+  return CyclingPowerSchema::Decode(data, size, measurement, error);
+}
+
+bool DecodeLocationAndSpeed(const UINT8* data, size_t size, LocationAndSpeed* measurement, std::string* error) {
+  return LocationAndSpeedSchema::Decode(data, size, measurement, error);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool DescribeMeasurement(USHORT characteristic_uuid, const UINT8* data, size_t size, std::string* text) {
+  std::string error;
+  std::ostringstream stream;
+
+  if (characteristic_uuid == Heart_Rate_Measurement) {
+    HeartRateMeasurement value;
+    if (!DecodeHeartRateMeasurement(data, size, &value, &error))
+      return false;
+    stream << "Heart rate: " << value.heart_rate << " bpm";
+    if (value.flags & kHeartRateEnergyExpended)
+      stream << ", Energy expended: " << value.energy_expended << " kJ";
+    for (int i = 0; i < value.rr_interval_count; i++)
+      stream << (i == 0 ? ", RR intervals: " : " ") << value.rr_intervals[i] * 1000 / 1024 << " ms";
+  } else if (characteristic_uuid == Temperature_Measurement || characteristic_uuid == Intermediate_Temperature) {
+    TemperatureMeasurement value;
+    if (!DecodeTemperatureMeasurement(data, size, &value, &error))
+      return false;
+    stream << "Temperature: " << value.temperature << ((value.flags & kTemperatureFahrenheit) ? " F" : " C");
+    if (value.flags & kTemperatureTimestamp) {
+      stream << ", Time: ";
+      AppendDateTime(stream, value.timestamp);
+    }
+    if (value.flags & kTemperatureType)
+      stream << ", Type: " << static_cast<int>(value.temperature_type);
+  } else if (characteristic_uuid == Blood_Pressure_Measurement || characteristic_uuid == Intermediate_Cuff_Pressure) {
+    BloodPressureMeasurement value;
+    if (!DecodeBloodPressureMeasurement(data, size, &value, &error))
+      return false;
+    const char* unit = (value.flags & kBloodPressureKpa) ? " kPa" : " mmHg";
+    stream << "Systolic: " << value.systolic << unit
+           << ", Diastolic: " << value.diastolic << unit
+           << ", Mean arterial pressure: " << value.mean_arterial_pressure << unit;
+    if (value.flags & kBloodPressureTimestamp) {
+      stream << ", Time: ";
+      AppendDateTime(stream, value.timestamp);
+    }
+    if (value.flags & kBloodPressurePulseRate)
+      stream << ", Pulse rate: " << value.pulse_rate << " bpm";
+    if (value.flags & kBloodPressureUserId)
+      stream << ", User: " << static_cast<int>(value.user_id);
+  } else if (characteristic_uuid == CSC_Measurement) {
+    CscMeasurement value;
+    if (!DecodeCscMeasurement(data, size, &value, &error))
+      return false;
+    stream << "Wheel revolutions: " << value.wheel_revolutions
+           << ", Crank revolutions: " << value.crank_revolutions;
+  } else if (characteristic_uuid == RSC_Measurement) {
+    RscMeasurement value;
+    if (!DecodeRscMeasurement(data, size, &value, &error))
+      return false;
+    stream << "Speed: " << value.speed / 256.0 << " m/s, Cadence: " << static_cast<int>(value.cadence) << " spm";
+    if (value.flags & kRscStrideLength)
+      stream << ", Stride length: " << value.stride_length << " cm";
+    if (value.flags & kRscTotalDistance)
+      stream << ", Total distance: " << value.total_distance / 10.0 << " m";
+  } else if (characteristic_uuid == Cycling_Power_Measurement) {
+    CyclingPowerMeasurement value;
+    if (!DecodeCyclingPowerMeasurement(data, size, &value, &error))
+      return false;
+    stream << "Power: " << value.power << " W";
+    if (value.flags & kCyclingPowerCrankRevolutions)
+      stream << ", Crank revolutions: " << value.crank_revolutions;
+    if (value.flags & kCyclingPowerAccumulatedEnergy)
+      stream << ", Accumulated energy: " << value.accumulated_energy << " kJ";
+  } else if (characteristic_uuid == Location_and_Speed) {
+    LocationAndSpeed value;
+    if (!DecodeLocationAndSpeed(data, size, &value, &error))
+      return false;
+    stream << "Flags: 0x" << std::hex << value.flags << std::dec;
+    if (value.flags & kLocationSpeed)
+      stream << ", Speed: " << value.speed / 100.0 << " m/s";
+    if (value.flags & kLocationLocation)
+      stream << ", Location: " << value.latitude / 1e7 << ", " << value.longitude / 1e7;
+    if (value.flags & kLocationElevation)
+      stream << ", Elevation: " << value.elevation / 100.0 << " m";
+  } else {
+    return false;
+  }
+
+  *text = stream.str();
+  return true;
+}
+
+}  // namespace btle
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <string>
+
+#include "base.h"
+
+// Decoders for the flag driven measurement characteristics of the Bluetooth
+// SIG profiles. Each decoder resets and fills a caller provided record, so a
+// record can be reused for every notification of a characteristic.
+//
+// Fields whose flag bit is clear are left to zero. Units are those of the
+// specification of each characteristic, noted next to the fields.
+// See https://developer.bluetooth.org/gatt/characteristics/Pages/CharacteristicsHome.aspx
+namespace btle {
+
+struct DateTime {
+  UINT16 year;
+  UINT8 month;
+  UINT8 day;
+  UINT8 hours;
+  UINT8 minutes;
+  UINT8 seconds;
+};
+
+// "Heart_Rate_Measurement"
+enum HeartRateFlags {
+  kHeartRateUInt16 = 0x01,
+  kHeartRateContactDetected = 0x02,
+  kHeartRateContactSupported = 0x04,
+  kHeartRateEnergyExpended = 0x08,
+  kHeartRateRrIntervals = 0x10,
+};
+
+const size_t kMaxRrIntervals = 32;
+
+struct HeartRateMeasurement {
+  UINT16 flags;
+  // Beats per minute.
+  UINT16 heart_rate;
+  // Kilo Joules.
+  UINT16 energy_expended;
+  // 1/1024 second.
+  UINT8 rr_interval_count;
+  UINT16 rr_intervals[kMaxRrIntervals];
+};
+
+// "Temperature_Measurement" and "Intermediate_Temperature"
+enum TemperatureFlags {
+  kTemperatureFahrenheit = 0x01,
+  kTemperatureTimestamp = 0x02,
+  kTemperatureType = 0x04,
+};
+
+struct TemperatureMeasurement {
+  UINT16 flags;
+  // Celsius or Fahrenheit (kTemperatureFahrenheit).
+  double temperature;
+  DateTime timestamp;
+  UINT8 temperature_type;
+};
+
+// "Blood_Pressure_Measurement" and "Intermediate_Cuff_Pressure"
+enum BloodPressureFlags {
+  kBloodPressureKpa = 0x01,
+  kBloodPressureTimestamp = 0x02,
+  kBloodPressurePulseRate = 0x04,
+  kBloodPressureUserId = 0x08,
+  kBloodPressureStatus = 0x10,
+};
+
+struct BloodPressureMeasurement {
+  UINT16 flags;
+  // mmHg or kPa (kBloodPressureKpa).
+  double systolic;
+  double diastolic;
+  double mean_arterial_pressure;
+  DateTime timestamp;
+  // Beats per minute.
+  double pulse_rate;
+  UINT8 user_id;
+  UINT16 status;
+};
+
+// "CSC_Measurement"
+enum CscFlags {
+  kCscWheelRevolutions = 0x01,
+  kCscCrankRevolutions = 0x02,
+};
+
+struct CscMeasurement {
+  UINT16 flags;
+  UINT32 wheel_revolutions;
+  // 1/1024 second.
+  UINT16 last_wheel_event_time;
+  UINT16 crank_revolutions;
+  // 1/1024 second.
+  UINT16 last_crank_event_time;
+};
+
+// "RSC_Measurement"
+enum RscFlags {
+  kRscStrideLength = 0x01,
+  kRscTotalDistance = 0x02,
+  kRscRunning = 0x04,
+};
+
+struct RscMeasurement {
+  UINT16 flags;
+  // 1/256 meter per second.
+  UINT16 speed;
+  // Steps per minute.
+  UINT8 cadence;
+  // Centimeters.
+  UINT16 stride_length;
+  // Decimeters.
+  UINT32 total_distance;
+};
+
+// "Cycling_Power_Measurement"
+enum CyclingPowerFlags {
+  kCyclingPowerPedalBalance = 0x0001,
+  kCyclingPowerPedalBalanceLeft = 0x0002,
+  kCyclingPowerAccumulatedTorque = 0x0004,
+  kCyclingPowerTorqueFromCrank = 0x0008,
+  kCyclingPowerWheelRevolutions = 0x0010,
+  kCyclingPowerCrankRevolutions = 0x0020,
+  kCyclingPowerExtremeForces = 0x0040,
+  kCyclingPowerExtremeTorques = 0x0080,
+  kCyclingPowerExtremeAngles = 0x0100,
+  kCyclingPowerTopDeadSpotAngle = 0x0200,
+  kCyclingPowerBottomDeadSpotAngle = 0x0400,
+  kCyclingPowerAccumulatedEnergy = 0x0800,
+  kCyclingPowerOffsetCompensation = 0x1000,
+};
+
+struct CyclingPowerMeasurement {
+  UINT16 flags;
+  // Watts.
+  INT16 power;
+  // 1/2 percent.
+  UINT8 pedal_power_balance;
+  // 1/32 Newton meter.
+  UINT16 accumulated_torque;
+  UINT32 wheel_revolutions;
+  // 1/2048 second.
+  UINT16 last_wheel_event_time;
+  UINT16 crank_revolutions;
+  // 1/1024 second.
+  UINT16 last_crank_event_time;
+  // Newtons.
+  INT16 max_force;
+  INT16 min_force;
+  // 1/32 Newton meter.
+  INT16 max_torque;
+  INT16 min_torque;
+  // Maximum (low 12 bits) and minimum (high 12 bits) angles, in degrees.
+  UINT32 extreme_angles;
+  // Degrees.
+  UINT16 top_dead_spot_angle;
+  UINT16 bottom_dead_spot_angle;
+  // Kilo Joules.
+  UINT16 accumulated_energy;
+
+  UINT16 max_angle() const { return static_cast<UINT16>(extreme_angles & 0xfff); }
+  UINT16 min_angle() const { return static_cast<UINT16>(extreme_angles >> 12); }
+};
+
+// "Location_and_Speed"
+enum LocationAndSpeedFlags {
+  kLocationSpeed = 0x0001,
+  kLocationTotalDistance = 0x0002,
+  kLocationLocation = 0x0004,
+  kLocationElevation = 0x0008,
+  kLocationHeading = 0x0010,
+  kLocationRollingTime = 0x0020,
+  kLocationUtcTime = 0x0040,
+};
+
+struct LocationAndSpeed {
+  UINT16 flags;
+  // 1/100 meter per second.
+  UINT16 speed;
+  // Decimeters.
+  UINT32 total_distance;
+  // 1/10^7 degree.
+  INT32 latitude;
+  INT32 longitude;
+  // Centimeters.
+  INT32 elevation;
+  // 1/100 degree.
+  UINT16 heading;
+  // Seconds.
+  UINT8 rolling_time;
+  DateTime utc_time;
+};
+
+bool DecodeHeartRateMeasurement(const UINT8* data, size_t size, HeartRateMeasurement* measurement, std::string* error);
+bool DecodeTemperatureMeasurement(const UINT8* data, size_t size, TemperatureMeasurement* measurement, std::string* error);
+bool DecodeBloodPressureMeasurement(const UINT8* data, size_t size, BloodPressureMeasurement* measurement, std::string* error);
+bool DecodeCscMeasurement(const UINT8* data, size_t size, CscMeasurement* measurement, std::string* error);
+bool DecodeRscMeasurement(const UINT8* data, size_t size, RscMeasurement* measurement, std::string* error);
+bool DecodeCyclingPowerMeasurement(const UINT8* data, size_t size, CyclingPowerMeasurement* measurement, std::string* error);
+bool DecodeLocationAndSpeed(const UINT8* data, size_t size, LocationAndSpeed* measurement, std::string* error);
+
+// Decodes a value of one of the characteristics above, identified by its
+// short uuid, into a readable string. Returns false for other
+// characteristics, or invalid values.
+bool DescribeMeasurement(USHORT characteristic_uuid, const UINT8* data, size_t size, std::string* text);
+
+}  // namespace btle
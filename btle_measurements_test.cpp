@@ -0,0 +1,278 @@
+#include "stdafx.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "btle_measurements.h"
+#include "btle_test.h"
+
+namespace {
+
+// Within rounding of the decimal value an SFLOAT or FLOAT encodes.
+bool Near(double expected, double actual) {
+  return fabs(expected - actual) <= 1e-9 * (1.0 + fabs(expected));
+}
+
+// Every prefix of "data" shorter than "size" fails to decode, with an error.
+template<typename T>
+int CountTruncatedDecoded(bool (*decode)(const UINT8* data, size_t size, T* measurement, std::string* error),
+                          const UINT8* data, size_t size) {
+  int decoded = 0;
+  for (size_t length = 0; length < size; length++) {
+    std::vector<UINT8> prefix(data, data + length);
+    T measurement;
+    std::string error;
+    if (decode(prefix.data(), prefix.size(), &measurement, &error) || error.empty())
+      decoded++;
+  }
+  return decoded;
+}
+
+}  // namespace
+
+BTLE_TEST(measurements, HeartRate) {
+  btle::HeartRateMeasurement measurement;
+  std::string error;
+
+  // 8-bit rate only.
+  const UINT8 rate8[] = { 0x00, 72 };
+  BTLE_EXPECT(btle::DecodeHeartRateMeasurement(rate8, sizeof(rate8), &measurement, &error));
+  BTLE_EXPECT_EQ(72, measurement.heart_rate);
+  BTLE_EXPECT_EQ(0, measurement.energy_expended);
+  BTLE_EXPECT_EQ(0, measurement.rr_interval_count);
+
+  // 16-bit rate: the 8-bit field, present when the flag is clear, is gone.
+  const UINT8 rate16[] = { 0x01, 0x2c, 0x01 };
+  BTLE_EXPECT(btle::DecodeHeartRateMeasurement(rate16, sizeof(rate16), &measurement, &error));
+  BTLE_EXPECT_EQ(300, measurement.heart_rate);
+
+  // Energy expended after an 8-bit rate, then after a 16-bit rate.
+  const UINT8 energy8[] = { 0x08, 70, 0x10, 0x00 };
+  BTLE_EXPECT(btle::DecodeHeartRateMeasurement(energy8, sizeof(energy8), &measurement, &error));
+  BTLE_EXPECT_EQ(70, measurement.heart_rate);
+  BTLE_EXPECT_EQ(16, measurement.energy_expended);
+  const UINT8 energy16[] = { 0x09, 0x50, 0x00, 0x20, 0x00 };
+  BTLE_EXPECT(btle::DecodeHeartRateMeasurement(energy16, sizeof(energy16), &measurement, &error));
+  BTLE_EXPECT_EQ(80, measurement.heart_rate);
+  BTLE_EXPECT_EQ(32, measurement.energy_expended);
+}
+
+// RR intervals fill the rest of the value: an odd trailing byte is ignored,
+// and intervals past kMaxRrIntervals are dropped.
+BTLE_TEST(measurements, HeartRateRrIntervals) {
+  btle::HeartRateMeasurement measurement;
+  std::string error;
+
+  const UINT8 intervals[] = { 0x19, 0x50, 0x00, 0x10, 0x00, 0x00, 0x04, 0x00, 0x02, 0xff };
+  BTLE_EXPECT(btle::DecodeHeartRateMeasurement(intervals, sizeof(intervals), &measurement, &error));
+  BTLE_EXPECT_EQ(80, measurement.heart_rate);
+  BTLE_EXPECT_EQ(16, measurement.energy_expended);
+  BTLE_EXPECT_EQ(2, measurement.rr_interval_count);
+  BTLE_EXPECT_EQ(1024, measurement.rr_intervals[0]);
+  BTLE_EXPECT_EQ(512, measurement.rr_intervals[1]);
+
+  // Without the flag, trailing bytes are not intervals.
+  const UINT8 no_flag[] = { 0x00, 60, 0x00, 0x04 };
+  BTLE_EXPECT(btle::DecodeHeartRateMeasurement(no_flag, sizeof(no_flag), &measurement, &error));
+  BTLE_EXPECT_EQ(0, measurement.rr_interval_count);
+
+  std::vector<UINT8> many;
+  many.push_back(0x10);
+  many.push_back(60);
+  for (size_t i = 0; i < btle::kMaxRrIntervals + 8; i++) {
+    many.push_back(static_cast<UINT8>(i));
+    many.push_back(0x03);
+  }
+  BTLE_EXPECT(btle::DecodeHeartRateMeasurement(many.data(), many.size(), &measurement, &error));
+  BTLE_EXPECT_EQ(btle::kMaxRrIntervals, static_cast<size_t>(measurement.rr_interval_count));
+  BTLE_EXPECT_EQ(0x031f, measurement.rr_intervals[btle::kMaxRrIntervals - 1]);
+}
+
+BTLE_TEST(measurements, Temperature) {
+  btle::TemperatureMeasurement measurement;
+  std::string error;
+
+  // 36.7 C: mantissa 367, exponent -1.
+  const UINT8 minimal[] = { 0x00, 0x6f, 0x01, 0x00, 0xff };
+  BTLE_EXPECT(btle::DecodeTemperatureMeasurement(minimal, sizeof(minimal), &measurement, &error));
+  BTLE_EXPECT(Near(36.7, measurement.temperature));
+  BTLE_EXPECT_EQ(0, measurement.temperature_type);
+
+  // Temperature type without a time stamp comes right after the value.
+  const UINT8 type_only[] = { 0x04, 0x6f, 0x01, 0x00, 0xff, 0x02 };
+  BTLE_EXPECT(btle::DecodeTemperatureMeasurement(type_only, sizeof(type_only), &measurement, &error));
+  BTLE_EXPECT_EQ(2, measurement.temperature_type);
+  BTLE_EXPECT_EQ(0, measurement.timestamp.year);
+
+  // 98.6 F, time stamp and type.
+  const UINT8 full[] = { 0x07, 0xda, 0x03, 0x00, 0xff, 0xde, 0x07, 0x0c, 0x1f, 0x17, 0x3b, 0x3a, 0x03 };
+  BTLE_EXPECT(btle::DecodeTemperatureMeasurement(full, sizeof(full), &measurement, &error));
+  BTLE_EXPECT(Near(98.6, measurement.temperature));
+  BTLE_EXPECT_EQ(btle::kTemperatureFahrenheit, measurement.flags & btle::kTemperatureFahrenheit);
+  BTLE_EXPECT_EQ(2014, measurement.timestamp.year);
+  BTLE_EXPECT_EQ(12, measurement.timestamp.month);
+  BTLE_EXPECT_EQ(31, measurement.timestamp.day);
+  BTLE_EXPECT_EQ(23, measurement.timestamp.hours);
+  BTLE_EXPECT_EQ(59, measurement.timestamp.minutes);
+  BTLE_EXPECT_EQ(58, measurement.timestamp.seconds);
+  BTLE_EXPECT_EQ(3, measurement.temperature_type);
+}
+
+BTLE_TEST(measurements, BloodPressure) {
+  btle::BloodPressureMeasurement measurement;
+  std::string error;
+
+  const UINT8 minimal[] = { 0x00, 0x78, 0x00, 0x50, 0x00, 0x5d, 0x00 };
+  BTLE_EXPECT(btle::DecodeBloodPressureMeasurement(minimal, sizeof(minimal), &measurement, &error));
+  BTLE_EXPECT(Near(120.0, measurement.systolic));
+  BTLE_EXPECT(Near(80.0, measurement.diastolic));
+  BTLE_EXPECT(Near(93.0, measurement.mean_arterial_pressure));
+
+  // kPa (exponent -1), pulse rate, user id and status, no time stamp.
+  const UINT8 kpa[] = { 0x1d, 0xa0, 0xf0, 0x6b, 0xf0, 0x7c, 0xf0, 0x48, 0x00, 0x05, 0x01, 0x02 };
+  BTLE_EXPECT(btle::DecodeBloodPressureMeasurement(kpa, sizeof(kpa), &measurement, &error));
+  BTLE_EXPECT(Near(16.0, measurement.systolic));
+  BTLE_EXPECT(Near(10.7, measurement.diastolic));
+  BTLE_EXPECT(Near(12.4, measurement.mean_arterial_pressure));
+  BTLE_EXPECT(Near(72.0, measurement.pulse_rate));
+  BTLE_EXPECT_EQ(5, measurement.user_id);
+  BTLE_EXPECT_EQ(0x0201, measurement.status);
+
+  const UINT8 timestamp[] = { 0x02, 0x78, 0x00, 0x50, 0x00, 0x5d, 0x00, 0xdf, 0x07, 0x01, 0x02, 0x03, 0x04, 0x05 };
+  BTLE_EXPECT(btle::DecodeBloodPressureMeasurement(timestamp, sizeof(timestamp), &measurement, &error));
+  BTLE_EXPECT_EQ(2015, measurement.timestamp.year);
+  BTLE_EXPECT_EQ(5, measurement.timestamp.seconds);
+}
+
+// Absent fields are zero, even when the record held a value before.
+BTLE_TEST(measurements, AbsentFieldsAreZero) {
+  btle::BloodPressureMeasurement measurement;
+  std::string error;
+  const UINT8 full[] = { 0x1e, 0x78, 0x00, 0x50, 0x00, 0x5d, 0x00, 0xdf, 0x07, 0x01, 0x02, 0x03, 0x04, 0x05, 0x48, 0x00, 0x05, 0x01, 0x02 };
+  BTLE_EXPECT(btle::DecodeBloodPressureMeasurement(full, sizeof(full), &measurement, &error));
+  BTLE_EXPECT_EQ(2015, measurement.timestamp.year);
+  BTLE_EXPECT(Near(72.0, measurement.pulse_rate));
+
+  const UINT8 minimal[] = { 0x00, 0x78, 0x00, 0x50, 0x00, 0x5d, 0x00 };
+  BTLE_EXPECT(btle::DecodeBloodPressureMeasurement(minimal, sizeof(minimal), &measurement, &error));
+  BTLE_EXPECT_EQ(0, measurement.timestamp.year);
+  BTLE_EXPECT_EQ(0, measurement.timestamp.seconds);
+  BTLE_EXPECT_EQ(0.0, measurement.pulse_rate);
+  BTLE_EXPECT_EQ(0, measurement.user_id);
+  BTLE_EXPECT_EQ(0, measurement.status);
+}
+
+BTLE_TEST(measurements, Csc) {
+  btle::CscMeasurement measurement;
+  std::string error;
+
+  const UINT8 wheel[] = { 0x01, 0x10, 0x00, 0x01, 0x00, 0x00, 0x04 };
+  BTLE_EXPECT(btle::DecodeCscMeasurement(wheel, sizeof(wheel), &measurement, &error));
+  BTLE_EXPECT_EQ(0x10010u, measurement.wheel_revolutions);
+  BTLE_EXPECT_EQ(1024, measurement.last_wheel_event_time);
+  BTLE_EXPECT_EQ(0, measurement.crank_revolutions);
+
+  // Crank data right after the flags when there is no wheel data.
+  const UINT8 crank[] = { 0x02, 0x20, 0x00, 0x00, 0x08 };
+  BTLE_EXPECT(btle::DecodeCscMeasurement(crank, sizeof(crank), &measurement, &error));
+  BTLE_EXPECT_EQ(0u, measurement.wheel_revolutions);
+  BTLE_EXPECT_EQ(32, measurement.crank_revolutions);
+  BTLE_EXPECT_EQ(2048, measurement.last_crank_event_time);
+
+  const UINT8 both[] = { 0x03, 0x10, 0x00, 0x00, 0x00, 0x00, 0x04, 0x20, 0x00, 0x00, 0x08 };
+  BTLE_EXPECT(btle::DecodeCscMeasurement(both, sizeof(both), &measurement, &error));
+  BTLE_EXPECT_EQ(16u, measurement.wheel_revolutions);
+  BTLE_EXPECT_EQ(1024, measurement.last_wheel_event_time);
+  BTLE_EXPECT_EQ(32, measurement.crank_revolutions);
+  BTLE_EXPECT_EQ(2048, measurement.last_crank_event_time);
+}
+
+BTLE_TEST(measurements, Rsc) {
+  btle::RscMeasurement measurement;
+  std::string error;
+
+  const UINT8 minimal[] = { 0x04, 0x00, 0x02, 0x5a };
+  BTLE_EXPECT(btle::DecodeRscMeasurement(minimal, sizeof(minimal), &measurement, &error));
+  BTLE_EXPECT_EQ(512, measurement.speed);
+  BTLE_EXPECT_EQ(90, measurement.cadence);
+  BTLE_EXPECT_EQ(0, measurement.stride_length);
+
+  // Total distance without stride length.
+  const UINT8 distance[] = { 0x02, 0x00, 0x02, 0x5a, 0x10, 0x27, 0x00, 0x00 };
+  BTLE_EXPECT(btle::DecodeRscMeasurement(distance, sizeof(distance), &measurement, &error));
+  BTLE_EXPECT_EQ(0, measurement.stride_length);
+  BTLE_EXPECT_EQ(10000u, measurement.total_distance);
+
+  const UINT8 full[] = { 0x07, 0x00, 0x02, 0x5a, 0x64, 0x00, 0x10, 0x27, 0x00, 0x00 };
+  BTLE_EXPECT(btle::DecodeRscMeasurement(full, sizeof(full), &measurement, &error));
+  BTLE_EXPECT_EQ(100, measurement.stride_length);
+  BTLE_EXPECT_EQ(10000u, measurement.total_distance);
+}
+
+BTLE_TEST(measurements, CyclingPower) {
+  btle::CyclingPowerMeasurement measurement;
+  std::string error;
+
+  // Signed power.
+  const UINT8 minimal[] = { 0x00, 0x00, 0xfb, 0xff };
+  BTLE_EXPECT(btle::DecodeCyclingPowerMeasurement(minimal, sizeof(minimal), &measurement, &error));
+  BTLE_EXPECT_EQ(-5, measurement.power);
+
+  // Pedal balance, crank revolutions, extreme forces and angles.
+  const UINT8 full[] = { 0x61, 0x01, 0xfa, 0x00, 0x64, 0x10, 0x00, 0x00, 0x04, 0xe8, 0x03, 0x38, 0xff, 0x23, 0x61, 0x45 };
+  BTLE_EXPECT(btle::DecodeCyclingPowerMeasurement(full, sizeof(full), &measurement, &error));
+  BTLE_EXPECT_EQ(250, measurement.power);
+  BTLE_EXPECT_EQ(100, measurement.pedal_power_balance);
+  BTLE_EXPECT_EQ(0, measurement.accumulated_torque);
+  BTLE_EXPECT_EQ(0u, measurement.wheel_revolutions);
+  BTLE_EXPECT_EQ(16, measurement.crank_revolutions);
+  BTLE_EXPECT_EQ(1024, measurement.last_crank_event_time);
+  BTLE_EXPECT_EQ(1000, measurement.max_force);
+  BTLE_EXPECT_EQ(-200, measurement.min_force);
+  BTLE_EXPECT_EQ(0x123, measurement.max_angle());
+  BTLE_EXPECT_EQ(0x456, measurement.min_angle());
+  BTLE_EXPECT_EQ(0, measurement.accumulated_energy);
+}
+
+BTLE_TEST(measurements, LocationAndSpeed) {
+  btle::LocationAndSpeed measurement;
+  std::string error;
+
+  // Signed location and elevation, without speed or distance.
+  const UINT8 location[] = { 0x0c, 0x00, 0x40, 0xe2, 0x01, 0x00, 0xc0, 0x1d, 0xfe, 0xff, 0x9c, 0xff, 0xff };
+  BTLE_EXPECT(btle::DecodeLocationAndSpeed(location, sizeof(location), &measurement, &error));
+  BTLE_EXPECT_EQ(0, measurement.speed);
+  BTLE_EXPECT_EQ(123456, measurement.latitude);
+  BTLE_EXPECT_EQ(-123456, measurement.longitude);
+  BTLE_EXPECT_EQ(-100, measurement.elevation);
+
+  const UINT8 full[] = { 0x73, 0x00, 0x00, 0x02, 0x10, 0x27, 0x00, 0x10, 0x27, 0x3c,
+                         0xdf, 0x07, 0x06, 0x0f, 0x0c, 0x1e, 0x00 };
+  BTLE_EXPECT(btle::DecodeLocationAndSpeed(full, sizeof(full), &measurement, &error));
+  BTLE_EXPECT_EQ(512, measurement.speed);
+  BTLE_EXPECT_EQ(10000u, measurement.total_distance);
+  BTLE_EXPECT_EQ(0, measurement.latitude);
+  BTLE_EXPECT_EQ(10000, measurement.heading);
+  BTLE_EXPECT_EQ(60, measurement.rolling_time);
+  BTLE_EXPECT_EQ(2015, measurement.utc_time.year);
+  BTLE_EXPECT_EQ(30, measurement.utc_time.minutes);
+}
+
+// Values shorter than their flags require fail with an error.
+BTLE_TEST(measurements, Truncated) {
+  const UINT8 heart_rate[] = { 0x09, 0x50, 0x00, 0x10, 0x00 };
+  BTLE_EXPECT_EQ(0, CountTruncatedDecoded(&btle::DecodeHeartRateMeasurement, heart_rate, sizeof(heart_rate)));
+  const UINT8 temperature[] = { 0x07, 0xda, 0x03, 0x00, 0xff, 0xde, 0x07, 0x0c, 0x1f, 0x17, 0x3b, 0x3a, 0x03 };
+  BTLE_EXPECT_EQ(0, CountTruncatedDecoded(&btle::DecodeTemperatureMeasurement, temperature, sizeof(temperature)));
+  const UINT8 blood_pressure[] = { 0x1e, 0x78, 0x00, 0x50, 0x00, 0x5d, 0x00, 0xdf, 0x07, 0x01, 0x02, 0x03, 0x04, 0x05, 0x48, 0x00, 0x05, 0x01, 0x02 };
+  BTLE_EXPECT_EQ(0, CountTruncatedDecoded(&btle::DecodeBloodPressureMeasurement, blood_pressure, sizeof(blood_pressure)));
+  const UINT8 csc[] = { 0x03, 0x10, 0x00, 0x00, 0x00, 0x00, 0x04, 0x20, 0x00, 0x00, 0x08 };
+  BTLE_EXPECT_EQ(0, CountTruncatedDecoded(&btle::DecodeCscMeasurement, csc, sizeof(csc)));
+  const UINT8 rsc[] = { 0x07, 0x00, 0x02, 0x5a, 0x64, 0x00, 0x10, 0x27, 0x00, 0x00 };
+  BTLE_EXPECT_EQ(0, CountTruncatedDecoded(&btle::DecodeRscMeasurement, rsc, sizeof(rsc)));
+  const UINT8 cycling_power[] = { 0x61, 0x01, 0xfa, 0x00, 0x64, 0x10, 0x00, 0x00, 0x04, 0xe8, 0x03, 0x38, 0xff, 0x23, 0x61, 0x45 };
+  BTLE_EXPECT_EQ(0, CountTruncatedDecoded(&btle::DecodeCyclingPowerMeasurement, cycling_power, sizeof(cycling_power)));
+  const UINT8 location[] = { 0x0c, 0x00, 0x40, 0xe2, 0x01, 0x00, 0xc0, 0x1d, 0xfe, 0xff, 0x9c, 0xff, 0xff };
+  BTLE_EXPECT_EQ(0, CountTruncatedDecoded(&btle::DecodeLocationAndSpeed, location, sizeof(location)));
+}
@@ -0,0 +1,495 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "btle_oad.h"
+
+namespace btle {
+namespace oad {
+
+namespace {
+
+USHORT Crc16(USHORT crc, UINT8 value) {
+  const USHORT poly = 0x1021;
+  for (int i = 0; i < 8; i++, value <<= 1) {
+    bool msb = (crc & 0x8000) != 0;
+    crc <<= 1;
+    if (value & 0x80)
+      crc |= 0x0001;
+    if (msb)
+      crc ^= poly;
+  }
+  return crc;
+}
+
+USHORT ReadBlockIndex(const UINT8* payload) {
+  return static_cast<USHORT>(payload[0] | (payload[1] << 8));
+}
+
+}  // namespace
+
+USHORT ComputeImageCrc(const UINT8* data, size_t size) {
+  USHORT crc = 0;
+  for (size_t i = 4; i < size; i++) {
+    crc = Crc16(crc, data[i]);
+  }
+  crc = Crc16(crc, 0);
+  crc = Crc16(crc, 0);
+  return crc;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool Image::LoadFromBuffer(const UINT8* data, size_t size, scoped_refptr<Image>* image, std::string* error) {
+  if (size < kBlockSize) {
+    *error = "OAD image is too small to contain an image header.";
+    return false;
+  }
+
+  size_t length = static_cast<size_t>(data[6] | (data[7] << 8)) * kFlashWordSize;
+  if (length == 0 || length > size) {
+    std::ostringstream string_stream;
+    string_stream << "OAD image header length (" << length << " bytes) does not match image size (" << size << " bytes).";
+    *error = string_stream.str();
+    return false;
+  }
+
+  if (length % kBlockSize != 0 || length / kBlockSize > 0xffff) {
+    std::ostringstream string_stream;
+    string_stream << "OAD image length (" << length << " bytes) is not a valid number of blocks.";
+    *error = string_stream.str();
+    return false;
+  }
+
+  USHORT header_crc = static_cast<USHORT>(data[0] | (data[1] << 8));
+  USHORT crc = ComputeImageCrc(data, length);
+  if (crc != header_crc) {
+    std::ostringstream string_stream;
+    string_stream << "OAD image CRC (0x" << std::hex << crc << ") does not match its header (0x" << header_crc << ").";
+    *error = string_stream.str();
+    return false;
+  }
+
+  std::vector<UINT8> buffer(data, data + length);
+  (*image) = scoped_refptr<Image>(new Image(buffer));
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool Image::LoadFromFile(const std::wstring& path, scoped_refptr<Image>* image, std::string* error) {
+  HANDLE file_handle = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error opening OAD image '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_handle<HANDLE> handle(file_handle);
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(handle.get(), &file_size)) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error getting size of OAD image '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  if (static_cast<ULONGLONG>(file_size.QuadPart) > 0xffff * kBlockSize) {
+    *error = "OAD image file is too large.";
+    return false;
+  }
+
+  DWORD size = static_cast<DWORD>(file_size.QuadPart);
+  scoped_array<UINT8> data(new UINT8[size + 1]);
+  DWORD actual_size = 0;
+  if (!ReadFile(handle.get(), data.get(), size, &actual_size, NULL) || actual_size != size) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error reading OAD image '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  return LoadFromBuffer(data.get(), size, image, error);
+}
+
+USHORT Image::ComputeCrc() const {
+  return ComputeImageCrc(data(), size());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool UpdateEngine::Run(Target* target, UpdateProgress* progress, std::string* error) {
+  *progress = UpdateProgress();
+  progress->total_blocks = image_.block_count();
+  start_us_ = monotonic_microseconds();
+  sent_until_ = 0;
+
+  if (!target->Connect(error))
+    return false;
+
+  for (;;) {
+    TransferResult result = Transfer(target, progress, error);
+    target->Disconnect();
+
+    if (result == kTransferComplete) {
+      error->clear();
+      progress->acknowledged_blocks = progress->total_blocks;
+      ReportProgress(*target, progress);
+      return true;
+    }
+
+    if (result == kTransferFailed)
+      return false;
+
+    // The link was lost: reconnect and let the target tell us where to
+    // resume from.
+    bool connected = false;
+    std::string connect_error = *error;
+    while (!connected && progress->reconnects < static_cast<ULONG>(options_.max_reconnects)) {
+      progress->reconnects++;
+      Sleep(options_.reconnect_delay_ms);
+      connected = target->Connect(&connect_error);
+    }
+
+    if (!connected) {
+      std::ostringstream string_stream;
+      string_stream << "OAD transfer to '" << target->name() << "' interrupted after " << progress->reconnects << " reconnect(s): " << connect_error;
+      *error = string_stream.str();
+      return false;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+UpdateEngine::TransferResult UpdateEngine::Transfer(Target* target, UpdateProgress* progress, std::string* error) {
+  if (!target->WriteImageIdentify(image_.identify(), kIdentifySize, error))
+    return kTransferInterrupted;
+
+  const int total = image_.block_count();
+  int next_block = 0;
+  int requested = 0;
+  int rewind_block = -1;
+  int timeouts = 0;
+  bool started = false;
+
+  for (;;) {
+    bool all_sent = started && next_block == total;
+    DWORD timeout = all_sent ? options_.completion_timeout_ms : options_.block_request_timeout_ms;
+
+    USHORT block_index = 0;
+    WaitResult result = target->WaitForBlockRequest(timeout, &block_index, error);
+    switch (result) {
+    case kImageRejected:
+      if (error->empty())
+        *error = "OAD target rejected the image.";
+      return kTransferFailed;
+
+    case kWaitError:
+      return kTransferInterrupted;
+
+    case kTargetDisconnected:
+      // The target reboots into the new image once it has received the last
+      // block.
+      if (all_sent)
+        return kTransferComplete;
+      *error = "OAD target disconnected.";
+      return kTransferInterrupted;
+
+    case kWaitTimeout:
+      if (!started) {
+        *error = "OAD target did not request any block after image identification.";
+        return kTransferFailed;
+      }
+      progress->timeouts++;
+      if (++timeouts > options_.max_timeouts) {
+        *error = all_sent ? "OAD target did not reboot after the last block." : "OAD target stopped requesting blocks.";
+        return kTransferInterrupted;
+      }
+
+      // Re-send the whole window from the last requested block. This holds
+      // once the last block is sent too: it may have been lost, and only the
+      // target rebooting into the image tells the transfer is complete.
+      next_block = requested;
+      rewind_block = requested;
+      break;
+
+    case kBlockRequest:
+      timeouts = 0;
+      if (block_index >= total) {
+        std::ostringstream string_stream;
+        string_stream << "OAD target requested block " << block_index << " of a " << total << " blocks image.";
+        *error = string_stream.str();
+        return kTransferFailed;
+      }
+
+      if (!started) {
+        // First request after identification: this is where the target wants
+        // us to start (or resume) the transfer.
+        started = true;
+        requested = block_index;
+        next_block = block_index;
+      } else if (block_index > requested) {
+        requested = block_index;
+        if (next_block < requested)
+          next_block = requested;
+      } else if (block_index == requested && block_index < next_block && block_index != rewind_block) {
+        // The target asks again for a block we already sent: it was lost, and
+        // every block sent after it was ignored.
+        next_block = block_index;
+        rewind_block = block_index;
+      }
+
+      progress->acknowledged_blocks = static_cast<USHORT>(requested);
+      ReportProgress(*target, progress);
+      break;
+    }
+
+    while (next_block < total && next_block < requested + options_.window_size) {
+      if (!SendBlock(target, static_cast<USHORT>(next_block), progress, error))
+        return kTransferInterrupted;
+      next_block++;
+    }
+  }
+}
+
+bool UpdateEngine::SendBlock(Target* target, USHORT index, UpdateProgress* progress, std::string* error) {
+  UINT8 payload[kBlockPayloadSize];
+  payload[0] = static_cast<UINT8>(index & 0xff);
+  payload[1] = static_cast<UINT8>(index >> 8);
+  memcpy(payload + 2, image_.block(index), kBlockSize);
+  if (!target->WriteImageBlock(payload, sizeof(payload), error))
+    return false;
+
+  progress->blocks_sent++;
+  if (index < sent_until_) {
+    progress->blocks_resent++;
+  } else {
+    sent_until_ = index + 1;
+  }
+  return true;
+}
+
+void UpdateEngine::ReportProgress(const Target& target, UpdateProgress* progress) {
+  progress->elapsed_us = monotonic_microseconds() - start_us_;
+  if (progress_callback_)
+    progress_callback_(target, *progress);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+void UpdateTargets(const std::vector<scoped_refptr<Target>>& targets,
+                   const Image& image,
+                   const UpdateOptions& options,
+                   size_t max_parallel,
+                   const ProgressCallback& progress_callback,
+                   std::vector<UpdateResult>* results) {
+  results->assign(targets.size(), UpdateResult());
+  if (targets.empty())
+    return;
+
+  // Workers only use raw pointers: "targets" and "image" keep everything
+  // alive until all workers are joined, and reference counts aren't
+  // thread-safe.
+  std::mutex mutex;
+  size_t next_target = 0;
+  std::function<void()> worker = [&]() {
+    UpdateEngine engine(image, options);
+    engine.set_progress_callback(progress_callback);
+    for (;;) {
+      size_t index;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (next_target == targets.size())
+          return;
+        index = next_target++;
+      }
+
+      UpdateResult& result = (*results)[index];
+      result.success = engine.Run(targets[index].get(), &result.progress, &result.error);
+    }
+  };
+
+  size_t worker_count = std::min(std::max(max_parallel, static_cast<size_t>(1)), targets.size());
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < worker_count; i++) {
+    workers.push_back(std::thread(worker));
+  }
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+SimulatedTarget::SimulatedTarget(const std::string& name, const SimulatedTargetOptions& options)
+  : name_(name),
+    options_(options),
+    connected_(false),
+    disconnect_pending_(false),
+    disconnected_once_(false),
+    identified_(false),
+    rejected_(false),
+    complete_(false),
+    image_valid_(false),
+    total_blocks_(0),
+    next_block_(0),
+    blocks_received_(0),
+    blocks_dropped_(0),
+    random_(options.seed) {
+  memset(identify_, 0, sizeof(identify_));
+}
+
+bool SimulatedTarget::Connect(std::string*) {
+  connected_ = true;
+  disconnect_pending_ = false;
+  identified_ = false;
+  rejected_ = false;
+  notifications_.clear();
+  return true;
+}
+
+void SimulatedTarget::Disconnect() {
+  connected_ = false;
+  identified_ = false;
+  notifications_.clear();
+}
+
+bool SimulatedTarget::WriteImageIdentify(const UINT8* identify, size_t size, std::string* error) {
+  if (!connected_ || disconnect_pending_) {
+    *error = "Simulated OAD target is not connected.";
+    return false;
+  }
+
+  if (size != kIdentifySize) {
+    *error = "Invalid OAD image identify payload size.";
+    return false;
+  }
+
+  size_t length = static_cast<size_t>(identify[2] | (identify[3] << 8)) * kFlashWordSize;
+  size_t blocks = length / kBlockSize;
+  if (blocks == 0 || blocks > options_.capacity_blocks) {
+    rejected_ = true;
+    return true;
+  }
+
+  // A different image restarts the download from scratch, the same image
+  // resumes from the first missing block.
+  if (memcmp(identify_, identify, kIdentifySize) != 0 || complete_) {
+    memcpy(identify_, identify, kIdentifySize);
+    total_blocks_ = static_cast<USHORT>(blocks);
+    next_block_ = 0;
+    complete_ = false;
+    image_valid_ = false;
+    image_.assign(length, 0xff);
+  }
+
+  identified_ = true;
+  Notify(next_block_);
+  return true;
+}
+
+bool SimulatedTarget::WriteImageBlock(const UINT8* payload, size_t size, std::string* error) {
+  if (!connected_ || disconnect_pending_) {
+    *error = "Simulated OAD target is not connected.";
+    return false;
+  }
+
+  if (size != kBlockPayloadSize) {
+    *error = "Invalid OAD image block payload size.";
+    return false;
+  }
+
+  if (!identified_)
+    return true;
+
+  if (options_.drop_one_in != 0 && NextRandomDrop()) {
+    blocks_dropped_++;
+    return true;
+  }
+
+  blocks_received_++;
+  USHORT block_index = ReadBlockIndex(payload);
+  if (block_index == next_block_) {
+    memcpy(&image_[block_index * kBlockSize], payload + 2, kBlockSize);
+    next_block_++;
+  }
+
+  if (next_block_ == total_blocks_) {
+    // Validate the image and "reboot" into it.
+    complete_ = true;
+    image_valid_ = (ComputeImageCrc(&image_[0], image_.size()) == (image_[0] | (image_[1] << 8)));
+    disconnect_pending_ = true;
+    return true;
+  }
+
+  if (options_.disconnect_after_blocks != 0 && !disconnected_once_ && blocks_received_ >= options_.disconnect_after_blocks) {
+    disconnected_once_ = true;
+    disconnect_pending_ = true;
+    return true;
+  }
+
+  Notify(next_block_);
+  return true;
+}
+
+WaitResult SimulatedTarget::WaitForBlockRequest(DWORD timeout_ms, USHORT* block_index, std::string* error) {
+  if (!connected_ || disconnect_pending_) {
+    connected_ = false;
+    return kTargetDisconnected;
+  }
+
+  if (rejected_) {
+    rejected_ = false;
+    *error = "Simulated OAD target rejected the image.";
+    return kImageRejected;
+  }
+
+  if (notifications_.empty()) {
+    Sleep(timeout_ms);
+    return kWaitTimeout;
+  }
+
+  ULONGLONG now_us = monotonic_microseconds();
+  const Notification& notification = notifications_.front();
+  if (notification.due_us > now_us) {
+    ULONGLONG wait_ms = (notification.due_us - now_us + 999) / 1000;
+    if (wait_ms > timeout_ms) {
+      Sleep(timeout_ms);
+      return kWaitTimeout;
+    }
+    Sleep(static_cast<DWORD>(wait_ms));
+  }
+
+  *block_index = notification.block_index;
+  notifications_.pop_front();
+  return kBlockRequest;
+}
+
+void SimulatedTarget::Notify(USHORT block_index) {
+  Notification notification;
+  notification.due_us = monotonic_microseconds() + options_.notify_latency_ms * 1000;
+  notification.block_index = block_index;
+  notifications_.push_back(notification);
+}
+
+bool SimulatedTarget::NextRandomDrop() {
+  random_ = random_ * 1103515245 + 12345;
+  return ((random_ >> 16) % options_.drop_one_in) == 0;
+}
+
+}  // namespace oad
+}  // namespace btle
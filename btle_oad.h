@@ -0,0 +1,297 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "base.h"
+
+// Over-the-air download (OAD) of firmware images to TI SensorTags.
+//
+// The profile uses two characteristics of "OAD_Service":
+// - "OADImage_Identify": the host writes the 8 byte image header (version,
+//   length, uid). The target answers with a block request, or with a
+//   notification on this characteristic if it rejects the image.
+// - "OADImage_Block": the target notifies the index of the block it expects
+//   next, and the host writes blocks as [index (LE16), 16 bytes of data].
+// See http://processors.wiki.ti.com/index.php/OAD
+namespace btle {
+namespace oad {
+
+// Number of data bytes in a single image block.
+const size_t kBlockSize = 16;
+// Number of bytes written to "OADImage_Block": block index + block data.
+const size_t kBlockPayloadSize = 2 + kBlockSize;
+// Number of bytes of the image header written to "OADImage_Identify".
+const size_t kIdentifySize = 8;
+// Image length in the header is expressed in flash words of 4 bytes.
+const size_t kFlashWordSize = 4;
+
+//////////////////////////////////////////////////////////////////////////////
+// A firmware image, as produced by the TI BLE stack build ("*.bin").
+//
+// Header layout: crc0 (2), crc1 (2), ver (2), len (2), uid (4), res (4).
+// Loading fails if crc0 doesn't match the CRC of the image.
+//
+class Image : public RefCounted<Image> {
+public:
+  static bool LoadFromFile(const std::wstring& path, scoped_refptr<Image>* image, std::string* error);
+  static bool LoadFromBuffer(const UINT8* data, size_t size, scoped_refptr<Image>* image, std::string* error);
+
+  USHORT crc() const { return ReadUShort(0); }
+  USHORT version() const { return ReadUShort(4); }
+  USHORT length() const { return ReadUShort(6); }
+  const UINT8* uid() const { return &data_[8]; }
+
+  size_t size() const { return data_.size(); }
+  const UINT8* data() const { return &data_[0]; }
+
+  USHORT block_count() const { return static_cast<USHORT>(data_.size() / kBlockSize); }
+  const UINT8* block(USHORT index) const { return &data_[index * kBlockSize]; }
+
+  // Payload written to "OADImage_Identify" (ver, len, uid).
+  const UINT8* identify() const { return &data_[4]; }
+
+  // Computes the image CRC the same way the target does when it validates
+  // the downloaded image.
+  USHORT ComputeCrc() const;
+
+private:
+  explicit Image(std::vector<UINT8>& data) {
+    data_.swap(data);
+  }
+
+  USHORT ReadUShort(size_t offset) const {
+    return static_cast<USHORT>(data_[offset] | (data_[offset + 1] << 8));
+  }
+
+  std::vector<UINT8> data_;
+};
+
+// Computes the CRC of an image the way the OAD target does: CRC-16 (0x1021)
+// over the whole image, skipping the 4 CRC bytes of the header.
+USHORT ComputeImageCrc(const UINT8* data, size_t size);
+
+enum WaitResult {
+  kBlockRequest,
+  kWaitTimeout,
+  kTargetDisconnected,
+  kImageRejected,
+  kWaitError
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// A device able to receive an image. The update engine drives a target from
+// a single thread, so implementations don't need to be re-entrant.
+//
+class Target : public RefCounted<Target> {
+public:
+  virtual std::string name() const = 0;
+
+  virtual bool Connect(std::string* error) = 0;
+  virtual void Disconnect() = 0;
+
+  // Writes the image header to "OADImage_Identify".
+  virtual bool WriteImageIdentify(const UINT8* identify, size_t size, std::string* error) = 0;
+
+  // Writes a block payload (see kBlockPayloadSize) to "OADImage_Block"
+  // without waiting for a response.
+  virtual bool WriteImageBlock(const UINT8* payload, size_t size, std::string* error) = 0;
+
+  // Waits for the next block request notified by the target.
+  virtual WaitResult WaitForBlockRequest(DWORD timeout_ms, USHORT* block_index, std::string* error) = 0;
+
+protected:
+  virtual ~Target() {
+  }
+};
+
+struct UpdateOptions {
+  UpdateOptions()
+    : window_size(8),
+      block_request_timeout_ms(2000),
+      completion_timeout_ms(3000),
+      max_timeouts(5),
+      max_reconnects(5),
+      reconnect_delay_ms(1000) {
+  }
+
+  // Maximum number of blocks written ahead of the last block request.
+  USHORT window_size;
+  // Time to wait for a block request before re-sending the window.
+  DWORD block_request_timeout_ms;
+  // Time to wait for the target to reboot once the last block is sent.
+  DWORD completion_timeout_ms;
+  // Number of consecutive timeouts before the link is considered lost.
+  int max_timeouts;
+  // Number of times the engine reconnects and resumes the transfer.
+  int max_reconnects;
+  DWORD reconnect_delay_ms;
+};
+
+struct UpdateProgress {
+  UpdateProgress()
+    : total_blocks(0),
+      acknowledged_blocks(0),
+      blocks_sent(0),
+      blocks_resent(0),
+      timeouts(0),
+      reconnects(0),
+      elapsed_us(0) {
+  }
+
+  USHORT total_blocks;
+  // Number of blocks the target confirmed by requesting a later block.
+  USHORT acknowledged_blocks;
+  ULONG blocks_sent;
+  ULONG blocks_resent;
+  ULONG timeouts;
+  ULONG reconnects;
+  ULONGLONG elapsed_us;
+
+  double percent() const {
+    return total_blocks ? 100.0 * acknowledged_blocks / total_blocks : 0.0;
+  }
+
+  // Effective throughput, counting only acknowledged image bytes.
+  double bytes_per_second() const {
+    return elapsed_us ? acknowledged_blocks * kBlockSize * 1000000.0 / elapsed_us : 0.0;
+  }
+};
+
+typedef std::function<void(const Target& target, const UpdateProgress& progress)> ProgressCallback;
+
+//////////////////////////////////////////////////////////////////////////////
+// Streams an image to a target, block by block, driven by the block
+// requests notified by the target. Up to "window_size" blocks are written
+// ahead of the last request; a repeated request for an already sent block
+// rewinds the stream to that block, and a timeout re-sends the window.
+//
+// The transfer is complete once the target disconnects (reboots into the new
+// image) after the last block is sent.
+//
+class UpdateEngine {
+public:
+  UpdateEngine(const Image& image, const UpdateOptions& options)
+    : image_(image), options_(options), start_us_(0), sent_until_(0) {
+  }
+
+  void set_progress_callback(const ProgressCallback& callback) { progress_callback_ = callback; }
+
+  bool Run(Target* target, UpdateProgress* progress, std::string* error);
+
+private:
+  enum TransferResult {
+    kTransferComplete,
+    kTransferInterrupted,
+    kTransferFailed
+  };
+
+  TransferResult Transfer(Target* target, UpdateProgress* progress, std::string* error);
+  bool SendBlock(Target* target, USHORT index, UpdateProgress* progress, std::string* error);
+  void ReportProgress(const Target& target, UpdateProgress* progress);
+
+  const Image& image_;
+  UpdateOptions options_;
+  ProgressCallback progress_callback_;
+  ULONGLONG start_us_;
+  // One past the highest block index written so far.
+  ULONG sent_until_;
+
+  UpdateEngine(const UpdateEngine& other);
+  const UpdateEngine& operator=(const UpdateEngine& other);
+};
+
+struct UpdateResult {
+  UpdateResult() : success(false) {
+  }
+
+  bool success;
+  std::string error;
+  UpdateProgress progress;
+};
+
+// Updates all "targets" with "image", running up to "max_parallel" transfers
+// at once. "results" receives one entry per target, in the same order.
+// "progress_callback" may be invoked concurrently from several threads.
+void UpdateTargets(const std::vector<scoped_refptr<Target>>& targets,
+                   const Image& image,
+                   const UpdateOptions& options,
+                   size_t max_parallel,
+                   const ProgressCallback& progress_callback,
+                   std::vector<UpdateResult>* results);
+
+struct SimulatedTargetOptions {
+  SimulatedTargetOptions()
+    : capacity_blocks(0x2000),
+      notify_latency_ms(0),
+      drop_one_in(0),
+      disconnect_after_blocks(0),
+      seed(1) {
+  }
+
+  // Largest image the target accepts.
+  USHORT capacity_blocks;
+  // Delay between receiving a block and notifying the next request.
+  DWORD notify_latency_ms;
+  // Silently drop one block write out of "drop_one_in" (0 = never).
+  ULONG drop_one_in;
+  // Drop the connection once, after receiving that many blocks (0 = never).
+  ULONG disconnect_after_blocks;
+  ULONG seed;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// In-memory OAD target, implementing the same state machine as the TI
+// firmware: every received block triggers a request for the next expected
+// block, out of order blocks are ignored, and the image is validated and the
+// device "reboots" (disconnects) once the last block is received.
+//
+class SimulatedTarget : public Target {
+public:
+  SimulatedTarget(const std::string& name, const SimulatedTargetOptions& options);
+
+  virtual std::string name() const { return name_; }
+  virtual bool Connect(std::string* error);
+  virtual void Disconnect();
+  virtual bool WriteImageIdentify(const UINT8* identify, size_t size, std::string* error);
+  virtual bool WriteImageBlock(const UINT8* payload, size_t size, std::string* error);
+  virtual WaitResult WaitForBlockRequest(DWORD timeout_ms, USHORT* block_index, std::string* error);
+
+  bool complete() const { return complete_; }
+  bool image_valid() const { return image_valid_; }
+  const std::vector<UINT8>& image() const { return image_; }
+  ULONG blocks_received() const { return blocks_received_; }
+  ULONG blocks_dropped() const { return blocks_dropped_; }
+
+private:
+  struct Notification {
+    ULONGLONG due_us;
+    USHORT block_index;
+  };
+
+  void Notify(USHORT block_index);
+  bool NextRandomDrop();
+
+  std::string name_;
+  SimulatedTargetOptions options_;
+  bool connected_;
+  bool disconnect_pending_;
+  bool disconnected_once_;
+  bool identified_;
+  bool rejected_;
+  bool complete_;
+  bool image_valid_;
+  UINT8 identify_[kIdentifySize];
+  USHORT total_blocks_;
+  USHORT next_block_;
+  std::vector<UINT8> image_;
+  std::deque<Notification> notifications_;
+  ULONG blocks_received_;
+  ULONG blocks_dropped_;
+  ULONG random_;
+};
+
+}  // namespace oad
+}  // namespace btle
@@ -0,0 +1,172 @@
+#include "stdafx.h"
+
+#include <string>
+#include <vector>
+
+#include "btle_oad.h"
+#include "btle_test.h"
+
+namespace {
+
+// Image of "blocks" blocks with a valid header and CRC, and pseudo random
+// data.
+std::vector<UINT8> MakeImageData(USHORT blocks, ULONG seed) {
+  std::vector<UINT8> data(blocks * btle::oad::kBlockSize);
+  ULONG random = seed;
+  for (size_t i = 0; i < data.size(); i++) {
+    random = random * 1103515245 + 12345;
+    data[i] = static_cast<UINT8>(random >> 16);
+  }
+
+  size_t words = data.size() / btle::oad::kFlashWordSize;
+  data[2] = 0xff;  // crc1, written by the target.
+  data[3] = 0xff;
+  data[4] = 0x02;  // ver
+  data[5] = 0x00;
+  data[6] = static_cast<UINT8>(words);
+  data[7] = static_cast<UINT8>(words >> 8);
+  USHORT crc = btle::oad::ComputeImageCrc(&data[0], data.size());
+  data[0] = static_cast<UINT8>(crc);
+  data[1] = static_cast<UINT8>(crc >> 8);
+  return data;
+}
+
+scoped_refptr<btle::oad::Image> MakeImage(USHORT blocks, ULONG seed) {
+  std::vector<UINT8> data = MakeImageData(blocks, seed);
+  scoped_refptr<btle::oad::Image> image;
+  std::string error;
+  btle::oad::Image::LoadFromBuffer(&data[0], data.size(), &image, &error);
+  return image;
+}
+
+// Short timeouts, so that lost blocks are re-sent quickly, and enough of
+// them not to give up on a lossy link.
+btle::oad::UpdateOptions FastOptions() {
+  btle::oad::UpdateOptions options;
+  options.block_request_timeout_ms = 2;
+  options.completion_timeout_ms = 2;
+  options.max_timeouts = 50;
+  options.reconnect_delay_ms = 0;
+  return options;
+}
+
+bool SameImage(const btle::oad::Image& image, const btle::oad::SimulatedTarget& target) {
+  return target.image().size() == image.size() &&
+      memcmp(&target.image()[0], image.data(), image.size()) == 0;
+}
+
+}  // namespace
+
+BTLE_TEST(oad, LoadImage) {
+  std::vector<UINT8> data = MakeImageData(64, 1);
+  scoped_refptr<btle::oad::Image> image;
+  std::string error;
+  BTLE_EXPECT(btle::oad::Image::LoadFromBuffer(&data[0], data.size(), &image, &error));
+  BTLE_EXPECT_EQ(64, image->block_count());
+  BTLE_EXPECT_EQ(image->crc(), image->ComputeCrc());
+}
+
+BTLE_TEST(oad, LoadRejectsCrcMismatch) {
+  std::vector<UINT8> data = MakeImageData(64, 1);
+  data[100] ^= 0x01;
+  scoped_refptr<btle::oad::Image> image;
+  std::string error;
+  BTLE_EXPECT(!btle::oad::Image::LoadFromBuffer(&data[0], data.size(), &image, &error));
+  BTLE_EXPECT(!error.empty());
+}
+
+BTLE_TEST(oad, LoadRejectsInvalidLength) {
+  std::vector<UINT8> data = MakeImageData(64, 1);
+  scoped_refptr<btle::oad::Image> image;
+  std::string error;
+  BTLE_EXPECT(!btle::oad::Image::LoadFromBuffer(&data[0], data.size() - btle::oad::kBlockSize, &image, &error));
+}
+
+BTLE_TEST(oad, Update) {
+  scoped_refptr<btle::oad::Image> image = MakeImage(64, 1);
+  scoped_refptr<btle::oad::SimulatedTarget> target(new btle::oad::SimulatedTarget("target", btle::oad::SimulatedTargetOptions()));
+  btle::oad::UpdateEngine engine(*image.get(), FastOptions());
+  btle::oad::UpdateProgress progress;
+  std::string error;
+  BTLE_EXPECT(engine.Run(target.get(), &progress, &error));
+  BTLE_EXPECT(target->complete());
+  BTLE_EXPECT(target->image_valid());
+  BTLE_EXPECT(SameImage(*image.get(), *target.get()));
+  BTLE_EXPECT_EQ(64u, progress.blocks_sent);
+  BTLE_EXPECT_EQ(0u, progress.blocks_resent);
+}
+
+// One block write out of five is lost, including the last blocks of the
+// image: the engine must keep re-sending until the target reboots into a
+// complete image.
+BTLE_TEST(oad, UpdateWithPacketLoss) {
+  scoped_refptr<btle::oad::Image> image = MakeImage(64, 1);
+  for (ULONG seed = 1; seed < 40; seed++) {
+    btle::oad::SimulatedTargetOptions target_options;
+    target_options.drop_one_in = 5;
+    target_options.seed = seed;
+    scoped_refptr<btle::oad::SimulatedTarget> target(new btle::oad::SimulatedTarget("target", target_options));
+    btle::oad::UpdateEngine engine(*image.get(), FastOptions());
+    btle::oad::UpdateProgress progress;
+    std::string error;
+    bool success = engine.Run(target.get(), &progress, &error);
+    BTLE_EXPECT(success);
+    BTLE_EXPECT(target->complete());
+    BTLE_EXPECT(target->image_valid());
+    BTLE_EXPECT(SameImage(*image.get(), *target.get()));
+    BTLE_EXPECT(target->blocks_dropped() == 0 || progress.blocks_resent > 0);
+  }
+}
+
+BTLE_TEST(oad, UpdateResumesAfterDisconnect) {
+  scoped_refptr<btle::oad::Image> image = MakeImage(64, 1);
+  btle::oad::SimulatedTargetOptions target_options;
+  target_options.disconnect_after_blocks = 20;
+  scoped_refptr<btle::oad::SimulatedTarget> target(new btle::oad::SimulatedTarget("target", target_options));
+  btle::oad::UpdateEngine engine(*image.get(), FastOptions());
+  btle::oad::UpdateProgress progress;
+  std::string error;
+  BTLE_EXPECT(engine.Run(target.get(), &progress, &error));
+  BTLE_EXPECT_EQ(1u, progress.reconnects);
+  BTLE_EXPECT(target->image_valid());
+  BTLE_EXPECT(SameImage(*image.get(), *target.get()));
+}
+
+BTLE_TEST(oad, UpdateFailsWithoutBlockRequests) {
+  scoped_refptr<btle::oad::Image> image = MakeImage(64, 1);
+  btle::oad::SimulatedTargetOptions target_options;
+  target_options.drop_one_in = 1;
+  scoped_refptr<btle::oad::SimulatedTarget> target(new btle::oad::SimulatedTarget("target", target_options));
+  btle::oad::UpdateOptions options = FastOptions();
+  options.max_timeouts = 3;
+  options.max_reconnects = 1;
+  btle::oad::UpdateEngine engine(*image.get(), options);
+  btle::oad::UpdateProgress progress;
+  std::string error;
+  BTLE_EXPECT(!engine.Run(target.get(), &progress, &error));
+  BTLE_EXPECT(!target->complete());
+  BTLE_EXPECT(!error.empty());
+}
+
+BTLE_TEST(oad, UpdateTargets) {
+  scoped_refptr<btle::oad::Image> image = MakeImage(256, 2);
+  std::vector<scoped_refptr<btle::oad::Target>> targets;
+  std::vector<btle::oad::SimulatedTarget*> simulated_targets;
+  for (ULONG i = 0; i < 8; i++) {
+    btle::oad::SimulatedTargetOptions target_options;
+    target_options.drop_one_in = 10;
+    target_options.seed = i + 1;
+    btle::oad::SimulatedTarget* target = new btle::oad::SimulatedTarget("target", target_options);
+    simulated_targets.push_back(target);
+    targets.push_back(scoped_refptr<btle::oad::Target>(target));
+  }
+
+  std::vector<btle::oad::UpdateResult> results;
+  btle::oad::UpdateTargets(targets, *image.get(), FastOptions(), 4, btle::oad::ProgressCallback(), &results);
+  BTLE_EXPECT_EQ(targets.size(), results.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    BTLE_EXPECT(results[i].success);
+    BTLE_EXPECT(simulated_targets[i]->image_valid());
+    BTLE_EXPECT(SameImage(*image.get(), *simulated_targets[i]));
+  }
+}
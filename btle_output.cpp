@@ -0,0 +1,291 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "btle_guid.h"
+#include "btle_output.h"
+
+namespace btle {
+
+namespace {
+
+const char kIndent[] = "                                                                ";
+const size_t kIndentSize = sizeof(kIndent) - 1;
+
+// Large enough for any number written by std::to_chars.
+const size_t kMaxNumberSize = 32;
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool ParseOutputFormat(std::string_view text, OutputFormat* format) {
+  if (text == "text") {
+    *format = kTextOutput;
+  } else if (text == "json") {
+    *format = kJsonOutput;
+  } else if (text == "ndjson") {
+    *format = kNdjsonOutput;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+OutputWriter::OutputWriter(FILE* file, OutputFormat format, size_t buffer_size)
+  : file_(file),
+    format_(format),
+    buffer_(buffer_size),
+    size_(0),
+    depth_(0),
+    records_(0),
+    finished_(false) {
+}
+
+OutputWriter::~OutputWriter() {
+  Finish();
+}
+
+void OutputWriter::BeginRecord(std::string_view name) {
+  if (format_ == kJsonOutput)
+    Append(records_ == 0 ? "[\n" : ",\n");
+  if (format_ == kTextOutput) {
+    BeginObject(name);
+    return;
+  }
+  Append("{");
+  Push(false);
+}
+
+void OutputWriter::EndRecord() {
+  records_++;
+  if (format_ == kTextOutput) {
+    EndObject();
+    return;
+  }
+  Pop('}');
+  if (format_ == kNdjsonOutput)
+    Append("\n");
+}
+
+void OutputWriter::BeginObject(std::string_view name) {
+  BeginValue(name);
+  if (format_ == kTextOutput) {
+    Append("\n");
+  } else {
+    Append("{");
+  }
+  Push(false);
+}
+
+void OutputWriter::EndObject() {
+  Pop('}');
+}
+
+void OutputWriter::BeginArray(std::string_view name) {
+  if (format_ != kTextOutput) {
+    BeginValue(name);
+    Append("[");
+  }
+  Push(true);
+}
+
+void OutputWriter::EndArray() {
+  Pop(']');
+}
+
+void OutputWriter::String(std::string_view name, std::string_view value) {
+  BeginValue(name);
+  if (format_ == kTextOutput) {
+    Append(value);
+  } else {
+    AppendJsonString(value);
+  }
+  EndValue();
+}
+
+void OutputWriter::UInt(std::string_view name, UINT64 value) {
+  BeginValue(name);
+  char* out = Reserve(kMaxNumberSize);
+  Commit(std::to_chars(out, out + kMaxNumberSize, value).ptr);
+  EndValue();
+}
+
+void OutputWriter::Int(std::string_view name, INT64 value) {
+  BeginValue(name);
+  char* out = Reserve(kMaxNumberSize);
+  Commit(std::to_chars(out, out + kMaxNumberSize, value).ptr);
+  EndValue();
+}
+
+void OutputWriter::Double(std::string_view name, double value) {
+  BeginValue(name);
+  if (format_ != kTextOutput && !std::isfinite(value)) {
+    Append("null");
+  } else {
+    char* out = Reserve(kMaxNumberSize);
+    if (format_ == kTextOutput) {
+      // Same as the default of streams.
+      Commit(std::to_chars(out, out + kMaxNumberSize, value, std::chars_format::general, 6).ptr);
+    } else {
+      // Shortest form that reads back to the same value.
+      Commit(std::to_chars(out, out + kMaxNumberSize, value).ptr);
+    }
+  }
+  EndValue();
+}
+
+void OutputWriter::Bool(std::string_view name, bool value) {
+  BeginValue(name);
+  Append(value ? "true" : "false");
+  EndValue();
+}
+
+void OutputWriter::Hex(std::string_view name, const UINT8* data, size_t size) {
+  BeginValue(name);
+  bool quoted = format_ != kTextOutput;
+  char* out = Reserve(2 * size + 2);
+  if (quoted)
+    *out++ = '"';
+  out = WriteHex(data, size, out);
+  if (quoted)
+    *out++ = '"';
+  Commit(out);
+  EndValue();
+}
+
+void OutputWriter::Null(std::string_view name) {
+  BeginValue(name);
+  if (format_ == kTextOutput) {
+    Append("\n");
+    AppendIndent(1);
+    Append("(none)");
+  } else {
+    Append("null");
+  }
+  EndValue();
+}
+
+void OutputWriter::Finish() {
+  if (finished_)
+    return;
+  if (format_ == kJsonOutput)
+    Append(records_ == 0 ? "[]\n" : "\n]\n");
+  Flush();
+  finished_ = true;
+}
+
+void OutputWriter::Flush() {
+  if (size_ > 0)
+    fwrite(buffer_.data(), 1, size_, file_);
+  size_ = 0;
+  fflush(file_);
+}
+
+char* OutputWriter::Reserve(size_t size) {
+  if (size_ + size > buffer_.size()) {
+    Flush();
+    if (size > buffer_.size())
+      buffer_.resize(size);
+  }
+  return buffer_.data() + size_;
+}
+
+void OutputWriter::Append(std::string_view text) {
+  char* out = Reserve(text.size());
+  memcpy(out, text.data(), text.size());
+  Commit(out + text.size());
+}
+
+void OutputWriter::AppendJsonString(std::string_view text) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  // Worst case: every character as "\u00xx".
+  char* out = Reserve(6 * text.size() + 2);
+  *out++ = '"';
+  for (size_t i = 0; i < text.size(); i++) {
+    UINT8 c = static_cast<UINT8>(text[i]);
+    if (c == '"' || c == '\\') {
+      *out++ = '\\';
+      *out++ = static_cast<char>(c);
+    } else if (c == '\n') {
+      *out++ = '\\';
+      *out++ = 'n';
+    } else if (c == '\r') {
+      *out++ = '\\';
+      *out++ = 'r';
+    } else if (c == '\t') {
+      *out++ = '\\';
+      *out++ = 't';
+    } else if (c < 0x20) {
+      memcpy(out, "\\u00", 4);
+      out[4] = kHexDigits[c >> 4];
+      out[5] = kHexDigits[c & 0x0f];
+      out += 6;
+    } else {
+      *out++ = static_cast<char>(c);
+    }
+  }
+  *out++ = '"';
+  Commit(out);
+}
+
+void OutputWriter::BeginValue(std::string_view name) {
+  if (format_ == kTextOutput) {
+    AppendIndent(0);
+    Append(name);
+    Append(":");
+    return;
+  }
+
+  if (depth_ == 0)
+    return;
+  int level = std::min(depth_, kMaxDepth) - 1;
+  if (!first_[level])
+    Append(",");
+  first_[level] = false;
+  if (!is_array_[level]) {
+    AppendJsonString(name);
+    Append(":");
+  }
+}
+
+void OutputWriter::AppendIndent(int extra_levels) {
+  // Only objects indent their fields.
+  size_t indent = 2 * extra_levels;
+  for (int i = 0; i < std::min(depth_, kMaxDepth); i++) {
+    if (!is_array_[i])
+      indent += 2;
+  }
+  Append(std::string_view(kIndent, std::min(indent, kIndentSize)));
+}
+
+void OutputWriter::EndValue() {
+  if (format_ == kTextOutput)
+    Append("\n");
+}
+
+void OutputWriter::Push(bool is_array) {
+  if (depth_ < kMaxDepth) {
+    first_[depth_] = true;
+    is_array_[depth_] = is_array;
+  }
+  depth_++;
+}
+
+void OutputWriter::Pop(char close) {
+  if (depth_ > 0)
+    depth_--;
+  if (format_ != kTextOutput) {
+    char text[1] = { close };
+    Append(std::string_view(text, 1));
+  }
+}
+
+}  // namespace btle
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdio.h>
+
+#include <string_view>
+#include <vector>
+
+#include "base.h"
+
+namespace btle {
+
+enum OutputFormat {
+  // Indented "Name:value" lines.
+  kTextOutput,
+  // A single JSON array of records.
+  kJsonOutput,
+  // One JSON object per record and per line.
+  kNdjsonOutput,
+};
+
+// Parses "text", "json" or "ndjson".
+bool ParseOutputFormat(std::string_view text, OutputFormat* format);
+
+//////////////////////////////////////////////////////////////////////////////
+// Streaming writer of a tree of records (objects, arrays and scalar fields)
+// in one of the OutputFormats, so that a single traversal of the devices
+// produces any of them.
+//
+// Everything is formatted in place into a large buffer, written to "file"
+// when full: fields never allocate, and the buffer is reused for the whole
+// output. Numbers go through std::to_chars, byte values through a hex
+// table.
+//
+// In text output, objects are a "Name:" line followed by their fields
+// indented by 2 more spaces, and arrays only group their elements. In JSON,
+// the names of the objects of an array are ignored. Nesting is limited to
+// kMaxDepth levels.
+//
+class OutputWriter {
+public:
+  static const size_t kDefaultBufferSize = 64 * 1024;
+
+  OutputWriter(FILE* file, OutputFormat format, size_t buffer_size = kDefaultBufferSize);
+  // Calls Finish().
+  ~OutputWriter();
+
+  OutputFormat format() const { return format_; }
+
+  // A top level object, e.g. a device.
+  void BeginRecord(std::string_view name);
+  void EndRecord();
+
+  void BeginObject(std::string_view name);
+  void EndObject();
+  void BeginArray(std::string_view name);
+  void EndArray();
+
+  void String(std::string_view name, std::string_view value);
+  void UInt(std::string_view name, UINT64 value);
+  void Int(std::string_view name, INT64 value);
+  void Double(std::string_view name, double value);
+  void Bool(std::string_view name, bool value);
+  // Lower case hex digits of "data", as a string.
+  void Hex(std::string_view name, const UINT8* data, size_t size);
+  // "null" in JSON, "Name:" followed by an indented "(none)" in text.
+  void Null(std::string_view name);
+
+  // Terminates the output (closes the JSON array) and flushes it. Nothing
+  // can be written after.
+  void Finish();
+
+  // Writes the buffered output to the file.
+  void Flush();
+
+  static constexpr int kMaxDepth = 32;
+
+private:
+  // Returns room for "size" characters, flushing the buffer if needed.
+  char* Reserve(size_t size);
+  void Commit(char* end) { size_ = end - buffer_.data(); }
+  void Append(std::string_view text);
+  void AppendJsonString(std::string_view text);
+  // Text indent of the current level, plus "extra_levels".
+  void AppendIndent(int extra_levels);
+
+  // Writes the indent and "name:" (text) or the separator and "name":
+  // (JSON) of a field or of the start of an object or array.
+  void BeginValue(std::string_view name);
+  // Ends a scalar field.
+  void EndValue();
+  void Push(bool is_array);
+  void Pop(char close);
+
+  FILE* file_;
+  OutputFormat format_;
+  std::vector<char> buffer_;
+  size_t size_;
+  int depth_;
+  // Per nesting level, for JSON: no value written yet, and array (vs
+  // object).
+  bool first_[kMaxDepth];
+  bool is_array_[kMaxDepth];
+  // Number of records written.
+  size_t records_;
+  bool finished_;
+
+  OutputWriter(const OutputWriter& other);
+  const OutputWriter& operator=(const OutputWriter& other);
+};
+
+}  // namespace btle
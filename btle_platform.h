@@ -0,0 +1,10 @@
+#pragma once
+
+// Bluetooth LE definitions: the Windows SDK headers, or their portable
+// subset on other platforms.
+#ifdef _WIN32
+#include <bluetoothapis.h>
+#include <bluetoothleapis.h>
+#else
+#include "btle_posix.h"
+#endif
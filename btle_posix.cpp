@@ -0,0 +1,332 @@
+#include "stdafx.h"
+
+#ifndef _WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "base.h"
+
+namespace {
+
+// A file, a file mapping (the file it maps) or a placeholder event (-1).
+struct PosixHandle {
+  int fd;
+};
+
+thread_local DWORD LastError = ERROR_SUCCESS;
+
+// Handles not closed yet, so that closed handles are reported invalid.
+std::mutex HandlesMutex;
+std::set<PosixHandle*> Handles;
+
+// Sizes of the views returned by MapViewOfFile(), for munmap().
+std::mutex ViewsMutex;
+std::map<const void*, size_t> Views;
+
+void SetErrorFromErrno() {
+  switch (errno) {
+  case ENOENT:
+    LastError = ERROR_FILE_NOT_FOUND;
+    break;
+  case ENOTDIR:
+    LastError = ERROR_PATH_NOT_FOUND;
+    break;
+  case EACCES:
+  case EPERM:
+  case EROFS:
+    LastError = ERROR_ACCESS_DENIED;
+    break;
+  case EBADF:
+    LastError = ERROR_INVALID_HANDLE;
+    break;
+  case ENOMEM:
+    LastError = ERROR_NOT_ENOUGH_MEMORY;
+    break;
+  case EINVAL:
+    LastError = ERROR_INVALID_PARAMETER;
+    break;
+  default:
+    LastError = ERROR_GEN_FAILURE;
+  }
+}
+
+int HandleFd(HANDLE handle) {
+  if (handle == NULL || handle == INVALID_HANDLE_VALUE)
+    return -1;
+  return reinterpret_cast<PosixHandle*>(handle)->fd;
+}
+
+HANDLE NewHandle(int fd) {
+  PosixHandle* handle = new PosixHandle();
+  handle->fd = fd;
+  std::lock_guard<std::mutex> lock(HandlesMutex);
+  Handles.insert(handle);
+  return handle;
+}
+
+}  // namespace
+
+DWORD GetLastError() {
+  return LastError;
+}
+
+void SetLastError(DWORD error) {
+  LastError = error;
+}
+
+BOOL CloseHandle(HANDLE handle) {
+  if (handle == NULL || handle == INVALID_HANDLE_VALUE) {
+    LastError = ERROR_INVALID_HANDLE;
+    return FALSE;
+  }
+
+  PosixHandle* posix_handle = reinterpret_cast<PosixHandle*>(handle);
+  {
+    std::lock_guard<std::mutex> lock(HandlesMutex);
+    if (Handles.erase(posix_handle) == 0) {
+      LastError = ERROR_INVALID_HANDLE;
+      return FALSE;
+    }
+  }
+  int result = posix_handle->fd >= 0 ? close(posix_handle->fd) : 0;
+  delete posix_handle;
+  if (result != 0) {
+    SetErrorFromErrno();
+    return FALSE;
+  }
+  return TRUE;
+}
+
+BOOL GetHandleInformation(HANDLE handle, DWORD* flags) {
+  std::lock_guard<std::mutex> lock(HandlesMutex);
+  if (Handles.find(reinterpret_cast<PosixHandle*>(handle)) == Handles.end()) {
+    LastError = ERROR_INVALID_HANDLE;
+    return FALSE;
+  }
+  *flags = 0;
+  return TRUE;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+HANDLE CreateFile(const WCHAR* path, DWORD desired_access, DWORD, void*,
+                  DWORD creation_disposition, DWORD, HANDLE) {
+  int flags = O_CLOEXEC;
+  if ((desired_access & GENERIC_READ) && (desired_access & GENERIC_WRITE))
+    flags |= O_RDWR;
+  else if (desired_access & GENERIC_WRITE)
+    flags |= O_WRONLY;
+  else
+    flags |= O_RDONLY;
+
+  switch (creation_disposition) {
+  case CREATE_NEW:
+    flags |= O_CREAT | O_EXCL;
+    break;
+  case CREATE_ALWAYS:
+    flags |= O_CREAT | O_TRUNC;
+    break;
+  case OPEN_ALWAYS:
+    flags |= O_CREAT;
+    break;
+  default:
+    break;
+  }
+
+  int fd = open(to_std_string(path).c_str(), flags, 0644);
+  if (fd < 0) {
+    SetErrorFromErrno();
+    return INVALID_HANDLE_VALUE;
+  }
+  return NewHandle(fd);
+}
+
+BOOL ReadFile(HANDLE file, LPVOID buffer, DWORD size, DWORD* read_size, void*) {
+  ssize_t result;
+  do {
+    result = read(HandleFd(file), buffer, size);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    SetErrorFromErrno();
+    return FALSE;
+  }
+  *read_size = static_cast<DWORD>(result);
+  return TRUE;
+}
+
+// As on Windows for files, writes everything unless an error occurs:
+// write() may write less than asked, e.g. when interrupted by a signal.
+BOOL WriteFile(HANDLE file, const void* buffer, DWORD size, DWORD* written, void*) {
+  const char* data = static_cast<const char*>(buffer);
+  DWORD total = 0;
+  while (total < size) {
+    ssize_t result = write(HandleFd(file), data + total, size - total);
+    if (result < 0) {
+      if (errno == EINTR)
+        continue;
+      SetErrorFromErrno();
+      *written = total;
+      return FALSE;
+    }
+    total += static_cast<DWORD>(result);
+  }
+  *written = total;
+  return TRUE;
+}
+
+BOOL SetFilePointerEx(HANDLE file, LARGE_INTEGER distance, LARGE_INTEGER* new_position, DWORD move_method) {
+  int whence = move_method == FILE_BEGIN ? SEEK_SET : (move_method == FILE_END ? SEEK_END : SEEK_CUR);
+  off_t result = lseek(HandleFd(file), static_cast<off_t>(distance.QuadPart), whence);
+  if (result < 0) {
+    SetErrorFromErrno();
+    return FALSE;
+  }
+  if (new_position != NULL)
+    new_position->QuadPart = result;
+  return TRUE;
+}
+
+BOOL SetEndOfFile(HANDLE file) {
+  int fd = HandleFd(file);
+  off_t position = lseek(fd, 0, SEEK_CUR);
+  if (position < 0 || ftruncate(fd, position) != 0) {
+    SetErrorFromErrno();
+    return FALSE;
+  }
+  return TRUE;
+}
+
+BOOL FlushFileBuffers(HANDLE file) {
+  if (fsync(HandleFd(file)) != 0) {
+    SetErrorFromErrno();
+    return FALSE;
+  }
+  return TRUE;
+}
+
+BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* size) {
+  struct stat file_stat;
+  if (fstat(HandleFd(file), &file_stat) != 0) {
+    SetErrorFromErrno();
+    return FALSE;
+  }
+  size->QuadPart = file_stat.st_size;
+  return TRUE;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Read-only mappings of whole files, the only kind the library uses.
+//
+HANDLE CreateFileMapping(HANDLE file, void*, DWORD,
+                         DWORD, DWORD, const WCHAR*) {
+  struct stat file_stat;
+  if (fstat(HandleFd(file), &file_stat) != 0) {
+    SetErrorFromErrno();
+    return NULL;
+  }
+  if (file_stat.st_size == 0) {
+    // As on Windows, empty files can't be mapped.
+    LastError = ERROR_FILE_INVALID;
+    return NULL;
+  }
+
+  int fd = dup(HandleFd(file));
+  if (fd < 0) {
+    SetErrorFromErrno();
+    return NULL;
+  }
+  return NewHandle(fd);
+}
+
+LPVOID MapViewOfFile(HANDLE mapping, DWORD, DWORD offset_high, DWORD offset_low, size_t size) {
+  int fd = HandleFd(mapping);
+  if (size == 0) {
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+      SetErrorFromErrno();
+      return NULL;
+    }
+    size = static_cast<size_t>(file_stat.st_size);
+  }
+
+  off_t offset = static_cast<off_t>((static_cast<UINT64>(offset_high) << 32) | offset_low);
+  void* view = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, offset);
+  if (view == MAP_FAILED) {
+    SetErrorFromErrno();
+    return NULL;
+  }
+
+  std::lock_guard<std::mutex> lock(ViewsMutex);
+  Views[view] = size;
+  return view;
+}
+
+BOOL UnmapViewOfFile(const void* view) {
+  size_t size;
+  {
+    std::lock_guard<std::mutex> lock(ViewsMutex);
+    std::map<const void*, size_t>::iterator it = Views.find(view);
+    if (it == Views.end()) {
+      LastError = ERROR_INVALID_PARAMETER;
+      return FALSE;
+    }
+    size = it->second;
+    Views.erase(it);
+  }
+  munmap(const_cast<void*>(view), size);
+  return TRUE;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+HANDLE CreateEvent(void*, BOOL, BOOL, const WCHAR*) {
+  return NewHandle(-1);
+}
+
+void Sleep(DWORD milliseconds) {
+  struct timespec duration;
+  duration.tv_sec = milliseconds / 1000;
+  duration.tv_nsec = static_cast<long>(milliseconds % 1000) * 1000000;
+  while (nanosleep(&duration, &duration) != 0 && errno == EINTR) {
+  }
+}
+
+ULONGLONG GetTickCount64() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<ULONGLONG>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+}
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  counter->QuadPart = static_cast<LONGLONG>(now.tv_sec) * 1000000000 + now.tv_nsec;
+  return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency) {
+  frequency->QuadPart = 1000000000;
+  return TRUE;
+}
+
+LONG InterlockedIncrement(LONG volatile* value) {
+  return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+LONG InterlockedDecrement(LONG volatile* value) {
+  return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST);
+}
+
+#endif  // _WIN32
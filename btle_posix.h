@@ -0,0 +1,294 @@
+#pragma once
+
+// The subset of the Win32 and Bluetooth LE APIs used by the library, to
+// build it on other platforms against a simulated or replayed GATT backend.
+//
+// Types, constants and structures have their Windows sizes and values, so
+// that traces and sample logs are portable. The functions are implemented
+// on top of POSIX in btle_posix.cpp. Handles are only files, file mappings
+// and placeholder events that can be closed (CreateEvent() doesn't create a
+// waitable event).
+#ifndef _WIN32
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+
+typedef uint8_t UINT8, BYTE, UCHAR, BOOLEAN;
+typedef int8_t INT8;
+typedef char CHAR;
+typedef uint16_t UINT16, USHORT, WORD;
+typedef int16_t INT16, SHORT;
+typedef uint32_t UINT32, UINT, DWORD, ULONG;
+typedef int32_t INT32, INT, BOOL, LONG, HRESULT;
+typedef uint64_t UINT64, ULONGLONG, ULONG64, DWORD64;
+typedef int64_t INT64, LONGLONG;
+typedef wchar_t WCHAR, _TCHAR;
+typedef void VOID;
+typedef void* PVOID;
+typedef void* LPVOID;
+typedef void* HANDLE;
+
+#define TRUE 1
+#define FALSE 0
+#define CALLBACK
+#define WINAPI
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _T(x) L##x
+
+typedef union _LARGE_INTEGER {
+  struct {
+    DWORD LowPart;
+    LONG HighPart;
+  };
+  LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct _GUID {
+  uint32_t Data1;
+  uint16_t Data2;
+  uint16_t Data3;
+  uint8_t Data4[8];
+} GUID, UUID;
+typedef GUID* LPGUID;
+
+inline bool operator==(const GUID& x, const GUID& y) {
+  return memcmp(&x, &y, sizeof(GUID)) == 0;
+}
+
+inline bool operator!=(const GUID& x, const GUID& y) {
+  return !(x == y);
+}
+
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define INFINITE 0xFFFFFFFF
+
+//////////////////////////////////////////////////////////////////////////////
+// Errors
+//
+#define S_OK ((HRESULT)0L)
+#define E_FAIL ((HRESULT)0x80004005L)
+#define E_INVALIDARG ((HRESULT)0x80070057L)
+#define E_HANDLE ((HRESULT)0x80070006L)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define HRESULT_CODE(hr) ((hr) & 0xFFFF)
+#define HRESULT_FROM_WIN32(x) \
+  ((HRESULT)(x) <= 0 ? ((HRESULT)(x)) : ((HRESULT)(((x) & 0x0000FFFF) | (7 << 16) | 0x80000000)))
+
+#define ERROR_SUCCESS 0L
+#define ERROR_FILE_NOT_FOUND 2L
+#define ERROR_PATH_NOT_FOUND 3L
+#define ERROR_ACCESS_DENIED 5L
+#define ERROR_INVALID_HANDLE 6L
+#define ERROR_NOT_ENOUGH_MEMORY 8L
+#define ERROR_INVALID_DATA 13L
+#define ERROR_GEN_FAILURE 31L
+#define ERROR_HANDLE_EOF 38L
+#define ERROR_NOT_SUPPORTED 50L
+#define ERROR_INVALID_PARAMETER 87L
+#define ERROR_SEM_TIMEOUT 121L
+#define ERROR_INSUFFICIENT_BUFFER 122L
+#define ERROR_MORE_DATA 234L
+#define ERROR_NO_MORE_ITEMS 259L
+#define ERROR_OPERATION_ABORTED 995L
+#define ERROR_FILE_INVALID 1006L
+#define ERROR_DEVICE_NOT_CONNECTED 1167L
+#define ERROR_NOT_FOUND 1168L
+#define ERROR_CANCELLED 1223L
+#define ERROR_TIMEOUT 1460L
+
+//////////////////////////////////////////////////////////////////////////////
+// Files
+//
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define FILE_SHARE_READ 0x00000001
+#define FILE_SHARE_WRITE 0x00000002
+#define CREATE_NEW 1
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define OPEN_ALWAYS 4
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define FILE_BEGIN 0
+#define FILE_CURRENT 1
+#define FILE_END 2
+#define PAGE_READONLY 0x02
+#define FILE_MAP_READ 0x0004
+
+DWORD GetLastError();
+void SetLastError(DWORD error);
+BOOL CloseHandle(HANDLE handle);
+// Fails with ERROR_INVALID_HANDLE for closed handles. No flags are set.
+BOOL GetHandleInformation(HANDLE handle, DWORD* flags);
+HANDLE CreateFile(const WCHAR* path, DWORD desired_access, DWORD share_mode, void* security_attributes,
+                  DWORD creation_disposition, DWORD flags_and_attributes, HANDLE template_file);
+BOOL ReadFile(HANDLE file, LPVOID buffer, DWORD size, DWORD* read, void* overlapped);
+BOOL WriteFile(HANDLE file, const void* buffer, DWORD size, DWORD* written, void* overlapped);
+BOOL SetFilePointerEx(HANDLE file, LARGE_INTEGER distance, LARGE_INTEGER* new_position, DWORD move_method);
+BOOL SetEndOfFile(HANDLE file);
+BOOL FlushFileBuffers(HANDLE file);
+BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* size);
+HANDLE CreateFileMapping(HANDLE file, void* security_attributes, DWORD protect,
+                         DWORD maximum_size_high, DWORD maximum_size_low, const WCHAR* name);
+LPVOID MapViewOfFile(HANDLE mapping, DWORD desired_access, DWORD offset_high, DWORD offset_low, size_t size);
+BOOL UnmapViewOfFile(const void* view);
+
+//////////////////////////////////////////////////////////////////////////////
+// Threads and time
+//
+HANDLE CreateEvent(void* security_attributes, BOOL manual_reset, BOOL initial_state, const WCHAR* name);
+void Sleep(DWORD milliseconds);
+ULONGLONG GetTickCount64();
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter);
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+LONG InterlockedIncrement(LONG volatile* value);
+LONG InterlockedDecrement(LONG volatile* value);
+
+#define ZeroMemory(destination, length) memset((destination), 0, (length))
+#define RtlZeroMemory(destination, length) memset((destination), 0, (length))
+#define CopyMemory(destination, source, length) memcpy((destination), (source), (length))
+
+//////////////////////////////////////////////////////////////////////////////
+// Device properties (devpropdef.h)
+//
+typedef ULONG DEVPROPID;
+
+typedef struct _DEVPROPKEY {
+  GUID fmtid;
+  DEVPROPID pid;
+} DEVPROPKEY;
+
+//////////////////////////////////////////////////////////////////////////////
+// Bluetooth (bluetoothapis.h)
+//
+typedef ULONGLONG BTH_ADDR;
+
+typedef struct _BLUETOOTH_ADDRESS {
+  union {
+    BTH_ADDR ullLong;
+    BYTE rgBytes[6];
+  };
+} BLUETOOTH_ADDRESS;
+
+#define BLUETOOTH_NULL_ADDRESS ((ULONGLONG)0x0)
+
+//////////////////////////////////////////////////////////////////////////////
+// Bluetooth LE (bthledef.h and bluetoothleapis.h)
+//
+typedef struct _BTH_LE_UUID {
+  BOOLEAN IsShortUuid;
+  union {
+    USHORT ShortUuid;
+    GUID LongUuid;
+  } Value;
+} BTH_LE_UUID, *PBTH_LE_UUID;
+
+typedef struct _BTH_LE_GATT_SERVICE {
+  BTH_LE_UUID ServiceUuid;
+  USHORT AttributeHandle;
+} BTH_LE_GATT_SERVICE, *PBTH_LE_GATT_SERVICE;
+
+typedef enum _BTH_LE_GATT_DESCRIPTOR_TYPE {
+  CharacteristicExtendedProperties,
+  CharacteristicUserDescription,
+  ClientCharacteristicConfiguration,
+  ServerCharacteristicConfiguration,
+  CharacteristicFormat,
+  CharacteristicAggregateFormat,
+  CustomDescriptor
+} BTH_LE_GATT_DESCRIPTOR_TYPE;
+
+typedef struct _BTH_LE_GATT_CHARACTERISTIC {
+  USHORT ServiceHandle;
+  BTH_LE_UUID CharacteristicUuid;
+  USHORT AttributeHandle;
+  USHORT CharacteristicValueHandle;
+  BOOLEAN IsBroadcastable;
+  BOOLEAN IsReadable;
+  BOOLEAN IsWritable;
+  BOOLEAN IsWritableWithoutResponse;
+  BOOLEAN IsSignedWritable;
+  BOOLEAN IsNotifiable;
+  BOOLEAN IsIndicatable;
+  BOOLEAN HasExtendedProperties;
+} BTH_LE_GATT_CHARACTERISTIC, *PBTH_LE_GATT_CHARACTERISTIC;
+
+typedef struct _BTH_LE_GATT_CHARACTERISTIC_VALUE {
+  ULONG DataSize;
+  UCHAR Data[1];
+} BTH_LE_GATT_CHARACTERISTIC_VALUE, *PBTH_LE_GATT_CHARACTERISTIC_VALUE;
+
+typedef struct _BTH_LE_GATT_DESCRIPTOR {
+  USHORT ServiceHandle;
+  USHORT CharacteristicHandle;
+  BTH_LE_GATT_DESCRIPTOR_TYPE DescriptorType;
+  BTH_LE_UUID DescriptorUuid;
+  USHORT AttributeHandle;
+} BTH_LE_GATT_DESCRIPTOR, *PBTH_LE_GATT_DESCRIPTOR;
+
+typedef struct _BTH_LE_GATT_DESCRIPTOR_VALUE {
+  BTH_LE_GATT_DESCRIPTOR_TYPE DescriptorType;
+  BTH_LE_UUID DescriptorUuid;
+  union {
+    struct {
+      BOOLEAN IsReliableWriteEnabled;
+      BOOLEAN IsAuxiliariesWritable;
+    } CharacteristicExtendedProperties;
+    struct {
+      BOOLEAN IsSubscribeToNotification;
+      BOOLEAN IsSubscribeToIndication;
+    } ClientCharacteristicConfiguration;
+    struct {
+      BOOLEAN IsBroadcast;
+    } ServerCharacteristicConfiguration;
+    struct {
+      UCHAR Format;
+      UCHAR Exponent;
+      BTH_LE_UUID Unit;
+      UCHAR NameSpace;
+      BTH_LE_UUID Description;
+    } CharacteristicFormat;
+  };
+  ULONG DataSize;
+  UCHAR Data[1];
+} BTH_LE_GATT_DESCRIPTOR_VALUE, *PBTH_LE_GATT_DESCRIPTOR_VALUE;
+
+typedef enum _BTH_LE_GATT_EVENT_TYPE {
+  CharacteristicValueChangedEvent,
+} BTH_LE_GATT_EVENT_TYPE;
+
+typedef VOID (CALLBACK *PFNBLUETOOTH_GATT_EVENT_CALLBACK)(BTH_LE_GATT_EVENT_TYPE EventType, PVOID EventOutParameter, PVOID Context);
+
+typedef struct _BLUETOOTH_GATT_VALUE_CHANGED_EVENT_REGISTRATION {
+  USHORT NumCharacteristics;
+  BTH_LE_GATT_CHARACTERISTIC Characteristics[1];
+} BLUETOOTH_GATT_VALUE_CHANGED_EVENT_REGISTRATION, *PBLUETOOTH_GATT_VALUE_CHANGED_EVENT_REGISTRATION;
+
+typedef struct _BLUETOOTH_GATT_VALUE_CHANGED_EVENT {
+  USHORT ChangedAttributeHandle;
+  size_t CharacteristicValueDataSize;
+  PBTH_LE_GATT_CHARACTERISTIC_VALUE CharacteristicValue;
+} BLUETOOTH_GATT_VALUE_CHANGED_EVENT, *PBLUETOOTH_GATT_VALUE_CHANGED_EVENT;
+
+typedef ULONG64 BTH_LE_GATT_RELIABLE_WRITE_CONTEXT;
+typedef HANDLE BLUETOOTH_GATT_EVENT_HANDLE;
+
+static const GUID BTH_LE_ATT_BLUETOOTH_BASE_GUID =
+    { 0x00000000, 0x0000, 0x1000, { 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB } };
+static const GUID GUID_BLUETOOTHLE_DEVICE_INTERFACE =
+    { 0x781aee18, 0x7733, 0x4ce4, { 0xad, 0xd0, 0x91, 0xf4, 0x1c, 0x67, 0xb5, 0x92 } };
+
+#define BLUETOOTH_GATT_FLAG_NONE 0x00000000
+#define BLUETOOTH_GATT_FLAG_CONNECTION_ENCRYPTED 0x00000001
+#define BLUETOOTH_GATT_FLAG_CONNECTION_AUTHENTICATED 0x00000002
+#define BLUETOOTH_GATT_FLAG_FORCE_READ_FROM_DEVICE 0x00000004
+#define BLUETOOTH_GATT_FLAG_FORCE_READ_FROM_CACHE 0x00000008
+#define BLUETOOTH_GATT_FLAG_SIGNED_WRITE 0x00000010
+#define BLUETOOTH_GATT_FLAG_WRITE_WITHOUT_RESPONSE 0x00000020
+#define BLUETOOTH_GATT_FLAG_RETURN_ALL 0x00000040
+
+#endif  // _WIN32
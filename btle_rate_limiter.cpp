@@ -0,0 +1,396 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "btle_rate_limiter.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+void TokenBucket::Configure(const RateLimit& limit, ULONGLONG now_us) {
+  rate_ = limit.rate;
+  burst_ = std::max(limit.burst, 1.0);
+  tokens_ = burst_;
+  last_us_ = now_us;
+}
+
+void TokenBucket::Refill(ULONGLONG now_us) {
+  if (now_us <= last_us_)
+    return;
+  tokens_ = std::min(burst_, tokens_ + rate_ * (now_us - last_us_) / 1000000.0);
+  last_us_ = now_us;
+}
+
+ULONGLONG TokenBucket::Delay(ULONGLONG now_us) {
+  if (rate_ <= 0.0)
+    return 0;
+
+  Refill(now_us);
+  if (tokens_ >= 1.0)
+    return 0;
+  return static_cast<ULONGLONG>((1.0 - tokens_) * 1000000.0 / rate_) + 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+WriteRateLimiter::WriteRateLimiter(const RateLimit& device_limit, const RateLimit& characteristic_limit)
+  : device_limit_(device_limit), characteristic_limit_(characteristic_limit), next_caller_id_(1) {
+}
+
+WriteRateLimiter::~WriteRateLimiter() {
+}
+
+void WriteRateLimiter::SetDeviceLimit(ULONGLONG device_address, const RateLimit& limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  device_limits_[device_address] = limit;
+  std::map<ULONGLONG, DeviceState>::iterator it = devices_.find(device_address);
+  if (it != devices_.end())
+    it->second.configured = false;
+}
+
+void WriteRateLimiter::SetCharacteristicLimit(ULONGLONG device_address, USHORT value_handle, const RateLimit& limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  DeviceState& device = devices_[device_address];
+  device.characteristic_limits[value_handle] = limit;
+  std::map<USHORT, CharacteristicState>::iterator it = device.characteristics.find(value_handle);
+  if (it != device.characteristics.end())
+    it->second.configured = false;
+}
+
+WriteRateLimiter::DeviceState& WriteRateLimiter::GetDevice(ULONGLONG device_address, ULONGLONG now_us) {
+  DeviceState& device = devices_[device_address];
+  if (!device.configured) {
+    std::map<ULONGLONG, RateLimit>::const_iterator it = device_limits_.find(device_address);
+    device.bucket.Configure(it != device_limits_.end() ? it->second : device_limit_, now_us);
+    device.configured = true;
+  }
+  return device;
+}
+
+WriteRateLimiter::CharacteristicState& WriteRateLimiter::GetCharacteristic(DeviceState& device, USHORT value_handle, ULONGLONG now_us) {
+  CharacteristicState& characteristic = device.characteristics[value_handle];
+  if (!characteristic.configured) {
+    std::map<USHORT, RateLimit>::const_iterator it = device.characteristic_limits.find(value_handle);
+    characteristic.bucket.Configure(it != device.characteristic_limits.end() ? it->second : characteristic_limit_, now_us);
+    characteristic.configured = true;
+  }
+  return characteristic;
+}
+
+void WriteRateLimiter::RecordQueued(DeviceState& device, int delta) {
+  metrics_.queue_depth += delta;
+  metrics_.max_queue_depth = std::max(metrics_.max_queue_depth, metrics_.queue_depth);
+  device.metrics.queue_depth += delta;
+  device.metrics.max_queue_depth = std::max(device.metrics.max_queue_depth, device.metrics.queue_depth);
+}
+
+void WriteRateLimiter::RecordWrite(DeviceState& device, bool throttled, ULONGLONG delay_us) {
+  WriteLimiterMetrics* all_metrics[] = { &metrics_, &device.metrics };
+  for (int i = 0; i < 2; i++) {
+    WriteLimiterMetrics& metrics = *all_metrics[i];
+    metrics.writes++;
+    if (throttled) {
+      metrics.throttled_writes++;
+      metrics.total_throttle_delay_us += delay_us;
+      metrics.max_throttle_delay_us = std::max(metrics.max_throttle_delay_us, delay_us);
+    }
+  }
+}
+
+void WriteRateLimiter::RecordAbandoned(DeviceState& device, bool timed_out) {
+  WriteLimiterMetrics* all_metrics[] = { &metrics_, &device.metrics };
+  for (int i = 0; i < 2; i++) {
+    if (timed_out) {
+      all_metrics[i]->timeouts++;
+    } else {
+      all_metrics[i]->cancellations++;
+    }
+  }
+}
+
+scoped_refptr<WriteRateLimiter::PendingWrite> WriteRateLimiter::Submit(
+    DeviceState& device, ULONGLONG device_address, USHORT value_handle, scoped_refptr<CharacteristicValue> value,
+    bool coalesce, IoExecutor* executor, const Caller& caller, ULONGLONG now_us, ULONG* caller_id) {
+  CharacteristicState& characteristic = GetCharacteristic(device, value_handle, now_us);
+  scoped_refptr<PendingWrite> pending;
+  if (coalesce && characteristic.pending != NULL && (characteristic.pending->executor != NULL) == (executor != NULL)) {
+    // A write of the same kind to the same characteristic is already waiting
+    // for a token: replace its value, written the way the latest caller
+    // writes it (flags, deadline...), and share its result.
+    pending = scoped_refptr<PendingWrite>(characteristic.pending);
+    metrics_.coalesced_writes++;
+    device.metrics.coalesced_writes++;
+  } else {
+    pending = scoped_refptr<PendingWrite>(new PendingWrite());
+    pending->device_address = device_address;
+    pending->value_handle = value_handle;
+    pending->start_us = now_us;
+    pending->executor = executor;
+    if (coalesce)
+      characteristic.pending = pending.get();
+    device.queue.push_back(pending);
+    RecordQueued(device, 1);
+  }
+
+  pending->value = value;
+  pending->callers.push_back(caller);
+  pending->callers.back().id = *caller_id = next_caller_id_++;
+  return pending;
+}
+
+ULONGLONG WriteRateLimiter::Delay(DeviceState& device, ULONGLONG now_us) {
+  CharacteristicState& characteristic = GetCharacteristic(device, device.queue.front()->value_handle, now_us);
+  return std::max(device.bucket.Delay(now_us), characteristic.bucket.Delay(now_us));
+}
+
+void WriteRateLimiter::Dequeue(DeviceState& device, PendingWrite* pending) {
+  std::deque<scoped_refptr<PendingWrite>>::iterator it = device.queue.begin();
+  while (it != device.queue.end() && it->get() != pending)
+    ++it;
+  if (it == device.queue.end())
+    return;
+
+  bool front = (it == device.queue.begin());
+  std::map<USHORT, CharacteristicState>::iterator characteristic = device.characteristics.find(pending->value_handle);
+  if (characteristic != device.characteristics.end() && characteristic->second.pending == pending)
+    characteristic->second.pending = NULL;
+  device.queue.erase(it);
+  RecordQueued(device, -1);
+
+  // Blocking writes watch the front of the queue themselves, asynchronous
+  // ones don't hold a thread and need to be posted.
+  if (front && !device.queue.empty() && device.queue.front()->executor != NULL) {
+    scoped_refptr<PendingWrite> next = device.queue.front();
+    next->executor->Post([this, next]() { ResumeAsync(next); });
+  }
+  condition_.notify_all();
+}
+
+scoped_refptr<CharacteristicValue> WriteRateLimiter::Issue(DeviceState& device) {
+  ULONGLONG now_us = monotonic_microseconds();
+  scoped_refptr<PendingWrite> pending = device.queue.front();
+  CharacteristicState& characteristic = GetCharacteristic(device, pending->value_handle, now_us);
+  device.bucket.Consume();
+  characteristic.bucket.Consume();
+  pending->issued = true;
+  RecordWrite(device, pending->throttled, now_us - pending->start_us);
+  Dequeue(device, pending.get());
+  return pending->value;
+}
+
+void WriteRateLimiter::ResumeAsync(scoped_refptr<PendingWrite> pending) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ULONGLONG now_us = monotonic_microseconds();
+  DeviceState& device = GetDevice(pending->device_address, now_us);
+  // Removed from the queue since this was posted.
+  if (device.queue.empty() || device.queue.front().get() != pending.get())
+    return;
+
+  ULONGLONG delay_us = Delay(device, now_us);
+  if (delay_us != 0) {
+    pending->throttled = true;
+    DWORD delay_ms = static_cast<DWORD>((delay_us + 999) / 1000);
+    pending->executor->PostDelayed([this, pending]() { ResumeAsync(pending); }, delay_ms);
+    return;
+  }
+
+  scoped_refptr<CharacteristicValue> value = Issue(device);
+  AsyncWriteFunction write = pending->callers.back().async_write;
+  lock.unlock();
+  write(value, [this, pending](bool success, const std::string& error) {
+    Complete(pending, success, error);
+  });
+}
+
+bool WriteRateLimiter::RemoveCaller(PendingWrite* pending, ULONG caller_id, bool timed_out, Caller* caller) {
+  if (pending->issued)
+    return false;
+  std::vector<Caller>::iterator it = pending->callers.begin();
+  while (it != pending->callers.end() && it->id != caller_id)
+    ++it;
+  if (it == pending->callers.end())
+    return false;
+
+  *caller = *it;
+  pending->callers.erase(it);
+  DeviceState& device = GetDevice(pending->device_address, monotonic_microseconds());
+  RecordAbandoned(device, timed_out);
+  if (pending->callers.empty())
+    Dequeue(device, pending);
+  return true;
+}
+
+void WriteRateLimiter::AbandonAsync(scoped_refptr<PendingWrite> pending, ULONG caller_id, bool timed_out) {
+  Caller caller;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!RemoveCaller(pending.get(), caller_id, timed_out, &caller))
+      return;
+  }
+  ReleaseCaller(pending->executor, caller);
+  caller.callback(false, timed_out ? kOperationTimedOut : kOperationCancelled);
+}
+
+void WriteRateLimiter::Complete(scoped_refptr<PendingWrite> pending, bool success, const std::string& error) {
+  std::vector<Caller> callers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callers.swap(pending->callers);
+  }
+  for (std::vector<Caller>::const_iterator it = callers.begin(); it != callers.end(); ++it) {
+    ReleaseCaller(pending->executor, *it);
+    it->callback(success, error);
+  }
+}
+
+void WriteRateLimiter::ReleaseCaller(IoExecutor* executor, const Caller& caller) {
+  // The deadline timer holds a reference to the write until it fires.
+  if (caller.timer_id != 0)
+    executor->CancelDelayed(caller.timer_id);
+  caller.context.token().Unregister(caller.cancel_id);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool WriteRateLimiter::Write(ULONGLONG device_address,
+                             USHORT value_handle,
+                             scoped_refptr<CharacteristicValue> value,
+                             bool coalesce,
+                             const OperationContext& context,
+                             const WriteFunction& write,
+                             std::string* error) {
+  // Wakes up the waits below. Registered without holding "mutex_", which
+  // the callback takes when invoked right away.
+  int cancel_id = context.token().Register([this]() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    condition_.notify_all();
+  });
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  ULONGLONG start_us = monotonic_microseconds();
+  DeviceState& device = GetDevice(device_address, start_us);
+
+  bool done = false;
+  bool success = false;
+  std::string write_error;
+  Caller caller;
+  caller.context = context;
+  caller.write = write;
+  caller.callback = [this, &done, &success, &write_error](bool result, const std::string& result_error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done = true;
+    success = result;
+    write_error = result_error;
+    condition_.notify_all();
+  };
+  ULONG caller_id;
+  scoped_refptr<PendingWrite> pending = Submit(device, device_address, value_handle, value, coalesce, NULL, caller, start_us, &caller_id);
+
+  // Any caller of the write can issue it: the first one may have given up.
+  while (!done) {
+    ULONGLONG delay_us = 0;
+    if (!pending->issued) {
+      if (context.expired() || context.token().cancelled()) {
+        bool timed_out = !context.token().cancelled();
+        RemoveCaller(pending.get(), caller_id, timed_out, &caller);
+        lock.unlock();
+        context.token().Unregister(cancel_id);
+        *error = timed_out ? kOperationTimedOut : kOperationCancelled;
+        return false;
+      }
+      if (device.queue.front().get() == pending.get()) {
+        delay_us = Delay(device, monotonic_microseconds());
+        if (delay_us == 0) {
+          scoped_refptr<CharacteristicValue> issued_value = Issue(device);
+          WriteFunction latest_write = pending->callers.back().write;
+          lock.unlock();
+          std::string result_error;
+          bool result = latest_write(issued_value, &result_error);
+          Complete(pending, result, result_error);
+          lock.lock();
+          continue;
+        }
+        pending->throttled = true;
+      }
+    }
+
+    // Waits for a token, for the write ahead to be issued or for the result
+    // of the write, but not past the deadline once issued.
+    if (!pending->issued && context.deadline_us() != 0) {
+      ULONGLONG now_us = monotonic_microseconds();
+      ULONGLONG remaining_us = context.deadline_us() > now_us ? context.deadline_us() - now_us : 0;
+      if (delay_us == 0 || remaining_us < delay_us)
+        delay_us = remaining_us;
+      if (delay_us == 0)
+        continue;
+    }
+    if (delay_us != 0) {
+      condition_.wait_for(lock, std::chrono::microseconds(delay_us));
+    } else {
+      condition_.wait(lock);
+    }
+  }
+  lock.unlock();
+  context.token().Unregister(cancel_id);
+
+  if (!success)
+    *error = write_error;
+  return success;
+}
+
+void WriteRateLimiter::WriteAsync(IoExecutor* executor,
+                                  ULONGLONG device_address,
+                                  USHORT value_handle,
+                                  scoped_refptr<CharacteristicValue> value,
+                                  bool coalesce,
+                                  const OperationContext& context,
+                                  const AsyncWriteFunction& write,
+                                  const WriteCallback& callback) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ULONGLONG now_us = monotonic_microseconds();
+  DeviceState& device = GetDevice(device_address, now_us);
+
+  Caller caller;
+  caller.context = context;
+  caller.callback = callback;
+  caller.async_write = write;
+  ULONG caller_id;
+  scoped_refptr<PendingWrite> pending = Submit(device, device_address, value_handle, value, coalesce, executor, caller, now_us, &caller_id);
+
+  // The deadline and cancellation callbacks only go through the executor,
+  // and wait for "mutex_": they can't run before the ids are stored.
+  Caller& added = pending->callers.back();
+  DWORD timeout_ms = context.remaining_ms();
+  if (timeout_ms != INFINITE)
+    added.timer_id = executor->PostDelayed([this, pending, caller_id]() { AbandonAsync(pending, caller_id, true); }, timeout_ms);
+  added.cancel_id = context.token().Register([this, executor, pending, caller_id]() {
+    executor->Post([this, pending, caller_id]() { AbandonAsync(pending, caller_id, false); });
+  });
+
+  // Otherwise, resumed by the write ahead of it once issued.
+  bool first = (pending->callers.size() == 1 && device.queue.front().get() == pending.get());
+  lock.unlock();
+  if (first)
+    ResumeAsync(pending);
+}
+
+WriteLimiterMetrics WriteRateLimiter::metrics() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return metrics_;
+}
+
+bool WriteRateLimiter::GetDeviceMetrics(ULONGLONG device_address, WriteLimiterMetrics* metrics) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<ULONGLONG, DeviceState>::const_iterator it = devices_.find(device_address);
+  if (it == devices_.end())
+    return false;
+  *metrics = it->second.metrics;
+  return true;
+}
+
+}  // namespace btle
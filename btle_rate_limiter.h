@@ -0,0 +1,255 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base.h"
+#include "btle.h"
+#include "btle_async.h"
+
+namespace btle {
+
+struct RateLimit {
+  RateLimit() : rate(0.0), burst(1.0) {
+  }
+
+  RateLimit(double r, double b) : rate(r), burst(b) {
+  }
+
+  // Sustained number of writes per second (0 = unlimited).
+  double rate;
+  // Number of writes allowed back to back after an idle period.
+  double burst;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Classic token bucket: "rate" tokens per second, up to "burst" tokens.
+//
+class TokenBucket {
+public:
+  TokenBucket() : rate_(0.0), burst_(1.0), tokens_(1.0), last_us_(0) {
+  }
+
+  void Configure(const RateLimit& limit, ULONGLONG now_us);
+
+  // Returns the number of microseconds until a token is available (0 if one
+  // is available now).
+  ULONGLONG Delay(ULONGLONG now_us);
+
+  // Takes a token. Only valid when Delay() returned 0.
+  void Consume() {
+    if (rate_ > 0.0)
+      tokens_ -= 1.0;
+  }
+
+private:
+  void Refill(ULONGLONG now_us);
+
+  double rate_;
+  double burst_;
+  double tokens_;
+  ULONGLONG last_us_;
+};
+
+struct WriteLimiterMetrics {
+  WriteLimiterMetrics()
+    : writes(0),
+      coalesced_writes(0),
+      throttled_writes(0),
+      total_throttle_delay_us(0),
+      max_throttle_delay_us(0),
+      queue_depth(0),
+      max_queue_depth(0),
+      timeouts(0),
+      cancellations(0) {
+  }
+
+  // Number of values actually written to devices.
+  ULONG writes;
+  // Number of values replaced by a later value before being written.
+  ULONG coalesced_writes;
+  // Number of writes that had to wait for a token.
+  ULONG throttled_writes;
+  ULONGLONG total_throttle_delay_us;
+  ULONGLONG max_throttle_delay_us;
+  // Number of writes currently waiting for a token.
+  ULONG queue_depth;
+  ULONG max_queue_depth;
+  // Number of callers whose deadline expired, or which were cancelled,
+  // before their write was issued.
+  ULONG timeouts;
+  ULONG cancellations;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Throttles characteristic writes with one token bucket per device and one
+// per characteristic. A write waiting for a token can be superseded by a
+// later write of the same kind (blocking or asynchronous) to the same
+// characteristic: only the last value is written, with the write function of
+// its caller, and every caller gets the result of that write.
+//
+// Writes to a device are issued in the order they were submitted, blocking
+// and asynchronous ones alike: a write waits until the writes submitted
+// before it were issued, then until both buckets have a token.
+//
+// A caller whose operation context expires or gets cancelled before its
+// write is issued completes right away with kOperationTimedOut or
+// kOperationCancelled. A write left without callers leaves the queue
+// without taking tokens.
+//
+// Devices are identified by their Bluetooth address, characteristics by
+// their value handle.
+//
+class WriteRateLimiter {
+public:
+  typedef std::function<bool(scoped_refptr<CharacteristicValue> value, std::string* error)> WriteFunction;
+  typedef std::function<void(bool success, const std::string& error)> WriteCallback;
+  // Starts writing "value", and invokes "callback" once done.
+  typedef std::function<void(scoped_refptr<CharacteristicValue> value, const WriteCallback& callback)> AsyncWriteFunction;
+
+  WriteRateLimiter(const RateLimit& device_limit, const RateLimit& characteristic_limit);
+  ~WriteRateLimiter();
+
+  // Overrides the default limits for a device, or one of its characteristics.
+  void SetDeviceLimit(ULONGLONG device_address, const RateLimit& limit);
+  void SetCharacteristicLimit(ULONGLONG device_address, USHORT value_handle, const RateLimit& limit);
+
+  // Blocks until the write is allowed, then calls "write". With "coalesce"
+  // false, the value is always written (e.g. for streams of distinct blocks).
+  bool Write(ULONGLONG device_address,
+             USHORT value_handle,
+             scoped_refptr<CharacteristicValue> value,
+             bool coalesce,
+             const OperationContext& context,
+             const WriteFunction& write,
+             std::string* error);
+
+  // Same, without blocking: "write" is started on an executor thread once
+  // the write is allowed, waiting for tokens with IoExecutor::PostDelayed(),
+  // and "callback" gets its result.
+  void WriteAsync(IoExecutor* executor,
+                  ULONGLONG device_address,
+                  USHORT value_handle,
+                  scoped_refptr<CharacteristicValue> value,
+                  bool coalesce,
+                  const OperationContext& context,
+                  const AsyncWriteFunction& write,
+                  const WriteCallback& callback);
+
+  WriteLimiterMetrics metrics() const;
+  bool GetDeviceMetrics(ULONGLONG device_address, WriteLimiterMetrics* metrics) const;
+
+private:
+  // Caller waiting for the result of a write, with the write function of
+  // its value: "write" for blocking writes, "async_write" for asynchronous
+  // ones.
+  struct Caller {
+    Caller() : id(0), timer_id(0), cancel_id(0) {
+    }
+
+    ULONG id;
+    OperationContext context;
+    WriteCallback callback;
+    WriteFunction write;
+    AsyncWriteFunction async_write;
+    // Deadline timer and cancellation callback of asynchronous callers.
+    ULONG timer_id;
+    int cancel_id;
+  };
+
+  // Referenced by the device queue, and by the tasks posted for it.
+  struct PendingWrite : public RefCounted<PendingWrite> {
+    PendingWrite() : device_address(0), value_handle(0), start_us(0), throttled(false), issued(false), executor(NULL) {
+    }
+
+    ULONGLONG device_address;
+    USHORT value_handle;
+    scoped_refptr<CharacteristicValue> value;
+    ULONGLONG start_us;
+    bool throttled;
+    bool issued;
+    // Set for asynchronous writes, which are resumed on "executor" when
+    // they reach the front of the device queue.
+    IoExecutor* executor;
+    // Callers in submission order: the last one is the caller of "value",
+    // whose write function is used. Empty once the write is completed, or
+    // removed from the queue.
+    std::vector<Caller> callers;
+  };
+
+  struct CharacteristicState {
+    CharacteristicState() : configured(false), pending(NULL) {
+    }
+
+    bool configured;
+    TokenBucket bucket;
+    // Write waiting for a token, values submitted meanwhile replace its value.
+    // Not a reference: cleared before the write leaves the device queue.
+    PendingWrite* pending;
+  };
+
+  struct DeviceState {
+    DeviceState() : configured(false) {
+    }
+
+    bool configured;
+    TokenBucket bucket;
+    std::map<USHORT, CharacteristicState> characteristics;
+    std::map<USHORT, RateLimit> characteristic_limits;
+    // Writes waiting for their turn, in submission order.
+    std::deque<scoped_refptr<PendingWrite>> queue;
+    WriteLimiterMetrics metrics;
+  };
+
+  DeviceState& GetDevice(ULONGLONG device_address, ULONGLONG now_us);
+  CharacteristicState& GetCharacteristic(DeviceState& device, USHORT value_handle, ULONGLONG now_us);
+  void RecordQueued(DeviceState& device, int delta);
+  void RecordWrite(DeviceState& device, bool throttled, ULONGLONG delay_us);
+  void RecordAbandoned(DeviceState& device, bool timed_out);
+
+  // Adds "caller" and its value to the pending write of the same kind of
+  // the characteristic, or queues a new write. Returns the write, and the id
+  // of the caller in "caller_id". "executor" is NULL for blocking writes.
+  scoped_refptr<PendingWrite> Submit(DeviceState& device, ULONGLONG device_address, USHORT value_handle,
+                                     scoped_refptr<CharacteristicValue> value, bool coalesce, IoExecutor* executor,
+                                     const Caller& caller, ULONGLONG now_us, ULONG* caller_id);
+  // Returns the number of microseconds before the write at the front of the
+  // queue of "device" can be issued.
+  ULONGLONG Delay(DeviceState& device, ULONGLONG now_us);
+  // Removes "pending" from the queue of "device", and wakes up the next
+  // write if it was at the front.
+  void Dequeue(DeviceState& device, PendingWrite* pending);
+  // Takes the tokens of the write at the front of the queue of "device",
+  // removes it, and wakes up the next one. Returns the value to write.
+  scoped_refptr<CharacteristicValue> Issue(DeviceState& device);
+  void ResumeAsync(scoped_refptr<PendingWrite> pending);
+  // Removes a caller of a write not issued yet, and the write itself if it
+  // was its last caller. Returns false if the caller is gone already.
+  bool RemoveCaller(PendingWrite* pending, ULONG caller_id, bool timed_out, Caller* caller);
+  // Completes an asynchronous caller whose context expired or got
+  // cancelled.
+  void AbandonAsync(scoped_refptr<PendingWrite> pending, ULONG caller_id, bool timed_out);
+  // Invokes the callbacks of the callers waiting for the result of
+  // "pending".
+  void Complete(scoped_refptr<PendingWrite> pending, bool success, const std::string& error);
+  static void ReleaseCaller(IoExecutor* executor, const Caller& caller);
+
+  RateLimit device_limit_;
+  RateLimit characteristic_limit_;
+  std::map<ULONGLONG, RateLimit> device_limits_;
+  std::map<ULONGLONG, DeviceState> devices_;
+  WriteLimiterMetrics metrics_;
+  ULONG next_caller_id_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+
+  WriteRateLimiter(const WriteRateLimiter& other);
+  const WriteRateLimiter& operator=(const WriteRateLimiter& other);
+};
+
+}  // namespace btle
@@ -0,0 +1,248 @@
+#include "stdafx.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "btle_rate_limiter.h"
+#include "btle_test.h"
+
+namespace {
+
+const ULONGLONG kDeviceAddress = 0x0011223344ULL;
+
+scoped_refptr<btle::CharacteristicValue> MakeValue(UINT8 byte) {
+  scoped_refptr<btle::CharacteristicValue> value(new btle::CharacteristicValue());
+  value->SetByte(byte);
+  return value;
+}
+
+// Values written through a limiter, in the order they were written.
+class WriteLog {
+public:
+  WriteLog() : completed_(0) {
+  }
+
+  btle::WriteRateLimiter::AsyncWriteFunction AsyncWrite() {
+    return [this](scoped_refptr<btle::CharacteristicValue> value, const btle::WriteRateLimiter::WriteCallback& callback) {
+      Add(value);
+      callback(true, std::string());
+    };
+  }
+
+  btle::WriteRateLimiter::WriteCallback Callback() {
+    return [this](bool success, const std::string&) {
+      if (success)
+        completed_++;
+    };
+  }
+
+  void Add(scoped_refptr<btle::CharacteristicValue> value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.push_back(value->info().Data[0]);
+  }
+
+  // Waits up to a few seconds for "count" callbacks.
+  bool WaitForCompleted(int count) {
+    for (int i = 0; i < 5000 && completed_ < count; i++)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return completed_ == count;
+  }
+
+  // Callback recording the error of a failed write.
+  btle::WriteRateLimiter::WriteCallback ErrorCallback(std::string* error) {
+    return [this, error](bool success, const std::string& result_error) {
+      if (!success) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        *error = result_error;
+      }
+      completed_++;
+    };
+  }
+
+  std::vector<UINT8> values() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return values_;
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<UINT8> values_;
+  std::atomic<int> completed_;
+};
+
+}  // namespace
+
+// Throttled writes are issued in submission order, whichever
+// characteristic they go to.
+BTLE_TEST(rate_limiter, WriteAsyncInOrder) {
+  btle::IoExecutor executor(4);
+  btle::WriteRateLimiter limiter(btle::RateLimit(500.0, 1.0), btle::RateLimit());
+  WriteLog log;
+  for (UINT8 i = 0; i < 20; i++) {
+    limiter.WriteAsync(&executor, kDeviceAddress, static_cast<USHORT>(i % 3 + 1), MakeValue(i), false, btle::OperationContext(), log.AsyncWrite(), log.Callback());
+  }
+  BTLE_EXPECT(log.WaitForCompleted(20));
+  std::vector<UINT8> values = log.values();
+  BTLE_EXPECT_EQ(20u, values.size());
+  for (size_t i = 0; i < values.size(); i++)
+    BTLE_EXPECT_EQ(i, values[i]);
+
+  btle::WriteLimiterMetrics metrics = limiter.metrics();
+  BTLE_EXPECT_EQ(20u, metrics.writes);
+  BTLE_EXPECT(metrics.throttled_writes > 0);
+  BTLE_EXPECT_EQ(0u, metrics.queue_depth);
+}
+
+// Blocking and asynchronous writes share the same queue.
+BTLE_TEST(rate_limiter, WriteMixedInOrder) {
+  btle::IoExecutor executor(2);
+  btle::WriteRateLimiter limiter(btle::RateLimit(500.0, 1.0), btle::RateLimit());
+  WriteLog log;
+  for (UINT8 i = 0; i < 10; i++) {
+    if (i % 2 == 0) {
+      limiter.WriteAsync(&executor, kDeviceAddress, 1, MakeValue(i), false, btle::OperationContext(), log.AsyncWrite(), log.Callback());
+      continue;
+    }
+    std::string error;
+    BTLE_EXPECT(limiter.Write(kDeviceAddress, 1, MakeValue(i), false, btle::OperationContext(), [&log](scoped_refptr<btle::CharacteristicValue> value, std::string*) {
+      log.Add(value);
+      return true;
+    }, &error));
+  }
+  BTLE_EXPECT(log.WaitForCompleted(5));
+  std::vector<UINT8> values = log.values();
+  BTLE_EXPECT_EQ(10u, values.size());
+  for (size_t i = 0; i < values.size(); i++)
+    BTLE_EXPECT_EQ(i, values[i]);
+}
+
+// Writes waiting for a token don't hold the executor thread.
+BTLE_TEST(rate_limiter, WriteAsyncDoesNotBlockExecutor) {
+  btle::IoExecutor executor(1);
+  btle::WriteRateLimiter limiter(btle::RateLimit(20.0, 1.0), btle::RateLimit());
+  WriteLog log;
+  for (UINT8 i = 0; i < 5; i++) {
+    limiter.WriteAsync(&executor, kDeviceAddress, 1, MakeValue(i), false, btle::OperationContext(), log.AsyncWrite(), log.Callback());
+  }
+
+  std::atomic<bool> ran(false);
+  executor.Post([&ran]() { ran = true; });
+  for (int i = 0; i < 1000 && !ran; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  BTLE_EXPECT(ran);
+  BTLE_EXPECT(log.values().size() < 5u);
+  BTLE_EXPECT(log.WaitForCompleted(5));
+}
+
+// Values submitted while a write waits for a token replace its value, and
+// their callers get the result of that write.
+BTLE_TEST(rate_limiter, WriteAsyncCoalesces) {
+  btle::IoExecutor executor(1);
+  btle::WriteRateLimiter limiter(btle::RateLimit(), btle::RateLimit(20.0, 1.0));
+  WriteLog log;
+  for (UINT8 i = 0; i < 4; i++) {
+    limiter.WriteAsync(&executor, kDeviceAddress, 1, MakeValue(i), true, btle::OperationContext(), log.AsyncWrite(), log.Callback());
+  }
+  BTLE_EXPECT(log.WaitForCompleted(4));
+  std::vector<UINT8> values = log.values();
+  BTLE_EXPECT_EQ(2u, values.size());
+  BTLE_EXPECT_EQ(0, values[0]);
+  BTLE_EXPECT_EQ(3, values[1]);
+  BTLE_EXPECT_EQ(2u, limiter.metrics().coalesced_writes);
+}
+
+// A coalesced value is written with the write function of its caller, not
+// with the one of the write it replaced.
+BTLE_TEST(rate_limiter, WriteAsyncCoalescesWriteFunction) {
+  btle::IoExecutor executor(1);
+  btle::WriteRateLimiter limiter(btle::RateLimit(), btle::RateLimit(20.0, 1.0));
+  WriteLog log;
+  std::atomic<int> writer(-1);
+  for (UINT8 i = 0; i < 4; i++) {
+    limiter.WriteAsync(&executor, kDeviceAddress, 1, MakeValue(i), true, btle::OperationContext(),
+        [&log, &writer, i](scoped_refptr<btle::CharacteristicValue> value, const btle::WriteRateLimiter::WriteCallback& callback) {
+          writer = i;
+          log.Add(value);
+          callback(true, std::string());
+        },
+        log.Callback());
+  }
+  BTLE_EXPECT(log.WaitForCompleted(4));
+  std::vector<UINT8> values = log.values();
+  BTLE_EXPECT_EQ(2u, values.size());
+  BTLE_EXPECT_EQ(3, values[1]);
+  BTLE_EXPECT_EQ(3, writer);
+}
+
+// Throttled writes whose context expires or gets cancelled complete right
+// away, leave the queue without taking tokens, and don't delay the writes
+// behind them.
+BTLE_TEST(rate_limiter, WriteAsyncAbandoned) {
+  btle::IoExecutor executor(2);
+  btle::WriteRateLimiter limiter(btle::RateLimit(2.0, 1.0), btle::RateLimit());
+  WriteLog log;
+  std::string timeout_error;
+  std::string cancel_error;
+  btle::CancellationSource cancellation;
+  ULONGLONG start_us = monotonic_microseconds();
+  limiter.WriteAsync(&executor, kDeviceAddress, 1, MakeValue(0), false, btle::OperationContext(), log.AsyncWrite(), log.Callback());
+  limiter.WriteAsync(&executor, kDeviceAddress, 2, MakeValue(1), false, btle::OperationContext(20), log.AsyncWrite(), log.ErrorCallback(&timeout_error));
+  limiter.WriteAsync(&executor, kDeviceAddress, 3, MakeValue(2), false, btle::OperationContext(cancellation.token()), log.AsyncWrite(), log.ErrorCallback(&cancel_error));
+  cancellation.Cancel();
+  BTLE_EXPECT(log.WaitForCompleted(3));
+  // Well before the 500 ms the next token takes.
+  BTLE_EXPECT(monotonic_microseconds() - start_us < 400000);
+  BTLE_EXPECT_EQ(std::string(btle::kOperationTimedOut), timeout_error);
+  BTLE_EXPECT_EQ(std::string(btle::kOperationCancelled), cancel_error);
+
+  btle::WriteLimiterMetrics metrics = limiter.metrics();
+  BTLE_EXPECT_EQ(1u, metrics.writes);
+  BTLE_EXPECT_EQ(1u, metrics.timeouts);
+  BTLE_EXPECT_EQ(1u, metrics.cancellations);
+  BTLE_EXPECT_EQ(0u, metrics.queue_depth);
+
+  // The next write waits for the token the first one took, and no more.
+  limiter.WriteAsync(&executor, kDeviceAddress, 1, MakeValue(3), false, btle::OperationContext(), log.AsyncWrite(), log.Callback());
+  BTLE_EXPECT(log.WaitForCompleted(4));
+  std::vector<UINT8> values = log.values();
+  BTLE_EXPECT_EQ(2u, values.size());
+  BTLE_EXPECT_EQ(3, values[1]);
+  BTLE_EXPECT(monotonic_microseconds() - start_us < 900000);
+}
+
+// Blocking writes wait for a token until their deadline, or until they get
+// cancelled.
+BTLE_TEST(rate_limiter, WriteAbandoned) {
+  btle::WriteRateLimiter limiter(btle::RateLimit(2.0, 1.0), btle::RateLimit());
+  WriteLog log;
+  btle::WriteRateLimiter::WriteFunction write = [&log](scoped_refptr<btle::CharacteristicValue> value, std::string*) {
+    log.Add(value);
+    return true;
+  };
+  std::string error;
+  BTLE_EXPECT(limiter.Write(kDeviceAddress, 1, MakeValue(0), false, btle::OperationContext(), write, &error));
+
+  ULONGLONG start_us = monotonic_microseconds();
+  BTLE_EXPECT(!limiter.Write(kDeviceAddress, 1, MakeValue(1), false, btle::OperationContext(20), write, &error));
+  BTLE_EXPECT_EQ(std::string(btle::kOperationTimedOut), error);
+
+  btle::CancellationSource cancellation;
+  std::thread canceller([&cancellation]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    cancellation.Cancel();
+  });
+  BTLE_EXPECT(!limiter.Write(kDeviceAddress, 1, MakeValue(2), true, btle::OperationContext(cancellation.token()), write, &error));
+  canceller.join();
+  BTLE_EXPECT_EQ(std::string(btle::kOperationCancelled), error);
+  BTLE_EXPECT(monotonic_microseconds() - start_us < 400000);
+
+  BTLE_EXPECT_EQ(1u, log.values().size());
+  btle::WriteLimiterMetrics metrics = limiter.metrics();
+  BTLE_EXPECT_EQ(1u, metrics.timeouts);
+  BTLE_EXPECT_EQ(1u, metrics.cancellations);
+  BTLE_EXPECT_EQ(0u, metrics.queue_depth);
+}
@@ -0,0 +1,598 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "btle_sample_log.h"
+
+namespace btle {
+
+namespace {
+
+const char kFileMagic[8] = { 'B', 'T', 'L', 'E', 'S', 'L', 'O', 'G' };
+const char kTrailerMagic[8] = { 'B', 'T', 'L', 'E', 'S', 'E', 'N', 'D' };
+const UINT32 kFileVersion = 1;
+const UINT32 kBlockMagic = 0x314b4c42;  // "BLK1"
+const UINT32 kFooterMagic = 0x31584449;  // "IDX1"
+
+// Record holding the uuid of a characteristic number, not a sample.
+const UINT32 kDefinitionRecord = 0x1;
+
+const size_t kMinBlockSize = 256;
+const size_t kMaxBlockSize = 16 * 1024 * 1024;
+
+struct FileHeader {
+  char magic[8];
+  UINT32 version;
+  UINT32 block_size;
+};
+
+struct BlockHeader {
+  UINT32 magic;
+  UINT32 record_count;
+  // Including the block header.
+  UINT32 used_bytes;
+  UINT32 reserved;
+  UINT64 first_timestamp_us;
+  UINT64 last_timestamp_us;
+};
+
+struct RecordHeader {
+  UINT64 timestamp_us;
+  UINT64 device;
+  UINT16 characteristic;
+  UINT16 size;
+  UINT32 flags;
+};
+
+// Followed by "block_count" BlockHeaders and "uuid_count" pairs of high and
+// low uuid halves.
+struct FooterHeader {
+  UINT32 magic;
+  UINT32 block_count;
+  UINT32 uuid_count;
+  UINT32 reserved;
+};
+
+// Last bytes of a closed file.
+struct Trailer {
+  UINT64 footer_offset;
+  char magic[8];
+};
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader must be packed");
+static_assert(sizeof(BlockHeader) == 32, "BlockHeader must be packed");
+static_assert(sizeof(RecordHeader) == 24, "RecordHeader must be packed");
+static_assert(sizeof(FooterHeader) == 16, "FooterHeader must be packed");
+static_assert(sizeof(Trailer) == 16, "Trailer must be packed");
+
+// Offset of the first block.
+const UINT64 kBlocksOffset = sizeof(FileHeader);
+
+size_t Align8(size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+size_t RecordSize(size_t payload_size) {
+  return sizeof(RecordHeader) + Align8(payload_size);
+}
+
+void SetFileError(const char* action, const std::wstring& path, std::string* error) {
+  HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+  std::ostringstream string_stream;
+  string_stream << "Error " << action << " sample log '" << to_std_string(path) << "': hr=" << hr << ".";
+  *error = string_stream.str();
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+SampleLogWriter::SampleLogWriter()
+  : block_size_(0),
+    commit_interval_us_(0),
+    last_commit_us_(0),
+    last_timestamp_us_(0),
+    unflushed_(false),
+    stopping_(false),
+    block_offset_(0),
+    block_used_(0),
+    block_committed_(0) {
+}
+
+SampleLogWriter::~SampleLogWriter() {
+  std::string error;
+  Close(&error);
+}
+
+bool SampleLogWriter::Open(const std::wstring& path, size_t block_size, UINT64 commit_interval_us, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (is_open()) {
+    *error = "Sample log is already open.";
+    return false;
+  }
+  if (block_size < kMinBlockSize || block_size > kMaxBlockSize || block_size % 8 != 0) {
+    *error = "Invalid sample log block size.";
+    return false;
+  }
+
+  HANDLE file_handle = CreateFile(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    SetFileError("creating", path, error);
+    return false;
+  }
+  file_.set(file_handle);
+  path_ = path;
+  block_size_ = block_size;
+  commit_interval_us_ = commit_interval_us;
+  last_commit_us_ = monotonic_microseconds();
+  last_timestamp_us_ = 0;
+  block_.assign(block_size, 0);
+  block_offset_ = kBlocksOffset;
+  index_.clear();
+  numbers_.clear();
+  uuids_.clear();
+  StartBlock();
+
+  FileHeader header;
+  memcpy(header.magic, kFileMagic, sizeof(header.magic));
+  header.version = kFileVersion;
+  header.block_size = static_cast<UINT32>(block_size);
+  if (!WriteAt(0, &header, sizeof(header), error)) {
+    file_.set(INVALID_HANDLE_VALUE);
+    return false;
+  }
+
+  stopping_ = false;
+  commit_error_.clear();
+  if (commit_interval_us_ > 0)
+    commit_thread_ = std::thread([this]() { RunCommits(); });
+  return true;
+}
+
+bool SampleLogWriter::Append(UINT64 timestamp_us, const BluetoothAddress& device, UuidId characteristic_id,
+                             const UINT8* data, size_t size, std::string* error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_open()) {
+    *error = "Sample log is not open.";
+    return false;
+  }
+  if (!commit_error_.empty()) {
+    *error = commit_error_;
+    commit_error_.clear();
+    return false;
+  }
+  if (characteristic_id == kInvalidUuidId) {
+    *error = "Invalid characteristic id.";
+    return false;
+  }
+  if (size > kMaxPayloadSize || sizeof(BlockHeader) + RecordSize(size) > block_size_) {
+    *error = "Sample is too large for the sample log blocks.";
+    return false;
+  }
+
+  timestamp_us = std::max(timestamp_us, last_timestamp_us_);
+  last_timestamp_us_ = timestamp_us;
+
+  if (characteristic_id >= numbers_.size())
+    numbers_.resize(characteristic_id + 1, kInvalidUuidId);
+  UINT16 number = numbers_[characteristic_id];
+  if (number == kInvalidUuidId) {
+    if (uuids_.size() >= kInvalidUuidId) {
+      *error = "Too many characteristics in the sample log.";
+      return false;
+    }
+    number = static_cast<UINT16>(uuids_.size());
+    const Uuid& uuid = UuidIds.Get(characteristic_id);
+    UINT64 halves[2] = { uuid.high(), uuid.low() };
+    if (!AppendRecord(timestamp_us, 0, number, kDefinitionRecord, reinterpret_cast<const UINT8*>(halves), sizeof(halves), error))
+      return false;
+    uuids_.push_back(uuid);
+    numbers_[characteristic_id] = number;
+  }
+
+  return AppendRecord(timestamp_us, device.value(), number, 0, data, size, error);
+}
+
+bool SampleLogWriter::Commit(std::string* error) {
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+  HANDLE file;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_open())
+      return true;
+    last_commit_us_ = monotonic_microseconds();
+    if (!CommitBlock(error))
+      return false;
+    if (!unflushed_)
+      return true;
+    unflushed_ = false;
+    file = file_.get();
+  }
+
+  // Without the lock: FlushFileBuffers waits for the disk.
+  if (!FlushFileBuffers(file)) {
+    SetFileError("flushing", path_, error);
+    return false;
+  }
+  return true;
+}
+
+bool SampleLogWriter::Close(std::string* error) {
+  std::thread commit_thread;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    commit_thread.swap(commit_thread_);
+  }
+  commit_condition_.notify_all();
+  if (commit_thread.joinable())
+    commit_thread.join();
+
+  std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!is_open())
+    return true;
+  bool success = CommitBlock(error) && WriteFooter(error);
+  if (success && !FlushFileBuffers(file_.get())) {
+    SetFileError("flushing", path_, error);
+    success = false;
+  }
+  file_.set(INVALID_HANDLE_VALUE);
+  return success;
+}
+
+bool SampleLogWriter::AppendRecord(UINT64 timestamp_us, UINT64 device, UINT16 characteristic, UINT32 flags,
+                                   const UINT8* data, size_t size, std::string* error) {
+  size_t record_size = RecordSize(size);
+  if (block_used_ + record_size > block_size_) {
+    // The block is full: write it and move to the next slot.
+    if (!CommitBlock(error))
+      return false;
+    index_.insert(index_.end(), &block_[0], &block_[0] + sizeof(BlockHeader));
+    block_offset_ += block_size_;
+    StartBlock();
+  }
+
+  RecordHeader record;
+  record.timestamp_us = timestamp_us;
+  record.device = device;
+  record.characteristic = characteristic;
+  record.size = static_cast<UINT16>(size);
+  record.flags = flags;
+  UINT8* out = &block_[block_used_];
+  memcpy(out, &record, sizeof(record));
+  if (size > 0)
+    memcpy(out + sizeof(record), data, size);
+  memset(out + sizeof(record) + size, 0, record_size - sizeof(record) - size);
+  block_used_ += record_size;
+
+  BlockHeader* header = reinterpret_cast<BlockHeader*>(&block_[0]);
+  if (header->record_count == 0)
+    header->first_timestamp_us = timestamp_us;
+  header->last_timestamp_us = timestamp_us;
+  header->record_count++;
+  header->used_bytes = static_cast<UINT32>(block_used_);
+  return true;
+}
+
+bool SampleLogWriter::CommitBlock(std::string* error) {
+  if (block_committed_ == block_used_)
+    return true;
+  if (block_committed_ == 0) {
+    if (!WriteAt(block_offset_, &block_[0], block_used_, error))
+      return false;
+  } else {
+    // The new records, then the header that counts them, so that a reader
+    // never sees a header counting records not written yet.
+    if (!WriteAt(block_offset_ + block_committed_, &block_[block_committed_], block_used_ - block_committed_, error))
+      return false;
+    if (!WriteAt(block_offset_, &block_[0], sizeof(BlockHeader), error))
+      return false;
+  }
+  block_committed_ = block_used_;
+  return true;
+}
+
+bool SampleLogWriter::WriteAt(UINT64 offset, const void* data, size_t size, std::string* error) {
+  LARGE_INTEGER position;
+  position.QuadPart = static_cast<LONGLONG>(offset);
+  if (!SetFilePointerEx(file_.get(), position, NULL, FILE_BEGIN)) {
+    SetFileError("seeking", path_, error);
+    return false;
+  }
+  DWORD written = 0;
+  if (!WriteFile(file_.get(), data, static_cast<DWORD>(size), &written, NULL) || written != size) {
+    SetFileError("writing", path_, error);
+    return false;
+  }
+  unflushed_ = true;
+  return true;
+}
+
+bool SampleLogWriter::WriteFooter(std::string* error) {
+  // The last block is in the index only if it has records; the footer
+  // follows its used bytes.
+  UINT64 footer_offset = block_offset_;
+  const BlockHeader* last = reinterpret_cast<const BlockHeader*>(&block_[0]);
+  if (last->record_count > 0) {
+    index_.insert(index_.end(), &block_[0], &block_[0] + sizeof(BlockHeader));
+    footer_offset += block_used_;
+  }
+
+  FooterHeader footer;
+  footer.magic = kFooterMagic;
+  footer.block_count = static_cast<UINT32>(index_.size() / sizeof(BlockHeader));
+  footer.uuid_count = static_cast<UINT32>(uuids_.size());
+  footer.reserved = 0;
+
+  std::vector<UINT8> data(sizeof(footer));
+  memcpy(&data[0], &footer, sizeof(footer));
+  data.insert(data.end(), index_.begin(), index_.end());
+  for (std::vector<Uuid>::const_iterator it = uuids_.begin(); it != uuids_.end(); ++it) {
+    UINT64 halves[2] = { it->high(), it->low() };
+    const UINT8* bytes = reinterpret_cast<const UINT8*>(halves);
+    data.insert(data.end(), bytes, bytes + sizeof(halves));
+  }
+  Trailer trailer;
+  trailer.footer_offset = footer_offset;
+  memcpy(trailer.magic, kTrailerMagic, sizeof(trailer.magic));
+  const UINT8* bytes = reinterpret_cast<const UINT8*>(&trailer);
+  data.insert(data.end(), bytes, bytes + sizeof(trailer));
+
+  return WriteAt(footer_offset, &data[0], data.size(), error);
+}
+
+void SampleLogWriter::RunCommits() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    UINT64 due_us = last_commit_us_ + commit_interval_us_;
+    UINT64 now_us = monotonic_microseconds();
+    if (now_us < due_us) {
+      commit_condition_.wait_for(lock, std::chrono::microseconds(due_us - now_us));
+      continue;
+    }
+
+    lock.unlock();
+    std::string error;
+    bool success = Commit(&error);
+    lock.lock();
+    if (!success)
+      commit_error_ = error;
+  }
+}
+
+void SampleLogWriter::StartBlock() {
+  BlockHeader header = { kBlockMagic, 0, sizeof(BlockHeader), 0, 0, 0 };
+  memcpy(&block_[0], &header, sizeof(header));
+  block_used_ = sizeof(BlockHeader);
+  block_committed_ = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+SampleLogReader::SampleLogReader()
+  : mapping_(NULL),
+    data_(NULL),
+    size_(0),
+    block_size_(0),
+    complete_(false) {
+}
+
+SampleLogReader::~SampleLogReader() {
+  Close();
+}
+
+bool SampleLogReader::Open(const std::wstring& path, std::string* error) {
+  Close();
+
+  // The writer may still be appending to the file.
+  HANDLE file_handle = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    SetFileError("opening", path, error);
+    return false;
+  }
+  file_.set(file_handle);
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file_.get(), &file_size)) {
+    SetFileError("getting size of", path, error);
+    Close();
+    return false;
+  }
+  size_ = static_cast<UINT64>(file_size.QuadPart);
+  if (size_ < sizeof(FileHeader)) {
+    *error = "Invalid sample log '" + to_std_string(path) + "': file is too short.";
+    Close();
+    return false;
+  }
+
+  mapping_ = CreateFileMapping(file_.get(), NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping_ == NULL) {
+    SetFileError("mapping", path, error);
+    Close();
+    return false;
+  }
+  data_ = static_cast<const UINT8*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (data_ == NULL) {
+    SetFileError("mapping", path, error);
+    Close();
+    return false;
+  }
+
+  FileHeader header;
+  memcpy(&header, data_, sizeof(header));
+  if (memcmp(header.magic, kFileMagic, sizeof(header.magic)) != 0 ||
+      header.version != kFileVersion ||
+      header.block_size < kMinBlockSize || header.block_size > kMaxBlockSize) {
+    *error = "Invalid sample log '" + to_std_string(path) + "': bad header.";
+    Close();
+    return false;
+  }
+  block_size_ = header.block_size;
+
+  complete_ = ReadFooter();
+  if (!complete_)
+    RecoverBlocks();
+  return true;
+}
+
+void SampleLogReader::Close() {
+  if (data_ != NULL)
+    UnmapViewOfFile(data_);
+  data_ = NULL;
+  if (mapping_ != NULL)
+    CloseHandle(mapping_);
+  mapping_ = NULL;
+  file_.set(INVALID_HANDLE_VALUE);
+  size_ = 0;
+  complete_ = false;
+  blocks_.clear();
+  uuids_.clear();
+}
+
+SampleLogReader::Cursor SampleLogReader::Range(UINT64 from_us, UINT64 to_us) const {
+  // Blocks are in time order: skip those that end before "from_us".
+  std::vector<BlockInfo>::const_iterator first = std::lower_bound(
+      blocks_.begin(), blocks_.end(), from_us,
+      [](const BlockInfo& block, UINT64 timestamp_us) { return block.last_timestamp_us < timestamp_us; });
+
+  Cursor cursor;
+  cursor.reader_ = this;
+  cursor.block_ = first - blocks_.begin();
+  cursor.position_ = sizeof(BlockHeader);
+  cursor.from_us_ = from_us;
+  cursor.to_us_ = to_us;
+  return cursor;
+}
+
+bool SampleLogReader::ReadFooter() {
+  Trailer trailer;
+  if (size_ < sizeof(FileHeader) + sizeof(FooterHeader) + sizeof(trailer))
+    return false;
+  memcpy(&trailer, data_ + size_ - sizeof(trailer), sizeof(trailer));
+  if (memcmp(trailer.magic, kTrailerMagic, sizeof(trailer.magic)) != 0)
+    return false;
+
+  UINT64 end = size_ - sizeof(trailer);
+  if (trailer.footer_offset < kBlocksOffset || trailer.footer_offset > end - sizeof(FooterHeader))
+    return false;
+  FooterHeader footer;
+  memcpy(&footer, data_ + trailer.footer_offset, sizeof(footer));
+  UINT64 footer_size = sizeof(footer) +
+      static_cast<UINT64>(footer.block_count) * sizeof(BlockHeader) +
+      static_cast<UINT64>(footer.uuid_count) * 2 * sizeof(UINT64);
+  if (footer.magic != kFooterMagic || trailer.footer_offset + footer_size != end)
+    return false;
+
+  const UINT8* entry = data_ + trailer.footer_offset + sizeof(footer);
+  for (UINT32 i = 0; i < footer.block_count; i++, entry += sizeof(BlockHeader)) {
+    BlockHeader header;
+    memcpy(&header, entry, sizeof(header));
+    BlockInfo block = { kBlocksOffset + static_cast<UINT64>(i) * block_size_,
+                        header.first_timestamp_us, header.last_timestamp_us,
+                        header.record_count, header.used_bytes };
+    if (header.used_bytes > block_size_ || block.offset + header.used_bytes > trailer.footer_offset) {
+      blocks_.clear();
+      return false;
+    }
+    blocks_.push_back(block);
+  }
+  for (UINT32 i = 0; i < footer.uuid_count; i++, entry += 2 * sizeof(UINT64)) {
+    UINT64 halves[2];
+    memcpy(halves, entry, sizeof(halves));
+    uuids_.push_back(Uuid(halves[0], halves[1]));
+  }
+  return true;
+}
+
+void SampleLogReader::RecoverBlocks() {
+  blocks_.clear();
+  uuids_.clear();
+  // Walk the block slots up to the first one that is missing or empty. The
+  // uuids of the characteristics come from the definition records.
+  for (UINT64 offset = kBlocksOffset; offset + sizeof(BlockHeader) <= size_; offset += block_size_) {
+    BlockHeader header;
+    memcpy(&header, data_ + offset, sizeof(header));
+    if (header.magic != kBlockMagic || header.record_count == 0 ||
+        header.used_bytes < sizeof(BlockHeader) || header.used_bytes > block_size_ ||
+        offset + header.used_bytes > size_) {
+      break;
+    }
+
+    UINT32 record_count = 0;
+    size_t position = sizeof(BlockHeader);
+    while (position + sizeof(RecordHeader) <= header.used_bytes) {
+      RecordHeader record;
+      memcpy(&record, data_ + offset + position, sizeof(record));
+      size_t record_size = RecordSize(record.size);
+      if (record_size > header.used_bytes - position)
+        break;
+      if ((record.flags & kDefinitionRecord) != 0 && record.size == 2 * sizeof(UINT64)) {
+        UINT64 halves[2];
+        memcpy(halves, data_ + offset + position + sizeof(record), sizeof(halves));
+        if (record.characteristic >= uuids_.size())
+          uuids_.resize(record.characteristic + 1);
+        uuids_[record.characteristic] = Uuid(halves[0], halves[1]);
+      }
+      position += record_size;
+      record_count++;
+    }
+
+    BlockInfo block = { offset, header.first_timestamp_us, header.last_timestamp_us,
+                        record_count, static_cast<UINT32>(position) };
+    blocks_.push_back(block);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+bool SampleLogReader::Cursor::Next(SampleRecord* record) {
+  if (reader_ == NULL)
+    return false;
+  const std::vector<BlockInfo>& blocks = reader_->blocks_;
+  while (block_ < blocks.size()) {
+    const BlockInfo& block = blocks[block_];
+    if (block.first_timestamp_us > to_us_) {
+      block_ = blocks.size();
+      return false;
+    }
+
+    const UINT8* data = reader_->data_ + block.offset;
+    while (position_ + sizeof(RecordHeader) <= block.used_bytes) {
+      RecordHeader header;
+      memcpy(&header, data + position_, sizeof(header));
+      size_t record_size = RecordSize(header.size);
+      if (record_size > block.used_bytes - position_)
+        break;
+      const UINT8* payload = data + position_ + sizeof(header);
+      position_ += record_size;
+
+      if ((header.flags & kDefinitionRecord) != 0 || header.timestamp_us < from_us_)
+        continue;
+      if (header.timestamp_us > to_us_) {
+        block_ = blocks.size();
+        return false;
+      }
+      if (header.characteristic >= reader_->uuids_.size())
+        continue;
+
+      record->timestamp_us = header.timestamp_us;
+      record->device = BluetoothAddress(header.device);
+      record->characteristic = reader_->uuids_[header.characteristic];
+      record->payload = ValueView(payload, header.size);
+      return true;
+    }
+
+    block_++;
+    position_ = sizeof(BlockHeader);
+  }
+  return false;
+}
+
+}  // namespace btle
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base.h"
+#include "btle_address.h"
+#include "btle_uuid.h"
+#include "btle_uuid_interner.h"
+#include "btle_value_view.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Binary, append-only log of raw characteristic values, e.g. the samples of
+// a SensorTag or a Heart Rate Monitor.
+//
+// File layout (little endian):
+//   header   "BTLESLOG", version, block size
+//   blocks   fixed-size slots: a block header (record count, used bytes,
+//            first and last timestamp) followed by records. A record is a
+//            timestamp (monotonic_microseconds), the device address, a
+//            characteristic number, the payload size and the payload,
+//            padded to 8 bytes.
+//   footer   written by Close(): the block headers and the uuid of each
+//            characteristic number, followed by a trailer pointing to it.
+//
+// Characteristic numbers are local to the file: the first record of a
+// characteristic is preceded by a definition record holding its uuid.
+// Records are in time order, so that a reader can binary search the blocks
+// of a time range. A file without a footer (the writer didn't close it) is
+// read by walking the block headers.
+//
+
+struct SampleRecord {
+  UINT64 timestamp_us;
+  BluetoothAddress device;
+  Uuid characteristic;
+  ValueView payload;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Appends records to a log file, under a lock, so that any number of
+// monitoring sessions can share it.
+//
+// Records are copied into the current block in memory. The block is written
+// to its slot when full, and a background thread writes and flushes the
+// records appended since the last commit every "commit_interval_us": a
+// single write and flush covers all the records of the interval (group
+// commit), instead of one per record, and a log that stops receiving
+// samples still reaches the disk. Appends go on while the disk flushes.
+//
+class SampleLogWriter {
+public:
+  static const size_t kDefaultBlockSize = 64 * 1024;
+  static const UINT64 kDefaultCommitIntervalUs = 100 * 1000;
+  // Largest payload of a record.
+  static const size_t kMaxPayloadSize = 0xffff;
+
+  SampleLogWriter();
+  // Calls Close().
+  ~SampleLogWriter();
+
+  // Creates (or truncates) the log file at "path". With a
+  // "commit_interval_us" of 0, records are only committed by Commit() and
+  // Close().
+  bool Open(const std::wstring& path, size_t block_size, UINT64 commit_interval_us, std::string* error);
+
+  // Appends a record. A timestamp earlier than the previous record is raised
+  // to it, as producers read the clock before taking the lock. Fails with
+  // the error of a background commit that failed since the previous call.
+  bool Append(UINT64 timestamp_us, const BluetoothAddress& device, UuidId characteristic_id,
+              const UINT8* data, size_t size, std::string* error);
+
+  // Writes and flushes the records appended since the last commit.
+  bool Commit(std::string* error);
+
+  // Commits, writes the footer and closes the file.
+  bool Close(std::string* error);
+
+  bool is_open() const { return file_.get() != INVALID_HANDLE_VALUE; }
+
+private:
+  // All of these must be called with the lock held.
+  bool AppendRecord(UINT64 timestamp_us, UINT64 device, UINT16 characteristic, UINT32 flags,
+                    const UINT8* data, size_t size, std::string* error);
+  bool CommitBlock(std::string* error);
+  bool WriteAt(UINT64 offset, const void* data, size_t size, std::string* error);
+  bool WriteFooter(std::string* error);
+  void StartBlock();
+  void RunCommits();
+
+  // Held while flushing, before "mutex_": Close() waits for the flush in
+  // progress before closing the file.
+  std::mutex flush_mutex_;
+  std::mutex mutex_;
+  scoped_handle<HANDLE> file_;
+  std::wstring path_;
+  size_t block_size_;
+  UINT64 commit_interval_us_;
+  UINT64 last_commit_us_;
+  UINT64 last_timestamp_us_;
+  // Whether data was written since the last flush.
+  bool unflushed_;
+
+  std::thread commit_thread_;
+  std::condition_variable commit_condition_;
+  bool stopping_;
+  // Error of the last background commit, until reported by Append().
+  std::string commit_error_;
+
+  // The block being filled, its slot, and how much of it is on disk.
+  std::vector<UINT8> block_;
+  UINT64 block_offset_;
+  size_t block_used_;
+  size_t block_committed_;
+
+  // Headers of the full blocks, for the footer.
+  std::vector<UINT8> index_;
+  // Characteristic number of each UuidId (kInvalidUuidId if none yet), and
+  // uuid of each characteristic number.
+  std::vector<UINT16> numbers_;
+  std::vector<Uuid> uuids_;
+
+  SampleLogWriter(const SampleLogWriter& other);
+  const SampleLogWriter& operator=(const SampleLogWriter& other);
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Reads a log file through a read-only mapping: Open() only reads the footer
+// (or the block headers), and records are decoded while iterating, with
+// payloads pointing into the mapping.
+//
+class SampleLogReader {
+public:
+  // Iterates over the records of a time range.
+  class Cursor {
+  public:
+    Cursor() : reader_(NULL), block_(0), position_(0), from_us_(0), to_us_(0) {
+    }
+
+    // Returns false after the last record of the range.
+    bool Next(SampleRecord* record);
+
+  private:
+    friend class SampleLogReader;
+
+    const SampleLogReader* reader_;
+    size_t block_;
+    size_t position_;
+    UINT64 from_us_;
+    UINT64 to_us_;
+  };
+
+  struct BlockInfo {
+    UINT64 offset;
+    UINT64 first_timestamp_us;
+    UINT64 last_timestamp_us;
+    UINT32 record_count;
+    UINT32 used_bytes;
+  };
+
+  SampleLogReader();
+  ~SampleLogReader();
+
+  bool Open(const std::wstring& path, std::string* error);
+  void Close();
+
+  // False if the file had no footer and was recovered from its blocks.
+  bool complete() const { return complete_; }
+  const std::vector<BlockInfo>& blocks() const { return blocks_; }
+  const std::vector<Uuid>& characteristics() const { return uuids_; }
+
+  // Records with "from_us" <= timestamp <= "to_us". Skips the blocks
+  // before "from_us" with a binary search.
+  Cursor Range(UINT64 from_us, UINT64 to_us) const;
+  Cursor All() const { return Range(0, ~0ULL); }
+
+private:
+  bool ReadFooter();
+  // Keeps the blocks up to the first one that is missing, empty or torn:
+  // never fails, a file without blocks is an empty log.
+  void RecoverBlocks();
+
+  scoped_handle<HANDLE> file_;
+  HANDLE mapping_;
+  const UINT8* data_;
+  UINT64 size_;
+  size_t block_size_;
+  bool complete_;
+  std::vector<BlockInfo> blocks_;
+  std::vector<Uuid> uuids_;
+
+  SampleLogReader(const SampleLogReader& other);
+  const SampleLogReader& operator=(const SampleLogReader& other);
+};
+
+}  // namespace btle
@@ -0,0 +1,70 @@
+#include "stdafx.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "btle_sample_log.h"
+#include "btle_test.h"
+
+namespace {
+
+const wchar_t kLogPath[] = L"btle_sample_log_test.log";
+
+size_t CountRecords(const std::wstring& path, bool* complete) {
+  btle::SampleLogReader reader;
+  std::string error;
+  if (!reader.Open(path, &error))
+    return 0;
+  *complete = reader.complete();
+  size_t count = 0;
+  btle::SampleRecord record;
+  btle::SampleLogReader::Cursor cursor = reader.All();
+  while (cursor.Next(&record))
+    count++;
+  return count;
+}
+
+}  // namespace
+
+BTLE_TEST(sample_log, AppendAndClose) {
+  btle::UuidId id = btle::UuidIds.Intern(btle::Uuid(static_cast<USHORT>(0x2a37)));
+  btle::SampleLogWriter writer;
+  std::string error;
+  BTLE_EXPECT(writer.Open(kLogPath, 1024, btle::SampleLogWriter::kDefaultCommitIntervalUs, &error));
+  UINT8 payload[2] = { 0x00, 72 };
+  for (UINT64 i = 0; i < 100; i++)
+    BTLE_EXPECT(writer.Append(i * 1000, btle::BluetoothAddress(0x00126f4f5c4eULL), id, payload, sizeof(payload), &error));
+  BTLE_EXPECT(writer.Close(&error));
+
+  bool complete = false;
+  BTLE_EXPECT_EQ(100u, CountRecords(kLogPath, &complete));
+  BTLE_EXPECT(complete);
+  remove(to_std_string(kLogPath).c_str());
+}
+
+// Records reach the file within the commit interval, without further
+// appends or an explicit Commit().
+BTLE_TEST(sample_log, BackgroundCommit) {
+  btle::UuidId id = btle::UuidIds.Intern(btle::Uuid(static_cast<USHORT>(0x2a37)));
+  btle::SampleLogWriter writer;
+  std::string error;
+  BTLE_EXPECT(writer.Open(kLogPath, 1024, 5 * 1000, &error));
+  UINT8 payload[2] = { 0x00, 72 };
+  for (UINT64 i = 0; i < 10; i++)
+    BTLE_EXPECT(writer.Append(i * 1000, btle::BluetoothAddress(0x00126f4f5c4eULL), id, payload, sizeof(payload), &error));
+
+  bool complete = true;
+  size_t count = 0;
+  for (int i = 0; i < 1000 && count < 10; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    count = CountRecords(kLogPath, &complete);
+  }
+  BTLE_EXPECT_EQ(10u, count);
+  BTLE_EXPECT(!complete);
+
+  BTLE_EXPECT(writer.Close(&error));
+  remove(to_std_string(kLogPath).c_str());
+}
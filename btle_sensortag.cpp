@@ -0,0 +1,371 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define BTLE_SENSORTAG_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include "btle_characteristics_def.h"
+#include "btle_sensortag.h"
+
+namespace btle {
+namespace sensortag {
+
+namespace {
+
+// TMP006 calibration constants.
+const double kS0 = 6.4E-14;
+const double kA1 = 1.75E-3;
+const double kA2 = -1.678E-5;
+const double kB0 = -2.94E-5;
+const double kB1 = -5.7E-7;
+const double kB2 = 4.63E-9;
+const double kC2 = 13.4;
+const double kTref = 298.15;
+
+// Sensor voltage (V) per unit of the raw object value.
+const double kVoltsPerUnit = 0.00000015625;
+// Ambient temperature is in 1/128 degrees.
+const double kAmbientScale = 1.0 / 128.0;
+const double kKelvinOffset = 273.15;
+
+// S polynomial, expanded: S0 + dT * (S0 * a1 + dT * S0 * a2).
+const double kSa1 = kS0 * kA1;
+const double kSa2 = kS0 * kA2;
+
+// Accelerometer range is +/-2 g on 8 bits.
+const double kAccelerometerScale = 1.0 / 64.0;
+// Magnetometer range is +/-1000 uT on 16 bits.
+const double kMagnetometerScale = 2000.0 / 65536.0;
+// Gyroscope range is +/-250 deg/s on 16 bits.
+const double kGyroscopeScale = 500.0 / 65536.0;
+
+inline
+int ReadInt16(const UINT8* data) {
+  return static_cast<INT16>(data[0] | (data[1] << 8));
+}
+
+inline
+unsigned ReadUInt16(const UINT8* data) {
+  return static_cast<USHORT>(data[0] | (data[1] << 8));
+}
+
+inline
+void DecodeVector3(const UINT8* data, double scale, Vector3* vector) {
+  vector->x = ReadInt16(data) * scale;
+  vector->y = ReadInt16(data + 2) * scale;
+  vector->z = ReadInt16(data + 4) * scale;
+}
+
+inline
+double ObjectTemperature(double raw_object, double ambient) {
+  double die = ambient + kKelvinOffset;
+  double delta = die - kTref;
+  double s = kS0 + delta * (kSa1 + delta * kSa2);
+  double offset = kB0 + delta * (kB1 + delta * kB2);
+  double voltage = raw_object * kVoltsPerUnit - offset;
+  double f = voltage * (1.0 + kC2 * voltage);
+  double die2 = die * die;
+  return sqrt(sqrt(die2 * die2 + f / s)) - kKelvinOffset;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+void DecodeIrTemperature(const UINT8* data, IrTemperature* temperature) {
+  temperature->ambient = ReadInt16(data + 2) * kAmbientScale;
+  temperature->object = ObjectTemperature(ReadInt16(data), temperature->ambient);
+}
+
+void DecodeIrTemperatures(const UINT8* data, size_t count, IrTemperature* temperatures) {
+  size_t index = 0;
+#if BTLE_SENSORTAG_SSE2
+  const __m128d ambient_scale = _mm_set1_pd(kAmbientScale);
+  const __m128d kelvin_offset = _mm_set1_pd(kKelvinOffset);
+  const __m128d tref = _mm_set1_pd(kTref);
+  const __m128d s0 = _mm_set1_pd(kS0);
+  const __m128d sa1 = _mm_set1_pd(kSa1);
+  const __m128d sa2 = _mm_set1_pd(kSa2);
+  const __m128d b0 = _mm_set1_pd(kB0);
+  const __m128d b1 = _mm_set1_pd(kB1);
+  const __m128d b2 = _mm_set1_pd(kB2);
+  const __m128d c2 = _mm_set1_pd(kC2);
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d volts_per_unit = _mm_set1_pd(kVoltsPerUnit);
+
+  for (; index + 2 <= count; index += 2) {
+    // Two samples: 16-bit lanes [object0, ambient0, object1, ambient1],
+    // sign extended to 32 bits and reordered as [o0, o1, a0, a1].
+    __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data + index * kIrTemperatureSize));
+    raw = _mm_srai_epi32(_mm_unpacklo_epi16(raw, raw), 16);
+    raw = _mm_shuffle_epi32(raw, _MM_SHUFFLE(3, 1, 2, 0));
+    __m128d object = _mm_cvtepi32_pd(raw);
+    __m128d ambient = _mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(raw, raw)), ambient_scale);
+
+    __m128d die = _mm_add_pd(ambient, kelvin_offset);
+    __m128d delta = _mm_sub_pd(die, tref);
+    __m128d s = _mm_add_pd(s0, _mm_mul_pd(delta, _mm_add_pd(sa1, _mm_mul_pd(delta, sa2))));
+    __m128d offset = _mm_add_pd(b0, _mm_mul_pd(delta, _mm_add_pd(b1, _mm_mul_pd(delta, b2))));
+    __m128d voltage = _mm_sub_pd(_mm_mul_pd(object, volts_per_unit), offset);
+    __m128d f = _mm_mul_pd(voltage, _mm_add_pd(one, _mm_mul_pd(c2, voltage)));
+    __m128d die2 = _mm_mul_pd(die, die);
+    __m128d t4 = _mm_add_pd(_mm_mul_pd(die2, die2), _mm_div_pd(f, s));
+    object = _mm_sub_pd(_mm_sqrt_pd(_mm_sqrt_pd(t4)), kelvin_offset);
+
+    // IrTemperature is {object, ambient}: interleave back.
+    _mm_storeu_pd(&temperatures[index].object, _mm_unpacklo_pd(object, ambient));
+    _mm_storeu_pd(&temperatures[index + 1].object, _mm_unpackhi_pd(object, ambient));
+  }
+#endif
+  for (; index < count; index++) {
+    DecodeIrTemperature(data + index * kIrTemperatureSize, &temperatures[index]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+double ReferenceObjectTemperature(const UINT8* data) {
+  double ambient = ReadInt16(data + 2) / 128.0;
+  double Vobj2 = ReadInt16(data) * 0.00000015625;
+  double Tdie2 = ambient + 273.15;
+  double S = kS0*(1+kA1*(Tdie2 - kTref)+kA2*pow((Tdie2 - kTref),2));
+  double Vos = kB0 + kB1*(Tdie2 - kTref) + kB2*pow((Tdie2 - kTref),2);
+  double fObj = (Vobj2 - Vos) + kC2*pow((Vobj2 - Vos),2);
+  double tObj = pow(pow(Tdie2,4) + (fObj/S),.25);
+  return tObj - 273.15;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+void DecodeAccelerometer(const UINT8* data, Vector3* acceleration) {
+  acceleration->x = static_cast<INT8>(data[0]) * kAccelerometerScale;
+  acceleration->y = static_cast<INT8>(data[1]) * kAccelerometerScale;
+  acceleration->z = static_cast<INT8>(data[2]) * kAccelerometerScale;
+}
+
+void DecodeHumidity(const UINT8* data, Humidity* humidity) {
+  // SHT21: the 2 low bits of the humidity are status bits.
+  humidity->temperature = -46.85 + 175.72 / 65536.0 * ReadUInt16(data);
+  humidity->relative = -6.0 + 125.0 / 65536.0 * (ReadUInt16(data + 2) & ~0x0003);
+}
+
+void DecodeMagnetometer(const UINT8* data, Vector3* magnetic_field) {
+  DecodeVector3(data, kMagnetometerScale, magnetic_field);
+}
+
+void DecodeGyroscope(const UINT8* data, Vector3* rotation) {
+  DecodeVector3(data, kGyroscopeScale, rotation);
+}
+
+void DecodeBarometerCalibration(const UINT8* data, BarometerCalibration* calibration) {
+  calibration->c1 = static_cast<USHORT>(ReadUInt16(data));
+  calibration->c2 = static_cast<USHORT>(ReadUInt16(data + 2));
+  calibration->c3 = static_cast<USHORT>(ReadUInt16(data + 4));
+  calibration->c4 = static_cast<USHORT>(ReadUInt16(data + 6));
+  calibration->c5 = static_cast<SHORT>(ReadInt16(data + 8));
+  calibration->c6 = static_cast<SHORT>(ReadInt16(data + 10));
+  calibration->c7 = static_cast<SHORT>(ReadInt16(data + 12));
+  calibration->c8 = static_cast<SHORT>(ReadInt16(data + 14));
+}
+
+void DecodeBarometer(const BarometerCalibration& calibration, const UINT8* data, Barometer* barometer) {
+  LONGLONG t_r = ReadInt16(data);
+  LONGLONG p_r = ReadUInt16(data + 2);
+
+  barometer->temperature = calibration.c1 * t_r / 16777216.0 + calibration.c2 / 1024.0;
+
+  LONGLONG sensitivity = calibration.c3;
+  sensitivity += (calibration.c4 * t_r) >> 17;
+  sensitivity += (calibration.c5 * t_r * t_r) >> 34;
+  LONGLONG offset = static_cast<LONGLONG>(calibration.c6) << 14;
+  offset += (calibration.c7 * t_r) >> 3;
+  offset += (calibration.c8 * t_r * t_r) >> 19;
+  LONGLONG pascals = (sensitivity * p_r + offset) >> 14;
+  barometer->pressure = pascals / 100.0;
+}
+
+namespace {
+
+typedef void (*DecodeFunction)(const BarometerCalibration& calibration, const UINT8* data, Sample* sample);
+
+void DecodeIrTemperatureSample(const BarometerCalibration&, const UINT8* data, Sample* sample) {
+  DecodeIrTemperature(data, &sample->ir_temperature);
+}
+
+void DecodeAccelerometerSample(const BarometerCalibration&, const UINT8* data, Sample* sample) {
+  DecodeAccelerometer(data, &sample->acceleration);
+}
+
+void DecodeHumiditySample(const BarometerCalibration&, const UINT8* data, Sample* sample) {
+  DecodeHumidity(data, &sample->humidity);
+}
+
+void DecodeMagnetometerSample(const BarometerCalibration&, const UINT8* data, Sample* sample) {
+  DecodeMagnetometer(data, &sample->magnetic_field);
+}
+
+void DecodeBarometerSample(const BarometerCalibration& calibration, const UINT8* data, Sample* sample) {
+  DecodeBarometer(calibration, data, &sample->barometer);
+}
+
+void DecodeGyroscopeSample(const BarometerCalibration&, const UINT8* data, Sample* sample) {
+  DecodeGyroscope(data, &sample->rotation);
+}
+
+// Indexed by SensorKind.
+const SensorInfo kSensors[kSensorKindCount] = {
+  { kIrTemperature, "IR temperature", &IR_Temperature_Data, kIrTemperatureSize },
+  { kAccelerometer, "Accelerometer", &Accelerometer_Data, kAccelerometerSize },
+  { kHumidity, "Humidity", &Humidity_Data, kHumiditySize },
+  { kMagnetometer, "Magnetometer", &Magnetometer_Data, kMagnetometerSize },
+  { kBarometer, "Barometer", &Barometer_Data, kBarometerSize },
+  { kGyroscope, "Gyroscope", &Gyroscope_Data, kGyroscopeSize },
+};
+
+const DecodeFunction kDecoders[kSensorKindCount] = {
+  DecodeIrTemperatureSample,
+  DecodeAccelerometerSample,
+  DecodeHumiditySample,
+  DecodeMagnetometerSample,
+  DecodeBarometerSample,
+  DecodeGyroscopeSample,
+};
+
+// Number of IR temperature values decoded at once by DecodeBatch.
+const size_t kIrTemperatureChunk = 32;
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+const SensorInfo* GetSensorInfo(SensorKind kind) {
+  if (kind < 0 || kind >= kSensorKindCount)
+    return NULL;
+  return &kSensors[kind];
+}
+
+const SensorInfo* FindSensorInfo(const UUID& characteristic_uuid) {
+  for (int i = 0; i < kSensorKindCount; i++) {
+    if (*kSensors[i].data_uuid == characteristic_uuid)
+      return &kSensors[i];
+  }
+  return NULL;
+}
+
+const SensorInfo* FindSensorInfo(UuidId characteristic_id) {
+  // The data characteristics are interned with the other uuids of
+  // btle_characteristics_long.h, when UuidIds is constructed.
+  static const struct DataIds {
+    DataIds() {
+      for (int i = 0; i < kSensorKindCount; i++)
+        ids[i] = UuidIds.Find(Uuid(*kSensors[i].data_uuid));
+    }
+    UuidId ids[kSensorKindCount];
+  } data_ids;
+
+  if (characteristic_id == kInvalidUuidId)
+    return NULL;
+  for (int i = 0; i < kSensorKindCount; i++) {
+    if (data_ids.ids[i] == characteristic_id)
+      return &kSensors[i];
+  }
+  return NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+Decoder::Decoder() : has_barometer_calibration_(false) {
+  memset(&barometer_calibration_, 0, sizeof(barometer_calibration_));
+}
+
+bool Decoder::SetBarometerCalibration(const UINT8* data, size_t size, std::string* error) {
+  if (size < kBarometerCalibrationSize) {
+    *error = "Invalid barometer calibration size";
+    return false;
+  }
+  DecodeBarometerCalibration(data, &barometer_calibration_);
+  has_barometer_calibration_ = true;
+  return true;
+}
+
+bool Decoder::CheckKind(SensorKind kind, std::string* error) const {
+  if (GetSensorInfo(kind) == NULL) {
+    *error = "Unknown SensorTag sensor";
+    return false;
+  }
+  if (kind == kBarometer && !has_barometer_calibration_) {
+    *error = "Barometer calibration has not been read";
+    return false;
+  }
+  return true;
+}
+
+bool Decoder::Decode(const UUID& characteristic_uuid, const UINT8* data, size_t size, Sample* sample, std::string* error) const {
+  const SensorInfo* info = FindSensorInfo(characteristic_uuid);
+  if (info == NULL) {
+    *error = "Not a SensorTag data characteristic";
+    return false;
+  }
+  return Decode(info->kind, data, size, sample, error);
+}
+
+bool Decoder::Decode(UuidId characteristic_id, const UINT8* data, size_t size, Sample* sample, std::string* error) const {
+  const SensorInfo* info = FindSensorInfo(characteristic_id);
+  if (info == NULL) {
+    *error = "Not a SensorTag data characteristic";
+    return false;
+  }
+  return Decode(info->kind, data, size, sample, error);
+}
+
+bool Decoder::Decode(SensorKind kind, const UINT8* data, size_t size, Sample* sample, std::string* error) const {
+  if (!CheckKind(kind, error))
+    return false;
+  if (size < kSensors[kind].data_size) {
+    *error = "Invalid sensor data size";
+    return false;
+  }
+  sample->kind = kind;
+  kDecoders[kind](barometer_calibration_, data, sample);
+  return true;
+}
+
+bool Decoder::DecodeBatch(SensorKind kind, const UINT8* data, size_t count, Sample* samples, std::string* error) const {
+  if (!CheckKind(kind, error))
+    return false;
+
+  if (kind == kIrTemperature) {
+    // Use the SIMD decoder through a small buffer on the stack.
+    IrTemperature temperatures[kIrTemperatureChunk];
+    for (size_t index = 0; index < count; index += kIrTemperatureChunk) {
+      size_t chunk = std::min(kIrTemperatureChunk, count - index);
+      DecodeIrTemperatures(data + index * kIrTemperatureSize, chunk, temperatures);
+      for (size_t i = 0; i < chunk; i++) {
+        samples[index + i].kind = kIrTemperature;
+        samples[index + i].ir_temperature = temperatures[i];
+      }
+    }
+    return true;
+  }
+
+  size_t data_size = kSensors[kind].data_size;
+  DecodeFunction decode = kDecoders[kind];
+  for (size_t index = 0; index < count; index++) {
+    samples[index].kind = kind;
+    decode(barometer_calibration_, data + index * data_size, &samples[index]);
+  }
+  return true;
+}
+
+}  // namespace sensortag
+}  // namespace btle
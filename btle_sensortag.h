@@ -0,0 +1,158 @@
+#pragma once
+
+#include <string>
+
+#include "base.h"
+#include "btle_uuid_interner.h"
+
+// Decoders for the data characteristics of the TI SensorTag.
+// See http://processors.wiki.ti.com/index.php/SensorTag_User_Guide
+namespace btle {
+namespace sensortag {
+
+// Size of an "IR_Temperature_Data" value: object (LE16), ambient (LE16).
+const size_t kIrTemperatureSize = 4;
+
+struct IrTemperature {
+  // Degrees Celsius.
+  double object;
+  double ambient;
+};
+
+// Decodes an "IR_Temperature_Data" value.
+//
+// The object temperature uses the TMP006 formula of the user guide,
+// evaluated in Horner form with sqrt(sqrt(x)) for the fourth root. It
+// matches the direct pow() based evaluation within kIrTemperatureTolerance
+// over the whole range of raw values.
+void DecodeIrTemperature(const UINT8* data, IrTemperature* temperature);
+
+// Decodes "count" consecutive "IR_Temperature_Data" values of
+// kIrTemperatureSize bytes each, two at a time with SSE2 when available.
+void DecodeIrTemperatures(const UINT8* data, size_t count, IrTemperature* temperatures);
+
+// Maximum difference, in degrees Celsius, between the decoders above and
+// the reference formula. Raw values without a physical meaning decode to NaN
+// with both.
+const double kIrTemperatureTolerance = 1e-8;
+
+// Reference (pow based) evaluation of the object temperature, as given in the
+// user guide. Slow: only meant to validate the decoders.
+double ReferenceObjectTemperature(const UINT8* data);
+
+// Size of the other data characteristic values.
+const size_t kAccelerometerSize = 3;
+const size_t kHumiditySize = 4;
+const size_t kMagnetometerSize = 6;
+const size_t kBarometerSize = 4;
+const size_t kBarometerCalibrationSize = 16;
+const size_t kGyroscopeSize = 6;
+
+struct Vector3 {
+  double x;
+  double y;
+  double z;
+};
+
+struct Humidity {
+  // Degrees Celsius.
+  double temperature;
+  // Percent.
+  double relative;
+};
+
+struct Barometer {
+  // Degrees Celsius.
+  double temperature;
+  // Hectopascals.
+  double pressure;
+};
+
+// Coefficients of the "Barometer_Calibration" value, specific to each device.
+struct BarometerCalibration {
+  USHORT c1, c2, c3, c4;
+  SHORT c5, c6, c7, c8;
+};
+
+// Decodes the value of a data characteristic. Axes are reported in the order
+// of the value (x, y, z), without the sign conventions of the TI apps.
+void DecodeAccelerometer(const UINT8* data, Vector3* acceleration);  // g
+void DecodeHumidity(const UINT8* data, Humidity* humidity);
+void DecodeMagnetometer(const UINT8* data, Vector3* magnetic_field);  // uT
+void DecodeGyroscope(const UINT8* data, Vector3* rotation);  // deg/s
+void DecodeBarometerCalibration(const UINT8* data, BarometerCalibration* calibration);
+// Pressure is computed with the integer arithmetic of the T5400 datasheet.
+void DecodeBarometer(const BarometerCalibration& calibration, const UINT8* data, Barometer* barometer);
+
+enum SensorKind {
+  kIrTemperature,
+  kAccelerometer,
+  kHumidity,
+  kMagnetometer,
+  kBarometer,
+  kGyroscope,
+  kSensorKindCount
+};
+
+// A decoded value of any data characteristic.
+struct Sample {
+  SensorKind kind;
+  union {
+    IrTemperature ir_temperature;
+    Vector3 acceleration;
+    Humidity humidity;
+    Vector3 magnetic_field;
+    Barometer barometer;
+    Vector3 rotation;
+  };
+};
+
+struct SensorInfo {
+  SensorKind kind;
+  const char* name;
+  // "xxx_Data" characteristic.
+  const UUID* data_uuid;
+  size_t data_size;
+};
+
+// Returns the description of a sensor, or NULL for an unknown "kind".
+const SensorInfo* GetSensorInfo(SensorKind kind);
+
+// Returns the sensor whose data characteristic is "characteristic_uuid", or
+// NULL if it is not a SensorTag data characteristic.
+const SensorInfo* FindSensorInfo(const UUID& characteristic_uuid);
+// Same, from the interned id of the characteristic uuid (see
+// Characteristic::uuid_id()).
+const SensorInfo* FindSensorInfo(UuidId characteristic_id);
+
+//////////////////////////////////////////////////////////////////////////////
+// Decodes the data characteristics of one SensorTag. The barometer
+// calibration of the device is read once, and kept for all the samples of
+// the device. Decoding never allocates.
+//
+class Decoder {
+public:
+  Decoder();
+
+  bool SetBarometerCalibration(const UINT8* data, size_t size, std::string* error);
+  bool has_barometer_calibration() const { return has_barometer_calibration_; }
+  const BarometerCalibration& barometer_calibration() const { return barometer_calibration_; }
+
+  // Decodes one value of the data characteristic "characteristic_uuid".
+  bool Decode(const UUID& characteristic_uuid, const UINT8* data, size_t size, Sample* sample, std::string* error) const;
+  bool Decode(UuidId characteristic_id, const UINT8* data, size_t size, Sample* sample, std::string* error) const;
+  bool Decode(SensorKind kind, const UINT8* data, size_t size, Sample* sample, std::string* error) const;
+
+  // Decodes "count" consecutive values of sensor "kind", as buffered from
+  // notifications.
+  bool DecodeBatch(SensorKind kind, const UINT8* data, size_t count, Sample* samples, std::string* error) const;
+
+private:
+  bool CheckKind(SensorKind kind, std::string* error) const;
+
+  bool has_barometer_calibration_;
+  BarometerCalibration barometer_calibration_;
+};
+
+}  // namespace sensortag
+}  // namespace btle
@@ -0,0 +1,290 @@
+#include "stdafx.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "btle_sensortag.h"
+#include "btle_test.h"
+
+namespace {
+
+// Within kIrTemperatureTolerance of the reference, or NaN like it.
+bool CloseToReference(double expected, double actual) {
+  if (std::isnan(expected))
+    return std::isnan(actual);
+  return fabs(expected - actual) <= btle::sensortag::kIrTemperatureTolerance;
+}
+
+// "IR_Temperature_Data" values of every raw object temperature, for a
+// spread of raw ambient temperatures covering the whole 16-bit range.
+std::vector<UINT8> IrTemperaturePayloads() {
+  std::vector<UINT32> ambients;
+  for (UINT32 ambient = 0; ambient <= 0xffff; ambient += 0x10000 / 64 + 1)
+    ambients.push_back(ambient);
+  ambients.push_back(0x7fff);
+  ambients.push_back(0x8000);
+  ambients.push_back(0xffff);
+
+  std::vector<UINT8> data;
+  for (size_t i = 0; i < ambients.size(); i++) {
+    for (UINT32 object = 0; object <= 0xffff; object++) {
+      data.push_back(static_cast<UINT8>(object));
+      data.push_back(static_cast<UINT8>(object >> 8));
+      data.push_back(static_cast<UINT8>(ambients[i]));
+      data.push_back(static_cast<UINT8>(ambients[i] >> 8));
+    }
+  }
+  return data;
+}
+
+// "Barometer_Calibration" value of c1..c8, each little endian.
+std::vector<UINT8> CalibrationValue(const int (&coefficients)[8]) {
+  std::vector<UINT8> data;
+  for (int i = 0; i < 8; i++) {
+    data.push_back(static_cast<UINT8>(coefficients[i]));
+    data.push_back(static_cast<UINT8>(coefficients[i] >> 8));
+  }
+  return data;
+}
+
+const int kCalibration[8] = { 45150, 8000, 49014, 23893, 7024, 1200, 20384, -1990 };
+
+// Same decoded values. IR temperatures may come from different decoders,
+// so their object temperatures only need to be close.
+bool SameSample(const btle::sensortag::Sample& a, const btle::sensortag::Sample& b) {
+  if (a.kind != b.kind)
+    return false;
+  switch (a.kind) {
+  case btle::sensortag::kIrTemperature:
+    return a.ir_temperature.ambient == b.ir_temperature.ambient &&
+        (std::isnan(a.ir_temperature.object) ?
+            std::isnan(b.ir_temperature.object) :
+            fabs(a.ir_temperature.object - b.ir_temperature.object) <= 2 * btle::sensortag::kIrTemperatureTolerance);
+  case btle::sensortag::kHumidity:
+    return a.humidity.temperature == b.humidity.temperature && a.humidity.relative == b.humidity.relative;
+  case btle::sensortag::kBarometer:
+    return a.barometer.temperature == b.barometer.temperature && a.barometer.pressure == b.barometer.pressure;
+  default:
+    return a.acceleration.x == b.acceleration.x && a.acceleration.y == b.acceleration.y &&
+        a.acceleration.z == b.acceleration.z;
+  }
+}
+
+}  // namespace
+
+// The scalar decoder and the batch (SSE2) decoder both match the pow based
+// reference, at both positions in a pair of the batch decoder.
+BTLE_TEST(sensortag, IrTemperatureMatchesReference) {
+  std::vector<UINT8> data = IrTemperaturePayloads();
+  size_t count = data.size() / btle::sensortag::kIrTemperatureSize;
+
+  for (size_t start = 0; start < 2; start++) {
+    std::vector<btle::sensortag::IrTemperature> batch(count - start);
+    btle::sensortag::DecodeIrTemperatures(&data[start * btle::sensortag::kIrTemperatureSize], count - start, &batch[0]);
+
+    int mismatches = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+      const UINT8* value = &data[(start + i) * btle::sensortag::kIrTemperatureSize];
+      double expected = btle::sensortag::ReferenceObjectTemperature(value);
+      btle::sensortag::IrTemperature scalar;
+      btle::sensortag::DecodeIrTemperature(value, &scalar);
+      if (!CloseToReference(expected, scalar.object) ||
+          !CloseToReference(expected, batch[i].object) ||
+          scalar.ambient != batch[i].ambient) {
+        if (mismatches++ < 10)
+          BTLE_EXPECT_EQ(expected, batch[i].object);
+      }
+    }
+    BTLE_EXPECT_EQ(0, mismatches);
+  }
+}
+
+BTLE_TEST(sensortag, IrTemperature) {
+  // Object 0x0000, ambient 0x0c80 (25 C).
+  const UINT8 data[btle::sensortag::kIrTemperatureSize] = { 0x00, 0x00, 0x80, 0x0c };
+  btle::sensortag::IrTemperature temperature;
+  btle::sensortag::DecodeIrTemperature(data, &temperature);
+  BTLE_EXPECT_EQ(25.0, temperature.ambient);
+  BTLE_EXPECT(fabs(temperature.object - btle::sensortag::ReferenceObjectTemperature(data)) <= btle::sensortag::kIrTemperatureTolerance);
+}
+
+// Signed INT8 values, 64 per g.
+BTLE_TEST(sensortag, Accelerometer) {
+  const UINT8 data[btle::sensortag::kAccelerometerSize] = { 0x40, 0xc0, 0x00 };
+  btle::sensortag::Vector3 acceleration;
+  btle::sensortag::DecodeAccelerometer(data, &acceleration);
+  BTLE_EXPECT_EQ(1.0, acceleration.x);
+  BTLE_EXPECT_EQ(-1.0, acceleration.y);
+  BTLE_EXPECT_EQ(0.0, acceleration.z);
+
+  const UINT8 extremes[btle::sensortag::kAccelerometerSize] = { 0x7f, 0x80, 0x01 };
+  btle::sensortag::DecodeAccelerometer(extremes, &acceleration);
+  BTLE_EXPECT_EQ(127 / 64.0, acceleration.x);
+  BTLE_EXPECT_EQ(-2.0, acceleration.y);
+  BTLE_EXPECT_EQ(1 / 64.0, acceleration.z);
+}
+
+// SHT21 conversions, with the status bits of the humidity cleared: the
+// datasheet example 0x6352 is 42.5 %RH.
+BTLE_TEST(sensortag, Humidity) {
+  const UINT8 data[btle::sensortag::kHumiditySize] = { 0x00, 0x66, 0x52, 0x63 };
+  btle::sensortag::Humidity humidity;
+  btle::sensortag::DecodeHumidity(data, &humidity);
+  BTLE_EXPECT(fabs(humidity.temperature - 23.1634375) < 1e-9);
+  BTLE_EXPECT(fabs(humidity.relative - 42.492431640625) < 1e-9);
+
+  const UINT8 status[btle::sensortag::kHumiditySize] = { 0x00, 0x66, 0x50, 0x63 };
+  btle::sensortag::Humidity cleared;
+  btle::sensortag::DecodeHumidity(status, &cleared);
+  BTLE_EXPECT_EQ(humidity.relative, cleared.relative);
+
+  const UINT8 extremes[btle::sensortag::kHumiditySize] = { 0x00, 0x00, 0xff, 0xff };
+  btle::sensortag::DecodeHumidity(extremes, &humidity);
+  BTLE_EXPECT_EQ(-46.85, humidity.temperature);
+  BTLE_EXPECT(fabs(humidity.relative - (-6 + 125 * 65532 / 65536.0)) < 1e-9);
+}
+
+// Signed 16-bit values, over +-1000 uT.
+BTLE_TEST(sensortag, Magnetometer) {
+  const UINT8 data[btle::sensortag::kMagnetometerSize] = { 0x00, 0x40, 0x00, 0xc0, 0x01, 0x00 };
+  btle::sensortag::Vector3 magnetic_field;
+  btle::sensortag::DecodeMagnetometer(data, &magnetic_field);
+  BTLE_EXPECT_EQ(500.0, magnetic_field.x);
+  BTLE_EXPECT_EQ(-500.0, magnetic_field.y);
+  BTLE_EXPECT_EQ(2000 / 65536.0, magnetic_field.z);
+}
+
+// Signed 16-bit values, over +-250 deg/s.
+BTLE_TEST(sensortag, Gyroscope) {
+  const UINT8 data[btle::sensortag::kGyroscopeSize] = { 0x00, 0x40, 0x00, 0x80, 0xff, 0x7f };
+  btle::sensortag::Vector3 rotation;
+  btle::sensortag::DecodeGyroscope(data, &rotation);
+  BTLE_EXPECT_EQ(125.0, rotation.x);
+  BTLE_EXPECT_EQ(-250.0, rotation.y);
+  BTLE_EXPECT_EQ(32767 * 500 / 65536.0, rotation.z);
+}
+
+// Pressure from the integer formulas of the T5400 datasheet: each term is
+// truncated by its shift, so the result stays within a few pascals of the
+// same formulas computed in floating point.
+BTLE_TEST(sensortag, Barometer) {
+  std::vector<UINT8> value = CalibrationValue(kCalibration);
+  btle::sensortag::BarometerCalibration calibration;
+  btle::sensortag::DecodeBarometerCalibration(&value[0], &calibration);
+  BTLE_EXPECT_EQ(45150, calibration.c1);
+  BTLE_EXPECT_EQ(23893, calibration.c4);
+  BTLE_EXPECT_EQ(7024, calibration.c5);
+  BTLE_EXPECT_EQ(-1990, calibration.c8);
+
+  static const struct {
+    int temperature;
+    int pressure;
+    double celsius;
+    double hectopascals;
+  } kVectors[] = {
+    { 6000, 33000, 23.95939826965332, 1030.76 },
+    { -1200, 36864, 4.583120346069336, 1108.01 },
+    { 32767, 65535, 95.99340260028839, 2277.43 },
+    { -32768, 0, -80.37109375, -41.45 },
+  };
+  for (size_t i = 0; i < sizeof(kVectors) / sizeof(kVectors[0]); i++) {
+    const UINT8 data[btle::sensortag::kBarometerSize] = {
+      static_cast<UINT8>(kVectors[i].temperature), static_cast<UINT8>(kVectors[i].temperature >> 8),
+      static_cast<UINT8>(kVectors[i].pressure), static_cast<UINT8>(kVectors[i].pressure >> 8) };
+    btle::sensortag::Barometer barometer;
+    btle::sensortag::DecodeBarometer(calibration, data, &barometer);
+    BTLE_EXPECT(fabs(barometer.temperature - kVectors[i].celsius) < 1e-9);
+    BTLE_EXPECT(fabs(barometer.pressure - kVectors[i].hectopascals) < 1e-9);
+
+    double t_r = kVectors[i].temperature;
+    double sensitivity = calibration.c3 + calibration.c4 * t_r / 131072 + calibration.c5 * t_r * t_r / 17179869184.0;
+    double offset = calibration.c6 * 16384.0 + calibration.c7 * t_r / 8 + calibration.c8 * t_r * t_r / 524288;
+    double pascals = (sensitivity * kVectors[i].pressure + offset) / 16384;
+    BTLE_EXPECT(fabs(barometer.pressure * 100 - pascals) < 8);
+  }
+}
+
+// The calibration is read once per device, and then used for all its
+// samples; each decoder keeps the calibration of its own device.
+BTLE_TEST(sensortag, BarometerCalibrationCached) {
+  const UINT8 data[btle::sensortag::kBarometerSize] = { 0x70, 0x17, 0xe8, 0x80 };
+  btle::sensortag::Decoder decoder;
+  btle::sensortag::Sample sample;
+  std::string error;
+  BTLE_EXPECT(!decoder.has_barometer_calibration());
+  BTLE_EXPECT(!decoder.Decode(btle::sensortag::kBarometer, data, sizeof(data), &sample, &error));
+  BTLE_EXPECT_EQ(std::string("Barometer calibration has not been read"), error);
+
+  std::vector<UINT8> value = CalibrationValue(kCalibration);
+  BTLE_EXPECT(!decoder.SetBarometerCalibration(&value[0], value.size() - 1, &error));
+  BTLE_EXPECT_EQ(std::string("Invalid barometer calibration size"), error);
+  BTLE_EXPECT(!decoder.has_barometer_calibration());
+  BTLE_EXPECT(decoder.SetBarometerCalibration(&value[0], value.size(), &error));
+  BTLE_EXPECT(decoder.has_barometer_calibration());
+  BTLE_EXPECT_EQ(45150, decoder.barometer_calibration().c1);
+  BTLE_EXPECT_EQ(-1990, decoder.barometer_calibration().c8);
+
+  const int kOther[8] = { 40000, 9000, 50000, 20000, 6000, 1000, 21000, -2000 };
+  std::vector<UINT8> other_value = CalibrationValue(kOther);
+  btle::sensortag::Decoder other;
+  BTLE_EXPECT(other.SetBarometerCalibration(&other_value[0], other_value.size(), &error));
+
+  btle::sensortag::BarometerCalibration calibration;
+  btle::sensortag::DecodeBarometerCalibration(&value[0], &calibration);
+  btle::sensortag::Barometer expected;
+  btle::sensortag::DecodeBarometer(calibration, data, &expected);
+  for (int i = 0; i < 3; i++) {
+    BTLE_EXPECT(decoder.Decode(btle::sensortag::kBarometer, data, sizeof(data), &sample, &error));
+    BTLE_EXPECT_EQ(btle::sensortag::kBarometer, sample.kind);
+    BTLE_EXPECT_EQ(expected.temperature, sample.barometer.temperature);
+    BTLE_EXPECT_EQ(expected.pressure, sample.barometer.pressure);
+  }
+  BTLE_EXPECT(other.Decode(btle::sensortag::kBarometer, data, sizeof(data), &sample, &error));
+  BTLE_EXPECT(sample.barometer.pressure != expected.pressure);
+  BTLE_EXPECT_EQ(45150, decoder.barometer_calibration().c1);
+
+  // A short calibration leaves the one already read.
+  BTLE_EXPECT(!decoder.SetBarometerCalibration(&other_value[0], 4, &error));
+  BTLE_EXPECT_EQ(45150, decoder.barometer_calibration().c1);
+}
+
+// DecodeBatch decodes like Decode on each value, for every sensor, with IR
+// temperatures crossing the chunks of the batch decoder.
+BTLE_TEST(sensortag, DecodeBatch) {
+  btle::sensortag::Decoder decoder;
+  std::string error;
+  std::vector<UINT8> calibration = CalibrationValue(kCalibration);
+  BTLE_EXPECT(decoder.SetBarometerCalibration(&calibration[0], calibration.size(), &error));
+
+  const size_t kCount = 75;
+  for (int kind = 0; kind < btle::sensortag::kSensorKindCount; kind++) {
+    const btle::sensortag::SensorInfo* info = btle::sensortag::GetSensorInfo(static_cast<btle::sensortag::SensorKind>(kind));
+    std::vector<UINT8> data(kCount * info->data_size);
+    UINT32 seed = 12345 + kind;
+    for (size_t i = 0; i < data.size(); i++) {
+      seed = seed * 1103515245 + 12345;
+      data[i] = static_cast<UINT8>(seed >> 16);
+    }
+
+    std::vector<btle::sensortag::Sample> samples(kCount);
+    BTLE_EXPECT(decoder.DecodeBatch(info->kind, &data[0], kCount, &samples[0], &error));
+    int mismatches = 0;
+    for (size_t i = 0; i < kCount; i++) {
+      btle::sensortag::Sample expected;
+      BTLE_EXPECT(decoder.Decode(info->kind, &data[i * info->data_size], info->data_size, &expected, &error));
+      if (!SameSample(expected, samples[i])) {
+        if (mismatches++ < 10)
+          BTLE_EXPECT_EQ(kind * 1000 + static_cast<int>(i), -1);
+      }
+    }
+    BTLE_EXPECT_EQ(0, mismatches);
+  }
+
+  btle::sensortag::Decoder uncalibrated;
+  btle::sensortag::Sample sample;
+  BTLE_EXPECT(!uncalibrated.DecodeBatch(btle::sensortag::kBarometer, &calibration[0], 1, &sample, &error));
+  BTLE_EXPECT_EQ(std::string("Barometer calibration has not been read"), error);
+  BTLE_EXPECT(!decoder.DecodeBatch(btle::sensortag::kSensorKindCount, &calibration[0], 1, &sample, &error));
+  BTLE_EXPECT_EQ(std::string("Unknown SensorTag sensor"), error);
+}
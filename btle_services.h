@@ -1,25 +1,25 @@
-DEFINE_SERVICE(0x1800, Generic_Access)
-DEFINE_SERVICE(0x1801, Generic_Attribute)
-DEFINE_SERVICE(0x1802, Immediate_Alert)
-DEFINE_SERVICE(0x1803, Link_Loss)
-DEFINE_SERVICE(0x1804, Tx_Power)
-DEFINE_SERVICE(0x1805, Current_Time_Service)
-DEFINE_SERVICE(0x1806, Reference_Time_Update_Service)
-DEFINE_SERVICE(0x1807, Next_DST_Change_Service)
-DEFINE_SERVICE(0x1808, Glucose)
-DEFINE_SERVICE(0x1809, Health_Thermometer)
-DEFINE_SERVICE(0x180A, Device_Information)
-DEFINE_SERVICE(0x180D, Heart_Rate)
-DEFINE_SERVICE(0x180E, Phone_Alert_Status_Service)
-DEFINE_SERVICE(0x180F, Battery_Service)
-DEFINE_SERVICE(0x1810, Blood_Pressure)
-DEFINE_SERVICE(0x1811, Alert_Notification_Service)
-DEFINE_SERVICE(0x1812, Human_Interface_Device)
-DEFINE_SERVICE(0x1813, Scan_Parameters)
-DEFINE_SERVICE(0x1814, Running_Speed_and_Cadence)
-DEFINE_SERVICE(0x1816, Cycling_Speed_and_Cadence)
-DEFINE_SERVICE(0x1818, Cycling_Power)
-DEFINE_SERVICE(0x1819, Location_and_Navigation)
-
-// TI Sensor Tag
-DEFINE_SERVICE(0xffe0, Key_Press_State_Service)
+DEFINE_SERVICE(0x1800, Generic_Access)
+DEFINE_SERVICE(0x1801, Generic_Attribute)
+DEFINE_SERVICE(0x1802, Immediate_Alert)
+DEFINE_SERVICE(0x1803, Link_Loss)
+DEFINE_SERVICE(0x1804, Tx_Power)
+DEFINE_SERVICE(0x1805, Current_Time_Service)
+DEFINE_SERVICE(0x1806, Reference_Time_Update_Service)
+DEFINE_SERVICE(0x1807, Next_DST_Change_Service)
+DEFINE_SERVICE(0x1808, Glucose)
+DEFINE_SERVICE(0x1809, Health_Thermometer)
+DEFINE_SERVICE(0x180A, Device_Information)
+DEFINE_SERVICE(0x180D, Heart_Rate)
+DEFINE_SERVICE(0x180E, Phone_Alert_Status_Service)
+DEFINE_SERVICE(0x180F, Battery_Service)
+DEFINE_SERVICE(0x1810, Blood_Pressure)
+DEFINE_SERVICE(0x1811, Alert_Notification_Service)
+DEFINE_SERVICE(0x1812, Human_Interface_Device)
+DEFINE_SERVICE(0x1813, Scan_Parameters)
+DEFINE_SERVICE(0x1814, Running_Speed_and_Cadence)
+DEFINE_SERVICE(0x1816, Cycling_Speed_and_Cadence)
+DEFINE_SERVICE(0x1818, Cycling_Power)
+DEFINE_SERVICE(0x1819, Location_and_Navigation)
+
+// TI Sensor Tag
+DEFINE_SERVICE(0xffe0, Key_Press_State_Service)
@@ -1,13 +1,13 @@
-// See http://processors.wiki.ti.com/images/a/a8/BLE_SensorTag_GATT_Server.pdf
-// DEFINE_CHARACTERISTIC_LONG(0xf0000000, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, "")
-
-// TI Sensor Tag
-DEFINE_SERVICE_LONG(0xf000aa00, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, IR_Temperature_Service)
-DEFINE_SERVICE_LONG(0xf000aa10, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Accelerometer_Service)
-DEFINE_SERVICE_LONG(0xf000aa20, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Humidity_Service)
-DEFINE_SERVICE_LONG(0xf000aa30, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Magnetometer_Service)
-DEFINE_SERVICE_LONG(0xf000aa40, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Barometer_Service)
-DEFINE_SERVICE_LONG(0xf000aa50, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Gyroscope_Service)
-DEFINE_SERVICE_LONG(0xf000aa60, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Test_Service)
-DEFINE_SERVICE_LONG(0xf000ccc0, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Connection_Control_Service)
-DEFINE_SERVICE_LONG(0xf000ffc0, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, OAD_Service)
+// See http://processors.wiki.ti.com/images/a/a8/BLE_SensorTag_GATT_Server.pdf
+// DEFINE_CHARACTERISTIC_LONG(0xf0000000, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, "")
+
+// TI Sensor Tag
+DEFINE_SERVICE_LONG(0xf000aa00, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, IR_Temperature_Service)
+DEFINE_SERVICE_LONG(0xf000aa10, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Accelerometer_Service)
+DEFINE_SERVICE_LONG(0xf000aa20, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Humidity_Service)
+DEFINE_SERVICE_LONG(0xf000aa30, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Magnetometer_Service)
+DEFINE_SERVICE_LONG(0xf000aa40, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Barometer_Service)
+DEFINE_SERVICE_LONG(0xf000aa50, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Gyroscope_Service)
+DEFINE_SERVICE_LONG(0xf000aa60, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Test_Service)
+DEFINE_SERVICE_LONG(0xf000ccc0, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, Connection_Control_Service)
+DEFINE_SERVICE_LONG(0xf000ffc0, 0x0451, 0x4000, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, OAD_Service)
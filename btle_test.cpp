@@ -0,0 +1,70 @@
+#include "stdafx.h"
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "btle_test.h"
+
+namespace btle {
+namespace test {
+
+namespace {
+
+struct Test {
+  const char* name;
+  TestFunction function;
+};
+
+// Constructed on first use: registrations run during the static
+// initialization of the test files, in any order.
+std::vector<Test>& Tests() {
+  static std::vector<Test> tests;
+  return tests;
+}
+
+}  // namespace
+
+void TestContext::Fail(const char* file, int line, const std::string& message) {
+  failures_++;
+  printf("%s(%d): %s\n", file, line, message.c_str());
+}
+
+TestRegistration::TestRegistration(const char* name, TestFunction function) {
+  Test test;
+  test.name = name;
+  test.function = function;
+  Tests().push_back(test);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+int RunTests(const std::string& filter) {
+  int run = 0;
+  int failed = 0;
+  const std::vector<Test>& tests = Tests();
+  for (std::vector<Test>::const_iterator it = tests.begin(); it != tests.end(); ++it) {
+    if (!filter.empty() && std::string(it->name).find(filter) == std::string::npos)
+      continue;
+
+    printf("[ RUN  ] %s\n", it->name);
+    fflush(stdout);
+    TestContext context;
+    ULONGLONG start_us = monotonic_microseconds();
+    it->function(&context);
+    ULONGLONG elapsed_ms = (monotonic_microseconds() - start_us) / 1000;
+    printf("[ %s ] %s (%llu ms)\n", context.failures() == 0 ? " OK " : "FAIL", it->name, static_cast<unsigned long long>(elapsed_ms));
+    fflush(stdout);
+
+    run++;
+    if (context.failures() != 0)
+      failed++;
+  }
+
+  printf("%d test(s) run, %d failed.\n", run, failed);
+  return failed;
+}
+
+}  // namespace test
+}  // namespace btle
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "base.h"
+
+namespace btle {
+namespace test {
+
+//////////////////////////////////////////////////////////////////////////////
+// Unit tests of the library, run by the BluetoothLowEnergyTests executable.
+//
+// Tests are defined with BTLE_TEST in "btle_*_test.cpp" files, next to the
+// module they test, and register themselves when the executable starts.
+// Checks record failures and let the test go on.
+//
+class TestContext {
+public:
+  TestContext() : failures_(0) {
+  }
+
+  void Fail(const char* file, int line, const std::string& message);
+
+  int failures() const { return failures_; }
+
+private:
+  int failures_;
+
+  TestContext(const TestContext& other);
+  const TestContext& operator=(const TestContext& other);
+};
+
+typedef void (*TestFunction)(TestContext* test);
+
+class TestRegistration {
+public:
+  TestRegistration(const char* name, TestFunction function);
+};
+
+// Runs the tests whose name contains "filter", in the order they were
+// registered, and returns the number of tests that failed.
+int RunTests(const std::string& filter);
+
+template<class T, class U>
+void ExpectEqual(TestContext* test, const T& expected, const U& actual,
+                 const char* expected_text, const char* actual_text, const char* file, int line) {
+  if (expected == actual)
+    return;
+  std::ostringstream string_stream;
+  string_stream << actual_text << " is " << actual << ", expected " << expected_text << " (" << expected << ")";
+  test->Fail(file, line, string_stream.str());
+}
+
+}  // namespace test
+}  // namespace btle
+
+#define BTLE_TEST(suite, name) \
+  void suite##_##name##_Test(btle::test::TestContext* test); \
+  static btle::test::TestRegistration suite##_##name##_Registration(#suite "/" #name, &suite##_##name##_Test); \
+  void suite##_##name##_Test(btle::test::TestContext* test)
+
+#define BTLE_EXPECT(condition) \
+  do { \
+    if (!(condition)) \
+      test->Fail(__FILE__, __LINE__, #condition); \
+  } while (0)
+
+#define BTLE_EXPECT_EQ(expected, actual) \
+  btle::test::ExpectEqual(test, (expected), (actual), #expected, #actual, __FILE__, __LINE__)
@@ -0,0 +1,452 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "btle_time_series.h"
+
+namespace btle {
+
+namespace {
+
+// Window of the first XOR of a block: no XOR fits in it.
+const int kNoWindow = 64;
+// Leading zeros are stored on 5 bits.
+const int kMaxLeading = 31;
+
+UINT64 ZigZag(INT64 value) {
+  return (static_cast<UINT64>(value) << 1) ^ static_cast<UINT64>(value >> 63);
+}
+
+INT64 UnZigZag(UINT64 value) {
+  return static_cast<INT64>(value >> 1) ^ -static_cast<INT64>(value & 1);
+}
+
+// Differences of arbitrary integers wrap around instead of overflowing.
+INT64 WrappingSub(INT64 a, INT64 b) {
+  return static_cast<INT64>(static_cast<UINT64>(a) - static_cast<UINT64>(b));
+}
+
+INT64 WrappingAdd(INT64 a, INT64 b) {
+  return static_cast<INT64>(static_cast<UINT64>(a) + static_cast<UINT64>(b));
+}
+
+void WriteVarint(std::vector<UINT8>* bytes, UINT64 value) {
+  while (value >= 0x80) {
+    bytes->push_back(static_cast<UINT8>(value | 0x80));
+    value >>= 7;
+  }
+  bytes->push_back(static_cast<UINT8>(value));
+}
+
+UINT64 ReadVarint(const std::vector<UINT8>& bytes, size_t* position) {
+  UINT64 value = 0;
+  int shift = 0;
+  UINT8 byte;
+  do {
+    byte = bytes[(*position)++];
+    value |= static_cast<UINT64>(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return value;
+}
+
+// Appends the "count" low bits of "value", most significant first.
+void WriteBits(std::vector<UINT8>* bytes, size_t* bit_count, UINT64 value, int count) {
+  while (count > 0) {
+    int used = static_cast<int>(*bit_count & 7);
+    if (used == 0)
+      bytes->push_back(0);
+    int room = 8 - used;
+    int take = count < room ? count : room;
+    UINT8 bits = static_cast<UINT8>((value >> (count - take)) & ((1u << take) - 1));
+    bytes->back() |= static_cast<UINT8>(bits << (room - take));
+    count -= take;
+    *bit_count += take;
+  }
+}
+
+UINT64 ReadBits(const std::vector<UINT8>& bytes, size_t* bit_position, int count) {
+  UINT64 value = 0;
+  while (count > 0) {
+    int used = static_cast<int>(*bit_position & 7);
+    int room = 8 - used;
+    int take = count < room ? count : room;
+    UINT8 byte = bytes[*bit_position >> 3];
+    UINT64 bits = (byte >> (room - take)) & ((1u << take) - 1);
+    value = (value << take) | bits;
+    count -= take;
+    *bit_position += take;
+  }
+  return value;
+}
+
+UINT64 DoubleBits(double value) {
+  return std::bit_cast<UINT64>(value);
+}
+
+double BitsDouble(UINT64 bits) {
+  return std::bit_cast<double>(bits);
+}
+
+double ColumnValue(SeriesColumnType type, const SeriesSample& sample, size_t column) {
+  return type == kIntegerColumn ? static_cast<double>(sample.integers[column]) : sample.floats[column];
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+TimeSeries::TimeSeries(const std::vector<SeriesColumnType>& columns, size_t block_samples)
+  : columns_(columns),
+    block_samples_(block_samples > 0 ? block_samples : kDefaultBlockSamples),
+    timestamp_delta_(0) {
+  if (columns_.size() > kMaxSeriesColumns)
+    columns_.resize(kMaxSeriesColumns);
+  memset(encoders_, 0, sizeof(encoders_));
+}
+
+TimeSeries::~TimeSeries() {
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    delete blocks_[i];
+  }
+}
+
+void TimeSeries::StartBlock(const SeriesSample& sample) {
+  if (!blocks_.empty()) {
+    // The last block is full: release its spare capacity.
+    Block* full = blocks_.back();
+    full->timestamps.shrink_to_fit();
+    for (size_t column = 0; column < columns_.size(); column++) {
+      full->columns[column].shrink_to_fit();
+    }
+  }
+
+  Block* block = new Block();
+  block->count = 0;
+  block->first_timestamp_us = sample.timestamp_us;
+  block->last_timestamp_us = sample.timestamp_us;
+  for (size_t column = 0; column < columns_.size(); column++) {
+    double value = ColumnValue(columns_[column], sample, column);
+    block->summaries[column].min = value;
+    block->summaries[column].max = value;
+    block->summaries[column].sum = 0.0;
+
+    ColumnEncoder& encoder = encoders_[column];
+    encoder.integer = 0;
+    encoder.bits = 0;
+    encoder.bit_count = 0;
+    encoder.leading = kNoWindow;
+    encoder.trailing = kNoWindow;
+  }
+  timestamp_delta_ = 0;
+  blocks_.push_back(block);
+}
+
+void TimeSeries::Append(const SeriesSample& sample) {
+  if (blocks_.empty() || blocks_.back()->count >= block_samples_) {
+    SeriesSample first = sample;
+    if (!blocks_.empty() && first.timestamp_us < blocks_.back()->last_timestamp_us)
+      first.timestamp_us = blocks_.back()->last_timestamp_us;
+    StartBlock(first);
+  }
+
+  Block* block = blocks_.back();
+  UINT64 timestamp_us = std::max(sample.timestamp_us, block->last_timestamp_us);
+  if (block->count == 0) {
+    WriteVarint(&block->timestamps, timestamp_us);
+  }
+  else {
+    INT64 delta = static_cast<INT64>(timestamp_us - block->last_timestamp_us);
+    WriteVarint(&block->timestamps, ZigZag(WrappingSub(delta, timestamp_delta_)));
+    timestamp_delta_ = delta;
+  }
+  block->last_timestamp_us = timestamp_us;
+
+  for (size_t column = 0; column < columns_.size(); column++) {
+    ColumnEncoder& encoder = encoders_[column];
+    std::vector<UINT8>& bytes = block->columns[column];
+    double value;
+    if (columns_[column] == kIntegerColumn) {
+      INT64 integer = sample.integers[column];
+      WriteVarint(&bytes, ZigZag(WrappingSub(integer, encoder.integer)));
+      encoder.integer = integer;
+      value = static_cast<double>(integer);
+    }
+    else {
+      UINT64 bits = DoubleBits(sample.floats[column]);
+      if (block->count == 0) {
+        WriteBits(&bytes, &encoder.bit_count, bits, 64);
+      }
+      else {
+        UINT64 xor_bits = bits ^ encoder.bits;
+        if (xor_bits == 0) {
+          WriteBits(&bytes, &encoder.bit_count, 0, 1);
+        }
+        else {
+          int leading = std::min(std::countl_zero(xor_bits), kMaxLeading);
+          int trailing = std::countr_zero(xor_bits);
+          if (leading >= encoder.leading && trailing >= encoder.trailing) {
+            // Within the window of the previous XOR.
+            WriteBits(&bytes, &encoder.bit_count, 2, 2);
+            WriteBits(&bytes, &encoder.bit_count, xor_bits >> encoder.trailing, 64 - encoder.leading - encoder.trailing);
+          }
+          else {
+            int meaningful = 64 - leading - trailing;
+            WriteBits(&bytes, &encoder.bit_count, 3, 2);
+            WriteBits(&bytes, &encoder.bit_count, leading, 5);
+            WriteBits(&bytes, &encoder.bit_count, meaningful - 1, 6);
+            WriteBits(&bytes, &encoder.bit_count, xor_bits >> trailing, meaningful);
+            encoder.leading = leading;
+            encoder.trailing = trailing;
+          }
+        }
+      }
+      encoder.bits = bits;
+      value = sample.floats[column];
+    }
+
+    ColumnSummary& summary = block->summaries[column];
+    summary.min = std::min(summary.min, value);
+    summary.max = std::max(summary.max, value);
+    summary.sum += value;
+  }
+  block->count++;
+}
+
+size_t TimeSeries::FindBlock(UINT64 timestamp_us) const {
+  size_t low = 0;
+  size_t high = blocks_.size();
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    if (blocks_[middle]->last_timestamp_us < timestamp_us)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
+
+TimeSeries::Cursor TimeSeries::Range(UINT64 from_us, UINT64 to_us) const {
+  Cursor cursor;
+  cursor.series_ = this;
+  cursor.block_ = FindBlock(from_us);
+  cursor.from_us_ = from_us;
+  cursor.to_us_ = to_us;
+  cursor.StartBlock();
+  return cursor;
+}
+
+bool TimeSeries::Aggregate(size_t column, UINT64 from_us, UINT64 to_us, SeriesAggregate* aggregate, std::string* error) const {
+  if (column >= columns_.size()) {
+    *error = "Invalid time series column.";
+    return false;
+  }
+
+  memset(aggregate, 0, sizeof(*aggregate));
+  for (size_t index = FindBlock(from_us); index < blocks_.size(); index++) {
+    const Block* block = blocks_[index];
+    if (block->first_timestamp_us > to_us)
+      break;
+
+    const ColumnSummary& summary = block->summaries[column];
+    if (block->first_timestamp_us >= from_us && block->last_timestamp_us <= to_us) {
+      aggregate->min = aggregate->count == 0 ? summary.min : std::min(aggregate->min, summary.min);
+      aggregate->max = aggregate->count == 0 ? summary.max : std::max(aggregate->max, summary.max);
+      aggregate->sum += summary.sum;
+      aggregate->count += block->count;
+      aggregate->summary_blocks++;
+      continue;
+    }
+
+    // Partially covered: decode the block.
+    Cursor cursor;
+    cursor.series_ = this;
+    cursor.block_ = index;
+    cursor.from_us_ = from_us;
+    cursor.to_us_ = to_us;
+    cursor.StartBlock();
+    SeriesSample sample;
+    while (cursor.index_ < block->count) {
+      cursor.Decode(&sample);
+      if (sample.timestamp_us < from_us)
+        continue;
+      if (sample.timestamp_us > to_us)
+        break;
+      double value = ColumnValue(columns_[column], sample, column);
+      aggregate->min = aggregate->count == 0 ? value : std::min(aggregate->min, value);
+      aggregate->max = aggregate->count == 0 ? value : std::max(aggregate->max, value);
+      aggregate->sum += value;
+      aggregate->count++;
+    }
+    aggregate->decoded_blocks++;
+  }
+  return true;
+}
+
+SeriesStats TimeSeries::stats() const {
+  SeriesStats stats;
+  memset(&stats, 0, sizeof(stats));
+  stats.block_count = blocks_.size();
+  for (size_t index = 0; index < blocks_.size(); index++) {
+    const Block* block = blocks_[index];
+    stats.sample_count += block->count;
+    stats.encoded_bytes += sizeof(block->count) + sizeof(block->first_timestamp_us) + sizeof(block->last_timestamp_us);
+    stats.encoded_bytes += block->timestamps.size();
+    for (size_t column = 0; column < columns_.size(); column++) {
+      stats.encoded_bytes += block->columns[column].size() + sizeof(ColumnSummary);
+    }
+  }
+  stats.raw_bytes = static_cast<size_t>(stats.sample_count) * (sizeof(UINT64) + columns_.size() * sizeof(UINT64));
+  return stats;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+TimeSeries::Cursor::Cursor()
+  : series_(NULL),
+    block_(0),
+    index_(0),
+    from_us_(0),
+    to_us_(0),
+    timestamp_position_(0),
+    timestamp_(0),
+    timestamp_delta_(0) {
+}
+
+void TimeSeries::Cursor::StartBlock() {
+  index_ = 0;
+  timestamp_position_ = 0;
+  timestamp_ = 0;
+  timestamp_delta_ = 0;
+  for (size_t column = 0; column < kMaxSeriesColumns; column++) {
+    positions_[column] = 0;
+    integers_[column] = 0;
+    floats_[column] = 0;
+    leading_[column] = 0;
+    trailing_[column] = 0;
+  }
+}
+
+void TimeSeries::Cursor::Decode(SeriesSample* sample) {
+  const Block* block = series_->blocks_[block_];
+  if (index_ == 0) {
+    timestamp_ = ReadVarint(block->timestamps, &timestamp_position_);
+  }
+  else {
+    timestamp_delta_ = WrappingAdd(timestamp_delta_, UnZigZag(ReadVarint(block->timestamps, &timestamp_position_)));
+    timestamp_ += timestamp_delta_;
+  }
+  sample->timestamp_us = timestamp_;
+
+  const std::vector<SeriesColumnType>& columns = series_->columns_;
+  for (size_t column = 0; column < columns.size(); column++) {
+    const std::vector<UINT8>& bytes = block->columns[column];
+    size_t* position = &positions_[column];
+    sample->integers[column] = 0;
+    sample->floats[column] = 0.0;
+    if (columns[column] == kIntegerColumn) {
+      integers_[column] = WrappingAdd(integers_[column], UnZigZag(ReadVarint(bytes, position)));
+      sample->integers[column] = integers_[column];
+      continue;
+    }
+
+    if (index_ == 0) {
+      floats_[column] = ReadBits(bytes, position, 64);
+    }
+    else if (ReadBits(bytes, position, 1) != 0) {
+      if (ReadBits(bytes, position, 1) != 0) {
+        leading_[column] = static_cast<int>(ReadBits(bytes, position, 5));
+        int meaningful = static_cast<int>(ReadBits(bytes, position, 6)) + 1;
+        trailing_[column] = 64 - leading_[column] - meaningful;
+      }
+      int meaningful = 64 - leading_[column] - trailing_[column];
+      floats_[column] ^= ReadBits(bytes, position, meaningful) << trailing_[column];
+    }
+    sample->floats[column] = BitsDouble(floats_[column]);
+  }
+  index_++;
+}
+
+bool TimeSeries::Cursor::Next(SeriesSample* sample) {
+  if (series_ == NULL)
+    return false;
+
+  while (block_ < series_->blocks_.size()) {
+    const Block* block = series_->blocks_[block_];
+    if (block->first_timestamp_us > to_us_)
+      return false;
+
+    while (index_ < block->count) {
+      Decode(sample);
+      if (sample->timestamp_us > to_us_)
+        return false;
+      if (sample->timestamp_us >= from_us_)
+        return true;
+    }
+
+    block_++;
+    StartBlock();
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+TimeSeriesStore::TimeSeriesStore() {
+}
+
+TimeSeriesStore::~TimeSeriesStore() {
+  for (std::map<Key, TimeSeries*>::iterator it = series_.begin(); it != series_.end(); ++it) {
+    delete it->second;
+  }
+}
+
+TimeSeries* TimeSeriesStore::Get(const BluetoothAddress& device, UuidId characteristic,
+                                 const std::vector<SeriesColumnType>& columns, size_t block_samples, std::string* error) {
+  if (columns.empty() || columns.size() > kMaxSeriesColumns) {
+    *error = "Invalid number of time series columns.";
+    return NULL;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  Key key(device.value(), characteristic);
+  std::map<Key, TimeSeries*>::iterator it = series_.find(key);
+  if (it != series_.end()) {
+    if (it->second->columns() != columns) {
+      *error = "Time series exists with other columns.";
+      return NULL;
+    }
+    return it->second;
+  }
+
+  TimeSeries* series = new TimeSeries(columns, block_samples);
+  series_[key] = series;
+  return series;
+}
+
+TimeSeries* TimeSeriesStore::Find(const BluetoothAddress& device, UuidId characteristic) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<Key, TimeSeries*>::const_iterator it = series_.find(Key(device.value(), characteristic));
+  return it == series_.end() ? NULL : it->second;
+}
+
+SeriesStats TimeSeriesStore::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  SeriesStats total;
+  memset(&total, 0, sizeof(total));
+  for (std::map<Key, TimeSeries*>::const_iterator it = series_.begin(); it != series_.end(); ++it) {
+    SeriesStats stats = it->second->stats();
+    total.sample_count += stats.sample_count;
+    total.block_count += stats.block_count;
+    total.encoded_bytes += stats.encoded_bytes;
+    total.raw_bytes += stats.raw_bytes;
+  }
+  return total;
+}
+
+}  // namespace btle
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base.h"
+#include "btle_address.h"
+#include "btle_uuid_interner.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Compressed in-memory time series of sensor samples, one per device and
+// characteristic, stored by column.
+//
+// A sample is a timestamp and a fixed set of columns, each holding either
+// raw integers (e.g. heart rate, RR intervals, raw SensorTag readings) or
+// decoded floats (e.g. temperatures in Celsius). Samples are grouped into
+// blocks of a fixed number of samples. Each column of a block is encoded
+// on its own:
+// - timestamps: the first one, then the delta to the second, then the
+//   delta of deltas, zigzag and varint encoded. Samples at a steady rate
+//   take a byte.
+// - integers: the delta to the previous value, zigzag and varint encoded.
+// - floats: the XOR with the previous value, storing only its meaningful
+//   bits, and only a control bit when they fall within those of the
+//   previous XOR (as in Facebook's Gorilla). A repeated value takes a bit.
+//
+// Every block restarts the encodings, and keeps the count, the time range
+// and the minimum, maximum and sum of each column, so that a range is
+// aggregated by decoding only the blocks it partially covers.
+//
+
+enum SeriesColumnType {
+  kIntegerColumn,
+  kFloatColumn,
+};
+
+const size_t kMaxSeriesColumns = 8;
+
+struct SeriesSample {
+  UINT64 timestamp_us;
+  // The value of column i is in integers[i] or floats[i], depending on its
+  // type. The other entry is ignored by Append() and zero after decoding.
+  INT64 integers[kMaxSeriesColumns];
+  double floats[kMaxSeriesColumns];
+};
+
+// Aggregate of a column over a time range. Integers are converted to
+// doubles, which is exact up to 2^53.
+struct SeriesAggregate {
+  UINT64 count;
+  double min;
+  double max;
+  double sum;
+  // Blocks decoded to compute the aggregate, and blocks answered from their
+  // summary alone.
+  size_t decoded_blocks;
+  size_t summary_blocks;
+};
+
+struct SeriesStats {
+  UINT64 sample_count;
+  size_t block_count;
+  // Encoded bytes, summaries included.
+  size_t encoded_bytes;
+  // Size of the samples as an array of timestamps and 8-byte values.
+  size_t raw_bytes;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// A time series. Not thread safe: a series is appended to by the session
+// monitoring its characteristic, and callers synchronize with readers.
+//
+class TimeSeries {
+public:
+  static const size_t kDefaultBlockSamples = 1024;
+
+  // Iterates over the samples of a time range, decoding one block at a
+  // time. Remains valid while samples are appended.
+  class Cursor {
+  public:
+    Cursor();
+
+    // Returns false after the last sample of the range.
+    bool Next(SeriesSample* sample);
+
+  private:
+    friend class TimeSeries;
+
+    // Decodes the next sample of the current block.
+    void Decode(SeriesSample* sample);
+    void StartBlock();
+
+    const TimeSeries* series_;
+    size_t block_;
+    UINT32 index_;
+    UINT64 from_us_;
+    UINT64 to_us_;
+    // Decoder state of the current block.
+    size_t timestamp_position_;
+    UINT64 timestamp_;
+    INT64 timestamp_delta_;
+    size_t positions_[kMaxSeriesColumns];
+    INT64 integers_[kMaxSeriesColumns];
+    UINT64 floats_[kMaxSeriesColumns];
+    int leading_[kMaxSeriesColumns];
+    int trailing_[kMaxSeriesColumns];
+  };
+
+  TimeSeries(const std::vector<SeriesColumnType>& columns, size_t block_samples);
+  ~TimeSeries();
+
+  const std::vector<SeriesColumnType>& columns() const { return columns_; }
+
+  // Appends a sample. A timestamp earlier than the previous sample is
+  // raised to it, so that timestamps never decrease.
+  void Append(const SeriesSample& sample);
+
+  // Samples with "from_us" <= timestamp <= "to_us". Skips the blocks
+  // before "from_us" with a binary search.
+  Cursor Range(UINT64 from_us, UINT64 to_us) const;
+  Cursor All() const { return Range(0, ~0ULL); }
+
+  // Aggregates "column" over the samples of a time range.
+  bool Aggregate(size_t column, UINT64 from_us, UINT64 to_us, SeriesAggregate* aggregate, std::string* error) const;
+
+  SeriesStats stats() const;
+
+private:
+  struct ColumnSummary {
+    double min;
+    double max;
+    double sum;
+  };
+
+  struct Block {
+    UINT32 count;
+    UINT64 first_timestamp_us;
+    UINT64 last_timestamp_us;
+    std::vector<UINT8> timestamps;
+    // Integers are byte aligned varints, floats a bit stream.
+    std::vector<UINT8> columns[kMaxSeriesColumns];
+    ColumnSummary summaries[kMaxSeriesColumns];
+  };
+
+  // Encoder state of the last block.
+  struct ColumnEncoder {
+    INT64 integer;
+    UINT64 bits;
+    size_t bit_count;
+    int leading;
+    int trailing;
+  };
+
+  // Index of the first block ending at or after "timestamp_us".
+  size_t FindBlock(UINT64 timestamp_us) const;
+  void StartBlock(const SeriesSample& sample);
+
+  std::vector<SeriesColumnType> columns_;
+  size_t block_samples_;
+  std::vector<Block*> blocks_;
+  INT64 timestamp_delta_;
+  ColumnEncoder encoders_[kMaxSeriesColumns];
+
+  TimeSeries(const TimeSeries& other);
+  const TimeSeries& operator=(const TimeSeries& other);
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// The time series of each device and characteristic.
+//
+class TimeSeriesStore {
+public:
+  TimeSeriesStore();
+  ~TimeSeriesStore();
+
+  // Returns the series of "device" and "characteristic", creating it with
+  // "columns" and "block_samples" the first time. Fails if the series
+  // exists with other columns, or if "columns" is empty or has more than
+  // kMaxSeriesColumns columns.
+  TimeSeries* Get(const BluetoothAddress& device, UuidId characteristic,
+                  const std::vector<SeriesColumnType>& columns, size_t block_samples, std::string* error);
+
+  // Returns NULL if there is no series for "device" and "characteristic".
+  TimeSeries* Find(const BluetoothAddress& device, UuidId characteristic) const;
+
+  // Sum of the stats of all series.
+  SeriesStats stats() const;
+
+private:
+  typedef std::pair<UINT64, UuidId> Key;
+
+  mutable std::mutex mutex_;
+  std::map<Key, TimeSeries*> series_;
+
+  TimeSeriesStore(const TimeSeriesStore& other);
+  const TimeSeriesStore& operator=(const TimeSeriesStore& other);
+};
+
+}  // namespace btle
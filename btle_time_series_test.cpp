@@ -0,0 +1,317 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "btle_test.h"
+#include "btle_time_series.h"
+
+namespace {
+
+// Deterministic pseudo random numbers (xorshift64).
+class Random {
+public:
+  explicit Random(UINT64 seed) : state_(seed) {}
+
+  UINT64 Next() {
+    state_ ^= state_ << 13;
+    state_ ^= state_ >> 7;
+    state_ ^= state_ << 17;
+    return state_;
+  }
+
+  // Uniform in [0, bound).
+  UINT64 Below(UINT64 bound) { return Next() % bound; }
+
+private:
+  UINT64 state_;
+};
+
+// Integers: small deltas, large jumps and the extremes, whose deltas wrap
+// around.
+INT64 MakeInteger(Random* random, INT64 previous) {
+  switch (random->Below(8)) {
+  case 0:
+    return std::numeric_limits<INT64>::min();
+  case 1:
+    return std::numeric_limits<INT64>::max();
+  case 2:
+    return static_cast<INT64>(random->Next());
+  case 3:
+    return previous;
+  default:
+    return previous + static_cast<INT64>(random->Below(201)) - 100;
+  }
+}
+
+// Floats: repeats, small changes, arbitrary bit patterns and the special
+// values. NaNs only with "special", as they have no order for aggregates.
+double MakeFloat(Random* random, double previous, bool special) {
+  switch (random->Below(special ? 10 : 6)) {
+  case 0:
+    return previous;
+  case 1:
+    return static_cast<double>(random->Below(100000)) / 64;
+  case 2:
+    return 25.0 + static_cast<double>(random->Below(64)) * 0.03125;
+  case 3:
+    return -previous;
+  case 4:
+    return std::numeric_limits<double>::denorm_min() * static_cast<double>(random->Below(1000));
+  case 5:
+    return static_cast<double>(static_cast<INT64>(random->Below(2000000)) - 1000000) / 1000;
+  case 6:
+    return std::numeric_limits<double>::infinity();
+  case 7:
+    return -0.0;
+  case 8:
+    return std::numeric_limits<double>::quiet_NaN();
+  default:
+    return std::bit_cast<double>(random->Next());
+  }
+}
+
+// Samples with irregular timestamps: a steady rate, jitter, repeated
+// timestamps and long gaps.
+std::vector<btle::SeriesSample> MakeSamples(const std::vector<btle::SeriesColumnType>& columns, size_t count, bool special, UINT64 seed) {
+  Random random(seed);
+  std::vector<btle::SeriesSample> samples;
+  btle::SeriesSample sample = {};
+  sample.timestamp_us = 1000000;
+  for (size_t i = 0; i < count; i++) {
+    switch (random.Below(8)) {
+    case 0:
+      break;
+    case 1:
+      sample.timestamp_us += random.Below(1ULL << 40);
+      break;
+    case 2:
+      sample.timestamp_us += random.Below(2000);
+      break;
+    default:
+      sample.timestamp_us += 1000;
+      break;
+    }
+    for (size_t column = 0; column < columns.size(); column++) {
+      if (columns[column] == btle::kIntegerColumn)
+        sample.integers[column] = MakeInteger(&random, sample.integers[column]);
+      else
+        sample.floats[column] = MakeFloat(&random, sample.floats[column], special);
+    }
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+// Same timestamp and values, floats compared by their bits. The unused entry
+// of each column is zero.
+bool SameSample(const std::vector<btle::SeriesColumnType>& columns, const btle::SeriesSample& expected, const btle::SeriesSample& actual) {
+  if (expected.timestamp_us != actual.timestamp_us)
+    return false;
+  for (size_t column = 0; column < columns.size(); column++) {
+    if (columns[column] == btle::kIntegerColumn) {
+      if (expected.integers[column] != actual.integers[column] || actual.floats[column] != 0.0)
+        return false;
+    }
+    else {
+      if (std::bit_cast<UINT64>(expected.floats[column]) != std::bit_cast<UINT64>(actual.floats[column]) ||
+          actual.integers[column] != 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+// Compares the samples of "cursor" with those of "expected" from "from_us"
+// to "to_us", and returns the number of mismatches.
+int CountRangeMismatches(const std::vector<btle::SeriesColumnType>& columns, const std::vector<btle::SeriesSample>& expected,
+                         UINT64 from_us, UINT64 to_us, btle::TimeSeries::Cursor cursor) {
+  int mismatches = 0;
+  btle::SeriesSample sample;
+  for (std::vector<btle::SeriesSample>::const_iterator it = expected.begin(); it != expected.end(); ++it) {
+    if (it->timestamp_us < from_us || it->timestamp_us > to_us)
+      continue;
+    if (!cursor.Next(&sample) || !SameSample(columns, *it, sample))
+      mismatches++;
+  }
+  if (cursor.Next(&sample))
+    mismatches++;
+  return mismatches;
+}
+
+const std::vector<btle::SeriesColumnType> kColumns = {
+  btle::kIntegerColumn, btle::kFloatColumn, btle::kIntegerColumn, btle::kFloatColumn
+};
+
+}  // namespace
+
+// Every sample decodes to the appended one, across blocks, with the
+// special floats and the integer extremes.
+BTLE_TEST(time_series, RoundTrip) {
+  std::vector<btle::SeriesSample> samples = MakeSamples(kColumns, 5000, true, 0x9e3779b97f4a7c15ULL);
+  btle::TimeSeries series(kColumns, 100);
+  for (std::vector<btle::SeriesSample>::const_iterator it = samples.begin(); it != samples.end(); ++it)
+    series.Append(*it);
+
+  BTLE_EXPECT_EQ(0, CountRangeMismatches(kColumns, samples, 0, ~0ULL, series.All()));
+  btle::SeriesStats stats = series.stats();
+  BTLE_EXPECT_EQ(samples.size(), stats.sample_count);
+  BTLE_EXPECT_EQ(50u, stats.block_count);
+}
+
+// Samples at a steady rate, with slowly changing values, compress well.
+BTLE_TEST(time_series, SteadySamplesCompress) {
+  const std::vector<btle::SeriesColumnType> columns = { btle::kIntegerColumn, btle::kFloatColumn };
+  btle::TimeSeries series(columns, btle::TimeSeries::kDefaultBlockSamples);
+  std::vector<btle::SeriesSample> samples;
+  for (UINT64 i = 0; i < 10000; i++) {
+    btle::SeriesSample sample = {};
+    sample.timestamp_us = i * 1000000;
+    sample.integers[0] = 60 + (i / 16) % 8;
+    sample.floats[1] = 25.0 + ((i / 8) % 64) * 0.03125;
+    samples.push_back(sample);
+    series.Append(sample);
+  }
+  BTLE_EXPECT_EQ(0, CountRangeMismatches(columns, samples, 0, ~0ULL, series.All()));
+  btle::SeriesStats stats = series.stats();
+  BTLE_EXPECT(stats.encoded_bytes * 4 < stats.raw_bytes);
+}
+
+// A timestamp earlier than the previous one is raised to it, within a block
+// and at the start of the next block.
+BTLE_TEST(time_series, DecreasingTimestamps) {
+  const std::vector<btle::SeriesColumnType> columns = { btle::kIntegerColumn };
+  btle::TimeSeries series(columns, 2);
+  const UINT64 kTimestamps[] = { 100, 50, 200, 150, 300 };
+  const UINT64 kExpected[] = { 100, 100, 200, 200, 300 };
+  for (size_t i = 0; i < 5; i++) {
+    btle::SeriesSample sample = {};
+    sample.timestamp_us = kTimestamps[i];
+    sample.integers[0] = static_cast<INT64>(i);
+    series.Append(sample);
+  }
+  btle::TimeSeries::Cursor cursor = series.All();
+  btle::SeriesSample sample;
+  for (size_t i = 0; i < 5; i++) {
+    BTLE_EXPECT(cursor.Next(&sample));
+    BTLE_EXPECT_EQ(kExpected[i], sample.timestamp_us);
+    BTLE_EXPECT_EQ(static_cast<INT64>(i), sample.integers[0]);
+  }
+  BTLE_EXPECT(!cursor.Next(&sample));
+}
+
+// Range() returns the samples a scan of all samples selects, for ranges
+// within, across and outside the blocks.
+BTLE_TEST(time_series, Range) {
+  std::vector<btle::SeriesSample> samples = MakeSamples(kColumns, 3000, true, 12345);
+  btle::TimeSeries series(kColumns, 64);
+  for (std::vector<btle::SeriesSample>::const_iterator it = samples.begin(); it != samples.end(); ++it)
+    series.Append(*it);
+
+  UINT64 first_us = samples.front().timestamp_us;
+  UINT64 last_us = samples.back().timestamp_us;
+  Random random(777);
+  int mismatches = 0;
+  for (int i = 0; i < 300; i++) {
+    // Bounds on sample timestamps, between them, or outside the series.
+    UINT64 from_us = i % 3 == 0 ? samples[random.Below(samples.size())].timestamp_us : random.Below(last_us + 2000);
+    UINT64 to_us = i % 5 == 0 ? samples[random.Below(samples.size())].timestamp_us : from_us + random.Below(last_us / 4);
+    mismatches += CountRangeMismatches(kColumns, samples, from_us, to_us, series.Range(from_us, to_us));
+  }
+  BTLE_EXPECT_EQ(0, mismatches);
+  BTLE_EXPECT_EQ(0, CountRangeMismatches(kColumns, samples, last_us + 1, ~0ULL, series.Range(last_us + 1, ~0ULL)));
+  BTLE_EXPECT_EQ(0, CountRangeMismatches(kColumns, samples, 0, first_us - 1, series.Range(0, first_us - 1)));
+  BTLE_EXPECT_EQ(0, CountRangeMismatches(kColumns, samples, 10, 5, series.Range(10, 5)));
+}
+
+// Aggregate() matches the aggregate of a scan of all samples, and answers
+// the blocks a range fully covers from their summaries.
+BTLE_TEST(time_series, Aggregate) {
+  const std::vector<btle::SeriesColumnType> columns = { btle::kIntegerColumn, btle::kFloatColumn };
+  std::vector<btle::SeriesSample> samples = MakeSamples(columns, 3000, false, 4242);
+  // Integers within 2^53, converted exactly to doubles.
+  for (std::vector<btle::SeriesSample>::iterator it = samples.begin(); it != samples.end(); ++it)
+    it->integers[0] = it->integers[0] >> 11;
+  btle::TimeSeries series(columns, 64);
+  for (std::vector<btle::SeriesSample>::const_iterator it = samples.begin(); it != samples.end(); ++it)
+    series.Append(*it);
+
+  UINT64 last_us = samples.back().timestamp_us;
+  Random random(99);
+  std::string error;
+  int mismatches = 0;
+  for (int i = 0; i < 300; i++) {
+    UINT64 from_us = i % 3 == 0 ? samples[random.Below(samples.size())].timestamp_us : random.Below(last_us + 2000);
+    UINT64 to_us = i % 4 == 0 ? ~0ULL : from_us + random.Below(last_us / 2);
+    for (size_t column = 0; column < columns.size(); column++) {
+      UINT64 count = 0;
+      double min = 0.0;
+      double max = 0.0;
+      double sum = 0.0;
+      for (std::vector<btle::SeriesSample>::const_iterator it = samples.begin(); it != samples.end(); ++it) {
+        if (it->timestamp_us < from_us || it->timestamp_us > to_us)
+          continue;
+        double value = column == 0 ? static_cast<double>(it->integers[column]) : it->floats[column];
+        min = count == 0 ? value : std::min(min, value);
+        max = count == 0 ? value : std::max(max, value);
+        sum += value;
+        count++;
+      }
+
+      btle::SeriesAggregate aggregate;
+      BTLE_EXPECT(series.Aggregate(column, from_us, to_us, &aggregate, &error));
+      // Sums are added in another order.
+      bool same_sum = fabs(aggregate.sum - sum) <= 1e-9 * std::max(1.0, fabs(sum));
+      if (aggregate.count != count || (count > 0 && (aggregate.min != min || aggregate.max != max || !same_sum))) {
+        if (mismatches++ < 10)
+          BTLE_EXPECT_EQ(count, aggregate.count);
+      }
+      // At most the two blocks at the ends of the range are decoded.
+      if (aggregate.decoded_blocks > 2)
+        mismatches++;
+    }
+  }
+  BTLE_EXPECT_EQ(0, mismatches);
+
+  btle::SeriesAggregate aggregate;
+  BTLE_EXPECT(series.Aggregate(1, 0, ~0ULL, &aggregate, &error));
+  BTLE_EXPECT_EQ(samples.size(), aggregate.count);
+  BTLE_EXPECT_EQ(0u, aggregate.decoded_blocks);
+  BTLE_EXPECT_EQ(series.stats().block_count, aggregate.summary_blocks);
+
+  BTLE_EXPECT(!series.Aggregate(columns.size(), 0, ~0ULL, &aggregate, &error));
+  BTLE_EXPECT_EQ(std::string("Invalid time series column."), error);
+}
+
+// A store keeps one series per device and characteristic, with fixed
+// columns.
+BTLE_TEST(time_series, Store) {
+  btle::TimeSeriesStore store;
+  btle::BluetoothAddress device(0x00126f4f5c4eULL);
+  btle::BluetoothAddress other(0x00126f4f5c4fULL);
+  std::string error;
+  const std::vector<btle::SeriesColumnType> columns = { btle::kIntegerColumn };
+
+  BTLE_EXPECT(store.Find(device, 1) == NULL);
+  btle::TimeSeries* series = store.Get(device, 1, columns, 16, &error);
+  BTLE_EXPECT(series != NULL);
+  BTLE_EXPECT(store.Get(device, 1, columns, 16, &error) == series);
+  BTLE_EXPECT(store.Find(device, 1) == series);
+  BTLE_EXPECT(store.Find(other, 1) == NULL);
+  BTLE_EXPECT(store.Find(device, 2) == NULL);
+
+  const std::vector<btle::SeriesColumnType> floats = { btle::kFloatColumn };
+  BTLE_EXPECT(store.Get(device, 1, floats, 16, &error) == NULL);
+  BTLE_EXPECT_EQ(std::string("Time series exists with other columns."), error);
+  BTLE_EXPECT(store.Get(other, 1, std::vector<btle::SeriesColumnType>(), 16, &error) == NULL);
+  BTLE_EXPECT_EQ(std::string("Invalid number of time series columns."), error);
+  BTLE_EXPECT(store.Get(other, 1, std::vector<btle::SeriesColumnType>(btle::kMaxSeriesColumns + 1), 16, &error) == NULL);
+
+  btle::SeriesSample sample = {};
+  series->Append(sample);
+  BTLE_EXPECT_EQ(1u, store.stats().sample_count);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <functional>
+
+#include "btle_platform.h"
+
+#include "base.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Canonical 128-bit uuid, stored as two 64-bit halves in the order of the
+// text form ("xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" reads high then low).
+//
+// Short uuids are expanded against the Bluetooth base uuid, so 0x180a and
+// 0000180a-0000-1000-8000-00805f9b34fb are the same Uuid however the device
+// reports them. Equality is two integer compares and all conversions are
+// constexpr, so X-macro entries convert at compile time.
+//
+class Uuid {
+public:
+  // 0000xxxx-0000-1000-8000-00805f9b34fb
+  static const UINT64 kBaseHigh = 0x0000000000001000ULL;
+  static const UINT64 kBaseLow = 0x800000805f9b34fbULL;
+
+  constexpr Uuid() : high_(0), low_(0) {
+  }
+
+  constexpr Uuid(UINT64 high, UINT64 low) : high_(high), low_(low) {
+  }
+
+  constexpr explicit Uuid(USHORT short_uuid)
+    : high_(kBaseHigh | (static_cast<UINT64>(short_uuid) << 32)), low_(kBaseLow) {
+  }
+
+  constexpr explicit Uuid(const GUID& guid)
+    : high_((static_cast<UINT64>(guid.Data1) << 32) |
+            (static_cast<UINT64>(guid.Data2) << 16) |
+            guid.Data3),
+      low_((static_cast<UINT64>(guid.Data4[0]) << 56) |
+           (static_cast<UINT64>(guid.Data4[1]) << 48) |
+           (static_cast<UINT64>(guid.Data4[2]) << 40) |
+           (static_cast<UINT64>(guid.Data4[3]) << 32) |
+           (static_cast<UINT64>(guid.Data4[4]) << 24) |
+           (static_cast<UINT64>(guid.Data4[5]) << 16) |
+           (static_cast<UINT64>(guid.Data4[6]) << 8) |
+           guid.Data4[7]) {
+  }
+
+  constexpr explicit Uuid(const BTH_LE_UUID& uuid)
+    : Uuid(uuid.IsShortUuid ? Uuid(uuid.Value.ShortUuid) : Uuid(uuid.Value.LongUuid)) {
+  }
+
+  constexpr UINT64 high() const { return high_; }
+  constexpr UINT64 low() const { return low_; }
+
+  // True if the uuid is derived from the Bluetooth base uuid.
+  constexpr bool IsShort() const {
+    return low_ == kBaseLow && (high_ & 0xffff0000ffffffffULL) == kBaseHigh;
+  }
+
+  // Only meaningful if IsShort().
+  constexpr USHORT short_uuid() const {
+    return static_cast<USHORT>(high_ >> 32);
+  }
+
+  constexpr GUID ToGuid() const {
+    GUID guid = {};
+    guid.Data1 = static_cast<ULONG>(high_ >> 32);
+    guid.Data2 = static_cast<USHORT>(high_ >> 16);
+    guid.Data3 = static_cast<USHORT>(high_);
+    for (int i = 0; i < 8; i++)
+      guid.Data4[i] = static_cast<UCHAR>(low_ >> (56 - 8 * i));
+    return guid;
+  }
+
+  // Short form for uuids derived from the base uuid, as devices report them.
+  constexpr BTH_LE_UUID ToBthLeUuid() const {
+    BTH_LE_UUID uuid = {};
+    if (IsShort()) {
+      uuid.IsShortUuid = TRUE;
+      uuid.Value.ShortUuid = short_uuid();
+    } else {
+      uuid.IsShortUuid = FALSE;
+      uuid.Value.LongUuid = ToGuid();
+    }
+    return uuid;
+  }
+
+  constexpr bool operator==(const Uuid& other) const { return high_ == other.high_ && low_ == other.low_; }
+  constexpr bool operator!=(const Uuid& other) const { return !(*this == other); }
+  constexpr bool operator<(const Uuid& other) const {
+    return high_ != other.high_ ? high_ < other.high_ : low_ < other.low_;
+  }
+
+  // Short uuids only differ in 16 bits of the high half: both halves go
+  // through a 64-bit finalizer so that all bits of the hash depend on them.
+  size_t Hash() const {
+    return static_cast<size_t>(Mix(high_ ^ Mix(low_)));
+  }
+
+private:
+  static UINT64 Mix(UINT64 value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+  }
+
+  UINT64 high_;
+  UINT64 low_;
+};
+
+}  // namespace btle
+
+namespace std {
+
+template <>
+struct hash<btle::Uuid> {
+  size_t operator()(const btle::Uuid& uuid) const {
+    return uuid.Hash();
+  }
+};
+
+}  // namespace std
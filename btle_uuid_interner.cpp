@@ -0,0 +1,105 @@
+#include "stdafx.h"
+
+#include "btle_uuid_interner.h"
+
+namespace btle {
+
+UuidInterner UuidIds;
+
+namespace {
+
+// Initial number of slots, a power of 2.
+const size_t kInitialSlots = 512;
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+UuidInterner::UuidInterner() : slots_(kInitialSlots, kInvalidUuidId), count_(0) {
+  for (size_t i = 0; i < kBlockCount; i++)
+    blocks_[i].store(NULL, std::memory_order_relaxed);
+
+#define DEFINE_SERVICE(id, name) Intern(Uuid(static_cast<USHORT>(id)));
+#include "btle_services.h"
+#undef DEFINE_SERVICE
+
+#define DEFINE_CHARACTERISTIC(id, name) Intern(Uuid(static_cast<USHORT>(id)));
+#include "btle_characteristics.h"
+#undef DEFINE_CHARACTERISTIC
+
+#define DEFINE_DESCRIPTOR(id, name) Intern(Uuid(static_cast<USHORT>(id)));
+#include "btle_descriptors.h"
+#undef DEFINE_DESCRIPTOR
+
+#define BTLE_INTERN_LONG_UUID(uuid1, uuid2, uuid3, uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8, name) \
+  { \
+    GUID uuid = { uuid1, uuid2, uuid3, { uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8 } }; \
+    Intern(Uuid(uuid)); \
+  }
+#define DEFINE_SERVICE_LONG BTLE_INTERN_LONG_UUID
+#include "btle_services_long.h"
+#undef DEFINE_SERVICE_LONG
+
+#define DEFINE_CHARACTERISTIC_LONG BTLE_INTERN_LONG_UUID
+#include "btle_characteristics_long.h"
+#undef DEFINE_CHARACTERISTIC_LONG
+#undef BTLE_INTERN_LONG_UUID
+}
+
+UuidInterner::~UuidInterner() {
+  for (size_t i = 0; i < kBlockCount; i++)
+    delete[] blocks_[i].load(std::memory_order_relaxed);
+}
+
+UuidId UuidInterner::Intern(const Uuid& uuid) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t slot = Probe(uuid);
+  if (slots_[slot] != kInvalidUuidId)
+    return slots_[slot];
+
+  size_t count = count_.load(std::memory_order_relaxed);
+  if (count == kMaxCount)
+    return kInvalidUuidId;
+
+  Uuid* block = blocks_[count / kBlockSize].load(std::memory_order_relaxed);
+  if (block == NULL) {
+    block = new Uuid[kBlockSize];
+    blocks_[count / kBlockSize].store(block, std::memory_order_release);
+  }
+  block[count % kBlockSize] = uuid;
+  count_.store(count + 1, std::memory_order_release);
+
+  UuidId id = static_cast<UuidId>(count);
+  slots_[slot] = id;
+  if ((count + 1) * 2 > slots_.size())
+    Grow();
+  return id;
+}
+
+UuidId UuidInterner::Find(const Uuid& uuid) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return slots_[Probe(uuid)];
+}
+
+size_t UuidInterner::Probe(const Uuid& uuid) const {
+  size_t mask = slots_.size() - 1;
+  size_t index = uuid.Hash() & mask;
+  for (;;) {
+    UuidId id = slots_[index];
+    if (id == kInvalidUuidId || Get(id) == uuid)
+      return index;
+    index = (index + 1) & mask;
+  }
+}
+
+void UuidInterner::Grow() {
+  std::vector<UuidId> slots(slots_.size() * 2, kInvalidUuidId);
+  slots_.swap(slots);
+  for (std::vector<UuidId>::const_iterator it = slots.begin(); it != slots.end(); ++it) {
+    if (*it != kInvalidUuidId)
+      slots_[Probe(Get(*it))] = *it;
+  }
+}
+
+}  // namespace btle
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "base.h"
+#include "btle_uuid.h"
+
+namespace btle {
+
+// Dense id of an interned uuid.
+typedef UINT16 UuidId;
+const UuidId kInvalidUuidId = 0xffff;
+
+//////////////////////////////////////////////////////////////////////////////
+// Assigns each distinct uuid a dense 16-bit id, so that hot paths compare
+// and index by id instead of comparing 128-bit uuids.
+//
+// The uuids of the X-macro headers are interned at construction, so they
+// get the first ids; uuids discovered on devices are interned when the
+// model objects are created. Ids are never reused.
+//
+// Intern() and Find() take a lock. Get() is lock free: uuids are stored in
+// blocks that never move, and an id only reaches another thread along with
+// the object holding it.
+//
+class UuidInterner {
+public:
+  UuidInterner();
+  ~UuidInterner();
+
+  // Returns the id of "uuid", assigning the next one the first time.
+  // Returns kInvalidUuidId once all ids are used: objects holding that id
+  // must be compared by uuid.
+  UuidId Intern(const Uuid& uuid);
+
+  // Returns kInvalidUuidId for uuids that were never interned.
+  UuidId Find(const Uuid& uuid) const;
+
+  // The uuid of an id returned by Intern(), or the null uuid for
+  // kInvalidUuidId and ids not assigned yet.
+  const Uuid& Get(UuidId id) const {
+    if (id >= count_.load(std::memory_order_acquire))
+      return null_uuid_;
+    return blocks_[id / kBlockSize].load(std::memory_order_acquire)[id % kBlockSize];
+  }
+
+  size_t size() const { return count_.load(std::memory_order_acquire); }
+
+private:
+  static const size_t kBlockSize = 256;
+  static const size_t kBlockCount = 256;
+  // kInvalidUuidId is not a valid id.
+  static const size_t kMaxCount = kBlockSize * kBlockCount - 1;
+
+  // Returns the slot of "uuid" in slots_, or the empty slot where it
+  // belongs. Must be called with the lock held.
+  size_t Probe(const Uuid& uuid) const;
+  void Grow();
+
+  mutable std::mutex mutex_;
+  // Open addressing hash table of ids, at most half full.
+  std::vector<UuidId> slots_;
+  std::atomic<size_t> count_;
+  std::atomic<Uuid*> blocks_[kBlockCount];
+  Uuid null_uuid_;
+
+  UuidInterner(const UuidInterner& other);
+  const UuidInterner& operator=(const UuidInterner& other);
+};
+
+// Process-wide interner used by the btle model objects.
+extern UuidInterner UuidIds;
+
+}  // namespace btle
@@ -0,0 +1,40 @@
+#include "stdafx.h"
+
+#include "btle_test.h"
+#include "btle_uuid_interner.h"
+
+BTLE_TEST(uuid_interner, Intern) {
+  btle::UuidInterner interner;
+  btle::Uuid uuid(0x0123456789abcdefULL, 0xfedcba9876543210ULL);
+  BTLE_EXPECT_EQ(btle::kInvalidUuidId, interner.Find(uuid));
+  btle::UuidId id = interner.Intern(uuid);
+  BTLE_EXPECT(id != btle::kInvalidUuidId);
+  BTLE_EXPECT_EQ(id, interner.Intern(uuid));
+  BTLE_EXPECT_EQ(id, interner.Find(uuid));
+  BTLE_EXPECT(interner.Get(id) == uuid);
+}
+
+// Once all ids are used, new uuids get kInvalidUuidId, which maps to the
+// null uuid, and the uuids interned before keep their ids.
+BTLE_TEST(uuid_interner, Exhausted) {
+  btle::UuidInterner interner;
+  btle::Uuid first(1, 1);
+  btle::UuidId first_id = interner.Intern(first);
+  UINT64 next = 2;
+  while (interner.size() < btle::kInvalidUuidId) {
+    BTLE_EXPECT(interner.Intern(btle::Uuid(next, next)) != btle::kInvalidUuidId);
+    next++;
+  }
+
+  BTLE_EXPECT_EQ(btle::kInvalidUuidId, interner.Intern(btle::Uuid(next, next)));
+  BTLE_EXPECT_EQ(btle::kInvalidUuidId, interner.Find(btle::Uuid(next, next)));
+  BTLE_EXPECT(interner.Get(btle::kInvalidUuidId) == btle::Uuid());
+  BTLE_EXPECT_EQ(first_id, interner.Intern(first));
+  BTLE_EXPECT(interner.Get(first_id) == first);
+}
+
+BTLE_TEST(uuid_interner, GetUnassigned) {
+  btle::UuidInterner interner;
+  BTLE_EXPECT(interner.Get(static_cast<btle::UuidId>(interner.size())) == btle::Uuid());
+  BTLE_EXPECT(interner.Get(btle::kInvalidUuidId) == btle::Uuid());
+}
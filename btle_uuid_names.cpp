@@ -0,0 +1,150 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "btle_guid.h"
+#include "btle_uuid.h"
+#include "btle_uuid_names.h"
+#include "btle_uuid_registry.h"
+
+namespace btle {
+
+namespace {
+
+struct ShortUuidName {
+  USHORT uuid;
+  std::string_view name;
+};
+
+constexpr bool ShortUuidLess(const ShortUuidName& x, const ShortUuidName& y) {
+  return x.uuid < y.uuid;
+}
+
+// Stable insertion sort: for duplicated uuids, the first entry of the header
+// wins, as with the switch it replaces.
+template <typename T, size_t N, typename Less>
+constexpr std::array<T, N> Sorted(std::array<T, N> entries, Less less) {
+  for (size_t i = 1; i < N; i++) {
+    T entry = entries[i];
+    size_t j = i;
+    for (; j > 0 && less(entry, entries[j - 1]); j--)
+      entries[j] = entries[j - 1];
+    entries[j] = entry;
+  }
+  return entries;
+}
+
+constexpr auto kServiceNames = Sorted(std::array{
+#define DEFINE_SERVICE(id, name) ShortUuidName{ id, #name },
+#include "btle_services.h"
+#undef DEFINE_SERVICE
+}, ShortUuidLess);
+
+constexpr auto kCharacteristicNames = Sorted(std::array{
+#define DEFINE_CHARACTERISTIC(id, name) ShortUuidName{ id, #name },
+#include "btle_characteristics.h"
+#undef DEFINE_CHARACTERISTIC
+}, ShortUuidLess);
+
+constexpr auto kDescriptorNames = Sorted(std::array{
+#define DEFINE_DESCRIPTOR(id, name) ShortUuidName{ id, #name },
+#include "btle_descriptors.h"
+#undef DEFINE_DESCRIPTOR
+}, ShortUuidLess);
+
+template <size_t N>
+std::string_view Find(const std::array<ShortUuidName, N>& names, USHORT uuid) {
+  ShortUuidName key = { uuid, std::string_view() };
+  typename std::array<ShortUuidName, N>::const_iterator it = std::lower_bound(names.begin(), names.end(), key, ShortUuidLess);
+  if (it == names.end() || it->uuid != uuid)
+    return std::string_view();
+  return it->name;
+}
+
+const char kHexDigits[] = "0123456789abcdef";
+
+char* WriteHex(char* out, ULONG value, int digits) {
+  for (int i = digits - 1; i >= 0; i--) {
+    out[i] = kHexDigits[value & 0x0f];
+    value >>= 4;
+  }
+  return out + digits;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+std::string_view FindServiceName(const BTH_LE_UUID& uuid) {
+  Uuid normalized(uuid);
+  std::string_view name = UuidNames.Find(kServiceUuid, normalized);
+  if (name.empty() && normalized.IsShort())
+    return Find(kServiceNames, normalized.short_uuid());
+  return name;
+}
+
+std::string_view FindCharacteristicName(const BTH_LE_UUID& uuid) {
+  Uuid normalized(uuid);
+  std::string_view name = UuidNames.Find(kCharacteristicUuid, normalized);
+  if (name.empty() && normalized.IsShort())
+    return Find(kCharacteristicNames, normalized.short_uuid());
+  return name;
+}
+
+std::string_view FindDescriptorName(const BTH_LE_UUID& uuid) {
+  Uuid normalized(uuid);
+  std::string_view name = UuidNames.Find(kDescriptorUuid, normalized);
+  if (name.empty() && normalized.IsShort())
+    return Find(kDescriptorNames, normalized.short_uuid());
+  return name;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+size_t FormatUuid(const BTH_LE_UUID& uuid, char* buffer, size_t size) {
+  char text[kUuidStringSize];
+  char* out = text;
+  if (uuid.IsShortUuid) {
+    // Same form as the stream version: no leading zeros.
+    USHORT value = uuid.Value.ShortUuid;
+    int digits = 1;
+    while (digits < 4 && (value >> (4 * digits)) != 0)
+      digits++;
+    *out++ = '0';
+    *out++ = 'x';
+    out = WriteHex(out, value, digits);
+  } else {
+    out = WriteGuid(uuid.Value.LongUuid, out);
+  }
+
+  size_t length = out - text;
+  if (length + 1 > size)
+    return 0;
+  memcpy(buffer, text, length);
+  buffer[length] = 0;
+  return length;
+}
+
+size_t FormatUuidDisplay(const BTH_LE_UUID& uuid, std::string_view name, char* buffer, size_t size) {
+  size_t length = FormatUuid(uuid, buffer, size);
+  if (length == 0 || name.empty())
+    return length;
+
+  if (length + 3 + name.size() + 2 + 1 > size)
+    return 0;
+  char* out = buffer + length;
+  memcpy(out, " ['", 3);
+  out += 3;
+  memcpy(out, name.data(), name.size());
+  out += name.size();
+  memcpy(out, "']", 2);
+  out += 2;
+  *out = 0;
+  return out - buffer;
+}
+
+}  // namespace btle
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string_view>
+
+#include "btle_platform.h"
+
+#include "base.h"
+
+// Names of the services, characteristics and descriptors listed in the
+// X-macro headers (btle_services.h, btle_characteristics.h, ...).
+//
+// Short uuids, and long uuids derived from the Bluetooth base uuid, are
+// compiled into constant tables sorted by uuid, searched with a binary
+// search. Uuids are first looked up in the UuidNames registry
+// (btle_uuid_registry.h), which vendor files can extend at runtime, so that
+// vendor definitions of base derived uuids are found and take precedence
+// over the tables. Lookups and formatting never allocate.
+namespace btle {
+
+// Return an empty view for unknown uuids.
+std::string_view FindServiceName(const BTH_LE_UUID& uuid);
+std::string_view FindCharacteristicName(const BTH_LE_UUID& uuid);
+std::string_view FindDescriptorName(const BTH_LE_UUID& uuid);
+
+// Largest result of FormatUuid, including the terminating null.
+const size_t kUuidStringSize = 37;
+// Buffer size large enough for FormatUuidDisplay with any name of the tables.
+const size_t kUuidDisplaySize = 128;
+
+// Writes "0x180a" for short uuids, "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx"
+// for long ones, null terminated. Returns the number of characters written,
+// not counting the null, or 0 if "size" is too small.
+size_t FormatUuid(const BTH_LE_UUID& uuid, char* buffer, size_t size);
+
+// Writes "<uuid> ['<name>']", or "<uuid>" if "name" is empty, null
+// terminated. Returns the number of characters written, not counting the
+// null, or 0 if "size" is too small.
+size_t FormatUuidDisplay(const BTH_LE_UUID& uuid, std::string_view name, char* buffer, size_t size);
+
+}  // namespace btle
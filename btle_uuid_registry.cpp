@@ -0,0 +1,216 @@
+#include "stdafx.h"
+
+#include <cstring>
+#include <sstream>
+
+#include "btle_guid.h"
+#include "btle_uuid_registry.h"
+
+namespace btle {
+
+UuidRegistry UuidNames;
+
+namespace {
+
+// Initial number of slots, a power of 2.
+const size_t kInitialSlots = 256;
+
+inline
+UINT64 HashUuid(UuidKind kind, const Uuid& uuid) {
+  return uuid.Hash() ^ (kind * 0x9e3779b97f4a7c15ULL);
+}
+
+inline
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+std::string_view Trim(std::string_view text) {
+  while (!text.empty() && IsSpace(text.front()))
+    text.remove_prefix(1);
+  while (!text.empty() && IsSpace(text.back()))
+    text.remove_suffix(1);
+  return text;
+}
+
+std::string_view NextToken(std::string_view* text) {
+  *text = Trim(*text);
+  size_t end = 0;
+  while (end < text->size() && !IsSpace((*text)[end]))
+    end++;
+  std::string_view token = text->substr(0, end);
+  text->remove_prefix(end);
+  return token;
+}
+
+bool ParseKind(std::string_view text, UuidKind* kind) {
+  if (text == "service") {
+    *kind = kServiceUuid;
+  } else if (text == "characteristic") {
+    *kind = kCharacteristicUuid;
+  } else if (text == "descriptor") {
+    *kind = kDescriptorUuid;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+UuidRegistry::UuidRegistry() : slots_(kInitialSlots), count_(0) {
+  // For duplicated uuids, the first entry of the header wins.
+#define DEFINE_SERVICE_LONG(uuid1, uuid2, uuid3, uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8, name) \
+  { \
+    GUID uuid = { uuid1, uuid2, uuid3, { uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8 } }; \
+    Insert(kServiceUuid, Uuid(uuid), #name, false); \
+  }
+#include "btle_services_long.h"
+#undef DEFINE_SERVICE_LONG
+
+#define DEFINE_CHARACTERISTIC_LONG(uuid1, uuid2, uuid3, uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8, name) \
+  { \
+    GUID uuid = { uuid1, uuid2, uuid3, { uuid_b1, uuid_b2, uuid_b3, uuid_b4, uuid_b5, uuid_b6, uuid_b7, uuid_b8 } }; \
+    Insert(kCharacteristicUuid, Uuid(uuid), #name, false); \
+  }
+#include "btle_characteristics_long.h"
+#undef DEFINE_CHARACTERISTIC_LONG
+}
+
+UuidRegistry::~UuidRegistry() {
+}
+
+bool UuidRegistry::LoadFromFile(const std::wstring& path, std::string* error) {
+  HANDLE file_handle = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error opening uuid file '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  scoped_handle<HANDLE> handle(file_handle);
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(handle.get(), &file_size)) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error getting size of uuid file '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  DWORD size = static_cast<DWORD>(file_size.QuadPart);
+  scoped_array<char> data(new char[size + 1]);
+  DWORD actual_size = 0;
+  if (!ReadFile(handle.get(), data.get(), size, &actual_size, NULL) || actual_size != size) {
+    HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+    std::ostringstream string_stream;
+    string_stream << "Error reading uuid file '" << to_std_string(path) << "': hr=" << hr << ".";
+    *error = string_stream.str();
+    return false;
+  }
+
+  return LoadFromBuffer(data.get(), size, error);
+}
+
+bool UuidRegistry::LoadFromBuffer(const char* data, size_t size, std::string* error) {
+  std::string_view text(data, size);
+  int line_number = 0;
+  while (!text.empty()) {
+    line_number++;
+    size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+
+    size_t comment = line.find('#');
+    if (comment != std::string_view::npos)
+      line = line.substr(0, comment);
+    line = Trim(line);
+    if (line.empty())
+      continue;
+
+    UuidKind kind;
+    GUID uuid;
+    std::string_view kind_text = NextToken(&line);
+    std::string_view uuid_text = NextToken(&line);
+    std::string_view name = Trim(line);
+    if (!ParseKind(kind_text, &kind) || !ParseGuid(uuid_text, &uuid) || name.empty()) {
+      std::ostringstream string_stream;
+      string_stream << "Invalid uuid definition at line " << line_number << ".";
+      *error = string_stream.str();
+      return false;
+    }
+    Add(kind, uuid, name);
+  }
+  return true;
+}
+
+void UuidRegistry::Add(UuidKind kind, const GUID& uuid, std::string_view name) {
+  Uuid normalized(uuid);
+  Entry& entry = slots_[Probe(kind, normalized, HashUuid(kind, normalized))];
+  if (entry.used && entry.name_index != kBuiltInName) {
+    names_[entry.name_index].assign(name.data(), name.size());
+    entry.name = names_[entry.name_index];
+    return;
+  }
+
+  names_.push_back(std::string(name));
+  Insert(kind, normalized, names_.back(), true);
+  slots_[Probe(kind, normalized, HashUuid(kind, normalized))].name_index = names_.size() - 1;
+}
+
+std::string_view UuidRegistry::Find(UuidKind kind, const GUID& uuid) const {
+  return Find(kind, Uuid(uuid));
+}
+
+std::string_view UuidRegistry::Find(UuidKind kind, const Uuid& uuid) const {
+  const Entry& entry = slots_[Probe(kind, uuid, HashUuid(kind, uuid))];
+  return entry.used ? entry.name : std::string_view();
+}
+
+size_t UuidRegistry::Probe(UuidKind kind, const Uuid& uuid, UINT64 hash) const {
+  size_t mask = slots_.size() - 1;
+  size_t index = static_cast<size_t>(hash) & mask;
+  for (;;) {
+    const Entry& entry = slots_[index];
+    if (!entry.used)
+      return index;
+    if (entry.hash == hash && entry.kind == kind && entry.uuid == uuid)
+      return index;
+    index = (index + 1) & mask;
+  }
+}
+
+void UuidRegistry::Insert(UuidKind kind, const Uuid& uuid, std::string_view name, bool replace) {
+  if ((count_ + 1) * 2 > slots_.size())
+    Grow();
+
+  UINT64 hash = HashUuid(kind, uuid);
+  Entry& entry = slots_[Probe(kind, uuid, hash)];
+  if (entry.used) {
+    if (replace)
+      entry.name = name;
+    return;
+  }
+  entry.used = true;
+  entry.kind = kind;
+  entry.hash = hash;
+  entry.uuid = uuid;
+  entry.name = name;
+  count_++;
+}
+
+void UuidRegistry::Grow() {
+  std::vector<Entry> slots(slots_.size() * 2);
+  slots_.swap(slots);
+  for (std::vector<Entry>::const_iterator it = slots.begin(); it != slots.end(); ++it) {
+    if (it->used)
+      slots_[Probe(it->kind, it->uuid, it->hash)] = *it;
+  }
+}
+
+}  // namespace btle
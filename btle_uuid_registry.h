@@ -0,0 +1,92 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "base.h"
+#include "btle_uuid.h"
+
+namespace btle {
+
+enum UuidKind {
+  kServiceUuid,
+  kCharacteristicUuid,
+  kDescriptorUuid,
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// Names of 128-bit service, characteristic and descriptor uuids: the
+// entries of btle_services_long.h and btle_characteristics_long.h, plus
+// vendor definitions loaded at runtime.
+//
+// Entries live in an open addressing hash table (linear probing, at most
+// half full) over the uuid and its kind, so lookups take constant time
+// however many vendor entries are loaded.
+//
+// Vendor files have one definition per line, "#" starts a comment:
+//
+//   service         f000aa00-0451-4000-b000-000000000000 IR_Temperature_Service
+//   characteristic  f000aa01-0451-4000-b000-000000000000 IR_Temperature_Data
+//   descriptor      ...
+//
+// A vendor definition replaces a built-in one, or an earlier vendor one,
+// with the same uuid and kind. Vendor definitions of uuids derived from the
+// Bluetooth base uuid also take precedence over the short uuid tables of
+// btle_uuid_names.h. Loading is not thread safe: load vendor files at
+// startup, before any lookup.
+//
+class UuidRegistry {
+public:
+  // Starts with the built-in entries.
+  UuidRegistry();
+  ~UuidRegistry();
+
+  bool LoadFromFile(const std::wstring& path, std::string* error);
+  bool LoadFromBuffer(const char* data, size_t size, std::string* error);
+
+  void Add(UuidKind kind, const GUID& uuid, std::string_view name);
+
+  // Returns an empty view for unknown uuids. The name of a vendor entry stays
+  // valid until the entry is replaced.
+  std::string_view Find(UuidKind kind, const GUID& uuid) const;
+  std::string_view Find(UuidKind kind, const Uuid& uuid) const;
+
+  size_t size() const { return count_; }
+
+private:
+  static const size_t kBuiltInName = static_cast<size_t>(-1);
+
+  struct Entry {
+    Entry() : used(false), kind(kServiceUuid), hash(0), name_index(kBuiltInName) {
+    }
+
+    bool used;
+    UuidKind kind;
+    UINT64 hash;
+    Uuid uuid;
+    std::string_view name;
+    // Index of the name in "names_" for vendor entries.
+    size_t name_index;
+  };
+
+  // Returns the slot of the entry, or the empty slot where it belongs.
+  size_t Probe(UuidKind kind, const Uuid& uuid, UINT64 hash) const;
+  void Insert(UuidKind kind, const Uuid& uuid, std::string_view name, bool replace);
+  void Grow();
+
+  std::vector<Entry> slots_;
+  size_t count_;
+  // Names of vendor entries, one per entry: replacing a vendor entry
+  // reuses its name. A deque keeps them in place as it grows.
+  std::deque<std::string> names_;
+
+  UuidRegistry(const UuidRegistry& other);
+  const UuidRegistry& operator=(const UuidRegistry& other);
+};
+
+// Registry used by the Find*Name() functions of btle_uuid_names.h.
+extern UuidRegistry UuidNames;
+
+}  // namespace btle
@@ -0,0 +1,55 @@
+#include "stdafx.h"
+
+#include <string>
+
+#include "btle_test.h"
+#include "btle_uuid.h"
+#include "btle_uuid_names.h"
+#include "btle_uuid_registry.h"
+
+namespace {
+
+const GUID kVendorUuid = { 0xf000aa70, 0x0451, 0x4000, { 0xb0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } };
+
+}  // namespace
+
+BTLE_TEST(uuid_registry, LoadFromBuffer) {
+  btle::UuidRegistry registry;
+  std::string text =
+    "# vendor definitions\n"
+    "service f000aa70-0451-4000-b000-000000000000 Vendor_Service\n"
+    "characteristic 00002a37-0000-1000-8000-00805f9b34fb Vendor_Rate  # base derived\n";
+  std::string error;
+  BTLE_EXPECT(registry.LoadFromBuffer(text.data(), text.size(), &error));
+  BTLE_EXPECT(registry.Find(btle::kServiceUuid, kVendorUuid) == "Vendor_Service");
+  BTLE_EXPECT(registry.Find(btle::kCharacteristicUuid, btle::Uuid(static_cast<USHORT>(0x2a37))) == "Vendor_Rate");
+  BTLE_EXPECT(registry.Find(btle::kCharacteristicUuid, kVendorUuid).empty());
+
+  std::string invalid = "service not-a-uuid Name\n";
+  BTLE_EXPECT(!registry.LoadFromBuffer(invalid.data(), invalid.size(), &error));
+}
+
+// Adding a uuid again replaces its name in place, without growing the
+// registry.
+BTLE_TEST(uuid_registry, AddReplaces) {
+  btle::UuidRegistry registry;
+  size_t size = registry.size();
+  registry.Add(btle::kServiceUuid, kVendorUuid, "First");
+  BTLE_EXPECT_EQ(size + 1, registry.size());
+  for (int i = 0; i < 100; i++)
+    registry.Add(btle::kServiceUuid, kVendorUuid, "Name_" + std::to_string(i));
+  BTLE_EXPECT_EQ(size + 1, registry.size());
+  BTLE_EXPECT(registry.Find(btle::kServiceUuid, kVendorUuid) == "Name_99");
+}
+
+// Vendor names of base derived uuids are found through the Find*Name()
+// functions, which otherwise use the short uuid tables.
+BTLE_TEST(uuid_registry, FindNameOfBaseDerivedUuid) {
+  BTH_LE_UUID uuid = btle::Uuid(static_cast<USHORT>(0x29f0)).ToBthLeUuid();
+  BTLE_EXPECT(btle::FindDescriptorName(uuid).empty());
+  btle::UuidNames.Add(btle::kDescriptorUuid, btle::Uuid(static_cast<USHORT>(0x29f0)).ToGuid(), "Vendor_Descriptor");
+  BTLE_EXPECT(btle::FindDescriptorName(uuid) == "Vendor_Descriptor");
+
+  BTH_LE_UUID builtin = btle::Uuid(static_cast<USHORT>(0x2902)).ToBthLeUuid();
+  BTLE_EXPECT(btle::FindDescriptorName(builtin) == "Client_Characteristic_Configuration");
+}
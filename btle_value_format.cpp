@@ -0,0 +1,136 @@
+#include "stdafx.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "btle_ieee11073.h"
+#include "btle_value_format.h"
+
+namespace btle {
+
+namespace {
+
+template <int kBytes>
+inline
+UINT64 ReadUnsigned(const UINT8* data) {
+  UINT64 result = 0;
+  for (int i = 0; i < kBytes; i++)
+    result |= static_cast<UINT64>(data[i]) << (8 * i);
+  return result;
+}
+
+template <int kBits>
+inline
+INT64 SignExtend(UINT64 value) {
+  return static_cast<INT64>(value << (64 - kBits)) >> (64 - kBits);
+}
+
+template <int kBytes, int kBits>
+double DecodeUnsigned(const UINT8* data) {
+  return static_cast<double>(ReadUnsigned<kBytes>(data) & (~0ULL >> (64 - kBits)));
+}
+
+template <int kBytes, int kBits>
+double DecodeSigned(const UINT8* data) {
+  return static_cast<double>(SignExtend<kBits>(ReadUnsigned<kBytes>(data)));
+}
+
+double DecodeFloat32(const UINT8* data) {
+  UINT32 bits = static_cast<UINT32>(ReadUnsigned<4>(data));
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+double DecodeFloat64(const UINT8* data) {
+  UINT64 bits = ReadUnsigned<8>(data);
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+double DecodeSFloat(const UINT8* data) {
+  return ieee11073::SFloatToDouble(static_cast<UINT16>(ReadUnsigned<2>(data)));
+}
+
+double DecodeFloat(const UINT8* data) {
+  return ieee11073::FloatToDouble(static_cast<UINT32>(ReadUnsigned<4>(data)));
+}
+
+struct FormatInfo {
+  UCHAR format;
+  const char* name;
+  size_t size;
+  ValueFormat::DecodeFunction decode;
+  // Whether the exponent applies.
+  bool scaled;
+};
+
+// See https://developer.bluetooth.org/gatt/descriptors/Pages/DescriptorViewer.aspx?u=org.bluetooth.descriptor.gatt.characteristic_presentation_format.xml
+const FormatInfo kFormats[] = {
+  { 0x01, "boolean", 1, DecodeUnsigned<1, 1>, false },
+  { 0x02, "2bit", 1, DecodeUnsigned<1, 2>, false },
+  { 0x03, "nibble", 1, DecodeUnsigned<1, 4>, false },
+  { 0x04, "uint8", 1, DecodeUnsigned<1, 8>, true },
+  { 0x05, "uint12", 2, DecodeUnsigned<2, 12>, true },
+  { 0x06, "uint16", 2, DecodeUnsigned<2, 16>, true },
+  { 0x07, "uint24", 3, DecodeUnsigned<3, 24>, true },
+  { 0x08, "uint32", 4, DecodeUnsigned<4, 32>, true },
+  { 0x09, "uint48", 6, DecodeUnsigned<6, 48>, true },
+  { 0x0a, "uint64", 8, DecodeUnsigned<8, 64>, true },
+  { 0x0c, "sint8", 1, DecodeSigned<1, 8>, true },
+  { 0x0d, "sint12", 2, DecodeSigned<2, 12>, true },
+  { 0x0e, "sint16", 2, DecodeSigned<2, 16>, true },
+  { 0x0f, "sint24", 3, DecodeSigned<3, 24>, true },
+  { 0x10, "sint32", 4, DecodeSigned<4, 32>, true },
+  { 0x11, "sint48", 6, DecodeSigned<6, 48>, true },
+  { 0x12, "sint64", 8, DecodeSigned<8, 64>, true },
+  { 0x14, "float32", 4, DecodeFloat32, false },
+  { 0x15, "float64", 8, DecodeFloat64, false },
+  { 0x16, "SFLOAT", 2, DecodeSFloat, false },
+  { 0x17, "FLOAT", 4, DecodeFloat, false },
+};
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//
+ValueFormat::ValueFormat()
+  : decode_(NULL),
+    size_(0),
+    multiplier_(1.0),
+    divisor_(1.0),
+    format_(0),
+    format_name_(""),
+    exponent_(0) {
+  memset(&unit_, 0, sizeof(unit_));
+}
+
+bool ValueFormat::Compile(UCHAR format, CHAR exponent, const BTH_LE_UUID& unit, ValueFormat* value_format, std::string* error) {
+  for (size_t i = 0; i < sizeof(kFormats) / sizeof(kFormats[0]); i++) {
+    const FormatInfo& info = kFormats[i];
+    if (info.format != format)
+      continue;
+
+    ValueFormat result;
+    result.decode_ = info.decode;
+    result.size_ = info.size;
+    result.format_ = format;
+    result.format_name_ = info.name;
+    result.exponent_ = exponent;
+    result.unit_ = unit;
+    // Divide by 10^-exponent rather than multiply by an inexact 10^exponent.
+    if (info.scaled && exponent > 0)
+      result.multiplier_ = pow(10.0, exponent);
+    if (info.scaled && exponent < 0)
+      result.divisor_ = pow(10.0, -exponent);
+    *value_format = result;
+    return true;
+  }
+
+  *error = "Unsupported presentation format";
+  return false;
+}
+
+}  // namespace btle
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+
+#include "btle_platform.h"
+
+#include "base.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Decoder for the values of a characteristic described by a Characteristic
+// Presentation Format descriptor (0x2904): the format, exponent and unit of
+// the descriptor are compiled once into a decode function and a scale, so
+// decoding a value is a single indirect call.
+//
+// Only the numeric formats are supported (boolean to 64-bit integers,
+// IEEE-754 and IEEE-11073 floats). The exponent applies to integer formats.
+//
+class ValueFormat {
+public:
+  typedef double (*DecodeFunction)(const UINT8* data);
+
+  ValueFormat();
+
+  static bool Compile(UCHAR format, CHAR exponent, const BTH_LE_UUID& unit, ValueFormat* value_format, std::string* error);
+
+  bool valid() const { return decode_ != NULL; }
+  UCHAR format() const { return format_; }
+  const char* format_name() const { return format_name_; }
+  int exponent() const { return exponent_; }
+  const BTH_LE_UUID& unit() const { return unit_; }
+  // Number of bytes of a value.
+  size_t size() const { return size_; }
+
+  // Decodes a value of the characteristic, scaled by 10^exponent.
+  bool Decode(const UINT8* data, size_t size, double* value) const {
+    if (decode_ == NULL || size < size_)
+      return false;
+    *value = decode_(data) * multiplier_ / divisor_;
+    return true;
+  }
+
+private:
+  DecodeFunction decode_;
+  size_t size_;
+  double multiplier_;
+  double divisor_;
+  UCHAR format_;
+  const char* format_name_;
+  int exponent_;
+  BTH_LE_UUID unit_;
+};
+
+}  // namespace btle
@@ -0,0 +1,105 @@
+#include "stdafx.h"
+
+#include <string>
+
+#include "btle_test.h"
+#include "btle_uuid.h"
+#include "btle_value_format.h"
+
+namespace {
+
+// "Celsius temperature (degree Celsius)" unit.
+const BTH_LE_UUID kCelsius = btle::Uuid(static_cast<USHORT>(0x272f)).ToBthLeUuid();
+
+// Decodes "data" as "format" with "exponent", or returns -12345 if the
+// format does not compile or decode.
+double Decode(UCHAR format, CHAR exponent, const UINT8* data, size_t size) {
+  btle::ValueFormat value_format;
+  std::string error;
+  double value;
+  if (!btle::ValueFormat::Compile(format, exponent, kCelsius, &value_format, &error) ||
+      !value_format.Decode(data, size, &value))
+    return -12345;
+  return value;
+}
+
+}  // namespace
+
+// The 128-bit integers, the string and struct formats and the reserved
+// values are not compiled.
+BTLE_TEST(value_format, CompileRejectsUnsupportedFormats) {
+  const UCHAR kUnsupported[] = { 0x00, 0x0b, 0x13, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0xff };
+  for (size_t i = 0; i < sizeof(kUnsupported); i++) {
+    btle::ValueFormat value_format;
+    std::string error;
+    BTLE_EXPECT(!btle::ValueFormat::Compile(kUnsupported[i], 0, kCelsius, &value_format, &error));
+    BTLE_EXPECT_EQ(std::string("Unsupported presentation format"), error);
+    BTLE_EXPECT(!value_format.valid());
+  }
+
+  btle::ValueFormat value_format;
+  std::string error;
+  BTLE_EXPECT(btle::ValueFormat::Compile(0x0f, -2, kCelsius, &value_format, &error));
+  BTLE_EXPECT(value_format.valid());
+  BTLE_EXPECT_EQ(std::string("sint24"), std::string(value_format.format_name()));
+  BTLE_EXPECT_EQ(3u, value_format.size());
+  BTLE_EXPECT_EQ(-2, value_format.exponent());
+  BTLE_EXPECT(btle::Uuid(value_format.unit()) == btle::Uuid(kCelsius));
+
+  // Values shorter than the format are not decoded, nor values of a format
+  // that was not compiled.
+  const UINT8 data[3] = { 0x01, 0x02, 0x03 };
+  double value;
+  BTLE_EXPECT(!value_format.Decode(data, 2, &value));
+  BTLE_EXPECT(!btle::ValueFormat().Decode(data, sizeof(data), &value));
+}
+
+// Integers are scaled by 10^exponent, dividing for negative exponents so
+// that the result is the closest double to the decimal value.
+BTLE_TEST(value_format, Exponent) {
+  const UINT8 data[2] = { 0xd2, 0x04 };  // 1234
+  BTLE_EXPECT_EQ(1234.0, Decode(0x06, 0, data, sizeof(data)));
+  BTLE_EXPECT_EQ(12.34, Decode(0x06, -2, data, sizeof(data)));
+  BTLE_EXPECT_EQ(0.001234, Decode(0x06, -6, data, sizeof(data)));
+  BTLE_EXPECT_EQ(123400.0, Decode(0x06, 2, data, sizeof(data)));
+  BTLE_EXPECT_EQ(1234e10, Decode(0x06, 10, data, sizeof(data)));
+
+  const UINT8 negative[2] = { 0x2e, 0xfb };  // -1234
+  BTLE_EXPECT_EQ(-12.34, Decode(0x0e, -2, negative, sizeof(negative)));
+  BTLE_EXPECT_EQ(-1234000.0, Decode(0x0e, 3, negative, sizeof(negative)));
+
+  // The exponent does not apply to booleans, bit fields and floats.
+  const UINT8 one[1] = { 0x01 };
+  const UINT8 float_one[4] = { 0x00, 0x00, 0x80, 0x3f };
+  BTLE_EXPECT_EQ(1.0, Decode(0x01, 3, one, sizeof(one)));
+  BTLE_EXPECT_EQ(1.0, Decode(0x03, -3, one, sizeof(one)));
+  BTLE_EXPECT_EQ(1.0, Decode(0x14, -2, float_one, sizeof(float_one)));
+}
+
+// The 24-bit and 12-bit signed formats are sign extended, and the bits
+// above the 12-bit and sub-byte formats are ignored.
+BTLE_TEST(value_format, SignExtension) {
+  const UINT8 s24_min[3] = { 0x00, 0x00, 0x80 };
+  const UINT8 s24_minus_one[3] = { 0xff, 0xff, 0xff };
+  const UINT8 s24_max[3] = { 0xff, 0xff, 0x7f };
+  BTLE_EXPECT_EQ(-8388608.0, Decode(0x0f, 0, s24_min, 3));
+  BTLE_EXPECT_EQ(-1.0, Decode(0x0f, 0, s24_minus_one, 3));
+  BTLE_EXPECT_EQ(8388607.0, Decode(0x0f, 0, s24_max, 3));
+  BTLE_EXPECT_EQ(16777215.0, Decode(0x07, 0, s24_minus_one, 3));
+
+  const UINT8 s12_min[2] = { 0x00, 0x08 };
+  const UINT8 s12_minus_one[2] = { 0xff, 0x0f };
+  const UINT8 s12_high_bits[2] = { 0xff, 0xf7 };
+  BTLE_EXPECT_EQ(-2048.0, Decode(0x0d, 0, s12_min, 2));
+  BTLE_EXPECT_EQ(-1.0, Decode(0x0d, 0, s12_minus_one, 2));
+  BTLE_EXPECT_EQ(2047.0, Decode(0x0d, 0, s12_high_bits, 2));
+  BTLE_EXPECT_EQ(-0.1, Decode(0x0d, -1, s12_minus_one, 2));
+  BTLE_EXPECT_EQ(4095.0, Decode(0x05, 0, s12_minus_one, 2));
+  BTLE_EXPECT_EQ(2047.0, Decode(0x05, 0, s12_high_bits, 2));
+
+  const UINT8 ones[1] = { 0xff };
+  BTLE_EXPECT_EQ(1.0, Decode(0x01, 0, ones, 1));
+  BTLE_EXPECT_EQ(3.0, Decode(0x02, 0, ones, 1));
+  BTLE_EXPECT_EQ(15.0, Decode(0x03, 0, ones, 1));
+  BTLE_EXPECT_EQ(-1.0, Decode(0x0c, 0, ones, 1));
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "base.h"
+#include "btle.h"
+#include "btle_ieee11073.h"
+
+namespace btle {
+
+//////////////////////////////////////////////////////////////////////////////
+// Non-owning view over the bytes of a characteristic or descriptor value,
+// with bounds checked little-endian accessors. A view never allocates and
+// is only valid as long as the bytes it points to.
+//
+// Get*(offset) read at an offset of the view, Read*() read at the cursor and
+// advance it. All accessors return false, and leave the cursor unchanged,
+// when the value is too short.
+//
+class ValueView {
+public:
+  ValueView() : data_(NULL), size_(0), position_(0) {
+  }
+
+  ValueView(const UINT8* data, size_t size) : data_(data), size_(size), position_(0) {
+  }
+
+  explicit ValueView(const CharacteristicValue& value)
+    : data_(value.info().Data), size_(value.info().DataSize), position_(0) {
+  }
+
+  explicit ValueView(const DescriptorValue& value)
+    : data_(value.info().Data), size_(value.info().DataSize), position_(0) {
+  }
+
+  const UINT8* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  size_t position() const { return position_; }
+  size_t remaining() const { return size_ - position_; }
+  bool Seek(size_t position) {
+    if (position > size_)
+      return false;
+    position_ = position;
+    return true;
+  }
+
+  bool GetUInt8(size_t offset, UINT8* value) const {
+    if (!Check(offset, 1))
+      return false;
+    *value = data_[offset];
+    return true;
+  }
+
+  bool GetInt8(size_t offset, INT8* value) const {
+    if (!Check(offset, 1))
+      return false;
+    *value = static_cast<INT8>(data_[offset]);
+    return true;
+  }
+
+  bool GetUInt16(size_t offset, UINT16* value) const {
+    if (!Check(offset, 2))
+      return false;
+    *value = static_cast<UINT16>(Load(offset, 2));
+    return true;
+  }
+
+  bool GetInt16(size_t offset, INT16* value) const {
+    if (!Check(offset, 2))
+      return false;
+    *value = static_cast<INT16>(Load(offset, 2));
+    return true;
+  }
+
+  bool GetUInt24(size_t offset, UINT32* value) const {
+    if (!Check(offset, 3))
+      return false;
+    *value = Load(offset, 3);
+    return true;
+  }
+
+  bool GetInt24(size_t offset, INT32* value) const {
+    if (!Check(offset, 3))
+      return false;
+    *value = static_cast<INT32>(Load(offset, 3) << 8) >> 8;
+    return true;
+  }
+
+  bool GetUInt32(size_t offset, UINT32* value) const {
+    if (!Check(offset, 4))
+      return false;
+    *value = Load(offset, 4);
+    return true;
+  }
+
+  bool GetInt32(size_t offset, INT32* value) const {
+    if (!Check(offset, 4))
+      return false;
+    *value = static_cast<INT32>(Load(offset, 4));
+    return true;
+  }
+
+  // IEEE-11073 16-bit SFLOAT and 32-bit FLOAT.
+  bool GetSFloat(size_t offset, double* value) const {
+    if (!Check(offset, 2))
+      return false;
+    *value = ieee11073::SFloatToDouble(static_cast<UINT16>(Load(offset, 2)));
+    return true;
+  }
+
+  bool GetFloat(size_t offset, double* value) const {
+    if (!Check(offset, 4))
+      return false;
+    *value = ieee11073::FloatToDouble(Load(offset, 4));
+    return true;
+  }
+
+  // "size" bytes starting at "offset".
+  bool GetView(size_t offset, size_t size, ValueView* view) const {
+    if (!Check(offset, size))
+      return false;
+    *view = ValueView(data_ + offset, size);
+    return true;
+  }
+
+  bool ReadUInt8(UINT8* value) { return Advance(GetUInt8(position_, value), 1); }
+  bool ReadInt8(INT8* value) { return Advance(GetInt8(position_, value), 1); }
+  bool ReadUInt16(UINT16* value) { return Advance(GetUInt16(position_, value), 2); }
+  bool ReadInt16(INT16* value) { return Advance(GetInt16(position_, value), 2); }
+  bool ReadUInt24(UINT32* value) { return Advance(GetUInt24(position_, value), 3); }
+  bool ReadInt24(INT32* value) { return Advance(GetInt24(position_, value), 3); }
+  bool ReadUInt32(UINT32* value) { return Advance(GetUInt32(position_, value), 4); }
+  bool ReadInt32(INT32* value) { return Advance(GetInt32(position_, value), 4); }
+  bool ReadSFloat(double* value) { return Advance(GetSFloat(position_, value), 2); }
+  bool ReadFloat(double* value) { return Advance(GetFloat(position_, value), 4); }
+  bool ReadView(size_t size, ValueView* view) { return Advance(GetView(position_, size, view), size); }
+
+  bool Skip(size_t size) { return Advance(Check(position_, size), size); }
+
+private:
+  bool Check(size_t offset, size_t size) const {
+    return offset <= size_ && size <= size_ - offset;
+  }
+
+  UINT32 Load(size_t offset, size_t size) const {
+    UINT32 result = 0;
+    for (size_t i = 0; i < size; i++)
+      result |= static_cast<UINT32>(data_[offset + i]) << (8 * i);
+    return result;
+  }
+
+  bool Advance(bool success, size_t size) {
+    if (success)
+      position_ += size;
+    return success;
+  }
+
+  const UINT8* data_;
+  size_t size_;
+  size_t position_;
+};
+
+}  // namespace btle
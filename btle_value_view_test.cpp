@@ -0,0 +1,166 @@
+#include "stdafx.h"
+
+#include <cmath>
+
+#include "btle_test.h"
+#include "btle_value_view.h"
+
+// Every accessor fails at an offset too close to the end, or past it,
+// without writing its result.
+BTLE_TEST(value_view, GetOutOfRange) {
+  const UINT8 data[4] = { 0x01, 0x02, 0x03, 0x04 };
+  btle::ValueView view(data, sizeof(data));
+
+  UINT8 u8 = 0xaa;
+  INT8 s8 = 0x55;
+  UINT16 u16 = 0xaaaa;
+  INT16 s16 = 0x5555;
+  UINT32 u32 = 0xaaaaaaaa;
+  INT32 s32 = 0x55555555;
+  double number = 42.0;
+  BTLE_EXPECT(view.GetUInt8(3, &u8));
+  BTLE_EXPECT(!view.GetUInt8(4, &u8));
+  BTLE_EXPECT(!view.GetInt8(4, &s8));
+  BTLE_EXPECT(!view.GetUInt16(3, &u16));
+  BTLE_EXPECT(!view.GetInt16(3, &s16));
+  BTLE_EXPECT(!view.GetUInt24(2, &u32));
+  BTLE_EXPECT(!view.GetInt24(2, &s32));
+  BTLE_EXPECT(!view.GetUInt32(1, &u32));
+  BTLE_EXPECT(!view.GetInt32(1, &s32));
+  BTLE_EXPECT(!view.GetSFloat(3, &number));
+  BTLE_EXPECT(!view.GetFloat(1, &number));
+  BTLE_EXPECT(!view.GetUInt32(~static_cast<size_t>(0), &u32));
+  BTLE_EXPECT_EQ(0x04, u8);
+  BTLE_EXPECT_EQ(0x55, s8);
+  BTLE_EXPECT_EQ(0xaaaa, u16);
+  BTLE_EXPECT_EQ(0x5555, s16);
+  BTLE_EXPECT_EQ(0xaaaaaaaau, u32);
+  BTLE_EXPECT_EQ(0x55555555, s32);
+  BTLE_EXPECT_EQ(42.0, number);
+
+  BTLE_EXPECT(view.GetUInt32(0, &u32));
+  BTLE_EXPECT_EQ(0x04030201u, u32);
+
+  btle::ValueView empty;
+  BTLE_EXPECT(empty.empty());
+  BTLE_EXPECT(!empty.GetUInt8(0, &u8));
+}
+
+// Read*() fail at the end of the value and leave the cursor where it was.
+BTLE_TEST(value_view, ReadOutOfRange) {
+  const UINT8 data[3] = { 0x01, 0x02, 0x03 };
+  btle::ValueView view(data, sizeof(data));
+
+  UINT16 u16;
+  UINT32 u32;
+  INT32 s32;
+  double number;
+  BTLE_EXPECT(view.ReadUInt16(&u16));
+  BTLE_EXPECT_EQ(0x0201, u16);
+  BTLE_EXPECT(!view.ReadUInt16(&u16));
+  BTLE_EXPECT(!view.ReadUInt24(&u32));
+  BTLE_EXPECT(!view.ReadInt24(&s32));
+  BTLE_EXPECT(!view.ReadUInt32(&u32));
+  BTLE_EXPECT(!view.ReadSFloat(&number));
+  BTLE_EXPECT(!view.ReadFloat(&number));
+  BTLE_EXPECT_EQ(2u, view.position());
+  BTLE_EXPECT_EQ(1u, view.remaining());
+
+  UINT8 u8;
+  BTLE_EXPECT(view.ReadUInt8(&u8));
+  BTLE_EXPECT_EQ(0x03, u8);
+  BTLE_EXPECT(!view.ReadUInt8(&u8));
+  BTLE_EXPECT_EQ(3u, view.position());
+  BTLE_EXPECT_EQ(0u, view.remaining());
+
+  BTLE_EXPECT(!view.Seek(4));
+  BTLE_EXPECT(view.Seek(1));
+  BTLE_EXPECT(view.ReadUInt16(&u16));
+  BTLE_EXPECT_EQ(0x0302, u16);
+}
+
+// GetView()/ReadView()/Skip() past the end fail, including with sizes
+// whose sum with the offset overflows.
+BTLE_TEST(value_view, ViewAndSkipPastEnd) {
+  const UINT8 data[4] = { 0x01, 0x02, 0x03, 0x04 };
+  btle::ValueView view(data, sizeof(data));
+  const size_t kHuge = ~static_cast<size_t>(0);
+
+  btle::ValueView sub;
+  BTLE_EXPECT(view.GetView(1, 3, &sub));
+  BTLE_EXPECT_EQ(3u, sub.size());
+  BTLE_EXPECT(sub.data() == data + 1);
+  BTLE_EXPECT(view.GetView(4, 0, &sub));
+  BTLE_EXPECT(sub.empty());
+  BTLE_EXPECT(!view.GetView(1, 4, &sub));
+  BTLE_EXPECT(!view.GetView(5, 0, &sub));
+  BTLE_EXPECT(!view.GetView(1, kHuge, &sub));
+  BTLE_EXPECT(!view.GetView(kHuge, 2, &sub));
+
+  BTLE_EXPECT(view.Skip(1));
+  BTLE_EXPECT(!view.Skip(4));
+  BTLE_EXPECT(!view.Skip(kHuge));
+  BTLE_EXPECT_EQ(1u, view.position());
+  BTLE_EXPECT(!view.ReadView(4, &sub));
+  BTLE_EXPECT(view.ReadView(2, &sub));
+  BTLE_EXPECT_EQ(3u, view.position());
+  UINT8 u8;
+  BTLE_EXPECT(sub.GetUInt8(1, &u8));
+  BTLE_EXPECT_EQ(0x03, u8);
+  BTLE_EXPECT(!sub.GetUInt8(2, &u8));
+  BTLE_EXPECT(view.Skip(1));
+  BTLE_EXPECT(view.Skip(0));
+  BTLE_EXPECT(!view.Skip(1));
+  BTLE_EXPECT_EQ(4u, view.position());
+}
+
+// 24-bit values are sign extended from bit 23.
+BTLE_TEST(value_view, Int24SignExtension) {
+  const UINT8 data[12] = {
+    0x00, 0x00, 0x80,
+    0xff, 0xff, 0xff,
+    0xff, 0xff, 0x7f,
+    0x01, 0x00, 0x00,
+  };
+  btle::ValueView view(data, sizeof(data));
+  INT32 value;
+  BTLE_EXPECT(view.ReadInt24(&value));
+  BTLE_EXPECT_EQ(-8388608, value);
+  BTLE_EXPECT(view.ReadInt24(&value));
+  BTLE_EXPECT_EQ(-1, value);
+  BTLE_EXPECT(view.ReadInt24(&value));
+  BTLE_EXPECT_EQ(8388607, value);
+  BTLE_EXPECT(view.ReadInt24(&value));
+  BTLE_EXPECT_EQ(1, value);
+
+  UINT32 unsigned_value;
+  BTLE_EXPECT(view.GetUInt24(0, &unsigned_value));
+  BTLE_EXPECT_EQ(0x800000u, unsigned_value);
+  BTLE_EXPECT(view.GetUInt24(3, &unsigned_value));
+  BTLE_EXPECT_EQ(0xffffffu, unsigned_value);
+}
+
+// SFLOATs read through the cursor: 4-bit exponent, 12-bit mantissa, both
+// signed, and the NaN special value.
+BTLE_TEST(value_view, ReadSFloat) {
+  const UINT8 data[9] = {
+    0x72, 0x00,  // 114
+    0x72, 0xf0,  // 11.4
+    0x8c, 0xff,  // -116 * 10^-1
+    0xff, 0x07,  // NaN
+    0x01,
+  };
+  btle::ValueView view(data, sizeof(data));
+  double value;
+  BTLE_EXPECT(view.ReadSFloat(&value));
+  BTLE_EXPECT_EQ(114.0, value);
+  BTLE_EXPECT(view.ReadSFloat(&value));
+  BTLE_EXPECT_EQ(11.4, value);
+  BTLE_EXPECT(view.ReadSFloat(&value));
+  BTLE_EXPECT_EQ(-11.6, value);
+  BTLE_EXPECT(view.ReadSFloat(&value));
+  BTLE_EXPECT(std::isnan(value));
+  BTLE_EXPECT_EQ(8u, view.position());
+  BTLE_EXPECT(!view.ReadSFloat(&value));
+  BTLE_EXPECT_EQ(8u, view.position());
+}
@@ -1,16 +1,26 @@
-// stdafx.h : include file for standard system include files,
-// or project specific include files that are used frequently, but
-// are changed infrequently
-//
-
-#pragma once
-
-#include "targetver.h"
-
-#include <stdio.h>
-#include <tchar.h>
-
-// TODO: reference additional headers your program requires here
-#include <windows.h>
-
-#pragma warning(disable: 4800)
+// stdafx.h : include file for standard system include files,
+// or project specific include files that are used frequently, but
+// are changed infrequently
+//
+
+#pragma once
+
+#ifdef _WIN32
+
+#include "targetver.h"
+
+#include <stdio.h>
+#include <tchar.h>
+
+// TODO: reference additional headers your program requires here
+#include <windows.h>
+
+#pragma warning(disable: 4800)
+
+#else
+
+#include <stdio.h>
+
+#include "btle_posix.h"
+
+#endif